@@ -1,43 +1,248 @@
 #include "AnimatedGLTFObj.h"
+#include "DualQuaternionSkinning.h"
+#include "AnimationStateMachine.h"
+#include <limits>
 
 #define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES
 
-glm::mat4 AnimSceneNode::getAnimatedMatrix() const {
-    return glm::translate(glm::mat4(1.0f), translation) * glm::mat4(rotation) * glm::scale(glm::mat4(1.0f), scale) * matrix;
+void AnimatedGLTFObj::updateJointMatrices(NodeHierarchy& hierarchy, glm::mat4* jointMatrices, glm::vec4* bounds, bool reduced) const {
+    reduced = reduced && !jointRemap_.empty();
+    if (reduced) {
+        hierarchy.updateWorldMatrices(reducedNodes_);
+    }
+    else {
+        hierarchy.updateWorldMatrices();
+    }
+    const std::vector<float>& padding = reduced ? reducedPadding_ : jointPadding_;
+
+    glm::vec3 jointMin(std::numeric_limits<float>::max());
+    glm::vec3 jointMax(-std::numeric_limits<float>::max());
+    for (const SkinnedNode& skinned : skinnedNodes_) {
+        const Skin& skin = skins_[skinned.skin];
+        glm::mat4 inverseTransform = glm::inverse(hierarchy.worldMatrices_[skinned.node]);
+        glm::mat4* skinMatrices = jointMatrices + skin.firstJointMatrix;
+        for (size_t i = 0; i < skin.jointNodes.size(); i++) {
+            if (reduced && jointRemap_[skin.firstJointMatrix + i] != skin.firstJointMatrix + i) {
+                continue;
+            }
+            const glm::mat4& joint = hierarchy.worldMatrices_[skin.jointNodes[i]];
+            skinMatrices[i] = inverseTransform * (joint * skin.inverseBindMatrices[i]);
+            if (bounds != nullptr) {
+                glm::vec3 origin = glm::vec3(inverseTransform * joint[3]);
+                jointMin = glm::min(jointMin, origin);
+                jointMax = glm::max(jointMax, origin);
+            }
+        }
+    }
+    // KEPT JOINTS ARE ALL WRITTEN BY NOW, THE DROPPED ONES FOLLOW THEM
+    if (reduced) {
+        for (size_t joint = 0; joint < jointRemap_.size(); joint++) {
+            if (jointRemap_[joint] != joint) {
+                jointMatrices[joint] = jointMatrices[jointRemap_[joint]] * reducedOffsets_[joint];
+            }
+        }
+    }
+    if (bounds == nullptr) {
+        return;
+    }
+    if (jointMin.x > jointMax.x) {
+        *bounds = glm::vec4(0.0f, 0.0f, 0.0f, std::numeric_limits<float>::max()); // NO JOINTS, NOTHING TO BOUND
+        return;
+    }
+
+    // CENTRED ON THE JOINTS' BOX, THE RADIUS REACHES THE FAR SIDE OF EVERY JOINT'S PADDED SPHERE
+    glm::vec3 centre = (jointMin + jointMax) * 0.5f;
+    float radius = 0.0f;
+    for (const SkinnedNode& skinned : skinnedNodes_) {
+        const Skin& skin = skins_[skinned.skin];
+        glm::mat4 inverseTransform = glm::inverse(hierarchy.worldMatrices_[skinned.node]);
+        for (size_t i = 0; i < skin.jointNodes.size(); i++) {
+            const size_t joint = skin.firstJointMatrix + i;
+            if (reduced && jointRemap_[joint] != joint) {
+                continue;
+            }
+            float jointPadding = joint < padding.size() ? padding[joint] : 0.0f;
+            radius = std::max(radius, glm::distance(centre, glm::vec3(inverseTransform * hierarchy.worldMatrices_[skin.jointNodes[i]][3])) + jointPadding);
+        }
+    }
+    *bounds = glm::vec4(centre, radius);
 }
 
-// Also from Sascha Willems' gltfskinning example
-glm::mat4 AnimatedGLTFObj::getNodeMatrix(AnimSceneNode* node)
-{
-    glm::mat4 nodeMatrix = node->getAnimatedMatrix();
-    AnimSceneNode* currentParent = node->parent;
-    while (currentParent)
-    {
-        nodeMatrix = currentParent->getAnimatedMatrix() * nodeMatrix;
-        currentParent = currentParent->parent;
+void AnimatedGLTFObj::jointOrigins(const NodeHierarchy& hierarchy, std::vector<glm::vec3>& origins) const {
+    origins.assign(paletteSize(), glm::vec3(0.0f));
+    for (const SkinnedNode& skinned : skinnedNodes_) {
+        const Skin& skin = skins_[skinned.skin];
+        glm::mat4 inverseTransform = glm::inverse(hierarchy.worldMatrices_[skinned.node]);
+        for (size_t i = 0; i < skin.jointNodes.size(); i++) {
+            origins[skin.firstJointMatrix + i] = glm::vec3(inverseTransform * hierarchy.worldMatrices_[skin.jointNodes[i]][3]);
+        }
     }
-    return nodeMatrix;
 }
 
-// Also from Sascha Willems' gltfskinning example
-void AnimatedGLTFObj::updateJoints(AnimSceneNode* node)
-{
-    if (node->skinIndex > -1)
-    {
-        // Update the joint matrices
-        glm::mat4              inverseTransform = glm::inverse(getNodeMatrix(node));
-        Skin                   skin = skins_[node->skinIndex];
-        size_t                 numJoints = (uint32_t)skin.joints.size();
-        for (size_t i = 0; i < numJoints; i++)
-        {
-            (*(skin.finalJointMatrices))[i] = inverseTransform * (getNodeMatrix(skin.joints[i]) * skin.inverseBindMatrices[i]);
+void AnimatedGLTFObj::computeJointPadding() {
+    NodeHierarchy rest = hierarchy_;
+    std::vector<glm::mat4> palette(paletteSize());
+    updateJointMatrices(rest, palette.data());
+
+    // WHERE EACH JOINT'S ORIGIN LANDS IN THE SKINNED OUTPUT, AS updateJointMatrices PLACES IT FOR bounds
+    std::vector<glm::vec3> origins;
+    jointOrigins(rest, origins);
+
+    jointPadding_.assign(palette.size(), 0.0f);
+    for (const Vertex& v : vertices_) {
+        glm::vec3 position, normal, tangent;
+        DualQuaternionSkinning::skinVertexLinear(palette.data(), v, position, normal, tangent);
+        for (int i = 0; i < 4; i++) {
+            uint32_t joint = static_cast<uint32_t>(v.jointIndices[i]);
+            if (v.jointWeights[i] > 0.0f && joint < palette.size()) {
+                jointPadding_[joint] = std::max(jointPadding_[joint], glm::distance(position, origins[joint]));
+            }
         }
     }
+}
 
-    for (auto& child : node->children)
-    {
-        updateJoints(child);
+void AnimatedGLTFObj::computeBoneReduction(float minExtent) {
+    const size_t joints = paletteSize();
+    reducedNodes_.clear();
+    jointRemap_.clear();
+    reducedOffsets_.clear();
+    reducedPadding_.clear();
+
+    NodeHierarchy rest = hierarchy_;
+    std::vector<glm::mat4> palette(joints);
+    glm::vec4 restBounds;
+    updateJointMatrices(rest, palette.data(), &restBounds);
+    std::vector<glm::vec3> origins;
+    jointOrigins(rest, origins);
+    std::vector<glm::vec3> positions(vertices_.size());
+    for (size_t v = 0; v < vertices_.size(); v++) {
+        glm::vec3 normal, tangent;
+        DualQuaternionSkinning::skinVertexLinear(palette.data(), vertices_[v], positions[v], normal, tangent);
     }
+
+    // EACH JOINT'S NEAREST ANCESTOR IN THE SAME SKIN, AS PALETTE INDICES
+    std::vector<int32_t> jointParent(joints, -1);
+    std::vector<uint32_t> jointNode(joints, 0);
+    for (const Skin& skin : skins_) {
+        std::vector<int32_t> nodeJoint(hierarchy_.size(), -1);
+        for (size_t i = 0; i < skin.jointNodes.size(); i++) {
+            nodeJoint[skin.jointNodes[i]] = static_cast<int32_t>(skin.firstJointMatrix + i);
+            jointNode[skin.firstJointMatrix + i] = skin.jointNodes[i];
+        }
+        for (size_t i = 0; i < skin.jointNodes.size(); i++) {
+            for (int32_t n = hierarchy_.parents_[skin.jointNodes[i]]; n >= 0; n = hierarchy_.parents_[n]) {
+                if (nodeJoint[n] >= 0) {
+                    jointParent[skin.firstJointMatrix + i] = nodeJoint[n];
+                    break;
+                }
+            }
+        }
+    }
+
+    // HOW FAR FROM EACH JOINT ANYTHING IT OR A JOINT UNDER IT MOVES REACHES AT REST
+    std::vector<float> extent(joints, 0.0f);
+    for (size_t j = 0; j < joints; j++) {
+        for (int32_t a = jointParent[j]; a >= 0; a = jointParent[a]) {
+            extent[a] = std::max(extent[a], glm::distance(origins[j], origins[a]));
+        }
+    }
+    for (size_t v = 0; v < vertices_.size(); v++) {
+        for (int i = 0; i < 4; i++) {
+            int32_t joint = static_cast<int32_t>(vertices_[v].jointIndices[i]);
+            if (vertices_[v].jointWeights[i] <= 0.0f || joint >= static_cast<int32_t>(joints)) {
+                continue;
+            }
+            for (int32_t a = joint; a >= 0; a = jointParent[a]) {
+                extent[a] = std::max(extent[a], glm::distance(positions[v], origins[a]));
+            }
+        }
+    }
+
+    // HIERARCHY ORDER VISITS EVERY JOINT AFTER ITS PARENT JOINT, SO A DROPPED PARENT'S REMAP IS ALREADY ITS OWN NEAREST KEPT ANCESTOR
+    std::vector<uint32_t> remap(joints);
+    std::vector<uint32_t> order(joints);
+    for (size_t j = 0; j < joints; j++) {
+        remap[j] = static_cast<uint32_t>(j);
+        order[j] = static_cast<uint32_t>(j);
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return jointNode[a] < jointNode[b]; });
+    const float threshold = minExtent * restBounds.w;
+    size_t dropped = 0;
+    for (uint32_t j : order) {
+        const int32_t parent = jointParent[j];
+        if (parent >= 0 && (remap[parent] != static_cast<uint32_t>(parent) || extent[j] < threshold)) {
+            remap[j] = remap[parent];
+            dropped++;
+        }
+    }
+    if (dropped == 0) {
+        return;
+    }
+
+    // A DROPPED JOINT KEEPS ITS REST TRANSFORM RELATIVE TO ITS KEPT JOINT, FOLDED INTO THE KEPT JOINT'S INVERSE BIND AND ITS OWN
+    reducedOffsets_.assign(joints, glm::mat4(1.0f));
+    for (const Skin& skin : skins_) {
+        for (size_t i = 0; i < skin.jointNodes.size(); i++) {
+            const uint32_t joint = static_cast<uint32_t>(skin.firstJointMatrix + i);
+            const uint32_t kept = remap[joint];
+            if (kept != joint) {
+                const glm::mat4& keptInverseBind = skin.inverseBindMatrices[kept - skin.firstJointMatrix];
+                const glm::mat4 relative = glm::inverse(rest.worldMatrices_[jointNode[kept]]) * rest.worldMatrices_[jointNode[joint]];
+                reducedOffsets_[joint] = glm::inverse(keptInverseBind) * relative * skin.inverseBindMatrices[i];
+            }
+        }
+    }
+
+    // EVERY KEPT JOINT AND SKINNED NODE, AND THEIR ANCESTORS
+    std::vector<bool> needed(hierarchy_.size(), false);
+    auto need = [&](uint32_t node) {
+        for (int32_t n = static_cast<int32_t>(node); n >= 0 && !needed[n]; n = hierarchy_.parents_[n]) {
+            needed[n] = true;
+        }
+    };
+    for (size_t j = 0; j < joints; j++) {
+        if (remap[j] == j) {
+            need(jointNode[j]);
+        }
+    }
+    for (const SkinnedNode& skinned : skinnedNodes_) {
+        need(skinned.node);
+    }
+    for (size_t n = 0; n < hierarchy_.size(); n++) {
+        if (needed[n]) {
+            reducedNodes_.push_back(static_cast<uint32_t>(n));
+        }
+    }
+
+    reducedPadding_.assign(joints, 0.0f);
+    for (size_t v = 0; v < vertices_.size(); v++) {
+        for (int i = 0; i < 4; i++) {
+            uint32_t joint = static_cast<uint32_t>(vertices_[v].jointIndices[i]);
+            if (vertices_[v].jointWeights[i] > 0.0f && joint < joints) {
+                reducedPadding_[remap[joint]] = std::max(reducedPadding_[remap[joint]], glm::distance(positions[v], origins[remap[joint]]));
+            }
+        }
+    }
+    jointRemap_ = std::move(remap);
+    std::cout << "bone reduction: " << joints - dropped << " / " << joints << " joints kept, " << reducedNodes_.size() << " / " << hierarchy_.size() << " nodes updated" << std::endl;
+}
+
+void AnimatedGLTFObj::bakeFrozenPose(const AnimationStateMachine& machine) {
+    NodeHierarchy pose = hierarchy_;
+    AnimationStateMachine baked = machine;
+    baked.setHierarchy(pose);
+    baked.update(0.0f);
+    frozenPalette_.resize(paletteSize());
+    updateJointMatrices(pose, frozenPalette_.data(), &frozenBounds_);
+}
+
+void AnimatedGLTFObj::createBasePoseBuffer() {
+    std::vector<SkinnedVertex> basePoseVertices;
+    basePoseVertices.reserve(vertices_.size());
+    for (const Vertex& v : vertices_) {
+        basePoseVertices.push_back(SkinnedVertex::pack(v));
+    }
+    MeshHelper::createVertexBuffer(pDevHelper_, basePoseVertices, basePoseBuffer_, basePoseBufferMemory_);
 }
 
 // LOAD FUNCTIONS TEMPLATED FROM GLTFLOADING EXAMPLE ON GITHUB BY SASCHA WILLEMS
@@ -71,26 +276,32 @@ void AnimatedGLTFObj::loadTextures() {
 }
 
 void AnimatedGLTFObj::loadNode(tinygltf::Model& in, const tinygltf::Node& nodeIn, uint32_t nodeIndex, AnimSceneNode* parent, std::vector<AnimSceneNode*>& nodes, uint32_t globalVertexOffset, uint32_t globalIndexOffset) {
-    SMikkTSpaceContext mikktContext = { .m_pInterface = &MikkTInterface };
-
     AnimSceneNode* scNode = new AnimSceneNode{};
-    scNode->matrix = glm::mat4(1.0f);
     scNode->skinIndex = nodeIn.skin;
     scNode->parent = parent;
     scNode->index = nodeIndex;
 
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+    glm::mat4 matrix = glm::mat4(1.0f);
     if (nodeIn.translation.size() == 3) {
-        scNode->translation = glm::make_vec3(nodeIn.translation.data());
+        translation = glm::make_vec3(nodeIn.translation.data());
     }
     if (nodeIn.rotation.size() == 4) {
-        glm::quat q = glm::make_quat(nodeIn.rotation.data());
-        scNode->rotation = glm::mat4(q);
+        rotation = glm::make_quat(nodeIn.rotation.data());
     }
     if (nodeIn.scale.size() == 3) {
-        scNode->scale = glm::make_vec3(nodeIn.scale.data());
+        scale = glm::make_vec3(nodeIn.scale.data());
     }
     if (nodeIn.matrix.size() == 16) {
-        scNode->matrix = glm::make_mat4x4(nodeIn.matrix.data());
+        matrix = glm::make_mat4x4(nodeIn.matrix.data());
+    }
+
+    // ADDED BEFORE THE CHILDREN SO EVERY PARENT COMES FIRST IN THE HIERARCHY
+    scNode->hierarchyIndex = hierarchy_.addNode(parent ? static_cast<int32_t>(parent->hierarchyIndex) : -1, translation, rotation, scale, matrix);
+    if (nodeIn.skin > -1) {
+        skinnedNodes_.push_back(SkinnedNode{ scNode->hierarchyIndex, static_cast<uint32_t>(nodeIn.skin) });
     }
 
     if (nodeIn.children.size() > 0) {
@@ -106,10 +317,6 @@ void AnimatedGLTFObj::loadNode(tinygltf::Model& in, const tinygltf::Node& nodeIn
 
             const tinygltf::Primitive& gltfPrims = mesh.primitives[i];
 
-            uint32_t firstIndex = totalIndices_;
-            uint32_t firstVertex = totalVertices_;
-
-            uint32_t currentNumIndices = 0;
             uint32_t currentNumVertices = 0;
 
             // FOR VERTICES
@@ -193,27 +400,25 @@ void AnimatedGLTFObj::loadNode(tinygltf::Model& in, const tinygltf::Node& nodeIn
             const tinygltf::BufferView& view = in.bufferViews[accessor.bufferView];
             const tinygltf::Buffer& buffer = in.buffers[view.buffer];
 
-            currentNumIndices += static_cast<uint32_t>(accessor.count);
-
             switch (accessor.componentType) {
             case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: {
                 const uint32_t* buf = reinterpret_cast<const uint32_t*>(&buffer.data[accessor.byteOffset + view.byteOffset]);
                 for (size_t index = 0; index < accessor.count; index++) {
-                    p->stagingIndices_.push_back(buf[index] + firstVertex);
+                    p->stagingIndices_.push_back(buf[index]);
                 }
                 break;
             }
             case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
                 const uint16_t* buf = reinterpret_cast<const uint16_t*>(&buffer.data[accessor.byteOffset + view.byteOffset]);
                 for (size_t index = 0; index < accessor.count; index++) {
-                    p->stagingIndices_.push_back(buf[index] + firstVertex);
+                    p->stagingIndices_.push_back(buf[index]);
                 }
                 break;
             }
             case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
                 const uint8_t* buf = reinterpret_cast<const uint8_t*>(&buffer.data[accessor.byteOffset + view.byteOffset]);
                 for (size_t index = 0; index < accessor.count; index++) {
-                    p->stagingIndices_.push_back(buf[index] + firstVertex);
+                    p->stagingIndices_.push_back(buf[index]);
                 }
                 break;
             }
@@ -222,72 +427,15 @@ void AnimatedGLTFObj::loadNode(tinygltf::Model& in, const tinygltf::Node& nodeIn
                 std::_Xruntime_error("index component type not supported");
             }
 
-            p->indirectInfo.firstIndex = firstIndex + globalIndexOffset;
             p->indirectInfo.firstInstance = 0;
             p->indirectInfo.instanceCount = 1;
             p->indirectInfo.vertexOffset = globalVertexOffset;
-            p->worldTransformMatrix = scNode->matrix;
+            p->worldTransformMatrix = hierarchy_.matrices_[scNode->hierarchyIndex];
             p->materialIndex = gltfPrims.material;
 
-            // TANGENT SPACE CREATION - ALSO REFERENCED OFF OF: https://github.com/Eearslya/glTFView.
-            if (!tangentsBuff) {
-                //UNPACK VERTICES
-                std::vector<Vertex> unpacked(p->stagingIndices_.size());
-                uint32_t newInd = 0;
-                for (uint32_t index : p->stagingIndices_) {
-                    unpacked[newInd] = p->stagingVertices_[static_cast<std::vector<Vertex, std::allocator<Vertex>>::size_type>(index) - firstVertex];
-                    newInd++;
-                }
-                p->stagingVertices_ = std::move(unpacked);
-                p->stagingIndices_.clear();
-
-                // GEN TANGENT SPACE
-                MikkTSpaceHelper::MikkTContext context{ p };
-                mikktContext.m_pUserData = &context;
-                genTangSpaceDefault(&mikktContext);
-
-                //WELD VERTICES
-                p->stagingIndices_.clear();
-                p->stagingIndices_.reserve(p->stagingVertices_.size());
-                std::unordered_map<Vertex, uint32_t> uniqueVertices;
-
-                size_t oldVertexCount = p->stagingVertices_.size();
-                uint32_t postTVertexCount = 0;
-                for (size_t i = 0; i < oldVertexCount; ++i) {
-                    Vertex v = p->stagingVertices_[i];
-
-                    auto index = uniqueVertices.find(v);
-                    if (index == uniqueVertices.end()) {
-                        uint32_t vertIndex = postTVertexCount;
-                        postTVertexCount++;
-                        uniqueVertices.insert(std::make_pair(v, vertIndex));
-                        p->stagingVertices_[vertIndex] = v;
-                        p->stagingIndices_.push_back(vertIndex + firstVertex);
-                    }
-                    else {
-                        p->stagingIndices_.push_back(index->second + firstVertex);
-                    }
-                }
-                p->stagingVertices_.resize(postTVertexCount);
-
-                currentNumIndices = static_cast<uint32_t>(p->stagingIndices_.size());
-                currentNumVertices = static_cast<uint32_t>(p->stagingVertices_.size());
-            }
-
-            p->indirectInfo.indexCount = currentNumIndices;
-
-            totalIndices_ += currentNumIndices;
-            totalVertices_ += currentNumVertices;
-
+            // TANGENTS, WELD AND OPTIMISATION RUN IN PrimitiveFinisher::finish ONCE EVERY PRIMITIVE IS READ
             scNode->meshPrimitives.push_back(p);
-
-            vertices_.insert(vertices_.end(), p->stagingVertices_.begin(), p->stagingVertices_.end());
-            indices_.insert(indices_.end(), p->stagingIndices_.begin(), p->stagingIndices_.end());
-
-            p->stagingIndices_.clear();
-            p->stagingIndices_.shrink_to_fit();
-            p->stagingVertices_.clear();
-            p->stagingVertices_.shrink_to_fit();
+            pendingPrimitives_.push_back({ p, mesh.name, i, tangentsBuff == nullptr, "" });
         }
     }
 
@@ -344,6 +492,7 @@ void AnimatedGLTFObj::loadSkins() {
             AnimSceneNode* node = nodeFromIndex(jointInd);
             if (node) {
                 skins_[i].joints.push_back(node);
+                skins_[i].jointNodes.push_back(node->hierarchyIndex);
             }
         }
 
@@ -356,16 +505,17 @@ void AnimatedGLTFObj::loadSkins() {
 
             memcpy(skins_[i].inverseBindMatrices.data(), &buffer.data[accessor.byteOffset + bufferView.byteOffset], bufferSize);
         }
+
+        skins_[i].firstJointMatrix = i > 0 ? skins_[i - 1].firstJointMatrix + static_cast<uint32_t>(skins_[i - 1].inverseBindMatrices.size()) : 0;
     }
 }
 
 void AnimatedGLTFObj::loadGLTF(uint32_t globalVertexOffset, uint32_t globalIndexOffset) {
-    tinygltf::Model in;
+    pInputModel_ = new tinygltf::Model();
+    tinygltf::Model& in = *pInputModel_;
     tinygltf::TinyGLTF gltfContext;
     std::string error, warning;
 
-    pInputModel_ = &in;
-
     bool loadedFile = false;
     std::filesystem::path fPath = gltfPath_;
     if (fPath.extension() == ".glb") {
@@ -381,10 +531,6 @@ void AnimatedGLTFObj::loadGLTF(uint32_t globalVertexOffset, uint32_t globalIndex
             textureIndices_.resize(pInputModel_->images.size() + 3);
             loadTextures();
             loadMaterials();
-
-            for (auto& image : images_) {
-                image->load();
-            }
         }
 
         const tinygltf::Scene& scene = in.scenes[0];
@@ -392,18 +538,21 @@ void AnimatedGLTFObj::loadGLTF(uint32_t globalVertexOffset, uint32_t globalIndex
             const tinygltf::Node node = in.nodes[scene.nodes[i]];
             loadNode(in, node, scene.nodes[i], nullptr, pParentNodes, globalVertexOffset, globalIndexOffset);
         }
+        PrimitiveFinisher::finish(pendingPrimitives_, { optimizeMeshes_, false, weldEpsilon_ }, pJobs_, globalIndexOffset, vertices_, indices_, totalVertices_, totalIndices_, meshReport_);
+
+        if (!meshReport_.empty()) {
+            std::cout << meshReport_;
+            meshReport_.clear();
+        }
 
         loadSkins();
-        walkAnim.loadAnimation(gltfPath_, pParentNodes);
+        animations_.loadModel(in, gltfPath_, pParentNodes);
+        walkAnim = animations_.find(fPath.stem().string());
 
+        std::vector<glm::mat4> jointMatrices(skins_.empty() ? 0 : skins_.back().firstJointMatrix + skins_.back().inverseBindMatrices.size());
+        updateJointMatrices(hierarchy_, jointMatrices.data());
         for (auto& skin : skins_) {
-            skin.finalJointMatrices = new std::vector<glm::mat4>();
-            skin.finalJointMatrices->resize(skin.inverseBindMatrices.size());
-        }
-
-        for (auto node : pParentNodes)
-        {
-            updateJoints(node);
+            skin.finalJointMatrices = new std::vector<glm::mat4>(jointMatrices.begin() + skin.firstJointMatrix, jointMatrices.begin() + skin.firstJointMatrix + skin.inverseBindMatrices.size());
         }
     }
     else {
@@ -411,6 +560,36 @@ void AnimatedGLTFObj::loadGLTF(uint32_t globalVertexOffset, uint32_t globalIndex
     }
 }
 
+// GPU HALF OF THE LOAD, SEE GLTFObj::uploadTextures
+void AnimatedGLTFObj::uploadTextures() {
+    for (auto& image : images_) {
+        image->load();
+    }
+
+    delete pInputModel_;
+    pInputModel_ = nullptr;
+}
+
+void AnimatedGLTFObj::offsetNode(AnimSceneNode* node, uint32_t globalVertexOffset, uint32_t globalIndexOffset) {
+    for (auto& childNode : node->children) {
+        offsetNode(childNode, globalVertexOffset, globalIndexOffset);
+    }
+
+    for (auto& mesh : node->meshPrimitives) {
+        mesh->indirectInfo.firstIndex = mesh->indirectInfo.firstIndex - globalFirstIndex + globalIndexOffset;
+        mesh->indirectInfo.vertexOffset = globalVertexOffset;
+    }
+}
+
+void AnimatedGLTFObj::applyGlobalOffsets(uint32_t globalVertexOffset, uint32_t globalIndexOffset) {
+    for (auto& node : pParentNodes) {
+        offsetNode(node, globalVertexOffset, globalIndexOffset);
+    }
+
+    this->globalFirstVertex = globalVertexOffset;
+    this->globalFirstIndex = globalIndexOffset;
+}
+
 void AnimatedGLTFObj::loadMaterials() {
     uint32_t numImages = static_cast<uint32_t>(pInputModel_->textures.size());
     uint32_t dummyNormalIndex = numImages;
@@ -558,18 +737,23 @@ void AnimatedGLTFObj::createDescriptors() {
     }
 }
 
-AnimatedGLTFObj::AnimatedGLTFObj(std::string gltfPath, DeviceHelper* deviceHelper, uint32_t globalVertexOffset, uint32_t globalIndexOffset) {
+AnimatedGLTFObj::AnimatedGLTFObj(std::string gltfPath, DeviceHelper* deviceHelper, uint32_t globalVertexOffset, uint32_t globalIndexOffset, bool deferUpload, bool optimizeMeshes, float weldEpsilon, JobSystem* jobs) {
     gltfPath_ = gltfPath;
     pDevHelper_ = deviceHelper;
     this->globalFirstVertex = globalVertexOffset;
     this->globalFirstIndex = globalIndexOffset;
-    this->globalSkinningMatrixOffset = 0;
-    this->localModelTransform = glm::mat4(1.0f);
     this->pInputModel_ = nullptr;
+    this->optimizeMeshes_ = optimizeMeshes;
+    this->weldEpsilon_ = weldEpsilon;
+    this->pJobs_ = jobs;
     this->totalIndices_ = 0;
     this->totalVertices_ = 0;
 
     loadGLTF(globalVertexOffset, globalIndexOffset);
+
+    if (!deferUpload) {
+        uploadTextures();
+    }
 }
 
 // DELETION
@@ -1,6 +1,12 @@
 #pragma once
 
-#include "Animation.h"
+#include "AnimationLibrary.h"
+#include "MeshOptimizer.h"
+#include "VertexWelder.h"
+#include "TangentGenerator.h"
+#include "PrimitiveFinisher.h"
+
+class AnimationStateMachine;
 
 class AnimatedGLTFObj {
 public:
@@ -9,19 +15,24 @@ public:
 		AnimSceneNode* skeletonRoot = nullptr;
 		std::vector<glm::mat4> inverseBindMatrices;
 		std::vector<AnimSceneNode*> joints;
+		std::vector<uint32_t> jointNodes; // joints AS hierarchy_ INDICES
+		uint32_t firstJointMatrix = 0; // WHERE THE SKIN'S MATRICES START IN THE OBJECT'S SLICE OF THE GLOBAL SKINNING BUFFER
 		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
 		std::vector<glm::mat4>* finalJointMatrices = nullptr;
 	};
 
-	Animation walkAnim;
-	Animation idleAnim;
-	Animation runAnim;
-	uint32_t globalSkinningMatrixOffset;
+	AnimationLibrary animations_; // EVERY CLIP THE CHARACTER CAN PLAY, THE MODEL FILE'S OWN CLIPS PLUS ANY loadFile ADDS LATER
+	Animation* walkAnim = nullptr;
+	Animation* idleAnim = nullptr;
+	Animation* runAnim = nullptr;
 	uint32_t globalFirstVertex;
 	uint32_t globalFirstIndex;
 	uint32_t totalIndices_;
 	uint32_t totalVertices_;
-	glm::mat4 localModelTransform;
+
+	// THE BIND POSE AS SkinnedVertex, READ BY computeSkin FOR EVERY INSTANCE OF THE MODEL
+	VkBuffer basePoseBuffer_ = VK_NULL_HANDLE;
+	VkDeviceMemory basePoseBufferMemory_ = VK_NULL_HANDLE;
 
 	std::unordered_map<Material*, std::vector<MeshHelper*>> opaqueDraws;
 	std::unordered_map<Material*, std::vector<MeshHelper*>> transparentDraws;
@@ -33,26 +44,68 @@ public:
 	std::vector<Vertex> vertices_;
 	std::vector<uint32_t> indices_;
 	std::vector<AnimSceneNode*> pParentNodes;
+	NodeHierarchy hierarchy_; // THE REST POSE, EVERY AnimatedGameObject DRAWING THE MODEL ANIMATES ITS OWN COPY
+	// BY PALETTE INDEX, THE FURTHEST ANY VERTEX THE JOINT MOVES SITS FROM IT. JOINTS MOVE VERTICES RIGIDLY, SO NO POSE TAKES A VERTEX FURTHER THAN THAT FROM
+	// EVERY ONE OF ITS JOINTS AND A SPHERE HOLDING EACH JOINT'S PADDED SPHERE HOLDS THE WHOLE POSED MESH (ANIMATED JOINT SCALE ASIDE)
+	std::vector<float> jointPadding_;
+	// THE REDUCED SKELETON FROM computeBoneReduction. A DROPPED JOINT'S MATRIX IS ITS NEAREST KEPT ANCESTOR'S TIMES A FIXED OFFSET, SO IT HOLDS ITS REST
+	// POSE RELATIVE TO THAT ANCESTOR AND NEITHER IT NOR ANY NODE ONLY IT NEEDS IS UPDATED. jointRemap_ IS EMPTY WHEN NOTHING IS DROPPED
+	std::vector<uint32_t> reducedNodes_; // THE hierarchy_ NODES A REDUCED UPDATE STILL WALKS, PARENTS FIRST
+	std::vector<uint32_t> jointRemap_; // BY PALETTE INDEX, THE KEPT JOINT A DROPPED ONE FOLLOWS, ITSELF WHEN KEPT
+	std::vector<glm::mat4> reducedOffsets_; // BY PALETTE INDEX, WHAT A DROPPED JOINT'S MATRIX IS ITS KEPT JOINT'S TIMES
+	std::vector<float> reducedPadding_; // jointPadding_ WITH EVERY DROPPED JOINT'S VERTICES COUNTED AGAINST ITS KEPT JOINT
+	// WHAT A CHARACTER AT AnimationLOD::FROZEN SHOWS, FROM bakeFrozenPose. EMPTY UNTIL THEN, AND A FROZEN CHARACTER HOLDS ITS LAST POSE INSTEAD
+	std::vector<glm::mat4> frozenPalette_;
+	glm::vec4 frozenBounds_ = glm::vec4(0.0f);
 
 	void createDescriptors();
+	void uploadTextures();
+	void applyGlobalOffsets(uint32_t globalVertexOffset, uint32_t globalIndexOffset);
+
+	// ONE PASS OVER hierarchy (A COPY OF hierarchy_), THEN EVERY SKIN'S JOINT MATRICES ARE WRITTEN TO jointMatrices[firstJointMatrix + joint]. bounds, WHEN
+	// GIVEN, GETS THE POSED MESH'S BOUNDING SPHERE (xyz CENTRE, w RADIUS) IN THE SPACE computeSkin WRITES, CENTRED ON THE JOINTS AND REACHING EACH ONE'S
+	// jointPadding_. reduced UPDATES THE REDUCED SKELETON ONLY
+	void updateJointMatrices(NodeHierarchy& hierarchy, glm::mat4* jointMatrices, glm::vec4* bounds = nullptr, bool reduced = false) const;
+	size_t paletteSize() const { return skins_.empty() ? 0 : skins_.back().firstJointMatrix + skins_.back().inverseBindMatrices.size(); }
+	// THE VERTICES AS SkinnedVertex INTO basePoseBuffer_
+	void createBasePoseBuffer();
+	// SETS jointPadding_ FROM THE REST POSE
+	void computeJointPadding();
+	// DROPS EVERY JOINT WHOSE VERTICES AND CHILD JOINTS ALL SIT WITHIN minExtent (A FRACTION OF THE REST POSE'S BOUNDING RADIUS) OF IT, AND EVERY JOINT
+	// UNDER ONE THAT IS DROPPED. CALLED AFTER computeJointPadding
+	void computeBoneReduction(float minExtent);
+	// SETS frozenPalette_ TO THE POSE machine (CONFIGURED FOR THIS MODEL) SHOWS RIGHT NOW. machine ITSELF IS LEFT AS IT WAS
+	void bakeFrozenPose(const AnimationStateMachine& machine);
 
-	AnimatedGLTFObj(std::string gltfPath, DeviceHelper* deviceHelper, uint32_t globalVertexOffset, uint32_t globalIndexOffset);
+	AnimatedGLTFObj(std::string gltfPath, DeviceHelper* deviceHelper, uint32_t globalVertexOffset, uint32_t globalIndexOffset, bool deferUpload = false, bool optimizeMeshes = false, float weldEpsilon = 0.0f, JobSystem* jobs = nullptr);
 	~AnimatedGLTFObj();
 
 private:
 	std::string gltfPath_;
 	DeviceHelper* pDevHelper_;
 	tinygltf::Model* pInputModel_;
+	bool optimizeMeshes_;
+	float weldEpsilon_;
+	JobSystem* pJobs_; // THE LOADER'S WORKERS, NULL LOADS ON THE CALLING THREAD ONLY
+	std::string meshReport_;
+	std::vector<PrimitiveFinisher::Pending> pendingPrimitives_;
+
+	struct SkinnedNode {
+		uint32_t node;
+		uint32_t skin;
+	};
+	std::vector<SkinnedNode> skinnedNodes_; // IN HIERARCHY ORDER
 
 	void loadImages();
 	void loadTextures();
 	void loadMaterials();
 	void loadSkins();
-	void updateJoints(AnimSceneNode* node);
-	glm::mat4 getNodeMatrix(AnimSceneNode* node);
 	AnimSceneNode* nodeFromIndex(uint32_t index);
 	AnimSceneNode* findNode(AnimSceneNode* parent, uint32_t index);
 	void loadNode(tinygltf::Model& in, const tinygltf::Node& nodeIn, uint32_t index, AnimSceneNode* parent, std::vector<AnimSceneNode*>& nodes, uint32_t globalVertexOffset, uint32_t globalIndexOffset);
 	void loadGLTF(uint32_t globalVertexOffset, uint32_t globalIndexOffset);
+	void offsetNode(AnimSceneNode* node, uint32_t globalVertexOffset, uint32_t globalIndexOffset);
 	void recursiveDeleteNode(AnimSceneNode* node);
+	// WHERE EACH JOINT'S ORIGIN SITS IN THE SPACE computeSkin WRITES, BY PALETTE INDEX, FOR hierarchy'S LAST WORLD MATRICES
+	void jointOrigins(const NodeHierarchy& hierarchy, std::vector<glm::vec3>& origins) const;
 };;
@@ -1,171 +1,100 @@
 #include "AnimatedGameObject.h"
-#include "Time.h"
+#include <cstring>
 
-glm::mat4 AnimatedGameObject::getNodeMatrix(AnimSceneNode* node)
-{
-    glm::mat4 nodeMatrix = node->getAnimatedMatrix();
-    AnimSceneNode* currentParent = node->parent;
-    while (currentParent)
-    {
-        nodeMatrix = currentParent->getAnimatedMatrix() * nodeMatrix;
-        currentParent = currentParent->parent;
+// THE DUAL QUATERNIONS AND HASH OF A PALETTE THAT HAS JUST BEEN WRITTEN
+static void finishPalette(AnimatedGameObject& object, std::vector<glm::mat4>& bindMatrices, std::vector<DualQuaternionSkinning::DualQuat>& dualQuaternions) {
+    const glm::mat4* palette = bindMatrices.data() + object.firstJointMatrix;
+    if (object.skinningMode_ == AnimatedGameObject::SkinningMode::DUAL_QUATERNION) {
+        DualQuaternionSkinning::fromMatrices(palette, object.numInverseBindMatrices, dualQuaternions.data() + object.firstJointMatrix);
     }
-    return nodeMatrix;
+    object.paletteHash_ = AnimatedGameObject::hashPalette(palette, object.numInverseBindMatrices);
 }
 
-void AnimatedGameObject::updateJoints(AnimSceneNode* node, std::vector<glm::mat4>& bindMatrices) {
-    if (node->skinIndex > -1)
-    {
-        // Update the joint matrices
-        glm::mat4              inverseTransform = glm::inverse(getNodeMatrix(node));
-        AnimatedGLTFObj::Skin  skin = renderTarget->skins_[node->skinIndex];
-        size_t                 numJoints = (uint32_t)skin.joints.size();
-        std::vector<glm::mat4> jointMatrices(numJoints);
-        for (size_t i = renderTarget->globalSkinningMatrixOffset; i < renderTarget->globalSkinningMatrixOffset + numJoints; i++)
-        {
-            bindMatrices[i] = inverseTransform * (getNodeMatrix(skin.joints[i]) * skin.inverseBindMatrices[i]);
-        }
-    }
+void AnimatedGameObject::updateAnimation(std::vector<glm::mat4>& bindMatrices, std::vector<DualQuaternionSkinning::DualQuat>& dualQuaternions, float deltaTime, const AnimationLOD::Settings& lod, const AnimationLOD::View& view, size_t stagger) {
+    glm::mat4* palette = bindMatrices.data() + firstJointMatrix;
+    const size_t joints = numInverseBindMatrices;
+    lodLevel_ = lod.enabled && posed_ && !isPlayerObj ? AnimationLOD::selectLevel(lod, AnimationLOD::screenSize(view, worldBounds()), lodLevel_) : 0;
+    lodPendingTime_ += deltaTime;
+    lodUpdated_ = false;
 
-    for (auto& child : node->children)
-    {
-        updateJoints(child, bindMatrices);
+    if (lodLevel_ == AnimationLOD::FROZEN) {
+        if (!lodFrozen_ && renderTarget->frozenPalette_.size() == joints) {
+            std::copy(renderTarget->frozenPalette_.begin(), renderTarget->frozenPalette_.end(), palette);
+            poseBounds_ = renderTarget->frozenBounds_;
+            finishPalette(*this, bindMatrices, dualQuaternions);
+        }
+        lodFrozen_ = true;
+        lodSteps_ = 0;
+        // THE STATE MACHINE PAUSES WHILE FROZEN
+        lodPendingTime_ = AnimationLOD::frozenPendingTime(lod, lodPendingTime_, deltaTime);
+        return;
     }
-}
-
-void AnimatedGameObject::getAnimatedNodeTransform(std::vector<AnimatedGameObject::secondaryTransform>* transforms, Animation* anim) {
-    int count = 0;
-
-    for (auto& channel : anim->channels)
-    {
-        Animation::AnimationSampler& sampler = anim->samplers[channel.samplerIndex];
-        for (size_t i = 0; i < sampler.inputs.size() - 1; i++)
-        {
-            if (sampler.interpolation != "LINEAR")
-            {
-                std::cout << "This sample only supports linear interpolations\n";
-                continue;
-            }
+    lodFrozen_ = false;
 
-            // Get the input keyframe values for the current time stamp
-            if ((anim->currentTime >= sampler.inputs[i]) && (anim->currentTime <= sampler.inputs[i + 1]))
-            {
-                float a = (anim->currentTime - sampler.inputs[i]) / (sampler.inputs[i + 1] - sampler.inputs[i]);
-                if (channel.path == "translation")
-                {
-                    transforms->at(count).position = glm::mix(sampler.outputsVec4[i], sampler.outputsVec4[i + 1], a);
-                }
-                if (channel.path == "rotation")
-                {
-                    glm::quat q1{};
-                    q1.x = sampler.outputsVec4[i].x;
-                    q1.y = sampler.outputsVec4[i].y;
-                    q1.z = sampler.outputsVec4[i].z;
-                    q1.w = sampler.outputsVec4[i].w;
-
-                    glm::quat q2{};
-                    q2.x = sampler.outputsVec4[i + 1].x;
-                    q2.y = sampler.outputsVec4[i + 1].y;
-                    q2.z = sampler.outputsVec4[i + 1].z;
-                    q2.w = sampler.outputsVec4[i + 1].w;
-
-                    transforms->at(count).rotation = glm::normalize(glm::slerp(q1, q2, a));
-                }
-                if (channel.path == "scale")
-                {
-                    transforms->at(count).scale = glm::mix(sampler.outputsVec4[i], sampler.outputsVec4[i + 1], a);
-                }
-            }
+    // BETWEEN UPDATES, THE NEXT STEP OF THE INTERPOLATION OR NOTHING AT ALL (THE PALETTE AND ITS HASH STAY, SO computeSkin SKIPS THE OBJECT TOO)
+    if (posed_ && lod.enabled && !AnimationLOD::updatesThisFrame(lod, lodLevel_, view.frame, stagger)) {
+        if (lodStep_ < lodSteps_) {
+            lodStep_++;
+            const float t = static_cast<float>(lodStep_) / static_cast<float>(lodSteps_);
+            AnimationLOD::interpolatePalette(lodFromPalette_.data(), lodToPalette_.data(), t, joints, palette);
+            poseBounds_ = AnimationLOD::interpolateBounds(lodFromBounds_, lodToBounds_, t);
+            finishPalette(*this, bindMatrices, dualQuaternions);
         }
-        count++;
+        return;
     }
-}
-
-using namespace std::literals;
 
-void AnimatedGameObject::smoothFromCurrentPosition(std::vector<glm::mat4>& bindMatrices, float deltaTime) {
-    activeAnimation->currentTime += deltaTime;
-    previousAnimation->currentTime += deltaTime;
-    if (activeAnimation->currentTime > activeAnimation->end)
-    {
-        activeAnimation->currentTime -= activeAnimation->end;
+    stateMachine_.update(lodPendingTime_);
+    lodPendingTime_ = 0.0f;
+    lodUpdated_ = true;
+    const bool reduced = lod.enabled && lod.reduceBones[lodLevel_];
+    const uint32_t interval = lod.enabled ? std::max<uint32_t>(1, lod.updateInterval[lodLevel_]) : 1;
+    if (posed_ && lod.interpolate && interval > 1) {
+        // THE NEW POSE IS REACHED interval FRAMES FROM NOW, WHEN THE NEXT ONE IS EVALUATED
+        lodFromPalette_.assign(palette, palette + joints);
+        lodToPalette_.resize(joints);
+        lodFromBounds_ = poseBounds_;
+        renderTarget->updateJointMatrices(hierarchy_, lodToPalette_.data(), &lodToBounds_, reduced);
+        lodStep_ = 1;
+        lodSteps_ = interval;
+        AnimationLOD::interpolatePalette(lodFromPalette_.data(), lodToPalette_.data(), 1.0f / static_cast<float>(interval), joints, palette);
+        poseBounds_ = AnimationLOD::interpolateBounds(lodFromBounds_, lodToBounds_, 1.0f / static_cast<float>(interval));
     }
-    if (previousAnimation->currentTime > previousAnimation->end)
-    {
-        previousAnimation->currentTime -= previousAnimation->end;
+    else {
+        renderTarget->updateJointMatrices(hierarchy_, palette, &poseBounds_, reduced);
+        lodSteps_ = 0;
     }
+    posed_ = true;
+    finishPalette(*this, bindMatrices, dualQuaternions);
+}
 
-    getAnimatedNodeTransform(src, previousAnimation);
-    getAnimatedNodeTransform(dst, activeAnimation);
-
-    int i = 0;
+glm::vec4 AnimatedGameObject::worldBounds() const {
+    const glm::mat4& model = localModelTransform;
+    const float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    return glm::vec4(glm::vec3(model * glm::vec4(glm::vec3(poseBounds_), 1.0f)), poseBounds_.w * scale);
+}
 
-    for (auto& channel : activeAnimation->channels) {
-        switch (hash_str(channel.path)) {
-        case STRINGENUM::TRANSLATION:
-            channel.node->translation = Time::weightLerp(src->at(i).position, dst->at(i).position, smoothAmount);
-            break;
-        case STRINGENUM::ROTATION:
-            channel.node->rotation.x = Time::weightLerp(src->at(i).rotation.x, dst->at(i).rotation.x, smoothAmount);
-            channel.node->rotation.y = Time::weightLerp(src->at(i).rotation.y, dst->at(i).rotation.y, smoothAmount);
-            channel.node->rotation.z = Time::weightLerp(src->at(i).rotation.z, dst->at(i).rotation.z, smoothAmount);
-            channel.node->rotation.w = Time::weightLerp(src->at(i).rotation.w, dst->at(i).rotation.w, smoothAmount);
-            break;
-        case STRINGENUM::SCALE:
-            channel.node->scale = Time::weightLerp(src->at(i).scale, dst->at(i).scale, smoothAmount);
-            break;
-        default:
-            break;
-        }
-        i++;
+// FNV-1a OVER THE MATRICES' BITS, 8 BYTES AT A TIME
+uint64_t AnimatedGameObject::hashPalette(const glm::mat4* matrices, size_t count) {
+    uint64_t hash = 14695981039346656037ull;
+    const size_t words = count * sizeof(glm::mat4) / sizeof(uint64_t);
+    for (size_t i = 0; i < words; i++) {
+        uint64_t word;
+        memcpy(&word, reinterpret_cast<const char*>(matrices) + i * sizeof(uint64_t), sizeof(uint64_t));
+        hash = (hash ^ word) * 1099511628211ull;
     }
+    return hash;
 }
 
-void AnimatedGameObject::updateAnimation(std::vector<glm::mat4>& bindMatrices, float deltaTime) {
-    if (needsSmooth) {
-        smoothStart = Time::getCurrentTime();
-        smoothUntil = smoothStart + smoothDuration;
-        smoothAmount = 0.0f;
-        activeAnimation->currentTime = 0.0f;
-        needsSmooth = false;
-    }
-    if (smoothAmount <= 1.0f) {
-        smoothAmount = (std::chrono::duration<float>(Time::getCurrentTime() - smoothStart) / smoothDuration);
-        smoothFromCurrentPosition(bindMatrices, deltaTime);
-        for (auto& node : renderTarget->pParentNodes)
-        {
-            updateJoints(node, bindMatrices);
-        }
-        return;
-    }
-    Animation* animation = activeAnimation;
-    animation->currentTime += deltaTime;
-    if (animation->currentTime > animation->end)
-    {
-        animation->currentTime -= animation->end;
-    }
+// ABOUT FOUR CHUNKS PER THREAD, SO ONE CHARACTER IN A LONG CROSSFADE DOESN'T LEAVE THE OTHER THREADS WAITING
+static size_t animationGrain(size_t count, const JobSystem& jobs) {
+    return std::max<size_t>(1, count / ((jobs.activeWorkers() + 1) * 4));
+}
 
-    getAnimatedNodeTransform(dst, animation);
-    int i = 0;
-    for (auto& channel : animation->channels)
-    {
-        switch (hash_str(channel.path)) {
-        case STRINGENUM::TRANSLATION:
-            channel.node->translation = dst->at(i).position;
-            break;
-        case STRINGENUM::ROTATION:
-            channel.node->rotation = dst->at(i).rotation;
-            break;
-        case STRINGENUM::SCALE:
-            channel.node->scale = dst->at(i).scale;
-            break;
-        default:
-            break;
+void AnimatedGameObject::updateAnimations(const std::vector<AnimatedGameObject*>& objects, std::vector<glm::mat4>& bindMatrices, std::vector<DualQuaternionSkinning::DualQuat>& dualQuaternions, float deltaTime, const AnimationLOD::Settings& lod, const AnimationLOD::View& view, JobSystem& jobs) {
+    auto update = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            objects[i]->updateAnimation(bindMatrices, dualQuaternions, deltaTime, lod, view, i);
         }
-        i++;
-    }
-    for (auto& node : renderTarget->pParentNodes)
-    {
-        updateJoints(node, bindMatrices);
-    }
-}
\ No newline at end of file
+    };
+    jobs.parallelFor(objects.size(), animationGrain(objects.size(), jobs), update);
+}
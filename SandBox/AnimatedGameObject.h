@@ -2,66 +2,81 @@
 
 #include "DirectionalLight.h"
 #include "AnimatedGLTFObj.h"
+#include "AnimationStateMachine.h"
+#include "AnimationLOD.h"
+#include "DualQuaternionSkinning.h"
+#include "JobSystem.h"
 
 class AnimatedGameObject {
 public:
-	struct secondaryTransform {
-		glm::vec3 position;
-		glm::quat rotation;
-		glm::vec3 scale;
+	enum class SkinningMode : uint32_t {
+		LINEAR = 0,
+		DUAL_QUATERNION = 1 // NO CANDY WRAPPING AT TWISTED JOINTS, HALF THE PALETTE READS. THE SKIN'S NON UNIFORM SCALE IS LOST
 	};
 
-	Animation* activeAnimation;
-	Animation* previousAnimation;
-	bool needsSmooth;
-	std::chrono::time_point<std::chrono::system_clock> smoothStart;
-	std::chrono::time_point<std::chrono::system_clock> smoothUntil;
-	std::chrono::milliseconds smoothDuration;
-	float smoothAmount;
-	float timeAdditional;
+	AnimationStateMachine stateMachine_; // WHAT THE OBJECT PLAYS, SET UP ONCE renderTarget IS LOADED
 	int numInverseBindMatrices;
-	std::vector<secondaryTransform>* src;
-	std::vector<secondaryTransform>* dst;
 	Transform transform;
 	AnimatedGLTFObj* renderTarget;
+	AnimatedGameObject* pSource_ = nullptr; // THE OBJECT THAT LOADED renderTarget WHEN THIS ONE IS AN INSTANCE SHARING IT, nullptr FOR THAT OBJECT
 	bool isDynamic;
 	bool isOutline;
 	bool isPlayerObj;
 	DeviceHelper* pDevHelper;
 
-	std::vector<Vertex> basePoseVertices_;
+	// WHAT EACH INSTANCE HAS TO ITSELF: ITS POSE, ITS SLICE OF THE GLOBAL JOINT PALETTE, THE RANGE OF THE GLOBAL VERTEX STREAMS computeSkin WRITES
+	// IT INTO AND ITS MODEL TRANSFORM. EVERYTHING ELSE (MESHES, MATERIALS, SKINS, THE BASE POSE BUFFER) IS renderTarget'S
+	NodeHierarchy hierarchy_;
+	uint32_t firstJointMatrix = 0;
+	uint32_t firstVertex = 0;
+	glm::mat4 localModelTransform = glm::mat4(1.0f);
+	bool transformDirty_ = true; // RAISED BY setTransform, CLEARED ONCE THE RENDERER HAS RECOMPUTED THE OBJECT'S MODEL MATRICES
+	SkinningMode skinningMode_ = SkinningMode::LINEAR; // READ WHEN THE RENDERER BUILDS ITS SKINNING TABLE IN setupCompute
 
-	VkBuffer vertexBuffer_;
-	VkDeviceMemory vertexBufferMemory_;
+	// WHAT THE RENDERER DECIDES TO SKIP computeSkin ON. THE SKINNED VERTICES STAY IN THE GLOBAL STREAMS UNTIL THE OBJECT IS SKINNED AGAIN
+	glm::vec4 poseBounds_ = glm::vec4(0.0f); // THE POSED MESH'S BOUNDING SPHERE BEFORE localModelTransform, FROM THE LAST updateAnimation
+	uint64_t paletteHash_ = 0; // OF THE OBJECT'S RANGE OF bindMatrices AFTER THE LAST updateAnimation
+	uint64_t skinnedHash_ = 0; // paletteHash_ AS IT WAS THE LAST TIME computeSkin RAN FOR THE OBJECT
+	bool skinned_ = false; // UNTIL computeSkin FIRST RUNS, THE OBJECT'S RANGE OF THE STREAMS HOLDS THE UNSKINNED BIND POSE
+
+	// ANIMATION LOD, SEE AnimationLOD. THE PLAYER STAYS AT LEVEL 0
+	uint32_t lodLevel_ = 0;
+	bool posed_ = false; // SET BY THE FIRST updateAnimation, BEFORE IT poseBounds_ MEANS NOTHING AND THE OBJECT IS TREATED AS LEVEL 0
+	bool lodUpdated_ = false; // WHETHER THE LAST updateAnimation ADVANCED THE STATE MACHINE
+	bool lodFrozen_ = false; // THE OBJECT'S RANGE OF THE PALETTE HOLDS renderTarget'S BAKED POSE
+	float lodPendingTime_ = 0.0f; // TIME SINCE THE STATE MACHINE LAST ADVANCED
+	uint32_t lodStep_ = 0; // FRAMES OF THE CURRENT INTERPOLATION SHOWN SO FAR, OUT OF lodSteps_
+	uint32_t lodSteps_ = 0;
+	std::vector<glm::mat4> lodFromPalette_; // THE PALETTE SHOWN WHEN THE LAST UPDATE RAN AND THE ONE IT EVALUATED, lodSteps_ FRAMES APART
+	std::vector<glm::mat4> lodToPalette_;
+	glm::vec4 lodFromBounds_ = glm::vec4(0.0f);
+	glm::vec4 lodToBounds_ = glm::vec4(0.0f);
 
 	physx::PxRigidActor* physicsActor;
 	physx::PxShape* pShape_;
 
 	AnimatedGameObject(DeviceHelper* pD) { isDynamic = false; isPlayerObj = false; this->pDevHelper = pD; numInverseBindMatrices = 0; };
 
-	void smoothFromCurrentPosition(std::vector<glm::mat4>& bindMatrices, float deltaTime);
-	void updateAnimation(std::vector<glm::mat4>& bindMatrices, float deltaTime);
+	// WRITES THE OBJECT'S RANGE OF bindMatrices, AND OF dualQuaternions AS WELL IN DUAL_QUATERNION MODE, AT THE LEVEL lod AND view PICK FOR IT. stagger
+	// IS THE OBJECT'S PLACE IN THE CROWD, FOR AnimationLOD::updatesThisFrame
+	void updateAnimation(std::vector<glm::mat4>& bindMatrices, std::vector<DualQuaternionSkinning::DualQuat>& dualQuaternions, float deltaTime, const AnimationLOD::Settings& lod, const AnimationLOD::View& view, size_t stagger);
+	// updateAnimation FOR EVERY OBJECT, SPREAD OVER jobs. EACH OBJECT ONLY WRITES ITS OWN HIERARCHY, STATE MACHINE AND RANGE OF THE PALETTES, SO
+	// THE OBJECTS MAY SHARE CLIPS AND renderTargets
+	static void updateAnimations(const std::vector<AnimatedGameObject*>& objects, std::vector<glm::mat4>& bindMatrices, std::vector<DualQuaternionSkinning::DualQuat>& dualQuaternions, float deltaTime, const AnimationLOD::Settings& lod, const AnimationLOD::View& view, JobSystem& jobs);
+	// poseBounds_ THROUGH localModelTransform
+	glm::vec4 worldBounds() const;
+
+	static uint64_t hashPalette(const glm::mat4* matrices, size_t count);
 	void setAnimatedGLTFObj(AnimatedGLTFObj* obj) { this->renderTarget = obj; };
 
-	void setTransform(glm::mat4 newTransform) { this->renderTarget->localModelTransform = newTransform; };
+	// THE PLAYER AND loopUpdate SET THIS EVERY FRAME, transformDirty_ IS ONLY RAISED WHEN THE MATRIX ACTUALLY CHANGED
+	void setTransform(glm::mat4 newTransform) {
+		if (newTransform != this->localModelTransform) {
+			this->localModelTransform = newTransform;
+			this->transformDirty_ = true;
+		}
+	};
 	void loopUpdate() {
 		setTransform(transform.to_matrix());
 	}
-
-private:
-	enum STRINGENUM {
-		TRANSLATION,
-		ROTATION,
-		SCALE
-	};
-
-	STRINGENUM hash_str(std::string const& inString) {
-		if (inString == "translation") return TRANSLATION;
-		if (inString == "rotation") return ROTATION;
-		if (inString == "scale") return SCALE;
-	}
-
-	glm::mat4 getNodeMatrix(AnimSceneNode* node);
-	void updateJoints(AnimSceneNode* node, std::vector<glm::mat4>& bindMatrices);
-	static void getAnimatedNodeTransform(std::vector<AnimatedGameObject::secondaryTransform>* transforms, Animation* anim);
 };;
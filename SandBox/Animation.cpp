@@ -18,7 +18,7 @@ AnimSceneNode* findNode(AnimSceneNode* parent, uint32_t index)
     return nodeFound;
 }
 
-AnimSceneNode* nodeFromIndex(uint32_t index, std::vector<AnimSceneNode*> pParentNodes)
+AnimSceneNode* nodeFromIndex(uint32_t index, const std::vector<AnimSceneNode*>& pParentNodes)
 {
     AnimSceneNode* nodeFound = nullptr;
     for (auto& node : pParentNodes)
@@ -32,100 +32,78 @@ AnimSceneNode* nodeFromIndex(uint32_t index, std::vector<AnimSceneNode*> pParent
     return nodeFound;
 }
 
-void Animation::loadAnimation(std::string gltfPath_, std::vector<AnimSceneNode*> pParentNodes) {
-    tinygltf::Model in;
-    tinygltf::TinyGLTF gltfContext;
-    std::string error, warning;
+bool Animation::compressClips_ = true;
 
-    bool loadedFile = false;
-    std::filesystem::path fPath = gltfPath_;
-    if (fPath.extension() == ".glb") {
-        loadedFile = gltfContext.LoadBinaryFromFile(&(in), &error, &warning, gltfPath_);
+bool Animation::loadCompressed(const std::string& gltfPath_, uint64_t sourceHash, uint32_t clipIndex, const std::vector<AnimSceneNode*>& pParentNodes) {
+    // THE CLIP NAMES glTF NODES, THEY ARE RESOLVED AGAINST THIS MODEL'S HIERARCHY AGAIN
+    std::vector<uint32_t> sourceNodes;
+    float clipStart;
+    float clipEnd;
+    if (!ClipCompressor::read(gltfPath_, clipIndex, sourceHash, compiled_, sourceNodes, clipStart, clipEnd)) {
+        return false;
     }
-    else if (fPath.extension() == ".gltf") {
-        loadedFile = gltfContext.LoadASCIIFromFile(&(in), &error, &warning, gltfPath_);
+    for (size_t t = 0; t < compiled_.tracks_.size(); t++) {
+        AnimSceneNode* node = nodeFromIndex(sourceNodes[t], pParentNodes);
+        if (node == nullptr) {
+            compiled_ = CompiledAnimation();
+            return false;
+        }
+        compiled_.tracks_[t].node = node->hierarchyIndex;
     }
+    compiled_.finalize();
+    start = clipStart;
+    end = clipEnd;
+    return true;
+}
 
-    for (size_t i = 0; i < in.animations.size(); i++)
-    {
-        tinygltf::Animation glTFAnimation = in.animations[i];
-        name = glTFAnimation.name;
+void Animation::build(AnimationLoader::Clip clip, const std::vector<AnimSceneNode*>& pParentNodes, const std::string& gltfPath_, uint64_t sourceHash, uint32_t clipIndex) {
+    name = clip.name;
+    samplers = std::move(clip.samplers);
+    compiled_ = CompiledAnimation();
+    std::vector<uint32_t> trackNodes;
 
-        // Samplers
-        samplers.resize(glTFAnimation.samplers.size());
-        for (size_t j = 0; j < glTFAnimation.samplers.size(); j++)
+    // Adjust animation's start and end times
+    for (auto& sampler : samplers)
+    {
+        for (auto input : sampler.inputs)
         {
-            tinygltf::AnimationSampler glTFSampler = glTFAnimation.samplers[j];
-            Animation::AnimationSampler& dstSampler = samplers[j];
-            dstSampler.interpolation = glTFSampler.interpolation;
-
-            // Read sampler keyframe input time values
+            if (input < start)
             {
-                const tinygltf::Accessor& accessor = in.accessors[glTFSampler.input];
-                const tinygltf::BufferView& bufferView = in.bufferViews[accessor.bufferView];
-                const tinygltf::Buffer& buffer = in.buffers[bufferView.buffer];
-                const void* dataPtr = &buffer.data[accessor.byteOffset + bufferView.byteOffset];
-                const float* buf = static_cast<const float*>(dataPtr);
-                for (size_t index = 0; index < accessor.count; index++)
-                {
-                    dstSampler.inputs.push_back(buf[index]);
-                }
-                // Adjust animation's start and end times
-                for (auto input : samplers[j].inputs)
-                {
-                    if (input < start)
-                    {
-                        start = input;
-                    };
-                    if (input > end)
-                    {
-                        end = input;
-                    }
-                }
-            }
-
-            // Read sampler keyframe output translate/rotate/scale values
+                start = input;
+            };
+            if (input > end)
             {
-                const tinygltf::Accessor& accessor = in.accessors[glTFSampler.output];
-                const tinygltf::BufferView& bufferView = in.bufferViews[accessor.bufferView];
-                const tinygltf::Buffer& buffer = in.buffers[bufferView.buffer];
-                const void* dataPtr = &buffer.data[accessor.byteOffset + bufferView.byteOffset];
-                switch (accessor.type)
-                {
-                case TINYGLTF_TYPE_VEC3: {
-                    const glm::vec3* buf = static_cast<const glm::vec3*>(dataPtr);
-                    for (size_t index = 0; index < accessor.count; index++)
-                    {
-                        dstSampler.outputsVec4.push_back(glm::vec4(buf[index], 0.0f));
-                    }
-                    break;
-                }
-                case TINYGLTF_TYPE_VEC4: {
-                    const glm::vec4* buf = static_cast<const glm::vec4*>(dataPtr);
-                    for (size_t index = 0; index < accessor.count; index++)
-                    {
-                        dstSampler.outputsVec4.push_back(buf[index]);
-                    }
-                    break;
-                }
-                default: {
-                    std::cout << "unknown type" << std::endl;
-                    break;
-                }
-                }
+                end = input;
             }
         }
+    }
 
-        // Channels
-        numChannels = glTFAnimation.channels.size();
-        channels.resize(numChannels);
-        for (size_t j = 0; j < numChannels; j++)
-        {
-            tinygltf::AnimationChannel glTFChannel = glTFAnimation.channels[j];
-            Animation::AnimationChannel& dstChannel = channels[j];
-            dstChannel.path = glTFChannel.target_path;
-            dstChannel.samplerIndex = glTFChannel.sampler;
-            dstChannel.node = nodeFromIndex(glTFChannel.target_node, pParentNodes);
+    // Channels
+    numChannels = static_cast<int>(clip.channels.size());
+    channels.resize(numChannels);
+    for (size_t j = 0; j < numChannels; j++)
+    {
+        const AnimationLoader::Channel& glTFChannel = clip.channels[j];
+        Animation::AnimationChannel& dstChannel = channels[j];
+        dstChannel.path = glTFChannel.path;
+        dstChannel.samplerIndex = glTFChannel.samplerIndex;
+        dstChannel.node = glTFChannel.node >= 0 ? nodeFromIndex(static_cast<uint32_t>(glTFChannel.node), pParentNodes) : nullptr;
+
+        CompiledAnimation::Path path;
+        CompiledAnimation::Interpolation interpolation;
+        const AnimationSampler& sampler = samplers[dstChannel.samplerIndex];
+        if (!dstChannel.node || sampler.inputs.empty() || sampler.outputsVec4.empty() || !CompiledAnimation::parsePath(dstChannel.path, path) || !CompiledAnimation::parseInterpolation(sampler.interpolation, interpolation)) {
+            std::cout << "skipping animation channel " << j << " (" << dstChannel.path << ", " << sampler.interpolation << ")" << std::endl;
+            continue;
         }
+        compiled_.addTrack(path, interpolation, dstChannel.node->hierarchyIndex, sampler.inputs.data(), sampler.outputsVec4.data(), static_cast<uint32_t>(sampler.inputs.size()));
+        trackNodes.push_back(static_cast<uint32_t>(glTFChannel.node));
     }
-}
\ No newline at end of file
+    compiled_.finalize();
+
+    if (compressClips_ && compiled_.size() > 0) {
+        CompiledAnimation compressed = ClipCompressor::compress(compiled_, ClipCompressor::Settings{});
+        ClipCompressor::write(gltfPath_, clipIndex, sourceHash, compressed, trackNodes, start, end);
+        compiled_ = std::move(compressed);
+    }
+}
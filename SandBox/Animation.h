@@ -1,6 +1,8 @@
 #pragma once
 
 #include "MeshHelper.h"
+#include "ClipCompressor.h"
+#include "AnimationLoader.h"
 #include <filesystem>
 
 struct AnimSceneNode {
@@ -8,26 +10,14 @@ struct AnimSceneNode {
 	uint32_t index;
 	std::vector<AnimSceneNode*> children;
 	std::vector<MeshHelper*> meshPrimitives;
-	glm::vec3 translation{};
-	glm::vec3 scale{ 1.0f };
-	glm::quat rotation{}; 
-	glm::mat4 matrix;
-	glm::mat4 getAnimatedMatrix() const;
+	uint32_t hierarchyIndex; // THE NODE'S TRS AND WORLD MATRIX LIVE IN THE OWNING OBJECT'S NodeHierarchy AT THIS INDEX
 
 	int32_t skinIndex = -1;
 };
 
 class Animation {
 public:
-	struct AnimationGraph {
-
-	} animGraph;
-
-	struct AnimationSampler {
-		std::string interpolation;
-		std::vector<float> inputs;
-		std::vector<glm::vec4> outputsVec4;
-	};
+	typedef AnimationLoader::Sampler AnimationSampler;
 
 	struct AnimationChannel {
 		std::string path;
@@ -41,7 +31,14 @@ public:
 	std::vector<AnimationChannel> channels;
 	float start = std::numeric_limits<float>::max();
 	float end = std::numeric_limits<float>::min();
-	float currentTime = 0.0f;
+	CompiledAnimation compiled_; // WHAT THE PER FRAME UPDATE SAMPLES. samplers AND channels ARE THE SOURCE IT WAS BUILT FROM, EMPTY WHEN IT CAME FROM A CLIP FILE
+
+	// COMPRESS EVERY CLIP AND LOAD IT FROM ITS .orchidclip ON LATER RUNS, SEE ClipCompressor
+	static bool compressClips_;
 
-	void loadAnimation(std::string gltfPath_, std::vector<AnimSceneNode*> pParentNodes);
+	// CLIPS ARE LOADED THROUGH AnimationLibrary. build RESOLVES clip'S CHANNELS AGAINST pParentNodes AND COMPILES THEM, WRITING CLIP clipIndex'S
+	// .orchidclip WHEN compressClips_ IS SET
+	void build(AnimationLoader::Clip clip, const std::vector<AnimSceneNode*>& pParentNodes, const std::string& gltfPath_, uint64_t sourceHash, uint32_t clipIndex);
+	// false WHEN THE .orchidclip IS MISSING, STALE OR TARGETS NODES THIS MODEL DOESN'T HAVE
+	bool loadCompressed(const std::string& gltfPath_, uint64_t sourceHash, uint32_t clipIndex, const std::vector<AnimSceneNode*>& pParentNodes);
 };
@@ -0,0 +1,53 @@
+#include "AnimationLOD.h"
+#include "Camera.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+AnimationLOD::View AnimationLOD::fromCamera(const FPSCam& camera, uint64_t frame) {
+    View view;
+    view.viewMatrix = camera.viewMatrix;
+    view.projectionScale = std::abs(camera.projectionMatrix[1][1]);
+    view.frame = frame;
+    return view;
+}
+
+float AnimationLOD::screenSize(const View& view, const glm::vec4& sphere) {
+    const float depth = -(view.viewMatrix * glm::vec4(glm::vec3(sphere), 1.0f)).z;
+    if (depth <= sphere.w) {
+        return std::numeric_limits<float>::max();
+    }
+    return sphere.w * view.projectionScale / depth;
+}
+
+uint32_t AnimationLOD::selectLevel(const Settings& settings, float screenSize, uint32_t current) {
+    uint32_t level = 0;
+    while (level < FROZEN) {
+        // STAYING AT OR BELOW THE CURRENT LEVEL NEEDS THE CHARACTER TO GROW PAST THE THRESHOLD BY THE HYSTERESIS
+        const float threshold = settings.minScreenSize[level] * (level < current ? 1.0f + settings.hysteresis : 1.0f);
+        if (screenSize >= threshold) {
+            break;
+        }
+        level++;
+    }
+    return level;
+}
+
+bool AnimationLOD::updatesThisFrame(const Settings& settings, uint32_t level, uint64_t frame, size_t stagger) {
+    const uint32_t interval = std::max<uint32_t>(1, settings.updateInterval[level]);
+    return (frame + stagger) % interval == 0;
+}
+
+float AnimationLOD::frozenPendingTime(const Settings& settings, float pendingTime, float deltaTime) {
+    return std::min(pendingTime, deltaTime * static_cast<float>(std::max<uint32_t>(1, settings.updateInterval[FROZEN - 1])));
+}
+
+void AnimationLOD::interpolatePalette(const glm::mat4* from, const glm::mat4* to, float t, size_t count, glm::mat4* out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = from[i] + (to[i] - from[i]) * t;
+    }
+}
+
+glm::vec4 AnimationLOD::interpolateBounds(const glm::vec4& from, const glm::vec4& to, float t) {
+    return from + (to - from) * t;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+class FPSCam;
+
+// ANIMATION LEVEL OF DETAIL FROM HOW LARGE A CHARACTER IS ON SCREEN. EACH LEVEL DOWN UPDATES LESS OFTEN (THE STATE MACHINE THEN ADVANCES BY ALL THE
+// TIME SINCE THE LAST UPDATE, AND THE PALETTE IS INTERPOLATED OVER THE FRAMES BETWEEN) AND MAY USE THE MODEL'S REDUCED SKELETON, WHERE LEAF JOINTS
+// THAT MOVE TOO LITTLE TO SEE (FINGERS, END SITES) FOLLOW THEIR NEAREST KEPT ANCESTOR. THE LAST LEVEL HOLDS THE MODEL'S BAKED POSE AND COSTS
+// NOTHING. THE LEVEL IS PICKED FROM THE POSE BOUNDS OF THE LAST UPDATE, SO IT RUNS IN THE SAME JOB AS THE OBJECT'S ANIMATION
+class AnimationLOD {
+public:
+	static constexpr uint32_t LEVELS = 4;
+	static constexpr uint32_t FROZEN = LEVELS - 1;
+
+	struct Settings {
+		bool enabled = true;
+		bool interpolate = true; // BLEND FROM THE SHOWN PALETTE TO A NEW ONE OVER THE FRAMES UNTIL THE NEXT UPDATE, INSTEAD OF HOLDING EACH ONE
+		float minScreenSize[FROZEN] = { 0.25f, 0.1f, 0.04f }; // FRACTION OF THE SCREEN HEIGHT, BELOW minScreenSize[i] A CHARACTER DROPS PAST LEVEL i
+		uint32_t updateInterval[FROZEN] = { 1, 2, 4 }; // FRAMES
+		bool reduceBones[FROZEN] = { false, false, true };
+		float hysteresis = 0.15f; // A CHARACTER ONLY MOVES UP A LEVEL ONCE IT IS THIS MUCH LARGER THAN THE THRESHOLD, SO ONE ON A BOUNDARY DOESN'T FLICKER
+	};
+
+	// THE CAMERA AS THE LEVELS NEED IT, TAKEN ONCE PER FRAME
+	struct View {
+		glm::mat4 viewMatrix = glm::mat4(1.0f);
+		float projectionScale = 1.0f; // |projection[1][1]|, 1 / tan(FOV / 2)
+		uint64_t frame = 0;
+	};
+
+	static View fromCamera(const FPSCam& camera, uint64_t frame);
+	// THE DIAMETER OF sphere (xyz CENTRE, w RADIUS, WORLD SPACE) AS A FRACTION OF THE SCREEN HEIGHT, LARGE WHEN THE CAMERA IS INSIDE IT
+	static float screenSize(const View& view, const glm::vec4& sphere);
+	static uint32_t selectLevel(const Settings& settings, float screenSize, uint32_t current);
+	// WHETHER A CHARACTER AT level (NOT FROZEN) UPDATES ON view.frame. stagger (THE CHARACTER'S INDEX) SPREADS A LEVEL'S CHARACTERS OVER ITS INTERVAL
+	static bool updatesThisFrame(const Settings& settings, uint32_t level, uint64_t frame, size_t stagger);
+	// THE TIME A FROZEN CHARACTER KEEPS FOR ITS STATE MACHINE. AT MOST ONE INTERVAL OF THE SLOWEST ANIMATED LEVEL, SO THE CHARACTER DOESN'T JUMP BY
+	// THE WHOLE FROZEN TIME WHEN IT COMES BACK
+	static float frozenPendingTime(const Settings& settings, float pendingTime, float deltaTime);
+
+	// COMPONENT WISE, SO A LINEARLY SKINNED VERTEX MOVES IN A STRAIGHT LINE BETWEEN ITS TWO POSES. THE SHORT STEPS BETWEEN UPDATES KEEP THE SHEAR IT
+	// ADDS TO A ROTATING JOINT TOO SMALL TO SEE AT THE SIZES THAT INTERPOLATE
+	static void interpolatePalette(const glm::mat4* from, const glm::mat4* to, float t, size_t count, glm::mat4* out);
+	// CENTRE AND RADIUS LERPED, WHICH STILL BOUNDS EVERY VERTEX OF THE INTERPOLATED PALETTE
+	static glm::vec4 interpolateBounds(const glm::vec4& from, const glm::vec4& to, float t);
+};
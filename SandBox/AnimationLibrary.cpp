@@ -0,0 +1,93 @@
+#include "AnimationLibrary.h"
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+
+size_t AnimationLibrary::loadFile(const std::string& gltfPath, const std::vector<AnimSceneNode*>& pParentNodes) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // WITH COMPRESSION ON, THE FIRST PASS ONLY NEEDS THE CLIP LIST, THE KEYS ARE FETCHED IF A CLIP FILE TURNS OUT TO BE MISSING
+    std::vector<AnimationLoader::Clip> clips;
+    AnimationLoader::Stats stats;
+    if (!AnimationLoader::load(gltfPath, clips, !Animation::compressClips_, &stats)) {
+        std::cout << "couldnt open animation file " << gltfPath << std::endl;
+        return 0;
+    }
+    size_t added = addClips(gltfPath, clips, !Animation::compressClips_, pParentNodes, stats);
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "animation library: " << gltfPath << ": " << added << " clips, read " << stats.bytesRead / 1024.0f << " of "
+         << stats.fileBytes / 1024.0f << " KB" << (stats.fullLoad ? " (full glTF load)" : "") << " in "
+         << std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - startTime).count() << " ms\n";
+    std::cout << line.str();
+    return added;
+}
+
+size_t AnimationLibrary::loadModel(const tinygltf::Model& model, const std::string& gltfPath, const std::vector<AnimSceneNode*>& pParentNodes) {
+    std::vector<AnimationLoader::Clip> clips;
+    AnimationLoader::fromModel(model, clips);
+    AnimationLoader::Stats stats;
+    return addClips(gltfPath, clips, true, pParentNodes, stats);
+}
+
+size_t AnimationLibrary::addClips(const std::string& gltfPath, std::vector<AnimationLoader::Clip>& clips, bool keysLoaded, const std::vector<AnimSceneNode*>& pParentNodes, AnimationLoader::Stats& stats) {
+    uint64_t sourceHash = Animation::compressClips_ ? ClipCompressor::hashSource(gltfPath) : 0;
+
+    std::vector<Animation*> loaded(clips.size(), nullptr);
+    bool missing = false;
+    for (size_t i = 0; i < clips.size(); i++) {
+        Animation* animation = new Animation();
+        animation->name = clips[i].name;
+        if (Animation::compressClips_ && animation->loadCompressed(gltfPath, sourceHash, static_cast<uint32_t>(i), pParentNodes)) {
+            loaded[i] = animation;
+        }
+        else {
+            delete animation;
+            missing = true;
+        }
+    }
+
+    if (missing && !keysLoaded) {
+        AnimationLoader::Stats keyStats;
+        if (!AnimationLoader::load(gltfPath, clips, true, &keyStats) || clips.size() != loaded.size()) {
+            std::cout << "couldnt read animation keys from " << gltfPath << std::endl;
+            clips.clear();
+        }
+        stats.bytesRead += keyStats.bytesRead;
+        stats.fullLoad = keyStats.fullLoad;
+    }
+
+    std::string stem = std::filesystem::path(gltfPath).stem().string();
+    size_t added = 0;
+    for (size_t i = 0; i < loaded.size(); i++) {
+        if (loaded[i] == nullptr) {
+            if (i >= clips.size()) {
+                continue;
+            }
+            loaded[i] = new Animation();
+            loaded[i]->build(std::move(clips[i]), pParentNodes, gltfPath, sourceHash, static_cast<uint32_t>(i));
+        }
+
+        std::string name = loaded.size() == 1 ? stem : stem + "/" + (loaded[i]->name.empty() ? std::to_string(i) : loaded[i]->name);
+        if (names_.count(name) != 0) {
+            std::cout << "duplicate animation clip " << name << ", keeping the first" << std::endl;
+            delete loaded[i];
+            continue;
+        }
+        names_[name] = clips_.size();
+        clips_.push_back(loaded[i]);
+        added++;
+    }
+    return added;
+}
+
+Animation* AnimationLibrary::find(const std::string& name) const {
+    auto found = names_.find(name);
+    return found != names_.end() ? clips_[found->second] : nullptr;
+}
+
+AnimationLibrary::~AnimationLibrary() {
+    for (Animation* clip : clips_) {
+        delete clip;
+    }
+}
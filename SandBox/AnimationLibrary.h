@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Animation.h"
+#include <unordered_map>
+
+// A CHARACTER'S CLIPS BY NAME. A FILE WITH ONE CLIP IS NAMED AFTER THE FILE ("goroRun2"), A FILE WITH SEVERAL ADDS EACH CLIP UNDER "<file>/<clip name>".
+// CLIPS WITH AN UP TO DATE .orchidclip COME STRAIGHT FROM IT, THE REST ARE READ WITH AnimationLoader, SO A CLIP FILE'S MESHES AND IMAGES ARE NEVER LOADED
+class AnimationLibrary {
+public:
+	std::vector<Animation*> clips_;
+
+	// BOTH RETURN THE NUMBER OF CLIPS ADDED
+	size_t loadFile(const std::string& gltfPath, const std::vector<AnimSceneNode*>& pParentNodes);
+	// FOR THE CLIPS STORED IN THE MODEL'S OWN FILE, WHOSE DOCUMENT IS ALREADY PARSED
+	size_t loadModel(const tinygltf::Model& model, const std::string& gltfPath, const std::vector<AnimSceneNode*>& pParentNodes);
+
+	// nullptr WHEN THERE IS NO CLIP CALLED name
+	Animation* find(const std::string& name) const;
+	size_t size() const { return clips_.size(); }
+
+	AnimationLibrary() = default;
+	AnimationLibrary(const AnimationLibrary&) = delete;
+	AnimationLibrary& operator=(const AnimationLibrary&) = delete;
+	~AnimationLibrary();
+
+private:
+	std::unordered_map<std::string, size_t> names_;
+
+	// clips HOLDS ONLY NAMES AND CHANNELS WHEN keysLoaded IS false, THE KEYS ARE THEN READ ONLY IF A CLIP HAS NO USABLE .orchidclip
+	size_t addClips(const std::string& gltfPath, std::vector<AnimationLoader::Clip>& clips, bool keysLoaded, const std::vector<AnimSceneNode*>& pParentNodes, AnimationLoader::Stats& stats);
+};
@@ -0,0 +1,313 @@
+#include "AnimationLoader.h"
+#include <tiny_gltf.h>
+#include <json.hpp>
+#include <fstream>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <cstring>
+
+using json = nlohmann::json;
+
+static constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+static constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+static constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+static void copyInputs(const unsigned char* data, size_t stride, size_t count, std::vector<float>& inputs) {
+    inputs.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        memcpy(&inputs[i], data + i * stride, sizeof(float));
+    }
+}
+
+// VEC3 OUTPUTS ARE WIDENED TO vec4 WITH w = 0
+static void copyOutputs(const unsigned char* data, size_t stride, size_t count, uint32_t components, std::vector<glm::vec4>& outputs) {
+    outputs.assign(count, glm::vec4(0.0f));
+    for (size_t i = 0; i < count; i++) {
+        memcpy(&outputs[i], data + i * stride, sizeof(float) * components);
+    }
+}
+
+// THE FILES BEHIND A DOCUMENT'S buffers[], OPENED THE FIRST TIME AN ACCESSOR NEEDS THEM
+struct BufferFiles {
+    const json* buffers = nullptr;
+    std::string directory;
+    std::string glbPath;
+    size_t binStart = 0;
+    bool hasBin = false;
+    std::vector<std::unique_ptr<std::ifstream>> files;
+    std::vector<size_t> bases;
+    AnimationLoader::Stats* stats = nullptr;
+
+    std::ifstream* open(size_t buffer, size_t& base) {
+        if (buffers == nullptr || buffer >= buffers->size()) {
+            return nullptr;
+        }
+        if (files.size() != buffers->size()) {
+            files.resize(buffers->size());
+            bases.resize(buffers->size(), 0);
+        }
+        if (!files[buffer]) {
+            const json& source = (*buffers)[buffer];
+            std::string path;
+            if (!source.contains("uri")) {
+                // ONLY A .glb'S FIRST BUFFER MAY LEAVE OUT ITS URI, IT IS THE BIN CHUNK
+                if (buffer != 0 || !hasBin) {
+                    return nullptr;
+                }
+                path = glbPath;
+                bases[buffer] = binStart;
+            }
+            else {
+                std::string uri = source["uri"].get<std::string>();
+                if (uri.compare(0, 5, "data:") == 0) {
+                    return nullptr;
+                }
+                path = (std::filesystem::path(directory) / uri).string();
+                if (stats != nullptr) {
+                    std::error_code error;
+                    stats->fileBytes += static_cast<size_t>(std::filesystem::file_size(path, error));
+                }
+            }
+            files[buffer] = std::make_unique<std::ifstream>(path, std::ios::binary);
+            if (!files[buffer]->is_open()) {
+                files[buffer].reset();
+                return nullptr;
+            }
+        }
+        base = bases[buffer];
+        return files[buffer].get();
+    }
+};
+
+// READS ONE FLOAT ACCESSOR'S BYTE RANGE, RETURNS false FOR ANYTHING ONLY THE FULL LOADER HANDLES
+static bool readAccessor(const json& document, BufferFiles& buffers, size_t index, std::vector<unsigned char>& bytes, size_t& stride, size_t& count, uint32_t& components) {
+    const json& accessor = document.at("accessors").at(index);
+    if (accessor.contains("sparse") || !accessor.contains("bufferView") || accessor.value("componentType", 0) != TINYGLTF_COMPONENT_TYPE_FLOAT) {
+        return false;
+    }
+
+    std::string type = accessor.value("type", std::string());
+    if (type == "SCALAR") {
+        components = 1;
+    }
+    else if (type == "VEC3") {
+        components = 3;
+    }
+    else if (type == "VEC4") {
+        components = 4;
+    }
+    else {
+        return false;
+    }
+
+    const json& view = document.at("bufferViews").at(accessor["bufferView"].get<size_t>());
+    size_t elementSize = sizeof(float) * components;
+    stride = view.value("byteStride", size_t(0));
+    if (stride == 0) {
+        stride = elementSize;
+    }
+    count = accessor.value("count", size_t(0));
+    size_t offset = view.value("byteOffset", size_t(0)) + accessor.value("byteOffset", size_t(0));
+    size_t byteLength = count > 0 ? (count - 1) * stride + elementSize : 0;
+    if (accessor.value("byteOffset", size_t(0)) + byteLength > view.value("byteLength", size_t(0))) {
+        return false;
+    }
+
+    size_t base = 0;
+    std::ifstream* file = buffers.open(view.value("buffer", size_t(0)), base);
+    if (file == nullptr) {
+        return false;
+    }
+    bytes.resize(byteLength);
+    file->seekg(static_cast<std::streamoff>(base + offset));
+    file->read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(byteLength));
+    if (!*file) {
+        file->clear();
+        return false;
+    }
+    buffers.stats->bytesRead += byteLength;
+    return true;
+}
+
+bool AnimationLoader::load(const std::string& gltfPath, std::vector<Clip>& clips, bool withKeys, Stats* stats) {
+    Stats localStats;
+    Stats& result = stats != nullptr ? *stats : localStats;
+    result = Stats{};
+    clips.clear();
+
+    std::ifstream file(gltfPath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    result.fileBytes = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+
+    BufferFiles buffers;
+    buffers.directory = std::filesystem::path(gltfPath).parent_path().string();
+    buffers.stats = &result;
+
+    // A .glb IS A 12 BYTE HEADER, THE JSON CHUNK AND THE BIN CHUNK, EACH CHUNK BEHIND AN 8 BYTE LENGTH + TYPE
+    std::string text;
+    std::filesystem::path fPath = gltfPath;
+    if (fPath.extension() == ".glb") {
+        uint32_t header[5];
+        if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != GLB_MAGIC || header[4] != GLB_CHUNK_JSON) {
+            return false;
+        }
+        text.resize(header[3]);
+        file.read(&text[0], header[3]);
+
+        uint32_t binHeader[2];
+        size_t binOffset = sizeof(header) + header[3];
+        file.seekg(static_cast<std::streamoff>(binOffset));
+        if (file.read(reinterpret_cast<char*>(binHeader), sizeof(binHeader)) && binHeader[1] == GLB_CHUNK_BIN) {
+            buffers.glbPath = gltfPath;
+            buffers.binStart = binOffset + sizeof(binHeader);
+            buffers.hasBin = true;
+        }
+        result.bytesRead += sizeof(header) + sizeof(binHeader) + text.size();
+    }
+    else if (fPath.extension() == ".gltf") {
+        text.resize(result.fileBytes);
+        file.read(&text[0], result.fileBytes);
+        result.bytesRead += text.size();
+    }
+    else {
+        return false;
+    }
+    file.close();
+
+    bool complete = true;
+    json document = json::parse(text, nullptr, false);
+    if (document.is_discarded()) {
+        return false;
+    }
+    if (document.contains("buffers")) {
+        buffers.buffers = &document["buffers"];
+    }
+
+    try {
+        if (document.contains("animations")) {
+            std::vector<unsigned char> bytes;
+            for (const json& animation : document["animations"]) {
+                Clip clip;
+                clip.name = animation.value("name", std::string());
+                std::unordered_map<size_t, size_t> inputSamplers;
+
+                for (const json& sampler : animation.at("samplers")) {
+                    Sampler dstSampler;
+                    dstSampler.interpolation = sampler.value("interpolation", std::string("LINEAR"));
+
+                    size_t stride;
+                    size_t count;
+                    uint32_t components;
+                    if (withKeys && complete) {
+                        // EXPORTERS USUALLY SHARE ONE TIME ACCESSOR BETWEEN ALL OF A CLIP'S SAMPLERS, IT IS ONLY READ ONCE
+                        size_t input = sampler.at("input").get<size_t>();
+                        auto shared = inputSamplers.find(input);
+                        if (shared != inputSamplers.end()) {
+                            dstSampler.inputs = clip.samplers[shared->second].inputs;
+                        }
+                        else {
+                            complete = readAccessor(document, buffers, input, bytes, stride, count, components) && components == 1;
+                            if (complete) {
+                                copyInputs(bytes.data(), stride, count, dstSampler.inputs);
+                                inputSamplers[input] = clip.samplers.size();
+                            }
+                        }
+                        if (complete) {
+                            complete = readAccessor(document, buffers, sampler.at("output").get<size_t>(), bytes, stride, count, components);
+                        }
+                        // SCALAR OUTPUTS ARE MORPH TARGET weights, THE CHANNEL IS SKIPPED WHEN THE CLIP IS BUILT
+                        if (complete && components >= 3) {
+                            copyOutputs(bytes.data(), stride, count, components, dstSampler.outputsVec4);
+                        }
+                    }
+                    clip.samplers.push_back(std::move(dstSampler));
+                }
+
+                for (const json& channel : animation.at("channels")) {
+                    const json& target = channel.at("target");
+                    Channel dstChannel;
+                    dstChannel.path = target.value("path", std::string());
+                    dstChannel.node = target.value("node", -1);
+                    dstChannel.samplerIndex = channel.at("sampler").get<uint32_t>();
+                    clip.channels.push_back(dstChannel);
+                }
+                clips.push_back(std::move(clip));
+            }
+        }
+    }
+    catch (const json::exception&) {
+        complete = false;
+    }
+
+    if (complete) {
+        return true;
+    }
+
+    tinygltf::Model in;
+    tinygltf::TinyGLTF gltfContext;
+    std::string error, warning;
+    bool loadedFile = fPath.extension() == ".glb" ? gltfContext.LoadBinaryFromFile(&in, &error, &warning, gltfPath) : gltfContext.LoadASCIIFromFile(&in, &error, &warning, gltfPath);
+    if (!loadedFile) {
+        std::cout << "couldnt open gltf file " << gltfPath << ": " << error << std::endl;
+        clips.clear();
+        return false;
+    }
+    fromModel(in, clips, withKeys);
+    result.bytesRead = result.fileBytes;
+    result.fullLoad = true;
+    return true;
+}
+
+void AnimationLoader::fromModel(const tinygltf::Model& in, std::vector<Clip>& clips, bool withKeys) {
+    clips.clear();
+    for (const tinygltf::Animation& glTFAnimation : in.animations) {
+        Clip clip;
+        clip.name = glTFAnimation.name;
+
+        clip.samplers.resize(glTFAnimation.samplers.size());
+        for (size_t j = 0; j < glTFAnimation.samplers.size(); j++) {
+            const tinygltf::AnimationSampler& glTFSampler = glTFAnimation.samplers[j];
+            Sampler& dstSampler = clip.samplers[j];
+            dstSampler.interpolation = glTFSampler.interpolation;
+            if (!withKeys) {
+                continue;
+            }
+
+            {
+                const tinygltf::Accessor& accessor = in.accessors[glTFSampler.input];
+                const tinygltf::BufferView& bufferView = in.bufferViews[accessor.bufferView];
+                const tinygltf::Buffer& buffer = in.buffers[bufferView.buffer];
+                if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) {
+                    std::cout << "unknown component type" << std::endl;
+                    continue;
+                }
+                copyInputs(&buffer.data[accessor.byteOffset + bufferView.byteOffset], accessor.ByteStride(bufferView), accessor.count, dstSampler.inputs);
+            }
+
+            {
+                const tinygltf::Accessor& accessor = in.accessors[glTFSampler.output];
+                const tinygltf::BufferView& bufferView = in.bufferViews[accessor.bufferView];
+                const tinygltf::Buffer& buffer = in.buffers[bufferView.buffer];
+                if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || (accessor.type != TINYGLTF_TYPE_VEC3 && accessor.type != TINYGLTF_TYPE_VEC4)) {
+                    std::cout << "unknown type" << std::endl;
+                    continue;
+                }
+                copyOutputs(&buffer.data[accessor.byteOffset + bufferView.byteOffset], accessor.ByteStride(bufferView), accessor.count, accessor.type == TINYGLTF_TYPE_VEC3 ? 3 : 4, dstSampler.outputsVec4);
+            }
+        }
+
+        for (const tinygltf::AnimationChannel& glTFChannel : glTFAnimation.channels) {
+            Channel dstChannel;
+            dstChannel.path = glTFChannel.target_path;
+            dstChannel.node = glTFChannel.target_node;
+            dstChannel.samplerIndex = static_cast<uint32_t>(glTFChannel.sampler);
+            clip.channels.push_back(dstChannel);
+        }
+        clips.push_back(std::move(clip));
+    }
+}
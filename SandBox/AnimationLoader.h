@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <glm/glm.hpp>
+
+namespace tinygltf {
+	class Model;
+}
+
+// READS THE animations[] OF A glTF FILE WITHOUT LOADING THE REST OF IT. ONLY THE JSON IS PARSED (NO MESHES, NO IMAGE DECODING) AND ONLY THE BYTE RANGES
+// OF THE ACCESSORS THE ANIMATION SAMPLERS USE ARE READ, FROM THE .glb BIN CHUNK OR THE EXTERNAL .bin FILES. BUFFERS EMBEDDED AS data: URIs, SPARSE
+// ACCESSORS AND NON FLOAT KEYS FALL BACK TO A FULL TINYGLTF LOAD
+class AnimationLoader {
+public:
+	struct Sampler {
+		std::string interpolation;
+		std::vector<float> inputs;
+		std::vector<glm::vec4> outputsVec4;
+	};
+
+	struct Channel {
+		std::string path;
+		int32_t node; // -1 WHEN THE CHANNEL HAS NO TARGET NODE
+		uint32_t samplerIndex;
+	};
+
+	struct Clip {
+		std::string name;
+		std::vector<Sampler> samplers;
+		std::vector<Channel> channels;
+	};
+
+	struct Stats {
+		size_t fileBytes = 0;
+		size_t bytesRead = 0;
+		bool fullLoad = false;
+	};
+
+	// withKeys = false ONLY FILLS THE NAMES, CHANNELS AND INTERPOLATIONS, ENOUGH TO LOOK THE CLIPS UP IN THEIR COMPRESSED FILES
+	static bool load(const std::string& gltfPath, std::vector<Clip>& clips, bool withKeys = true, Stats* stats = nullptr);
+	// THE SAME CLIPS OUT OF A DOCUMENT THAT IS ALREADY PARSED (THE MODEL'S OWN FILE)
+	static void fromModel(const tinygltf::Model& model, std::vector<Clip>& clips, bool withKeys = true);
+};
@@ -0,0 +1,301 @@
+#include "AnimationStateMachine.h"
+#include <cmath>
+#include <algorithm>
+
+void AnimationStateMachine::init(NodeHierarchy& hierarchy) {
+    pHierarchy_ = &hierarchy;
+    nodeCount_ = hierarchy.size();
+    restPose_.resize(nodeCount_ * PoseBlender::VALUES_PER_NODE);
+    PoseBlender::restPose(hierarchy, restPose_.data());
+    pose_ = restPose_;
+    fadeFromPose_ = restPose_;
+
+    // ONE BUFFER PER BLEND SPACE SAMPLE, PLUS THE STATE BEING FADED OUT AND ONE LAYER
+    pool_.init(nodeCount_ * PoseBlender::VALUES_PER_NODE, MAX_BLEND_CLIPS + 2);
+}
+
+uint32_t AnimationStateMachine::addParameter(const std::string& name, float value) {
+    auto found = parameterNames_.find(name);
+    if (found != parameterNames_.end()) {
+        parameters_[found->second] = value;
+        return found->second;
+    }
+    uint32_t index = static_cast<uint32_t>(parameters_.size());
+    parameters_.push_back(value);
+    parameterNames_[name] = index;
+    return index;
+}
+
+int32_t AnimationStateMachine::parameterIndex(const std::string& name) const {
+    auto found = parameterNames_.find(name);
+    return found != parameterNames_.end() ? static_cast<int32_t>(found->second) : -1;
+}
+
+void AnimationStateMachine::setParameter(int32_t parameter, float value) {
+    if (parameter >= 0 && parameter < static_cast<int32_t>(parameters_.size())) {
+        parameters_[parameter] = value;
+    }
+}
+
+int32_t AnimationStateMachine::stateIndex(const std::string& name) const {
+    for (size_t i = 0; i < states_.size(); i++) {
+        if (states_[i].desc.name == name) {
+            return static_cast<int32_t>(i);
+        }
+    }
+    return -1;
+}
+
+void AnimationStateMachine::reserveTracks(const Animation* clip) {
+    trackScratch_.resize(std::max(trackScratch_.size(), clip->compiled_.size()));
+    laneScratch_.resize(std::max(laneScratch_.size(), clip->compiled_.laneScratchSize()));
+}
+
+float AnimationStateMachine::clipDuration(const Animation* clip) {
+    return clip->end > clip->start ? clip->end - clip->start : 0.0f;
+}
+
+bool AnimationStateMachine::addState(const State& state) {
+    if (state.samples.empty() || state.samples.size() > MAX_BLEND_CLIPS) {
+        std::cout << "animation state " << state.name << " needs 1 to " << MAX_BLEND_CLIPS << " clips" << std::endl;
+        return false;
+    }
+    for (const BlendSample& sample : state.samples) {
+        if (sample.clip == nullptr) {
+            std::cout << "animation state " << state.name << " has a missing clip" << std::endl;
+            return false;
+        }
+    }
+
+    StateData data{};
+    data.desc = state;
+    data.parameterX = state.parameterX.empty() ? -1 : parameterIndex(state.parameterX);
+    data.parameterY = state.parameterY.empty() ? -1 : parameterIndex(state.parameterY);
+    if ((state.samples.size() > 1 && data.parameterX < 0) || (!state.parameterY.empty() && data.parameterY < 0)) {
+        std::cout << "animation state " << state.name << " blends over an unknown parameter" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < state.samples.size(); i++) {
+        const BlendSample& sample = state.samples[i];
+        data.positionsX.push_back(sample.position.x);
+        data.positions.push_back(sample.position);
+        data.cursorOffsets[i] = static_cast<uint32_t>(data.cursors.size());
+        data.cursors.resize(data.cursors.size() + sample.clip->compiled_.size(), 0);
+        reserveTracks(sample.clip);
+    }
+    states_.push_back(std::move(data));
+    return true;
+}
+
+bool AnimationStateMachine::addTransition(const Transition& transition) {
+    TransitionData data{};
+    data.from = transition.from.empty() ? -1 : stateIndex(transition.from);
+    int32_t to = stateIndex(transition.to);
+    if ((!transition.from.empty() && data.from < 0) || to < 0) {
+        std::cout << "animation transition " << transition.from << " -> " << transition.to << " names an unknown state" << std::endl;
+        return false;
+    }
+    data.to = static_cast<uint32_t>(to);
+    data.duration = transition.duration;
+    data.exitTime = transition.exitTime;
+    for (const Condition& condition : transition.conditions) {
+        int32_t parameter = parameterIndex(condition.parameter);
+        if (parameter < 0) {
+            std::cout << "animation transition " << transition.from << " -> " << transition.to << " tests unknown parameter " << condition.parameter << std::endl;
+            return false;
+        }
+        data.conditions.push_back({ static_cast<uint32_t>(parameter), condition.compare, condition.value });
+    }
+    transitions_.push_back(std::move(data));
+    return true;
+}
+
+bool AnimationStateMachine::addLayer(const Layer& layer) {
+    if (layer.clip == nullptr || pHierarchy_ == nullptr) {
+        std::cout << "animation layer needs a clip and an initialised state machine" << std::endl;
+        return false;
+    }
+    reserveTracks(layer.clip);
+
+    LayerData data{};
+    data.desc = layer;
+    data.time = 0.0f;
+    data.cursors.assign(layer.clip->compiled_.size(), 0);
+    if (layer.maskRoot >= 0 && static_cast<size_t>(layer.maskRoot) < nodeCount_) {
+        data.boneWeights.resize(nodeCount_);
+        PoseBlender::subtreeMask(*pHierarchy_, static_cast<uint32_t>(layer.maskRoot), data.boneWeights.data());
+    }
+    if (layer.additive) {
+        data.reference.resize(nodeCount_ * PoseBlender::VALUES_PER_NODE);
+        PoseBlender::sampleClip(layer.clip->compiled_, layer.clip->start, data.cursors.data(), laneScratch_.data(), restPose_.data(), nodeCount_, trackScratch_.data(), data.reference.data());
+    }
+    layers_.push_back(std::move(data));
+    return true;
+}
+
+bool AnimationStateMachine::start(const std::string& state) {
+    int32_t index = stateIndex(state);
+    if (index < 0) {
+        std::cout << "unknown animation state " << state << std::endl;
+        return false;
+    }
+    current_ = index;
+    previous_ = -1;
+    states_[index].phase = 0.0f;
+    fadeElapsed_ = 0.0f;
+    fadeDuration_ = 0.0f;
+    return true;
+}
+
+const std::string& AnimationStateMachine::currentStateName() const {
+    static const std::string none;
+    return current_ >= 0 ? states_[current_].desc.name : none;
+}
+
+void AnimationStateMachine::enterState(uint32_t state, float duration) {
+    // AN INTERRUPTED CROSSFADE FADES OUT FROM THE POSE IT HAD REACHED, THE TWO STATES IT WAS BLENDING ARE DROPPED
+    if (isFading()) {
+        std::copy(pose_.begin(), pose_.end(), fadeFromPose_.begin());
+        previous_ = -1;
+    }
+    else {
+        previous_ = current_;
+    }
+    current_ = static_cast<int32_t>(state);
+    states_[state].phase = 0.0f;
+    fadeElapsed_ = 0.0f;
+    fadeDuration_ = duration;
+}
+
+void AnimationStateMachine::advanceState(StateData& state, float deltaTime) {
+    const uint32_t count = static_cast<uint32_t>(state.desc.samples.size());
+    if (count == 1) {
+        state.weights[0] = 1.0f;
+    }
+    else if (state.parameterY < 0) {
+        PoseBlender::blendSpace1D(state.positionsX.data(), count, parameters_[state.parameterX], state.weights);
+    }
+    else {
+        PoseBlender::blendSpace2D(state.positions.data(), count, glm::vec2(parameters_[state.parameterX], parameters_[state.parameterY]), state.weights);
+    }
+
+    // THE CYCLE LENGTH IS THE WEIGHTED AVERAGE OF THE SAMPLES', SO A WALK AND A RUN OF DIFFERENT LENGTHS STAY IN STEP WHILE THEY BLEND
+    float duration = 0.0f;
+    for (uint32_t i = 0; i < count; i++) {
+        duration += state.weights[i] * clipDuration(state.desc.samples[i].clip);
+    }
+    if (duration <= 0.0f) {
+        return;
+    }
+    state.phase += deltaTime * state.desc.speed / duration;
+    state.phase = state.desc.loop ? state.phase - std::floor(state.phase) : std::min(state.phase, 1.0f);
+}
+
+bool AnimationStateMachine::evaluateState(StateData& state, glm::vec4* out) {
+    glm::vec4* poses[MAX_BLEND_CLIPS];
+    float weights[MAX_BLEND_CLIPS];
+    uint32_t count = 0;
+    bool complete = true;
+    for (size_t i = 0; i < state.desc.samples.size(); i++) {
+        if (state.weights[i] < MIN_BLEND_WEIGHT) {
+            continue;
+        }
+        glm::vec4* pose = pool_.acquire();
+        if (pose == nullptr) {
+            complete = false;
+            break;
+        }
+        Animation* clip = state.desc.samples[i].clip;
+        PoseBlender::sampleClip(clip->compiled_, clip->start + state.phase * clipDuration(clip), state.cursors.data() + state.cursorOffsets[i], laneScratch_.data(), restPose_.data(), nodeCount_, trackScratch_.data(), pose);
+        poses[count] = pose;
+        weights[count] = state.weights[i];
+        count++;
+    }
+
+    complete = complete && count > 0;
+    if (complete) {
+        PoseBlender::blend(poses, weights, count, nodeCount_, out);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        pool_.release(poses[i]);
+    }
+    return complete;
+}
+
+void AnimationStateMachine::update(float deltaTime) {
+    if (current_ < 0) {
+        return;
+    }
+
+    for (const TransitionData& transition : transitions_) {
+        if (static_cast<int32_t>(transition.to) == current_ || (transition.from >= 0 && transition.from != current_)) {
+            continue;
+        }
+        if (transition.exitTime >= 0.0f && states_[current_].phase < transition.exitTime) {
+            continue;
+        }
+        bool pass = true;
+        for (const ConditionData& condition : transition.conditions) {
+            float value = parameters_[condition.parameter];
+            pass = condition.compare == Compare::GREATER ? value > condition.value : value < condition.value;
+            if (!pass) {
+                break;
+            }
+        }
+        if (pass) {
+            enterState(transition.to, transition.duration);
+            break;
+        }
+    }
+
+    bool fading = isFading();
+    advanceState(states_[current_], deltaTime);
+    if (fading && previous_ >= 0) {
+        advanceState(states_[previous_], deltaTime);
+    }
+    if (!evaluateState(states_[current_], pose_.data())) {
+        return;
+    }
+
+    if (fading) {
+        fadeElapsed_ += deltaTime;
+        float weight = std::min(fadeElapsed_ / fadeDuration_, 1.0f);
+        if (previous_ >= 0) {
+            glm::vec4* from = pool_.acquire();
+            if (from != nullptr && evaluateState(states_[previous_], from)) {
+                PoseBlender::blendMasked(from, pose_.data(), weight, nullptr, nodeCount_, pose_.data());
+            }
+            pool_.release(from);
+        }
+        else {
+            PoseBlender::blendMasked(fadeFromPose_.data(), pose_.data(), weight, nullptr, nodeCount_, pose_.data());
+        }
+    }
+
+    for (LayerData& layer : layers_) {
+        Animation* clip = layer.desc.clip;
+        float duration = clipDuration(clip);
+        if (duration > 0.0f) {
+            layer.time = std::fmod(layer.time + deltaTime, duration);
+        }
+        if (layer.desc.weight <= 0.0f) {
+            continue;
+        }
+
+        glm::vec4* layerPose = pool_.acquire();
+        if (layerPose == nullptr) {
+            break;
+        }
+        PoseBlender::sampleClip(clip->compiled_, clip->start + layer.time, layer.cursors.data(), laneScratch_.data(), restPose_.data(), nodeCount_, trackScratch_.data(), layerPose);
+        const float* mask = layer.boneWeights.empty() ? nullptr : layer.boneWeights.data();
+        if (layer.desc.additive) {
+            PoseBlender::addAdditive(pose_.data(), layerPose, layer.reference.data(), layer.desc.weight, mask, nodeCount_, pose_.data());
+        }
+        else {
+            PoseBlender::blendMasked(pose_.data(), layerPose, layer.desc.weight, mask, nodeCount_, pose_.data());
+        }
+        pool_.release(layerPose);
+    }
+
+    PoseBlender::applyPose(pose_.data(), *pHierarchy_);
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "PoseBlender.h"
+#include "PosePool.h"
+#include "Animation.h"
+#include <unordered_map>
+
+// A CHARACTER'S ANIMATION GRAPH AS DATA. STATES PLAY ONE CLIP OR A 1D/2D BLEND SPACE OVER FLOAT PARAMETERS, TRANSITIONS FIRE WHEN ALL OF THEIR
+// CONDITIONS ON THE PARAMETERS HOLD AND CROSSFADE OVER THEIR DURATION, AND LAYERS ARE BLENDED (OR ADDED) ON TOP OF THE RESULT, OPTIONALLY MASKED TO
+// ONE BRANCH OF THE SKELETON. GAMEPLAY ONLY SETS PARAMETERS. THE MACHINE KEEPS ITS OWN CLIP TIMES, SO CLIPS CAN BE SHARED BETWEEN CHARACTERS, AND IT
+// ONLY ADVANCES BY THE FRAME'S deltaTime. EVERY POSE BUFFER IT BLENDS IN COMES FROM A PosePool SIZED IN init, AND THE KEY CURSORS AND SAMPLING
+// SCRATCH ARE SIZED WHEN STATES AND LAYERS ARE ADDED, SO update NEVER ALLOCATES AND MACHINES ON DIFFERENT THREADS SHARE NOTHING BUT THE CLIPS
+class AnimationStateMachine {
+public:
+	static constexpr uint32_t MAX_BLEND_CLIPS = 8;
+	static constexpr float MIN_BLEND_WEIGHT = 0.001f; // BLEND SPACE SAMPLES BELOW THIS AREN'T SAMPLED (A SPEED EASING TOWARDS A SAMPLE NEVER QUITE GETS THERE)
+
+	enum class Compare : uint8_t {
+		GREATER,
+		LESS
+	};
+
+	struct Condition {
+		std::string parameter;
+		Compare compare;
+		float value;
+	};
+
+	struct BlendSample {
+		Animation* clip;
+		glm::vec2 position = glm::vec2(0.0f); // WHERE THE CLIP SITS IN THE BLEND SPACE, x ONLY FOR 1D
+	};
+
+	struct State {
+		std::string name;
+		std::vector<BlendSample> samples; // ONE SAMPLE PLAYS THE CLIP, MORE MAKE A BLEND SPACE OVER parameterX (AND parameterY FOR 2D)
+		std::string parameterX;
+		std::string parameterY;
+		float speed = 1.0f;
+		bool loop = true;
+	};
+
+	struct Transition {
+		std::string from; // EMPTY FOR ANY STATE
+		std::string to;
+		float duration = 0.15f; // SECONDS
+		float exitTime = -1.0f; // NORMALIZED TIME from HAS TO HAVE REACHED, NEGATIVE FOR NONE
+		std::vector<Condition> conditions;
+	};
+
+	struct Layer {
+		Animation* clip;
+		float weight = 1.0f;
+		bool additive = false; // ADDITIVE LAYERS ADD THE CLIP'S DIFFERENCE FROM ITS FIRST FRAME, OVERRIDE LAYERS BLEND TOWARDS THE CLIP
+		int32_t maskRoot = -1; // hierarchy INDEX OF THE BRANCH THE LAYER AFFECTS, -1 FOR THE WHOLE SKELETON
+	};
+
+	// CAPTURES hierarchy'S CURRENT TRS AS THE REST POSE, update WRITES THE BLENDED POSE BACK INTO IT
+	void init(NodeHierarchy& hierarchy);
+	// POINTS A COPY OF A CONFIGURED MACHINE AT ANOTHER INSTANCE OF THE SAME SKELETON, KEEPING ITS REST POSE, STATES AND PLAYBACK
+	void setHierarchy(NodeHierarchy& hierarchy) { pHierarchy_ = &hierarchy; }
+
+	uint32_t addParameter(const std::string& name, float value = 0.0f);
+	// -1 WHEN THERE IS NO PARAMETER CALLED name. CACHE IT, setParameter BY INDEX IS WHAT THE PER FRAME CODE SHOULD CALL
+	int32_t parameterIndex(const std::string& name) const;
+	void setParameter(int32_t parameter, float value);
+	float parameter(int32_t parameter) const { return parameters_[parameter]; }
+
+	// ALL RETURN false (AND SAY WHY) WHEN A NAME DOESN'T RESOLVE
+	bool addState(const State& state);
+	bool addTransition(const Transition& transition);
+	bool addLayer(const Layer& layer);
+	void setLayerWeight(uint32_t layer, float weight) { layers_[layer].desc.weight = weight; }
+
+	bool start(const std::string& state);
+	void update(float deltaTime);
+
+	const std::string& currentStateName() const;
+	bool isFading() const { return fadeElapsed_ < fadeDuration_; }
+
+private:
+	struct StateData {
+		State desc;
+		int32_t parameterX;
+		int32_t parameterY;
+		std::vector<float> positionsX;
+		std::vector<glm::vec2> positions;
+		float weights[MAX_BLEND_CLIPS];
+		float phase; // NORMALIZED, EVERY SAMPLE OF A BLEND SPACE PLAYS AT THE SAME PHASE SO THEIR STEPS LINE UP
+		std::vector<uint32_t> cursors; // EVERY SAMPLE'S KEY CURSORS, SAMPLE i'S START AT cursorOffsets[i]
+		uint32_t cursorOffsets[MAX_BLEND_CLIPS];
+	};
+
+	struct ConditionData {
+		uint32_t parameter;
+		Compare compare;
+		float value;
+	};
+
+	struct TransitionData {
+		int32_t from;
+		uint32_t to;
+		float duration;
+		float exitTime;
+		std::vector<ConditionData> conditions;
+	};
+
+	struct LayerData {
+		Layer desc;
+		float time;
+		std::vector<float> boneWeights; // EMPTY WITHOUT A MASK
+		std::vector<glm::vec4> reference; // THE CLIP'S FIRST FRAME, WHAT AN ADDITIVE LAYER IS RELATIVE TO
+		std::vector<uint32_t> cursors;
+	};
+
+	NodeHierarchy* pHierarchy_ = nullptr;
+	size_t nodeCount_ = 0;
+	std::vector<glm::vec4> restPose_;
+	std::vector<glm::vec4> pose_; // THE LAST BLENDED POSE
+	std::vector<glm::vec4> fadeFromPose_; // THE POSE AN INTERRUPTED CROSSFADE HAD REACHED, FADED OUT FROM INSTEAD OF A STATE
+	std::vector<glm::vec4> trackScratch_; // ONE VALUE PER TRACK OF THE LARGEST CLIP
+	std::vector<float> laneScratch_; // CompiledAnimation::laneScratchSize OF THE LARGEST CLIP
+	PosePool pool_;
+
+	std::vector<float> parameters_;
+	std::unordered_map<std::string, uint32_t> parameterNames_;
+	std::vector<StateData> states_;
+	std::vector<TransitionData> transitions_;
+	std::vector<LayerData> layers_;
+
+	int32_t current_ = -1;
+	int32_t previous_ = -1; // -1 WHILE FADING FROM fadeFromPose_
+	float fadeElapsed_ = 0.0f;
+	float fadeDuration_ = 0.0f;
+
+	int32_t stateIndex(const std::string& name) const;
+	void reserveTracks(const Animation* clip);
+	void enterState(uint32_t state, float duration);
+	void advanceState(StateData& state, float deltaTime);
+	// false WHEN THE POOL RAN OUT, out IS THEN LEFT AS IT WAS
+	bool evaluateState(StateData& state, glm::vec4* out);
+	static float clipDuration(const Animation* clip);
+};
@@ -0,0 +1,261 @@
+#include "BindlessMaterials.h"
+
+constexpr uint32_t MATERIAL_BUFFER_BINDING = 0;
+constexpr uint32_t DRAW_MATERIAL_BINDING = 1;
+constexpr uint32_t TEXTURE_ARRAY_BINDING = 2;
+// SAME NUMBERS AS IN THE PER MATERIAL SET SO shader.frag DECLARES THEM ONCE FOR BOTH PATHS
+constexpr uint32_t FIRST_ENVIRONMENT_BINDING = 5;
+constexpr uint32_t ENVIRONMENT_BINDINGS = 4;
+
+bool BindlessMaterials::supported(VkPhysicalDevice gpu, bool descriptorIndexingEnabled, uint32_t numMaterials) {
+    if (!descriptorIndexingEnabled || numMaterials == 0) {
+        return false;
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(gpu, &properties);
+
+    uint32_t samplers = numMaterials * TEXTURES_PER_MATERIAL + ENVIRONMENT_BINDINGS;
+    return samplers <= properties.limits.maxPerStageDescriptorSamplers && samplers <= properties.limits.maxDescriptorSetSamplers && samplers + 2 <= properties.limits.maxPerStageResources;
+}
+
+BindlessMaterials::BindlessMaterials(DeviceHelper* devHelper, int maxFramesInFlight, const std::vector<Material*>& materials) {
+    this->pDevHelper_ = devHelper;
+    this->maxFramesInFlight_ = maxFramesInFlight;
+    this->materials_ = materials;
+
+    for (uint32_t i = 0; i < materials_.size(); i++) {
+        materials_[i]->bindlessIndex = i;
+        sourceSets_.push_back(materials_[i]->descriptorSet);
+    }
+
+    createLayout();
+    createMaterialBuffer();
+
+    // A STREAMING SWAP RETIRES THE CURRENT SET FOR maxFramesInFlight + 1 FRAMES AND AT MOST ONE SWAP HAPPENS PER FRAME
+    uint32_t maxSets = 2 * maxFramesInFlight + 2;
+    uint32_t samplers = static_cast<uint32_t>(materials_.size()) * TEXTURES_PER_MATERIAL + ENVIRONMENT_BINDINGS;
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[0].descriptorCount = 2 * maxSets;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[1].descriptorCount = samplers * maxSets;
+
+    VkDescriptorPoolCreateInfo poolCInfo{};
+    poolCInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolCInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    poolCInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolCInfo.pPoolSizes = poolSizes.data();
+    poolCInfo.maxSets = maxSets;
+
+    if (vkCreateDescriptorPool(pDevHelper_->device_, &poolCInfo, nullptr, &descriptorPool_) != VK_SUCCESS) {
+        std::_Xruntime_error("Failed to create the bindless material descriptor pool!");
+    }
+
+    set_ = allocateSet();
+
+    VkDescriptorBufferInfo materialBufferInfo{ materialBuffer_, 0, VK_WHOLE_SIZE };
+    VkWriteDescriptorSet materialWrite{};
+    materialWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    materialWrite.dstSet = set_;
+    materialWrite.dstBinding = MATERIAL_BUFFER_BINDING;
+    materialWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    materialWrite.descriptorCount = 1;
+    materialWrite.pBufferInfo = &materialBufferInfo;
+    vkUpdateDescriptorSets(pDevHelper_->device_, 1, &materialWrite, 0, nullptr);
+
+    // BRDF LUT, IRRADIANCE, PREFILTERED MAP AND SHADOW MAP ARE THE SAME IN EVERY MATERIAL SET
+    std::array<VkCopyDescriptorSet, ENVIRONMENT_BINDINGS> copies{};
+    for (uint32_t i = 0; i < ENVIRONMENT_BINDINGS; i++) {
+        copies[i].sType = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET;
+        copies[i].srcSet = materials_[0]->descriptorSet;
+        copies[i].srcBinding = FIRST_ENVIRONMENT_BINDING + i;
+        copies[i].dstSet = set_;
+        copies[i].dstBinding = FIRST_ENVIRONMENT_BINDING + i;
+        copies[i].descriptorCount = 1;
+    }
+    vkUpdateDescriptorSets(pDevHelper_->device_, 0, nullptr, static_cast<uint32_t>(copies.size()), copies.data());
+
+    for (uint32_t i = 0; i < materials_.size(); i++) {
+        copyMaterialTextures(set_, i);
+    }
+}
+
+BindlessMaterials::~BindlessMaterials() {
+    vkDestroyDescriptorPool(pDevHelper_->device_, descriptorPool_, nullptr);
+    vkDestroyDescriptorSetLayout(pDevHelper_->device_, layout_, nullptr);
+    vkDestroyBuffer(pDevHelper_->device_, materialBuffer_, nullptr);
+    vkFreeMemory(pDevHelper_->device_, materialBufferMemory_, nullptr);
+    if (drawMaterialBuffer_ != VK_NULL_HANDLE) {
+        vkDestroyBuffer(pDevHelper_->device_, drawMaterialBuffer_, nullptr);
+        vkFreeMemory(pDevHelper_->device_, drawMaterialBufferMemory_, nullptr);
+    }
+}
+
+void BindlessMaterials::createLayout() {
+    std::array<VkDescriptorSetLayoutBinding, 3 + ENVIRONMENT_BINDINGS> bindings{};
+    bindings[0].binding = MATERIAL_BUFFER_BINDING;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    bindings[1].binding = DRAW_MATERIAL_BINDING;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    bindings[2].binding = TEXTURE_ARRAY_BINDING;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[2].descriptorCount = static_cast<uint32_t>(materials_.size()) * TEXTURES_PER_MATERIAL;
+    bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    for (uint32_t i = 0; i < ENVIRONMENT_BINDINGS; i++) {
+        bindings[3 + i].binding = FIRST_ENVIRONMENT_BINDING + i;
+        bindings[3 + i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[3 + i].descriptorCount = 1;
+        bindings[3 + i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutCInfo{};
+    layoutCInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutCInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutCInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(pDevHelper_->device_, &layoutCInfo, nullptr, &layout_) != VK_SUCCESS) {
+        std::_Xruntime_error("Failed to create the bindless material set layout!");
+    }
+}
+
+void BindlessMaterials::createMaterialBuffer() {
+    std::vector<GPUMaterial> gpuMaterials(materials_.size());
+    for (uint32_t i = 0; i < materials_.size(); i++) {
+        GPUMaterial& gpuMaterial = gpuMaterials[i];
+        for (uint32_t t = 0; t < TEXTURES_PER_MATERIAL; t++) {
+            gpuMaterial.textures[t] = i * TEXTURES_PER_MATERIAL + t;
+        }
+    }
+    uploadBuffer(gpuMaterials.data(), sizeof(GPUMaterial) * gpuMaterials.size(), materialBuffer_, materialBufferMemory_);
+}
+
+void BindlessMaterials::setDrawMaterials(const std::vector<uint32_t>& drawMaterials) {
+    // AN EMPTY SCENE STILL NEEDS SOMETHING BOUND AT THE BINDING
+    std::vector<uint32_t> data = drawMaterials.empty() ? std::vector<uint32_t>(1, 0) : drawMaterials;
+    uploadBuffer(data.data(), sizeof(uint32_t) * data.size(), drawMaterialBuffer_, drawMaterialBufferMemory_);
+
+    VkDescriptorBufferInfo drawMaterialBufferInfo{ drawMaterialBuffer_, 0, VK_WHOLE_SIZE };
+    VkWriteDescriptorSet drawMaterialWrite{};
+    drawMaterialWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    drawMaterialWrite.dstSet = set_;
+    drawMaterialWrite.dstBinding = DRAW_MATERIAL_BINDING;
+    drawMaterialWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    drawMaterialWrite.descriptorCount = 1;
+    drawMaterialWrite.pBufferInfo = &drawMaterialBufferInfo;
+    vkUpdateDescriptorSets(pDevHelper_->device_, 1, &drawMaterialWrite, 0, nullptr);
+}
+
+// SAME COPY ON WRITE AS TextureStreamer::patchMaterials - THE CURRENT SET IS COPIED INTO A NEW ONE, THE CHANGED MATERIALS' SLOTS ARE RECOPIED FROM
+// THEIR NEW MATERIAL SETS AND THE OLD SET IS FREED ONCE NO FRAME IN FLIGHT CAN STILL BE USING IT
+void BindlessMaterials::update(uint64_t frameNumber) {
+    for (size_t i = 0; i < retiredSets_.size();) {
+        if (retiredSets_[i].freeAfterFrame <= frameNumber) {
+            vkFreeDescriptorSets(pDevHelper_->device_, descriptorPool_, 1, &retiredSets_[i].set);
+            retiredSets_[i] = retiredSets_.back();
+            retiredSets_.pop_back();
+        }
+        else {
+            i++;
+        }
+    }
+
+    std::vector<uint32_t> changed;
+    for (uint32_t i = 0; i < materials_.size(); i++) {
+        if (materials_[i]->descriptorSet != sourceSets_[i]) {
+            changed.push_back(i);
+        }
+    }
+    if (changed.empty()) {
+        return;
+    }
+
+    VkDescriptorSet newSet = allocateSet();
+    if (newSet == VK_NULL_HANDLE) {
+        return;
+    }
+
+    std::vector<VkCopyDescriptorSet> copies;
+    auto copyBinding = [&](uint32_t binding, uint32_t count) {
+        VkCopyDescriptorSet copy{};
+        copy.sType = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET;
+        copy.srcSet = set_;
+        copy.srcBinding = binding;
+        copy.dstSet = newSet;
+        copy.dstBinding = binding;
+        copy.descriptorCount = count;
+        copies.push_back(copy);
+    };
+    copyBinding(MATERIAL_BUFFER_BINDING, 1);
+    if (drawMaterialBuffer_ != VK_NULL_HANDLE) {
+        copyBinding(DRAW_MATERIAL_BINDING, 1);
+    }
+    copyBinding(TEXTURE_ARRAY_BINDING, static_cast<uint32_t>(materials_.size()) * TEXTURES_PER_MATERIAL);
+    for (uint32_t i = 0; i < ENVIRONMENT_BINDINGS; i++) {
+        copyBinding(FIRST_ENVIRONMENT_BINDING + i, 1);
+    }
+    vkUpdateDescriptorSets(pDevHelper_->device_, 0, nullptr, static_cast<uint32_t>(copies.size()), copies.data());
+
+    for (uint32_t i : changed) {
+        copyMaterialTextures(newSet, i);
+        sourceSets_[i] = materials_[i]->descriptorSet;
+    }
+
+    retiredSets_.push_back(RetiredSet{ set_, frameNumber + maxFramesInFlight_ + 1 });
+    set_ = newSet;
+}
+
+VkDescriptorSet BindlessMaterials::allocateSet() {
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = descriptorPool_;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &layout_;
+
+    VkDescriptorSet set;
+    if (vkAllocateDescriptorSets(pDevHelper_->device_, &allocateInfo, &set) != VK_SUCCESS) {
+        std::cout << "could not allocate a bindless material set" << std::endl;
+        return VK_NULL_HANDLE;
+    }
+    return set;
+}
+
+// BINDINGS 0-4 OF THE MATERIAL'S OWN SET ARE ITS COLOR, NORMAL, METALLIC ROUGHNESS, AO AND EMISSION TEXTURES
+void BindlessMaterials::copyMaterialTextures(VkDescriptorSet dstSet, uint32_t materialIndex) {
+    std::array<VkCopyDescriptorSet, TEXTURES_PER_MATERIAL> copies{};
+    for (uint32_t i = 0; i < TEXTURES_PER_MATERIAL; i++) {
+        copies[i].sType = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET;
+        copies[i].srcSet = materials_[materialIndex]->descriptorSet;
+        copies[i].srcBinding = i;
+        copies[i].dstSet = dstSet;
+        copies[i].dstBinding = TEXTURE_ARRAY_BINDING;
+        copies[i].dstArrayElement = materialIndex * TEXTURES_PER_MATERIAL + i;
+        copies[i].descriptorCount = 1;
+    }
+    vkUpdateDescriptorSets(pDevHelper_->device_, 0, nullptr, static_cast<uint32_t>(copies.size()), copies.data());
+}
+
+void BindlessMaterials::uploadBuffer(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory) {
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    pDevHelper_->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+    void* mapped;
+    vkMapMemory(pDevHelper_->device_, stagingBufferMemory, 0, size, 0, &mapped);
+    memcpy(mapped, data, static_cast<size_t>(size));
+    vkUnmapMemory(pDevHelper_->device_, stagingBufferMemory);
+
+    pDevHelper_->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, memory);
+    pDevHelper_->copyBuffer(stagingBuffer, buffer, size);
+
+    vkDestroyBuffer(pDevHelper_->device_, stagingBuffer, nullptr);
+    vkFreeMemory(pDevHelper_->device_, stagingBufferMemory, nullptr);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "MeshHelper.h"
+
+// ONE DESCRIPTOR SET FOR EVERY STATIC MATERIAL IN THE SCENE. THE FIVE MATERIAL TEXTURES OF MATERIAL m SIT AT textures[m * 5 + binding] OF ONE
+// DESCRIPTOR INDEXED ARRAY, THE MATERIAL BUFFER HOLDS THOSE SLOTS, AND THE DRAW MATERIAL BUFFER MAPS A DRAW'S firstInstance TO ITS
+// MATERIAL. THE COLOR PASS BINDS THE SET ONCE INSTEAD OF ONCE PER BATCH. THE SLOTS ARE COPIED OUT OF THE PER MATERIAL SETS, SO WHEN THE TEXTURE
+// STREAMER SWAPS A MATERIAL'S SET THE CHANGE IS PICKED UP BY update AND COPIED INTO A FRESH BINDLESS SET (THE OLD ONE MAY STILL BE IN FLIGHT)
+class BindlessMaterials {
+public:
+	static constexpr uint32_t TEXTURES_PER_MATERIAL = 5;
+
+	// MATCHES THE std430 Material STRUCT IN shader.frag. ONLY THE TEXTURE SLOTS, THE PER SET SHADER DOESN'T APPLY THE FACTORS EITHER AND
+	// doubleSides IS THE PIPELINE'S CULL MODE
+	struct GPUMaterial {
+		uint32_t textures[TEXTURES_PER_MATERIAL];
+	};
+
+	VkDescriptorSetLayout layout_;
+	VkDescriptorSet set_; // THE CURRENT SET, BIND THIS ONE
+
+	// DESCRIPTOR INDEXING HAS TO BE ENABLED ON THE DEVICE AND THE ARRAY HAS TO FIT THE PER STAGE / PER SET SAMPLER LIMITS
+	static bool supported(VkPhysicalDevice gpu, bool descriptorIndexingEnabled, uint32_t numMaterials);
+
+	// EVERY MATERIAL'S descriptorSet HAS TO BE WRITTEN ALREADY (INCLUDING THE GENERATED ENVIRONMENT IMAGES AT BINDINGS 5-8)
+	BindlessMaterials(DeviceHelper* devHelper, int maxFramesInFlight, const std::vector<Material*>& materials);
+	~BindlessMaterials();
+
+	// INDEXED BY firstInstance, CALLED ONCE THE DRAW COMMANDS ARE BUILT
+	void setDrawMaterials(const std::vector<uint32_t>& drawMaterials);
+
+	// CALLED ONCE PER FRAME AFTER THE TEXTURE STREAMER'S UPDATE
+	void update(uint64_t frameNumber);
+
+private:
+	struct RetiredSet {
+		VkDescriptorSet set;
+		uint64_t freeAfterFrame;
+	};
+
+	DeviceHelper* pDevHelper_;
+	int maxFramesInFlight_;
+	VkDescriptorPool descriptorPool_;
+
+	std::vector<Material*> materials_;
+	std::vector<VkDescriptorSet> sourceSets_; // THE MATERIAL SETS THE SLOTS WERE LAST COPIED FROM
+	std::vector<RetiredSet> retiredSets_;
+
+	VkBuffer materialBuffer_;
+	VkDeviceMemory materialBufferMemory_;
+	VkBuffer drawMaterialBuffer_ = VK_NULL_HANDLE;
+	VkDeviceMemory drawMaterialBufferMemory_ = VK_NULL_HANDLE;
+
+	void createLayout();
+	void createMaterialBuffer();
+	VkDescriptorSet allocateSet();
+	void copyMaterialTextures(VkDescriptorSet dstSet, uint32_t materialIndex);
+	void uploadBuffer(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory);
+};
@@ -0,0 +1,248 @@
+#include "ClipCompressor.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <glm/gtc/quaternion.hpp>
+
+template<typename T>
+static void writeArray(std::ofstream& file, const T* data, size_t count) {
+    if (count > 0) {
+        file.write(reinterpret_cast<const char*>(data), sizeof(T) * count);
+    }
+}
+
+template<typename T>
+static bool readArray(const char*& cursor, const char* end, T* data, size_t count) {
+    size_t byteSize = sizeof(T) * count;
+    if (static_cast<size_t>(end - cursor) < byteSize) {
+        return false;
+    }
+    if (count > 0) {
+        memcpy(data, cursor, byteSize);
+    }
+    cursor += byteSize;
+    return true;
+}
+
+std::string ClipCompressor::clipPath(const std::string& gltfPath, uint32_t clipIndex) {
+    return clipIndex == 0 ? gltfPath + ".orchidclip" : gltfPath + "." + std::to_string(clipIndex) + ".orchidclip";
+}
+
+// A .glb IS SELF CONTAINED, SO UNLIKE ModelCache::hashSource THE SIBLINGS (WHICH INCLUDE THE OTHER CLIPS' FILES) STAY OUT OF THE HASH
+uint64_t ClipCompressor::hashSource(const std::string& gltfPath) {
+    std::ifstream file(gltfPath, std::ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    // STREAMED, SO HASHING A LARGE .glb DOESN'T HOLD ALL OF IT IN MEMORY
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    std::vector<char> block(1 << 16);
+    while (file.read(block.data(), block.size()) || file.gcount() > 0) {
+        size_t count = static_cast<size_t>(file.gcount());
+        for (size_t i = 0; i < count; i++) {
+            hash ^= static_cast<uint8_t>(block[i]);
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+// q AND -q ARE THE SAME ROTATION, b IS COMPARED IN a'S HEMISPHERE. PICKING THE SIGN PER COMPONENT WOULD HIDE A FLIPPED LARGEST COMPONENT
+static float valueError(const glm::vec4& a, const glm::vec4& b, bool rotation) {
+    const glm::vec4 difference = glm::abs(a - (rotation && glm::dot(a, b) < 0.0f ? -b : b));
+    return std::max(std::max(difference.x, difference.y), std::max(difference.z, difference.w));
+}
+
+static glm::vec4 interpolate(const glm::vec4& a, const glm::vec4& b, float t, bool rotation) {
+    if (!rotation) {
+        return glm::mix(a, b, t);
+    }
+    glm::quat q = glm::normalize(glm::slerp(glm::quat(a.w, a.x, a.y, a.z), glm::quat(b.w, b.x, b.y, b.z), t));
+    return glm::vec4(q.x, q.y, q.z, q.w);
+}
+
+CompiledAnimation ClipCompressor::compress(const CompiledAnimation& source, const Settings& settings) {
+    CompiledAnimation clip;
+
+    for (const CompiledAnimation::Track& track : source.tracks_) {
+        const float* times = source.keyTimes_.data() + track.firstKey;
+        if (track.interpolation == CompiledAnimation::Interpolation::CUBICSPLINE || track.quantized) {
+            clip.addTrack(track.path, track.interpolation, track.node, times, source.keyValues_.data() + track.firstValue, track.keyCount);
+            continue;
+        }
+
+        const bool rotation = track.path == CompiledAnimation::Path::ROTATION;
+        const float tolerance = rotation ? settings.rotationError : (track.path == CompiledAnimation::Path::TRANSLATION ? settings.translationError : settings.scaleError);
+
+        std::vector<glm::vec4> values(track.keyCount);
+        glm::vec3 rangeMin(std::numeric_limits<float>::max());
+        glm::vec3 rangeMax(-std::numeric_limits<float>::max());
+        for (uint32_t k = 0; k < track.keyCount; k++) {
+            values[k] = source.keyValue(track, k);
+            rangeMin = glm::min(rangeMin, glm::vec3(values[k]));
+            rangeMax = glm::max(rangeMax, glm::vec3(values[k]));
+        }
+        const glm::vec3 rangeExtent = rangeMax - rangeMin;
+
+        // THE ERROR IS CHECKED ON THE DECODED KEYS SO THE QUANTIZATION IS PART OF THE BOUND
+        std::vector<uint16_t> packed(track.keyCount * 3);
+        std::vector<glm::vec4> decoded(track.keyCount);
+        for (uint32_t k = 0; k < track.keyCount; k++) {
+            if (rotation) {
+                CompiledAnimation::packRotation(values[k], packed.data() + k * 3);
+                decoded[k] = CompiledAnimation::unpackRotation(packed.data() + k * 3);
+            }
+            else {
+                CompiledAnimation::packVector(values[k], rangeMin, rangeExtent, packed.data() + k * 3);
+                decoded[k] = CompiledAnimation::unpackVector(packed.data() + k * 3, rangeMin, rangeExtent);
+            }
+        }
+
+        // GREEDY: EXTEND THE SEGMENT FROM THE LAST KEPT KEY UNTIL SOME KEY IN BETWEEN FALLS OUTSIDE THE TOLERANCE, THEN KEEP THE KEY BEFORE THE FAILURE.
+        // A STEP TRACK ONLY DROPS KEYS THAT HOLD THE SAME VALUE AS THE KEY BEFORE THEM
+        std::vector<uint32_t> kept = { 0 };
+        uint32_t anchor = 0;
+        for (uint32_t end = anchor + 2; end < track.keyCount; end++) {
+            bool fits = true;
+            for (uint32_t i = anchor + 1; i < end && fits; i++) {
+                glm::vec4 predicted = decoded[anchor];
+                if (track.interpolation == CompiledAnimation::Interpolation::LINEAR) {
+                    predicted = interpolate(decoded[anchor], decoded[end], (times[i] - times[anchor]) / (times[end] - times[anchor]), rotation);
+                }
+                fits = valueError(predicted, values[i], rotation) <= tolerance;
+            }
+            if (!fits) {
+                anchor = end - 1;
+                kept.push_back(anchor);
+            }
+        }
+        if (track.keyCount > 1) {
+            kept.push_back(track.keyCount - 1);
+        }
+        // A CONSTANT TRACK NEEDS ONE KEY
+        if (kept.size() == 2 && valueError(decoded[kept[0]], values[kept[1]], rotation) <= tolerance) {
+            bool constant = true;
+            for (uint32_t k = 0; k < track.keyCount && constant; k++) {
+                constant = valueError(decoded[0], values[k], rotation) <= tolerance;
+            }
+            if (constant) {
+                kept.pop_back();
+            }
+        }
+
+        std::vector<float> keptTimes;
+        std::vector<uint16_t> keptPacked;
+        for (uint32_t k : kept) {
+            keptTimes.push_back(times[k]);
+            keptPacked.insert(keptPacked.end(), packed.begin() + k * 3, packed.begin() + k * 3 + 3);
+        }
+        clip.addQuantizedTrack(track.path, track.interpolation, track.node, keptTimes.data(), keptPacked.data(), static_cast<uint32_t>(kept.size()), rangeMin, rangeExtent);
+    }
+
+    clip.finalize();
+    return clip;
+}
+
+void ClipCompressor::write(const std::string& gltfPath, uint32_t clipIndex, uint64_t sourceHash, const CompiledAnimation& clip, const std::vector<uint32_t>& sourceNodes, float start, float end) {
+    Header header{};
+    header.magic = CLIP_MAGIC;
+    header.version = CLIP_VERSION;
+    header.sourceHash = sourceHash;
+    header.trackCount = static_cast<uint32_t>(clip.tracks_.size());
+    header.keyCount = static_cast<uint32_t>(clip.keyTimes_.size());
+    header.valueCount = static_cast<uint32_t>(clip.keyValues_.size());
+    header.packedCount = static_cast<uint32_t>(clip.packedKeys_.size());
+    header.start = start;
+    header.end = end;
+    header.totalSize = sizeof(Header) + header.trackCount * (sizeof(uint32_t) + sizeof(CompiledAnimation::Track)) + header.keyCount * sizeof(float)
+        + header.valueCount * sizeof(glm::vec4) + header.packedCount * sizeof(uint16_t);
+
+    std::ofstream file(clipPath(gltfPath, clipIndex), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "couldnt write animation clip: " << clipPath(gltfPath, clipIndex) << std::endl;
+        return;
+    }
+    writeArray(file, &header, 1);
+    writeArray(file, sourceNodes.data(), sourceNodes.size());
+    writeArray(file, clip.tracks_.data(), clip.tracks_.size());
+    writeArray(file, clip.keyTimes_.data(), clip.keyTimes_.size());
+    writeArray(file, clip.keyValues_.data(), clip.keyValues_.size());
+    writeArray(file, clip.packedKeys_.data(), clip.packedKeys_.size());
+}
+
+bool ClipCompressor::read(const std::string& gltfPath, uint32_t clipIndex, uint64_t sourceHash, CompiledAnimation& clip, std::vector<uint32_t>& sourceNodes, float& start, float& end) {
+    std::ifstream file(clipPath(gltfPath, clipIndex), std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    if (fileSize < sizeof(Header)) {
+        return false;
+    }
+
+    std::vector<char> blob(fileSize);
+    file.seekg(0);
+    file.read(blob.data(), fileSize);
+
+    Header header;
+    memcpy(&header, blob.data(), sizeof(Header));
+    if (header.magic != CLIP_MAGIC || header.version != CLIP_VERSION || header.sourceHash != sourceHash || header.totalSize != fileSize) {
+        std::cout << "animation clip out of date, rebuilding: " << clipPath(gltfPath, clipIndex) << std::endl;
+        return false;
+    }
+
+    const char* cursor = blob.data() + sizeof(Header);
+    const char* blobEnd = blob.data() + blob.size();
+    clip = CompiledAnimation();
+    sourceNodes.resize(header.trackCount);
+    clip.tracks_.resize(header.trackCount);
+    clip.keyTimes_.resize(header.keyCount);
+    clip.keyValues_.resize(header.valueCount);
+    clip.packedKeys_.resize(header.packedCount);
+    if (!readArray(cursor, blobEnd, sourceNodes.data(), sourceNodes.size()) || !readArray(cursor, blobEnd, clip.tracks_.data(), clip.tracks_.size())
+        || !readArray(cursor, blobEnd, clip.keyTimes_.data(), clip.keyTimes_.size()) || !readArray(cursor, blobEnd, clip.keyValues_.data(), clip.keyValues_.size())
+        || !readArray(cursor, blobEnd, clip.packedKeys_.data(), clip.packedKeys_.size())) {
+        return false;
+    }
+
+    start = header.start;
+    end = header.end;
+    return true;
+}
+
+ClipCompressor::Report ClipCompressor::evaluate(CompiledAnimation& source, CompiledAnimation& compressed, const NodeHierarchy* hierarchy, float end, size_t frames) {
+    Report report{};
+    report.tracks = source.size();
+    report.sourceKeys = source.keyTimes_.size();
+    report.keptKeys = compressed.keyTimes_.size();
+    report.sourceBytes = source.memorySize();
+    report.compressedBytes = compressed.memorySize();
+
+    std::vector<glm::vec4> sourcePose(source.size());
+    std::vector<glm::vec4> compressedPose(compressed.size());
+    NodeHierarchy sourceHierarchy = hierarchy ? *hierarchy : NodeHierarchy();
+    NodeHierarchy compressedHierarchy = sourceHierarchy;
+
+    for (size_t frame = 0; frame <= frames; frame++) {
+        float time = end * static_cast<float>(frame) / static_cast<float>(frames);
+        source.sample(time, sourcePose.data());
+        compressed.sample(time, compressedPose.data());
+        for (size_t t = 0; t < source.size(); t++) {
+            report.maxTrackError = std::max(report.maxTrackError, valueError(sourcePose[t], compressedPose[t], source.tracks_[t].path == CompiledAnimation::Path::ROTATION));
+        }
+
+        if (hierarchy) {
+            source.writePose(sourcePose.data(), sourceHierarchy);
+            compressed.writePose(compressedPose.data(), compressedHierarchy);
+            sourceHierarchy.updateWorldMatrices();
+            compressedHierarchy.updateWorldMatrices();
+            for (size_t n = 0; n < sourceHierarchy.size(); n++) {
+                report.maxPoseError = std::max(report.maxPoseError, glm::length(glm::vec3(sourceHierarchy.worldMatrices_[n][3] - compressedHierarchy.worldMatrices_[n][3])));
+            }
+        }
+    }
+    return report;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CompiledAnimation.h"
+
+// COMPRESSED ANIMATION CLIPS. compress DROPS EVERY KEY THE NEIGHBOURING KEPT KEYS ALREADY INTERPOLATE TO WITHIN THE SETTINGS' ERROR, STORES ROTATIONS AS
+// SMALLEST THREE (48 BITS) AND TRANSLATIONS/SCALES AS 16 BITS PER COMPONENT OVER THE TRACK'S OWN RANGE. THE RESULT IS STILL A CompiledAnimation, ITS
+// SAMPLER DECODES THE PACKED KEYS IN THE GATHER, AND write/read KEEP IT NEXT TO THE SOURCE SO A LATER RUN SKIPS PARSING THE .glb
+class ClipCompressor {
+public:
+	static constexpr uint32_t CLIP_MAGIC = 0x4C43524F; // "ORCL"
+	static constexpr uint32_t CLIP_VERSION = 1;
+
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceHash;
+		uint64_t totalSize;
+		uint32_t trackCount;
+		uint32_t keyCount;
+		uint32_t valueCount;
+		uint32_t packedCount;
+		float start;
+		float end;
+	};
+
+	// ERRORS ARE IN THE TRACK'S OWN UNITS: QUATERNION COMPONENTS FOR ROTATIONS, THE RIG'S LOCAL UNITS FOR TRANSLATIONS (CENTIMETRES FOR MIXAMO RIGS)
+	struct Settings {
+		float rotationError = 0.0002f;
+		float translationError = 0.005f;
+		float scaleError = 0.0002f;
+	};
+
+	struct Report {
+		size_t tracks = 0;
+		size_t sourceKeys = 0;
+		size_t keptKeys = 0;
+		size_t sourceBytes = 0;
+		size_t compressedBytes = 0;
+		float maxTrackError = 0.0f;
+		float maxPoseError = 0.0f;
+	};
+
+	// ONE FILE PER CLIP OF THE SOURCE, <gltf>.orchidclip FOR THE FIRST AND <gltf>.<clipIndex>.orchidclip FOR THE REST
+	static std::string clipPath(const std::string& gltfPath, uint32_t clipIndex);
+	static uint64_t hashSource(const std::string& gltfPath);
+
+	// CUBICSPLINE TRACKS ARE COPIED UNCOMPRESSED, THEIR TANGENTS DON'T SURVIVE DROPPING KEYS
+	static CompiledAnimation compress(const CompiledAnimation& source, const Settings& settings);
+
+	// sourceNodes HOLDS THE glTF NODE EACH TRACK TARGETS, THE HIERARCHY INDICES IN clip ARE ONLY VALID FOR THE MODEL THEY WERE RESOLVED AGAINST
+	static void write(const std::string& gltfPath, uint32_t clipIndex, uint64_t sourceHash, const CompiledAnimation& clip, const std::vector<uint32_t>& sourceNodes, float start, float end);
+	static bool read(const std::string& gltfPath, uint32_t clipIndex, uint64_t sourceHash, CompiledAnimation& clip, std::vector<uint32_t>& sourceNodes, float& start, float& end);
+
+	// SAMPLES BOTH CLIPS frames TIMES OVER [0, end]. maxTrackError IS THE LARGEST DECODED COMPONENT DIFFERENCE, maxPoseError THE LARGEST WORLD SPACE
+	// NODE POSITION DIFFERENCE WHEN THE POSES ARE APPLIED TO hierarchy (SKIPPED WHEN IT IS nullptr). NOT CALLED AT LOAD, SandBoxTests CHECKS THE BOUND
+	static Report evaluate(CompiledAnimation& source, CompiledAnimation& compressed, const NodeHierarchy* hierarchy, float end, size_t frames);
+};
@@ -0,0 +1,427 @@
+#include "CompiledAnimation.h"
+#include <algorithm>
+#include <glm/gtc/quaternion.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ANIMATION_SSE 1
+#include <emmintrin.h>
+#endif
+
+bool CompiledAnimation::parsePath(const std::string& path, Path& out) {
+    if (path == "translation") {
+        out = Path::TRANSLATION;
+        return true;
+    }
+    if (path == "rotation") {
+        out = Path::ROTATION;
+        return true;
+    }
+    if (path == "scale") {
+        out = Path::SCALE;
+        return true;
+    }
+    return false;
+}
+
+bool CompiledAnimation::parseInterpolation(const std::string& interpolation, Interpolation& out) {
+    if (interpolation == "LINEAR" || interpolation.empty()) {
+        out = Interpolation::LINEAR;
+        return true;
+    }
+    if (interpolation == "STEP") {
+        out = Interpolation::STEP;
+        return true;
+    }
+    if (interpolation == "CUBICSPLINE") {
+        out = Interpolation::CUBICSPLINE;
+        return true;
+    }
+    return false;
+}
+
+void CompiledAnimation::addTrack(Path path, Interpolation interpolation, uint32_t node, const float* times, const glm::vec4* values, uint32_t keyCount) {
+    Track track{ path, interpolation, node, static_cast<uint32_t>(keyTimes_.size()), keyCount, static_cast<uint32_t>(keyValues_.size()), 0, glm::vec3(0.0f), glm::vec3(0.0f) };
+    keyTimes_.insert(keyTimes_.end(), times, times + keyCount);
+    keyValues_.insert(keyValues_.end(), values, values + (interpolation == Interpolation::CUBICSPLINE ? keyCount * 3 : keyCount));
+    tracks_.push_back(track);
+}
+
+void CompiledAnimation::addQuantizedTrack(Path path, Interpolation interpolation, uint32_t node, const float* times, const uint16_t* packed, uint32_t keyCount, const glm::vec3& rangeMin, const glm::vec3& rangeExtent) {
+    Track track{ path, interpolation, node, static_cast<uint32_t>(keyTimes_.size()), keyCount, static_cast<uint32_t>(packedKeys_.size() / 3), 1, rangeMin, rangeExtent };
+    keyTimes_.insert(keyTimes_.end(), times, times + keyCount);
+    packedKeys_.insert(packedKeys_.end(), packed, packed + keyCount * 3);
+    tracks_.push_back(track);
+}
+
+glm::vec4 CompiledAnimation::keyValue(const Track& track, uint32_t key) const {
+    if (!track.quantized) {
+        return keyValues_[track.firstValue + key];
+    }
+    const uint16_t* packed = packedKeys_.data() + (track.firstValue + key) * 3;
+    return track.path == Path::ROTATION ? unpackRotation(packed) : unpackVector(packed, track.rangeMin, track.rangeExtent);
+}
+
+size_t CompiledAnimation::memorySize() const {
+    return tracks_.size() * sizeof(Track) + keyTimes_.size() * sizeof(float) + keyValues_.size() * sizeof(glm::vec4) + packedKeys_.size() * sizeof(uint16_t);
+}
+
+static constexpr float ROTATION_RANGE = 0.70710678f; // NO COMPONENT BUT THE LARGEST CAN EXCEED 1 / sqrt(2)
+static constexpr uint32_t ROTATION_MAX = (1u << 15) - 1;
+
+void CompiledAnimation::packRotation(const glm::vec4& rotation, uint16_t* packed) {
+    glm::vec4 q = glm::normalize(rotation);
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; i++) {
+        if (std::abs(q[i]) > std::abs(q[largest])) {
+            largest = i;
+        }
+    }
+    // q AND -q ARE THE SAME ROTATION, MAKING THE DROPPED COMPONENT POSITIVE SAVES ITS SIGN
+    if (q[largest] < 0.0f) {
+        q = -q;
+    }
+
+    uint64_t bits = largest;
+    for (uint32_t i = 0; i < 4; i++) {
+        if (i == largest) {
+            continue;
+        }
+        float normalized = std::clamp((q[i] / ROTATION_RANGE + 1.0f) * 0.5f, 0.0f, 1.0f);
+        bits = (bits << 15) | static_cast<uint64_t>(normalized * ROTATION_MAX + 0.5f);
+    }
+    packed[0] = static_cast<uint16_t>(bits >> 32);
+    packed[1] = static_cast<uint16_t>(bits >> 16);
+    packed[2] = static_cast<uint16_t>(bits);
+}
+
+glm::vec4 CompiledAnimation::unpackRotation(const uint16_t* packed) {
+    uint64_t bits = (static_cast<uint64_t>(packed[0]) << 32) | (static_cast<uint64_t>(packed[1]) << 16) | packed[2];
+    uint32_t largest = static_cast<uint32_t>(bits >> 45) & 3;
+
+    glm::vec4 q;
+    float sum = 0.0f;
+    int shift = 30;
+    for (uint32_t i = 0; i < 4; i++) {
+        if (i == largest) {
+            continue;
+        }
+        float normalized = static_cast<float>((bits >> shift) & ROTATION_MAX) / ROTATION_MAX;
+        q[i] = (normalized * 2.0f - 1.0f) * ROTATION_RANGE;
+        sum += q[i] * q[i];
+        shift -= 15;
+    }
+    q[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+    return q;
+}
+
+void CompiledAnimation::packVector(const glm::vec4& value, const glm::vec3& rangeMin, const glm::vec3& rangeExtent, uint16_t* packed) {
+    for (int i = 0; i < 3; i++) {
+        float normalized = rangeExtent[i] > 0.0f ? std::clamp((value[i] - rangeMin[i]) / rangeExtent[i], 0.0f, 1.0f) : 0.0f;
+        packed[i] = static_cast<uint16_t>(normalized * 65535.0f + 0.5f);
+    }
+}
+
+glm::vec4 CompiledAnimation::unpackVector(const uint16_t* packed, const glm::vec3& rangeMin, const glm::vec3& rangeExtent) {
+    return glm::vec4(rangeMin + glm::vec3(packed[0], packed[1], packed[2]) * (rangeExtent / 65535.0f), 0.0f);
+}
+
+void CompiledAnimation::finalize() {
+    groups_.clear();
+    laneTracks_.clear();
+
+    // STEP TRACKS RUN THROUGH THE LINEAR KERNEL WITH BOTH KEYS SET TO THE HELD VALUE
+    for (int rotation = 1; rotation >= 0; rotation--) {
+        for (int cubic = 0; cubic <= 1; cubic++) {
+            LaneGroup group{ rotation == 1, cubic == 1, static_cast<uint32_t>(laneTracks_.size()), 0 };
+            for (size_t i = 0; i < tracks_.size(); i++) {
+                if ((tracks_[i].path == Path::ROTATION) == group.rotation && (tracks_[i].interpolation == Interpolation::CUBICSPLINE) == group.cubic && tracks_[i].keyCount > 0) {
+                    laneTracks_.push_back(static_cast<int32_t>(i));
+                }
+            }
+            while (laneTracks_.size() % 4 != 0) {
+                laneTracks_.push_back(-1);
+            }
+            group.laneCount = static_cast<uint32_t>(laneTracks_.size()) - group.firstLane;
+            if (group.laneCount > 0) {
+                groups_.push_back(group);
+            }
+        }
+    }
+
+    laneStride_ = static_cast<uint32_t>(laneTracks_.size());
+    lanes_.assign(laneScratchSize(), 0.0f);
+    cursors_.assign(tracks_.size(), 0);
+}
+
+void CompiledAnimation::sample(float time, glm::vec4* pose, uint32_t* cursors, float* laneScratch) const {
+    float* a[4] = { lane(laneScratch, 0, 0), lane(laneScratch, 0, 1), lane(laneScratch, 0, 2), lane(laneScratch, 0, 3) };
+    float* b[4] = { lane(laneScratch, 1, 0), lane(laneScratch, 1, 1), lane(laneScratch, 1, 2), lane(laneScratch, 1, 3) };
+    float* c[4] = { lane(laneScratch, 2, 0), lane(laneScratch, 2, 1), lane(laneScratch, 2, 2), lane(laneScratch, 2, 3) };
+    float* d[4] = { lane(laneScratch, 3, 0), lane(laneScratch, 3, 1), lane(laneScratch, 3, 2), lane(laneScratch, 3, 3) };
+    float* laneT = this->laneT(laneScratch);
+
+    for (uint32_t l = 0; l < laneStride_; l++) {
+        int32_t trackIndex = laneTracks_[l];
+        if (trackIndex < 0) {
+            // PADDING LANES HOLD AN IDENTITY QUATERNION SO THE NORMALIZE NEVER DIVIDES BY ZERO. THE SCRATCH IS SHARED BETWEEN CLIPS, SO THEY ARE
+            // WRITTEN EVERY TIME
+            for (int i = 0; i < 4; i++) {
+                a[i][l] = i == 3 ? 1.0f : 0.0f;
+                b[i][l] = a[i][l];
+                c[i][l] = 0.0f;
+                d[i][l] = 0.0f;
+            }
+            laneT[l] = 0.0f;
+            continue;
+        }
+        const Track& track = tracks_[trackIndex];
+        const float* times = keyTimes_.data() + track.firstKey;
+        const uint32_t last = track.keyCount - 1;
+
+        // THE CURSOR ONLY MOVES FORWARD, A LOOPED (OR RESTARTED) CLIP STARTS OVER FROM THE FIRST KEY
+        uint32_t k = std::min(cursors[trackIndex], last);
+        if (time < times[k]) {
+            k = 0;
+        }
+        while (k + 1 < last && time >= times[k + 1]) {
+            k++;
+        }
+        cursors[trackIndex] = k;
+
+        const uint32_t k1 = std::min(k + 1, last);
+        const float dt = times[k1] - times[k];
+        float t = dt > 0.0f ? std::clamp((time - times[k]) / dt, 0.0f, 1.0f) : 0.0f;
+        glm::vec4 v0;
+        glm::vec4 v1;
+        switch (track.interpolation) {
+        case Interpolation::STEP:
+            v0 = keyValue(track, time >= times[k1] ? k1 : k);
+            v1 = v0;
+            t = 0.0f;
+            break;
+        case Interpolation::CUBICSPLINE: {
+            const glm::vec4* values = keyValues_.data() + track.firstValue;
+            v0 = values[k * 3 + 1];
+            v1 = values[k1 * 3 + 1];
+            glm::vec4 outTangent = values[k * 3 + 2] * dt;
+            glm::vec4 inTangent = values[k1 * 3] * dt;
+            for (int i = 0; i < 4; i++) {
+                c[i][l] = outTangent[i];
+                d[i][l] = inTangent[i];
+            }
+            break;
+        }
+        default:
+            v0 = keyValue(track, k);
+            v1 = keyValue(track, k1);
+            break;
+        }
+        for (int i = 0; i < 4; i++) {
+            a[i][l] = v0[i];
+            b[i][l] = v1[i];
+        }
+        laneT[l] = t;
+    }
+
+    for (const LaneGroup& group : groups_) {
+        if (group.cubic) {
+            evaluateCubic(group, laneScratch);
+        }
+        else {
+            evaluateLinear(group, laneScratch);
+        }
+    }
+
+    for (uint32_t l = 0; l < laneStride_; l++) {
+        if (laneTracks_[l] >= 0) {
+            pose[laneTracks_[l]] = glm::vec4(a[0][l], a[1][l], a[2][l], a[3][l]);
+        }
+    }
+}
+
+// ROTATIONS USE A CORRECTED NLERP (ZEUX, "APPROXIMATING SLERP"): THE BLEND FACTOR IS BENT BY A CUBIC FIT TO THE SLERP CURVE, WHICH KEEPS IT WITHIN
+// ~1E-4 OF glm::slerp WITHOUT THE acos AND sin. THE RESULT OVERWRITES THE a LANES
+void CompiledAnimation::evaluateLinear(const LaneGroup& group, float* laneScratch) const {
+    float* a[4] = { lane(laneScratch, 0, 0), lane(laneScratch, 0, 1), lane(laneScratch, 0, 2), lane(laneScratch, 0, 3) };
+    float* b[4] = { lane(laneScratch, 1, 0), lane(laneScratch, 1, 1), lane(laneScratch, 1, 2), lane(laneScratch, 1, 3) };
+    const float* laneT = this->laneT(laneScratch);
+    const uint32_t end = group.firstLane + group.laneCount;
+
+#ifdef ANIMATION_SSE
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (uint32_t l = group.firstLane; l < end; l += 4) {
+        __m128 av[4];
+        __m128 bv[4];
+        for (int i = 0; i < 4; i++) {
+            av[i] = _mm_loadu_ps(a[i] + l);
+            bv[i] = _mm_loadu_ps(b[i] + l);
+        }
+        __m128 t = _mm_loadu_ps(laneT + l);
+
+        if (group.rotation) {
+            __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(av[0], bv[0]), _mm_mul_ps(av[1], bv[1])), _mm_add_ps(_mm_mul_ps(av[2], bv[2]), _mm_mul_ps(av[3], bv[3])));
+            __m128 flip = _mm_and_ps(dot, signMask);
+            for (int i = 0; i < 4; i++) {
+                bv[i] = _mm_xor_ps(bv[i], flip);
+            }
+            __m128 d = _mm_andnot_ps(signMask, dot);
+
+            __m128 A = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+            __m128 B = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+            __m128 tHalf = _mm_sub_ps(t, half);
+            __m128 k = _mm_add_ps(_mm_mul_ps(A, _mm_mul_ps(tHalf, tHalf)), B);
+            t = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(t, tHalf), _mm_mul_ps(_mm_sub_ps(t, one), k)));
+        }
+
+        __m128 r[4];
+        for (int i = 0; i < 4; i++) {
+            r[i] = _mm_add_ps(av[i], _mm_mul_ps(_mm_sub_ps(bv[i], av[i]), t));
+        }
+        if (group.rotation) {
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], r[0]), _mm_mul_ps(r[1], r[1])), _mm_add_ps(_mm_mul_ps(r[2], r[2]), _mm_mul_ps(r[3], r[3]))));
+            for (int i = 0; i < 4; i++) {
+                r[i] = _mm_div_ps(r[i], length);
+            }
+        }
+        for (int i = 0; i < 4; i++) {
+            _mm_storeu_ps(a[i] + l, r[i]);
+        }
+    }
+#else
+    for (uint32_t l = group.firstLane; l < end; l++) {
+        float t = laneT[l];
+        float sign = 1.0f;
+        if (group.rotation) {
+            float dot = a[0][l] * b[0][l] + a[1][l] * b[1][l] + a[2][l] * b[2][l] + a[3][l] * b[3][l];
+            sign = dot < 0.0f ? -1.0f : 1.0f;
+            float d = std::abs(dot);
+            float A = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+            float B = 0.848013f + d * (-1.06021f + d * 0.215638f);
+            float k = A * (t - 0.5f) * (t - 0.5f) + B;
+            t = t + t * (t - 0.5f) * (t - 1.0f) * k;
+        }
+        float r[4];
+        for (int i = 0; i < 4; i++) {
+            r[i] = a[i][l] + (b[i][l] * sign - a[i][l]) * t;
+        }
+        float length = group.rotation ? std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]) : 1.0f;
+        for (int i = 0; i < 4; i++) {
+            a[i][l] = r[i] / length;
+        }
+    }
+#endif
+}
+
+// HERMITE BASIS OVER THE TWO VALUES (a, b) AND THE dt SCALED TANGENTS (c, d) THE GATHER ALREADY PREPARED
+void CompiledAnimation::evaluateCubic(const LaneGroup& group, float* laneScratch) const {
+    float* a[4] = { lane(laneScratch, 0, 0), lane(laneScratch, 0, 1), lane(laneScratch, 0, 2), lane(laneScratch, 0, 3) };
+    float* b[4] = { lane(laneScratch, 1, 0), lane(laneScratch, 1, 1), lane(laneScratch, 1, 2), lane(laneScratch, 1, 3) };
+    float* c[4] = { lane(laneScratch, 2, 0), lane(laneScratch, 2, 1), lane(laneScratch, 2, 2), lane(laneScratch, 2, 3) };
+    float* d[4] = { lane(laneScratch, 3, 0), lane(laneScratch, 3, 1), lane(laneScratch, 3, 2), lane(laneScratch, 3, 3) };
+    const float* laneT = this->laneT(laneScratch);
+    const uint32_t end = group.firstLane + group.laneCount;
+
+#ifdef ANIMATION_SSE
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+    for (uint32_t l = group.firstLane; l < end; l += 4) {
+        __m128 t = _mm_loadu_ps(laneT + l);
+        __m128 t2 = _mm_mul_ps(t, t);
+        __m128 t3 = _mm_mul_ps(t2, t);
+        __m128 h01 = _mm_sub_ps(_mm_mul_ps(three, t2), _mm_mul_ps(two, t3));
+        __m128 h00 = _mm_sub_ps(one, h01);
+        __m128 h10 = _mm_add_ps(_mm_sub_ps(t3, _mm_mul_ps(two, t2)), t);
+        __m128 h11 = _mm_sub_ps(t3, t2);
+
+        __m128 r[4];
+        for (int i = 0; i < 4; i++) {
+            r[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(h00, _mm_loadu_ps(a[i] + l)), _mm_mul_ps(h10, _mm_loadu_ps(c[i] + l))), _mm_add_ps(_mm_mul_ps(h01, _mm_loadu_ps(b[i] + l)), _mm_mul_ps(h11, _mm_loadu_ps(d[i] + l))));
+        }
+        if (group.rotation) {
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], r[0]), _mm_mul_ps(r[1], r[1])), _mm_add_ps(_mm_mul_ps(r[2], r[2]), _mm_mul_ps(r[3], r[3]))));
+            for (int i = 0; i < 4; i++) {
+                r[i] = _mm_div_ps(r[i], length);
+            }
+        }
+        for (int i = 0; i < 4; i++) {
+            _mm_storeu_ps(a[i] + l, r[i]);
+        }
+    }
+#else
+    for (uint32_t l = group.firstLane; l < end; l++) {
+        float t = laneT[l];
+        float t2 = t * t;
+        float t3 = t2 * t;
+        float h01 = 3.0f * t2 - 2.0f * t3;
+        float h00 = 1.0f - h01;
+        float h10 = t3 - 2.0f * t2 + t;
+        float h11 = t3 - t2;
+        float r[4];
+        for (int i = 0; i < 4; i++) {
+            r[i] = h00 * a[i][l] + h10 * c[i][l] + h01 * b[i][l] + h11 * d[i][l];
+        }
+        float length = group.rotation ? std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]) : 1.0f;
+        for (int i = 0; i < 4; i++) {
+            a[i][l] = r[i] / length;
+        }
+    }
+#endif
+}
+
+glm::vec4 CompiledAnimation::sampleTrack(uint32_t trackIndex, float time) const {
+    const Track& track = tracks_[trackIndex];
+    const float* times = keyTimes_.data() + track.firstKey;
+    const glm::vec4* values = keyValues_.data() + track.firstValue;
+    const uint32_t last = track.keyCount - 1;
+
+    uint32_t k = 0;
+    while (k + 1 < last && time >= times[k + 1]) {
+        k++;
+    }
+    const uint32_t k1 = std::min(k + 1, last);
+    const float dt = times[k1] - times[k];
+    const float t = dt > 0.0f ? std::clamp((time - times[k]) / dt, 0.0f, 1.0f) : 0.0f;
+
+    glm::vec4 result;
+    if (track.interpolation == Interpolation::STEP) {
+        result = keyValue(track, time >= times[k1] ? k1 : k);
+    }
+    else if (track.interpolation == Interpolation::CUBICSPLINE) {
+        float t2 = t * t;
+        float t3 = t2 * t;
+        result = (2.0f * t3 - 3.0f * t2 + 1.0f) * values[k * 3 + 1] + (t3 - 2.0f * t2 + t) * dt * values[k * 3 + 2] + (-2.0f * t3 + 3.0f * t2) * values[k1 * 3 + 1] + (t3 - t2) * dt * values[k1 * 3];
+        if (track.path == Path::ROTATION) {
+            result = glm::normalize(result);
+        }
+    }
+    else if (track.path == Path::ROTATION) {
+        glm::vec4 v0 = keyValue(track, k);
+        glm::vec4 v1 = keyValue(track, k1);
+        glm::quat q = glm::normalize(glm::slerp(glm::quat(v0.w, v0.x, v0.y, v0.z), glm::quat(v1.w, v1.x, v1.y, v1.z), t));
+        result = glm::vec4(q.x, q.y, q.z, q.w);
+    }
+    else {
+        result = glm::mix(keyValue(track, k), keyValue(track, k1), t);
+    }
+    return result;
+}
+
+void CompiledAnimation::writePose(const glm::vec4* pose, NodeHierarchy& hierarchy) const {
+    for (size_t i = 0; i < tracks_.size(); i++) {
+        const Track& track = tracks_[i];
+        switch (track.path) {
+        case Path::TRANSLATION:
+            hierarchy.translations_[track.node] = glm::vec3(pose[i]);
+            break;
+        case Path::ROTATION:
+            hierarchy.rotations_[track.node] = glm::quat(pose[i].w, pose[i].x, pose[i].y, pose[i].z);
+            break;
+        case Path::SCALE:
+            hierarchy.scales_[track.node] = glm::vec3(pose[i]);
+            break;
+        }
+    }
+}
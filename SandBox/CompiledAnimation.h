@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <glm/glm.hpp>
+#include "NodeHierarchy.h"
+
+// THE RUNTIME FORM OF AN Animation. TRACKS ARE RESOLVED ONCE AT LOAD (TARGET PATH AND INTERPOLATION AS ENUMS, TARGET NODE AS A NodeHierarchy INDEX),
+// KEY TIMES AND VALUES SIT IN TWO FLAT ARRAYS AND EVERY TRACK KEEPS A CURSOR TO ITS LAST KEY, SO A FRAME THAT MOVES FORWARD ONLY STEPS PAST THE KEYS
+// IT CROSSED. THE CURSORS AND LANES BELONG TO THE CALLER, SO ONE CLIP CAN BE SAMPLED BY ANY NUMBER OF CHARACTERS ON ANY NUMBER OF THREADS. sample GATHERS EVERY TRACK'S KEYS INTO STRUCTURE OF ARRAYS LANES (ROTATIONS FIRST, THEN TRANSLATIONS/SCALES, LINEAR AND STEP TRACKS
+// BEFORE CUBICSPLINE ONES) AND EVALUATES FOUR TRACKS PER SSE INSTRUCTION
+class CompiledAnimation {
+public:
+	enum class Path : uint8_t {
+		TRANSLATION,
+		ROTATION,
+		SCALE
+	};
+
+	enum class Interpolation : uint8_t {
+		LINEAR,
+		STEP,
+		CUBICSPLINE
+	};
+
+	struct Track {
+		Path path;
+		Interpolation interpolation;
+		uint32_t node;
+		uint32_t firstKey;
+		uint32_t keyCount;
+		uint32_t firstValue; // CUBICSPLINE KEYS STORE IN TANGENT, VALUE, OUT TANGENT. QUANTIZED TRACKS INDEX packedKeys_ IN KEYS
+		uint32_t quantized; // SEE ClipCompressor
+		glm::vec3 rangeMin; // TRANSLATION / SCALE DEQUANTIZATION RANGE
+		glm::vec3 rangeExtent;
+	};
+
+	std::vector<Track> tracks_; // IN THE SOURCE CHANNEL ORDER, sample'S OUTPUT FOLLOWS IT
+	std::vector<float> keyTimes_;
+	std::vector<glm::vec4> keyValues_;
+	std::vector<uint16_t> packedKeys_; // THREE PER QUANTIZED KEY
+
+	// RETURNS false FOR PATHS AND INTERPOLATIONS glTF DOESN'T DEFINE FOR NODE TRS (E.G. MORPH TARGET weights)
+	static bool parsePath(const std::string& path, Path& out);
+	static bool parseInterpolation(const std::string& interpolation, Interpolation& out);
+
+	// values HOLDS keyCount VALUES, OR 3 * keyCount FOR CUBICSPLINE
+	void addTrack(Path path, Interpolation interpolation, uint32_t node, const float* times, const glm::vec4* values, uint32_t keyCount);
+	// packed HOLDS 3 * keyCount VALUES FROM packRotation / packVector
+	void addQuantizedTrack(Path path, Interpolation interpolation, uint32_t node, const float* times, const uint16_t* packed, uint32_t keyCount, const glm::vec3& rangeMin, const glm::vec3& rangeExtent);
+	// CALLED ONCE AFTER THE LAST addTrack, BUILDS THE LANE ORDER
+	void finalize();
+
+	size_t size() const { return tracks_.size(); }
+
+	// cursors HOLDS size() VALUES AND IS KEPT PER PLAYBACK (ZEROED WHEN IT STARTS), laneScratch HOLDS laneScratchSize() FLOATS AND ONLY HAS TO BE
+	// PRIVATE TO THE THREAD. WRITES ONE VALUE PER TRACK TO pose (xyz FOR TRANSLATION AND SCALE, A NORMALIZED xyzw QUATERNION FOR ROTATION)
+	void sample(float time, glm::vec4* pose, uint32_t* cursors, float* laneScratch) const;
+	// THE SAME WITH THE CLIP'S OWN CURSORS AND LANES, FOR ONE-OFF TOOLS THAT OWN THE CLIP
+	void sample(float time, glm::vec4* pose) { sample(time, pose, cursors_.data(), lanes_.data()); }
+	size_t laneScratchSize() const { return LANE_VECTORS * laneStride_; }
+	// SCALAR EVALUATION OF ONE TRACK WITH glm::slerp, NO CURSOR. THE REFERENCE sample IS CHECKED AGAINST
+	glm::vec4 sampleTrack(uint32_t track, float time) const;
+	void writePose(const glm::vec4* pose, NodeHierarchy& hierarchy) const;
+
+	// DECODED VALUE OF A LINEAR OR STEP KEY
+	glm::vec4 keyValue(const Track& track, uint32_t key) const;
+	size_t memorySize() const;
+
+	// SMALLEST THREE: THE INDEX OF THE LARGEST COMPONENT IN 2 BITS AND THE OTHER THREE IN 15 BITS EACH, THE LARGEST IS REBUILT FROM THE UNIT LENGTH
+	static void packRotation(const glm::vec4& rotation, uint16_t* packed);
+	static glm::vec4 unpackRotation(const uint16_t* packed);
+	// 16 BITS PER COMPONENT OVER THE TRACK'S [rangeMin, rangeMin + rangeExtent]
+	static void packVector(const glm::vec4& value, const glm::vec3& rangeMin, const glm::vec3& rangeExtent, uint16_t* packed);
+	static glm::vec4 unpackVector(const uint16_t* packed, const glm::vec3& rangeMin, const glm::vec3& rangeExtent);
+
+private:
+	// ONE LANE PER TRACK, GROUPS PADDED TO A MULTIPLE OF FOUR
+	struct LaneGroup {
+		bool rotation;
+		bool cubic;
+		uint32_t firstLane;
+		uint32_t laneCount;
+	};
+
+	// GATHERED KEYS, FOUR COMPONENTS PER VECTOR: a/b ARE THE TWO KEYS, c/d THE dt SCALED OUT/IN TANGENTS OF CUBICSPLINE TRACKS, FOLLOWED BY ONE
+	// LANE OF BLEND FACTORS
+	static constexpr uint32_t LANE_VECTORS = 17;
+
+	std::vector<LaneGroup> groups_;
+	std::vector<int32_t> laneTracks_; // -1 FOR PADDING
+	uint32_t laneStride_ = 0;
+	std::vector<uint32_t> cursors_;
+	std::vector<float> lanes_;
+
+	float* lane(float* laneScratch, uint32_t vector, uint32_t component) const { return laneScratch + (vector * 4 + component) * laneStride_; }
+	float* laneT(float* laneScratch) const { return laneScratch + 16 * laneStride_; }
+	void evaluateLinear(const LaneGroup& group, float* laneScratch) const;
+	void evaluateCubic(const LaneGroup& group, float* laneScratch) const;
+};
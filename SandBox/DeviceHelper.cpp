@@ -1,11 +1,12 @@
 #include "DeviceHelper.h"
 
-void DeviceHelper::createImageView(const VkImage& image, VkImageView& imageView, const VkFormat format, const VkImageAspectFlags aspectFlags, const uint32_t mipLevels) const {
+void DeviceHelper::createImageView(const VkImage& image, VkImageView& imageView, const VkFormat format, const VkImageAspectFlags aspectFlags, const uint32_t mipLevels, const VkComponentMapping& components) const {
     VkImageViewCreateInfo imageViewCInfo{};
     imageViewCInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     imageViewCInfo.image = image;
     imageViewCInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
     imageViewCInfo.format = format;
+    imageViewCInfo.components = components;
     imageViewCInfo.subresourceRange.aspectMask = aspectFlags;
     imageViewCInfo.subresourceRange.baseMipLevel = 0;
     imageViewCInfo.subresourceRange.levelCount = mipLevels;
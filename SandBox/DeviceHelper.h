@@ -42,6 +42,7 @@ public:
     VkDescriptorPool descPool_;
     VkDescriptorSetLayout texDescSetLayout_;
     VkSampleCountFlagBits msaaSamples_;
+    bool textureCompressionBC_;
 
     DeviceHelper() {
         this->device_ = VK_NULL_HANDLE;
@@ -51,6 +52,7 @@ public:
         this->descPool_ = VK_NULL_HANDLE;
         this->texDescSetLayout_ = VK_NULL_HANDLE;
         this->msaaSamples_ = VK_SAMPLE_COUNT_1_BIT;
+        this->textureCompressionBC_ = false;
     };
 
     VkCommandBuffer beginSingleTimeCommands() const;
@@ -63,7 +65,7 @@ public:
 
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
 
-    void createImage(uint32_t width, uint32_t height, uint32_t mipLevel, uint16_t arrayLevels, VkImageCreateFlagBits flags, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) const;    void createImageView(const VkImage& image, VkImageView& imageView, const VkFormat format, const VkImageAspectFlags aspectFlags, const uint32_t mipLevels) const;
+    void createImage(uint32_t width, uint32_t height, uint32_t mipLevel, uint16_t arrayLevels, VkImageCreateFlagBits flags, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) const;    void createImageView(const VkImage& image, VkImageView& imageView, const VkFormat format, const VkImageAspectFlags aspectFlags, const uint32_t mipLevels, const VkComponentMapping& components = {}) const;
     void transitionImageLayout(VkCommandBuffer& cmdBuff, const VkImageSubresourceRange& subresourceRange, const VkImageLayout& oldLayout, const VkImageLayout& newLayout, VkImage& image);
 
     static glm::mat4 toGLMMat4(physx::PxMat44 pxMatrix) {
@@ -286,8 +286,9 @@ void DirectionalLight::createPipeline(VulkanDescriptorLayoutBuilder* modelMatrix
 
 	std::array<VkDescriptorSetLayout, 2> sets = { cascadeSetLayout->layout, modelMatrixDescriptorSet->layout };
 
-	auto bindings = Vertex::getBindingDescription();
-	auto attributes = Vertex::getPositionAttributeDescription();
+	// SHADOW CASCADES ONLY FETCH THE POSITION STREAM
+	auto bindings = VertexStreams::getBindingDescriptions();
+	auto attributes = VertexStreams::getPositionAttributeDescription();
 
 	VulkanPipelineBuilder::PipelineBuilderInfo pipelineInfo{};
 	pipelineInfo.pDescriptorSetLayouts = sets.data();
@@ -296,7 +297,7 @@ void DirectionalLight::createPipeline(VulkanDescriptorLayoutBuilder* modelMatrix
 	pipelineInfo.numStages = shaderStages.size();
 	pipelineInfo.pPushConstantRanges = &pcRange;
 	pipelineInfo.numRanges = 1;
-	pipelineInfo.vertexBindingDescriptions = &bindings;
+	pipelineInfo.vertexBindingDescriptions = &bindings[0];
 	pipelineInfo.numVertexBindingDescriptions = 1;
 	pipelineInfo.vertexAttributeDescriptions = attributes.data();
 	pipelineInfo.numVertexAttributeDescriptions = static_cast<int>(attributes.size());
@@ -452,6 +453,19 @@ void DirectionalLight::updateUniBuffers(FPSCam* camera, int currentFrame) {
 		cascades[currentFrame][i].splitDepth = (camera->getNearPlane() + splitDist * clipRange) * -1.0f;
 		cascades[currentFrame][i].viewProjectionMatrix = lightOrthoMatrix * lightViewMatrix;
 
+		// ROWS OF THE LIGHT MATRIX, THE SAME EXTRACTION AS FPSCam::updateFrustrumPlanes
+		glm::mat4 m = glm::transpose(cascades[currentFrame][i].viewProjectionMatrix);
+		std::array<glm::vec4, 6>& planes = cascades[currentFrame][i].frustumPlanes;
+		planes[0] = m[3] + m[0];
+		planes[1] = m[3] - m[0];
+		planes[2] = m[3] - m[1];
+		planes[3] = m[3] + m[1];
+		planes[4] = m[3] + m[2];
+		planes[5] = m[3] - m[2];
+		for (glm::vec4& plane : planes) {
+			plane /= glm::length(glm::vec3(plane));
+		}
+
 		lastSplitDist = shadowCascadeLevels[i];
 	}
 
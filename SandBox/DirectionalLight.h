@@ -17,6 +17,8 @@ private:
 
 		float splitDepth;
 		glm::mat4 viewProjectionMatrix;
+		// WORLD SPACE, LEFT/RIGHT/BOTTOM/TOP/NEAR/FAR LIKE FPSCam::frustumPlanes. FOR CULLING THE SHADOW CASTERS OF THE CASCADE
+		std::array<glm::vec4, 6> frustumPlanes;
 	};
 
 	std::vector<float> shadowCascadeLevels{};
@@ -0,0 +1,86 @@
+#include "DualQuaternionSkinning.h"
+
+DualQuaternionSkinning::DualQuat DualQuaternionSkinning::fromMatrix(const glm::mat4& matrix) {
+    // THE ROTATION OF THE UPPER 3x3 WITH ITS SCALE DIVIDED OUT
+    glm::mat3 rotation(glm::normalize(glm::vec3(matrix[0])), glm::normalize(glm::vec3(matrix[1])), glm::normalize(glm::vec3(matrix[2])));
+    glm::quat q = glm::normalize(glm::quat_cast(rotation));
+    glm::vec3 t = glm::vec3(matrix[3]);
+
+    DualQuat dq;
+    dq.real = glm::vec4(q.x, q.y, q.z, q.w);
+    dq.dual = glm::vec4(0.5f * (q.w * t + glm::cross(t, glm::vec3(q.x, q.y, q.z))), -0.5f * glm::dot(t, glm::vec3(q.x, q.y, q.z)));
+    return dq;
+}
+
+void DualQuaternionSkinning::fromMatrices(const glm::mat4* matrices, size_t count, DualQuat* out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = fromMatrix(matrices[i]);
+    }
+}
+
+float DualQuaternionSkinning::uniformScale(const glm::mat4* matrices, size_t count) {
+    if (count == 0) {
+        return 1.0f;
+    }
+    float total = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        total += glm::length(glm::vec3(matrices[i][0])) + glm::length(glm::vec3(matrices[i][1])) + glm::length(glm::vec3(matrices[i][2]));
+    }
+    return total / static_cast<float>(count * 3);
+}
+
+DualQuaternionSkinning::DualQuat DualQuaternionSkinning::blend(const DualQuat* palette, const glm::uvec4& joints, const glm::vec4& weights) {
+    const glm::vec4& hemisphere = palette[joints.x].real;
+    DualQuat blended;
+    blended.real = glm::vec4(0.0f);
+    for (int i = 0; i < 4; i++) {
+        const DualQuat& joint = palette[joints[i]];
+        const float w = glm::dot(joint.real, hemisphere) < 0.0f ? -weights[i] : weights[i];
+        blended.real += joint.real * w;
+        blended.dual += joint.dual * w;
+    }
+
+    float length = glm::length(blended.real);
+    if (length <= 0.0f) {
+        return palette[joints.x];
+    }
+    blended.real /= length;
+    blended.dual /= length;
+    return blended;
+}
+
+glm::vec3 DualQuaternionSkinning::transformPoint(const DualQuat& dq, const glm::vec3& point) {
+    const glm::vec3 r(dq.real);
+    const glm::vec3 d(dq.dual);
+    const glm::vec3 translation = 2.0f * (dq.real.w * d - dq.dual.w * r + glm::cross(r, d));
+    return transformVector(dq, point) + translation;
+}
+
+glm::vec3 DualQuaternionSkinning::transformVector(const DualQuat& dq, const glm::vec3& vector) {
+    const glm::vec3 r(dq.real);
+    return vector + 2.0f * glm::cross(r, glm::cross(r, vector) + dq.real.w * vector);
+}
+
+static glm::vec3 normalizedOrZero(const glm::vec3& v) {
+    float length = glm::length(v);
+    return length > 0.0f ? v / length : v;
+}
+
+void DualQuaternionSkinning::skinVertex(const DualQuat* palette, float bindScale, const Vertex& v, glm::vec3& position, glm::vec3& normal, glm::vec3& tangent) {
+    DualQuat dq = blend(palette, glm::uvec4(v.jointIndices), v.jointWeights);
+    position = transformPoint(dq, glm::vec3(v.pos) * bindScale);
+    normal = normalizedOrZero(transformVector(dq, glm::vec3(v.normal)));
+    tangent = normalizedOrZero(transformVector(dq, glm::vec3(v.tangent)));
+}
+
+void DualQuaternionSkinning::skinVertexLinear(const glm::mat4* palette, const Vertex& v, glm::vec3& position, glm::vec3& normal, glm::vec3& tangent) {
+    // THE WEIGHTS SkinnedVertex::pack STORES ADD UP TO 1
+    const float weightSum = v.jointWeights.x + v.jointWeights.y + v.jointWeights.z + v.jointWeights.w;
+    glm::mat4 skinMatrix(0.0f);
+    for (int i = 0; i < 4; i++) {
+        skinMatrix += palette[static_cast<uint32_t>(v.jointIndices[i])] * (weightSum > 0.0f ? v.jointWeights[i] / weightSum : 0.0f);
+    }
+    position = glm::vec3(skinMatrix * glm::vec4(glm::vec3(v.pos), 1.0f));
+    normal = normalizedOrZero(glm::mat3(skinMatrix) * glm::vec3(v.normal));
+    tangent = normalizedOrZero(glm::mat3(skinMatrix) * glm::vec3(v.tangent));
+}
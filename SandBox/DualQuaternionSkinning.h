@@ -0,0 +1,31 @@
+#pragma once
+
+#include "MeshHelper.h"
+
+// DUAL QUATERNION SKINNING, THE CPU HALF OF computeSkin'S DUAL QUATERNION PATH AND A REFERENCE FOR IT. A JOINT IS 8 FLOATS INSTEAD OF A mat4'S 16 AND
+// THE INFLUENCES ARE BLENDED AS RIGID TRANSFORMS, SO A TWISTED JOINT KEEPS ITS VOLUME WHERE A LINEAR BLEND COLLAPSES TOWARDS THE AXIS. DUAL QUATERNIONS
+// ONLY CARRY ROTATION AND TRANSLATION, SO A SKIN'S UNIFORM BIND SCALE (A MODEL AUTHORED IN CENTIMETRES UNDER A 0.01 ARMATURE COMES OUT AT 100) IS
+// APPLIED TO THE BASE POSE POSITION BEFORE THE BLENDED TRANSFORM. ANY OTHER SCALE IN THE JOINT MATRICES IS DROPPED
+class DualQuaternionSkinning {
+public:
+	// QUATERNIONS AS xyzw vec4, real IS THE ROTATION AND dual = 0.5 * translation * real. THE LAYOUT THE SHADER READS (TWO vec4 PER JOINT)
+	struct DualQuat {
+		glm::vec4 real = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		glm::vec4 dual = glm::vec4(0.0f);
+	};
+
+	// THE ROTATION AND TRANSLATION OF matrix, ITS SCALE DIVIDED OUT OF THE ROTATION
+	static DualQuat fromMatrix(const glm::mat4& matrix);
+	static void fromMatrices(const glm::mat4* matrices, size_t count, DualQuat* out);
+	// THE MEAN LENGTH OF THE BASIS VECTORS OF count JOINT MATRICES, THE bindScale FOR A SKIN AT ITS REST POSE
+	static float uniformScale(const glm::mat4* matrices, size_t count);
+
+	// WEIGHTED SUM ON THE FIRST INFLUENCE'S HEMISPHERE, THEN NORMALIZED. weights DON'T HAVE TO ADD UP TO 1
+	static DualQuat blend(const DualQuat* palette, const glm::uvec4& joints, const glm::vec4& weights);
+	static glm::vec3 transformPoint(const DualQuat& dq, const glm::vec3& point);
+	static glm::vec3 transformVector(const DualQuat& dq, const glm::vec3& vector);
+
+	// WHAT computeSkin WRITES FOR v IN EACH MODE, palette INDEXED BY v.jointIndices
+	static void skinVertex(const DualQuat* palette, float bindScale, const Vertex& v, glm::vec3& position, glm::vec3& normal, glm::vec3& tangent);
+	static void skinVertexLinear(const glm::mat4* palette, const Vertex& v, glm::vec3& position, glm::vec3& normal, glm::vec3& tangent);
+};
@@ -1,10 +1,9 @@
-#include "GLTFObject.h"
+#include "ModelCache.h"
+#include "TextureStreamer.h"
 
 #define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES
 
 void GLTFObj::loadNode(const tinygltf::Node& nodeIn, SceneNode* parent, uint32_t globalVertexOffset, uint32_t globalIndexOffset) {
-    SMikkTSpaceContext mikktContext = { .m_pInterface = &MikkTInterface };
-
     SceneNode* scNode = new SceneNode{};
     scNode->worldTransform = glm::mat4(1.0f);
     scNode->parent = parent;
@@ -35,10 +34,6 @@ void GLTFObj::loadNode(const tinygltf::Node& nodeIn, SceneNode* parent, uint32_t
             MeshHelper* p = new MeshHelper();
 
             const tinygltf::Primitive& gltfPrims = mesh.primitives[i];
-            uint32_t firstIndex = totalIndices_;
-            uint32_t firstVertex = totalVertices_;
-
-            uint32_t currentNumIndices = 0;
             uint32_t currentNumVertices = 0;
 
             // FOR VERTICES
@@ -85,27 +80,25 @@ void GLTFObj::loadNode(const tinygltf::Node& nodeIn, SceneNode* parent, uint32_t
             const tinygltf::BufferView& view = pInputModel_->bufferViews[accessor.bufferView];
             const tinygltf::Buffer& buffer = pInputModel_->buffers[view.buffer];
 
-            currentNumIndices += static_cast<uint32_t>(accessor.count);
-
             switch (accessor.componentType) {
             case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: {
                 const uint32_t* buf = reinterpret_cast<const uint32_t*>(&buffer.data[accessor.byteOffset + view.byteOffset]);
                 for (size_t index = 0; index < accessor.count; index++) {
-                    p->stagingIndices_.push_back(buf[index] + firstVertex);
+                    p->stagingIndices_.push_back(buf[index]);
                 }
                 break;
             }
             case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
                 const uint16_t* buf = reinterpret_cast<const uint16_t*>(&buffer.data[accessor.byteOffset + view.byteOffset]);
                 for (size_t index = 0; index < accessor.count; index++) {
-                    p->stagingIndices_.push_back(buf[index] + firstVertex);
+                    p->stagingIndices_.push_back(buf[index]);
                 }
                 break;
             }
             case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
                 const uint8_t* buf = reinterpret_cast<const uint8_t*>(&buffer.data[accessor.byteOffset + view.byteOffset]);
                 for (size_t index = 0; index < accessor.count; index++) {
-                    p->stagingIndices_.push_back(buf[index] + firstVertex);
+                    p->stagingIndices_.push_back(buf[index]);
                 }
                 break;
             }
@@ -114,72 +107,15 @@ void GLTFObj::loadNode(const tinygltf::Node& nodeIn, SceneNode* parent, uint32_t
                 std::_Xruntime_error("index component type not supported");
             }
 
-            p->indirectInfo.firstIndex = firstIndex + globalIndexOffset;
             p->indirectInfo.firstInstance = 0;
             p->indirectInfo.instanceCount = 1;
             p->indirectInfo.vertexOffset = globalVertexOffset;
             p->worldTransformMatrix = scNode->worldTransform;
             p->materialIndex = gltfPrims.material;
 
-            // TANGENT SPACE CREATION - ALSO REFERENCED OFF OF: https://github.com/Eearslya/glTFView.
-            if (!tangentsBuff) {
-                //UNPACK VERTICES
-                std::vector<Vertex> unpacked(p->stagingIndices_.size());
-                uint32_t newInd = 0;
-                for (uint32_t index : p->stagingIndices_) {
-                    unpacked[newInd] = p->stagingVertices_[static_cast<std::vector<Vertex, std::allocator<Vertex>>::size_type>(index) - firstVertex];
-                    newInd++;
-                }
-                p->stagingVertices_ = std::move(unpacked);
-                p->stagingIndices_.clear();
-
-                // GEN TANGENT SPACE
-                MikkTSpaceHelper::MikkTContext context{ p };
-                mikktContext.m_pUserData = &context;
-                genTangSpaceDefault(&mikktContext);
-
-                //WELD VERTICES
-                p->stagingIndices_.clear();
-                p->stagingIndices_.reserve(p->stagingVertices_.size());
-                std::unordered_map<Vertex, uint32_t> uniqueVertices;
-
-                size_t oldVertexCount = p->stagingVertices_.size();
-                uint32_t postTVertexCount = 0;
-                for (size_t i = 0; i < oldVertexCount; ++i) {
-                    Vertex v = p->stagingVertices_[i];
-
-                    auto index = uniqueVertices.find(v);
-                    if (index == uniqueVertices.end()) {
-                        uint32_t vertIndex = postTVertexCount;
-                        postTVertexCount++;
-                        uniqueVertices.insert(std::make_pair(v, vertIndex));
-                        p->stagingVertices_[vertIndex] = v;
-                        p->stagingIndices_.push_back(vertIndex);
-                    }
-                    else {
-                        p->stagingIndices_.push_back(index->second);
-                    }
-                }
-                p->stagingVertices_.resize(postTVertexCount);
-
-                currentNumIndices = static_cast<uint32_t>(p->stagingIndices_.size());
-                currentNumVertices = static_cast<uint32_t>(p->stagingVertices_.size());
-            }
-
-            p->indirectInfo.indexCount = currentNumIndices;
-
-            totalIndices_ += currentNumIndices; 
-            totalVertices_ += currentNumVertices;
-
+            // TANGENTS, WELD AND OPTIMISATION RUN IN PrimitiveFinisher::finish ONCE EVERY PRIMITIVE IS READ
             scNode->meshPrimitives.push_back(p);
-
-            vertices_.insert(vertices_.end(), p->stagingVertices_.begin(), p->stagingVertices_.end());
-            indices_.insert(indices_.end(), p->stagingIndices_.begin(), p->stagingIndices_.end());
-
-            p->stagingIndices_.clear();
-            p->stagingIndices_.shrink_to_fit();
-            p->stagingVertices_.clear();
-            p->stagingVertices_.shrink_to_fit();
+            pendingPrimitives_.push_back({ p, mesh.name, i, tangentsBuff == nullptr, "" });
         }
     }
 
@@ -192,10 +128,28 @@ void GLTFObj::loadNode(const tinygltf::Node& nodeIn, SceneNode* parent, uint32_t
 }
 
 void GLTFObj::loadGLTF(uint32_t globalVertexOffset, uint32_t globalIndexOffset) {
+    uint64_t sourceHash = 0;
+    if (useCache_ || cookTextures_) {
+        sourceHash = ModelCache::hashSource(gltfPath_);
+    }
+    if (useCache_) {
+        if (ModelCache::read(this, sourceHash, globalVertexOffset, globalIndexOffset)) {
+            loadedFromCache_ = true;
+            if (cookTextures_ && pInputModel_) {
+                cookImages(sourceHash);
+            }
+            return;
+        }
+    }
+
     pInputModel_ = new tinygltf::Model();
     tinygltf::TinyGLTF gltfContext;
     std::string error, warning;
 
+    if (streamTextures_) {
+        gltfContext.SetImageLoader(&GLTFObj::keepEncodedImage, nullptr);
+    }
+
     bool loadedFile = false;
     std::filesystem::path fPath = gltfPath_;
     if (fPath.extension() == ".glb") {
@@ -214,9 +168,6 @@ void GLTFObj::loadGLTF(uint32_t globalVertexOffset, uint32_t globalIndexOffset)
             textureIndices_.resize(pInputModel_->textures.size() + 3);
             loadTextures();
             loadMaterials();
-            for (auto& image : images_) {
-                image->load();
-            }
         }
 
         const tinygltf::Scene& scene = pInputModel_->scenes[0];
@@ -224,13 +175,164 @@ void GLTFObj::loadGLTF(uint32_t globalVertexOffset, uint32_t globalIndexOffset)
             const tinygltf::Node node = pInputModel_->nodes[scene.nodes[i]];
             loadNode(node, nullptr, globalVertexOffset, globalIndexOffset);
         }
+        updateWorldTransforms();
+        PrimitiveFinisher::finish(pendingPrimitives_, { optimizeMeshes_, true, weldEpsilon_ }, pJobs_, globalIndexOffset, vertices_, indices_, totalVertices_, totalIndices_, meshReport_);
+
+        // ONE WRITE PER MODEL SO REPORTS FROM PARALLEL LOADS DON'T INTERLEAVE
+        if (!meshReport_.empty()) {
+            std::cout << meshReport_;
+            meshReport_.clear();
+        }
+
+        if (useCache_) {
+            ModelCache::write(this, sourceHash, globalIndexOffset);
+        }
+
+        if (cookTextures_) {
+            cookImages(sourceHash);
+        }
     }
     else {
         std::cout << "couldnt open gltf file" << std::endl;
         std::cout << error.c_str() << std::endl;
     }
+}
+
+// GPU HALF OF THE LOAD, KEPT SEPARATE SO THE PARSING ABOVE CAN RUN ON A WORKER THREAD WHILE ALL QUEUE SUBMISSIONS STAY ON THE MAIN THREAD
+void GLTFObj::uploadTextures(TextureStreamer* streamer) {
+    size_t numModelImages = pInputModel_ ? pInputModel_->images.size() : 0;
+    for (size_t i = 0; i < images_.size(); i++) {
+        if (streamer && i < numModelImages && !images_[i]->pCooked_) {
+            streamer->enqueue(images_[i], this, pInputModel_->images[i]);
+        }
+        else {
+            images_[i]->load();
+        }
+    }
 
     delete pInputModel_;
+    pInputModel_ = nullptr;
+}
+
+void GLTFObj::flattenNode(SceneNode* node, int32_t parent, NodeHierarchy& hierarchy, std::vector<SceneNode*>& order) {
+    int32_t index = static_cast<int32_t>(hierarchy.addNode(parent, glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f), node->worldTransform));
+    order.push_back(node);
+    for (auto& child : node->children) {
+        flattenNode(child, index, hierarchy, order);
+    }
+}
+
+// loadNode ONLY SETS EACH NODE'S LOCAL TRANSFORM. THE TREE IS FLATTENED PARENTS FIRST, COMPOSED IN ONE PASS AND THE WORLD MATRICES HANDED BACK TO THE
+// NODES AND THEIR PRIMITIVES (AND FROM THERE TO THE MODEL CACHE AND THE RENDERER'S INSTANCE TRANSFORMS)
+void GLTFObj::updateWorldTransforms() {
+    NodeHierarchy hierarchy;
+    std::vector<SceneNode*> order;
+    for (auto& node : pParentNodes) {
+        flattenNode(node, -1, hierarchy, order);
+    }
+
+    hierarchy.updateWorldMatrices();
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i]->worldTransform = hierarchy.worldMatrices_[i];
+        for (auto& mesh : order[i]->meshPrimitives) {
+            mesh->worldTransformMatrix = hierarchy.worldMatrices_[i];
+        }
+    }
+}
+
+void GLTFObj::offsetNode(SceneNode* node, uint32_t globalVertexOffset, uint32_t globalIndexOffset) {
+    for (auto& childNode : node->children) {
+        offsetNode(childNode, globalVertexOffset, globalIndexOffset);
+    }
+
+    for (auto& mesh : node->meshPrimitives) {
+        mesh->indirectInfo.firstIndex = mesh->indirectInfo.firstIndex - globalFirstIndex + globalIndexOffset;
+        mesh->indirectInfo.vertexOffset = globalVertexOffset;
+    }
+}
+
+void GLTFObj::applyGlobalOffsets(uint32_t globalVertexOffset, uint32_t globalIndexOffset) {
+    for (auto& node : pParentNodes) {
+        offsetNode(node, globalVertexOffset, globalIndexOffset);
+    }
+
+    this->globalFirstVertex = globalVertexOffset;
+    this->globalFirstIndex = globalIndexOffset;
+}
+
+// BLOCK COMPRESSES EVERY MODEL IMAGE THE FIRST TIME IT IS SEEN AND REUSES THE COOKED FILE AFTER THAT. ONLY CPU WORK, SO IT RUNS ON THE LOADER THREAD
+void GLTFObj::cookImages(uint64_t sourceHash) {
+    size_t numModelImages = pInputModel_->images.size();
+    std::vector<uint32_t> usage(numModelImages, 0);
+    auto markUsage = [&](uint32_t textureIndex, uint32_t flag) {
+        if (textureIndex < textureIndices_.size() && textureIndices_[textureIndex] >= 0 && static_cast<size_t>(textureIndices_[textureIndex]) < numModelImages) {
+            usage[textureIndices_[textureIndex]] |= flag;
+        }
+    };
+    for (Material& m : mats_) {
+        markUsage(m.baseColorTexIndex, TextureCooker::USAGE_COLOR);
+        markUsage(m.emissionIndex, TextureCooker::USAGE_COLOR);
+        markUsage(m.normalTexIndex, TextureCooker::USAGE_NORMAL);
+        markUsage(m.metallicRoughnessIndex, TextureCooker::USAGE_METALLIC_ROUGHNESS);
+        markUsage(m.aoIndex, TextureCooker::USAGE_OCCLUSION);
+    }
+
+    for (size_t i = 0; i < numModelImages; i++) {
+        std::string path = TextureCooker::cookedPath(gltfPath_, i);
+        TextureCooker::CookedTexture* cooked = new TextureCooker::CookedTexture();
+        if (!TextureCooker::read(path, sourceHash, *cooked)) {
+            tinygltf::Image& image = pInputModel_->images[i];
+            std::vector<unsigned char> rgba;
+            int width = image.width;
+            int height = image.height;
+            if (image.component == 0) {
+                int channels;
+                stbi_uc* decoded = stbi_load_from_memory(image.image.data(), static_cast<int>(image.image.size()), &width, &height, &channels, STBI_rgb_alpha);
+                if (!decoded) {
+                    throw std::runtime_error("failed to decode texture image for cooking!");
+                }
+                rgba.assign(decoded, decoded + static_cast<size_t>(width) * height * 4);
+                stbi_image_free(decoded);
+            }
+            else if (image.component == 3) {
+                rgba.resize(static_cast<size_t>(width) * height * 4, 255);
+                for (size_t p = 0; p < static_cast<size_t>(width) * height; p++) {
+                    memcpy(&rgba[p * 4], &image.image[p * 3], 3);
+                }
+            }
+            else {
+                rgba = image.image;
+            }
+
+            auto cookStart = std::chrono::high_resolution_clock::now();
+            float error = TextureCooker::cook(rgba.data(), width, height, usage[i], *cooked);
+            float cookMs = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - cookStart).count();
+            TextureCooker::write(path, sourceHash, *cooked);
+
+            std::cout << "cooked: " << path << " " << TextureCooker::formatName(cooked->format) << " " << width << "x" << height << ", " << cooked->levels.size() << " mips, "
+                << rgba.size() / 1024 << "KB -> " << cooked->data.size() / 1024 << "KB, rmse " << error << " in " << cookMs << "ms" << std::endl;
+        }
+        images_[i]->pCooked_ = cooked;
+    }
+}
+
+// STREAMED MODELS KEEP THEIR PNG/JPG BYTES AS IS, COMPONENT 0 MARKS THE IMAGE AS STILL ENCODED UNTIL A STREAMER WORKER DECODES IT
+bool GLTFObj::keepEncodedImage(tinygltf::Image* image, const int imageIndex, std::string* error, std::string* warning, int requestedWidth, int requestedHeight, const unsigned char* bytes, int size, void* userData) {
+    image->image.assign(bytes, bytes + size);
+    image->width = 0;
+    image->height = 0;
+    image->component = 0;
+    image->bits = 8;
+    return true;
+}
+
+// STREAMED TEXTURES THAT ARE NOT ON THE GPU YET ARE SWAPPED FOR THE MATCHING DUMMY, SEE TextureStreamer::patchMaterials
+TextureHelper* GLTFObj::residentTexture(uint32_t textureIndex, uint32_t dummyOffset) {
+    TextureHelper* tex = images_[textureIndices_[textureIndex]];
+    if (tex->resident_) {
+        return tex;
+    }
+    return images_[images_.size() - 4 + dummyOffset];
 }
 
 // LOAD FUNCTIONS TEMPLATED FROM GLTFLOADING EXAMPLE ON GITHUB BY SASCHA WILLEMS
@@ -332,31 +434,31 @@ void GLTFObj::createDescriptors() {
             std::_Xruntime_error("Failed to allocate descriptor sets!");
         }
 
-        TextureHelper* t = images_[textureIndices_[m.baseColorTexIndex]];
+        TextureHelper* t = residentTexture(m.baseColorTexIndex, 2);
         VkDescriptorImageInfo colorImageInfo{};
         colorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         colorImageInfo.imageView = t->textureImageView_;
         colorImageInfo.sampler = t->textureSampler_;
 
-        TextureHelper* n = images_[textureIndices_[m.normalTexIndex]];
+        TextureHelper* n = residentTexture(m.normalTexIndex, 0);
         VkDescriptorImageInfo normalImageInfo{};
         normalImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         normalImageInfo.imageView = n->textureImageView_;
         normalImageInfo.sampler = n->textureSampler_;
 
-        TextureHelper* mR = images_[textureIndices_[m.metallicRoughnessIndex]];
+        TextureHelper* mR = residentTexture(m.metallicRoughnessIndex, 1);
         VkDescriptorImageInfo mrImageInfo{};
         mrImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         mrImageInfo.imageView = mR->textureImageView_;
         mrImageInfo.sampler = mR->textureSampler_;
 
-        TextureHelper* ao = images_[textureIndices_[m.aoIndex]];
+        TextureHelper* ao = residentTexture(m.aoIndex, 2);
         VkDescriptorImageInfo aoImageInfo{};
         aoImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         aoImageInfo.imageView = ao->textureImageView_;
         aoImageInfo.sampler = ao->textureSampler_;
 
-        TextureHelper* em = images_[textureIndices_[m.emissionIndex]];
+        TextureHelper* em = residentTexture(m.emissionIndex, 3);
         VkDescriptorImageInfo emissionImageInfo{};
         emissionImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         emissionImageInfo.imageView = em->textureImageView_;
@@ -408,13 +510,26 @@ void GLTFObj::createDescriptors() {
     }
 }
 
-GLTFObj::GLTFObj(std::string gltfPath, DeviceHelper* deviceHelper, uint32_t globalVertexOffset, uint32_t globalIndexOffset) {
+GLTFObj::GLTFObj(std::string gltfPath, DeviceHelper* deviceHelper, uint32_t globalVertexOffset, uint32_t globalIndexOffset, bool useCache, bool deferUpload, bool streamTextures, bool cookTextures, bool optimizeMeshes, float weldEpsilon, JobSystem* jobs) {
     gltfPath_ = gltfPath;
     pDevHelper_ = deviceHelper;
+    pInputModel_ = nullptr;
+    useCache_ = useCache;
+    streamTextures_ = streamTextures;
+    cookTextures_ = cookTextures;
+    optimizeMeshes_ = optimizeMeshes;
+    weldEpsilon_ = weldEpsilon;
+    pJobs_ = jobs;
+    this->totalIndices_ = 0;
+    this->totalVertices_ = 0;
     this->globalFirstVertex = globalVertexOffset;
     this->globalFirstIndex = globalIndexOffset;
 
     loadGLTF(globalVertexOffset, globalIndexOffset);
+
+    if (!deferUpload) {
+        uploadTextures();
+    }
 }
 
 // DELETION
@@ -1,6 +1,14 @@
 #pragma once
 
 #include "MeshHelper.h"
+#include "MeshOptimizer.h"
+#include "VertexWelder.h"
+#include "TangentGenerator.h"
+#include "MeshletBuilder.h"
+#include "NodeHierarchy.h"
+#include "PrimitiveFinisher.h"
+
+class TextureStreamer;
 
 class GLTFObj {
 public:
@@ -11,7 +19,7 @@ public:
 		glm::vec3 translation = glm::vec3(0.0f);
 		glm::quat rotation = glm::quat(0, 0, 0, 0);
 		glm::vec3 scale = glm::vec3(1.0f);
-		glm::mat4 worldTransform;
+		glm::mat4 worldTransform; // LOCAL WHILE loadNode RUNS, COMPOSED WITH THE PARENTS' BY updateWorldTransforms
 	};
 
 	uint32_t globalFirstVertex;
@@ -19,7 +27,9 @@ public:
 	uint32_t totalIndices_;
 	uint32_t totalVertices_;
 	glm::mat4 localModelTransform;
+	bool transformDirty_ = true; // RAISED BY setTransform, CLEARED ONCE THE RENDERER HAS RECOMPUTED THE OBJECT'S MODEL MATRICES
 	bool isSkyBox_ = false;
+	bool loadedFromCache_ = false;
 
 	std::unordered_map<Material*, std::vector<MeshHelper*>> opaqueDraws;
 	std::unordered_map<Material*, std::vector<MeshHelper*>> transparentDraws;
@@ -32,20 +42,38 @@ public:
 	std::vector<SceneNode*> pParentNodes;
 
 	void createDescriptors();
+	void uploadTextures(TextureStreamer* streamer = nullptr);
+	void applyGlobalOffsets(uint32_t globalVertexOffset, uint32_t globalIndexOffset);
 
-	GLTFObj(std::string gltfPath, DeviceHelper* deviceHelper, uint32_t globalVertexOffset, uint32_t globalIndexOffset);
+	GLTFObj(std::string gltfPath, DeviceHelper* deviceHelper, uint32_t globalVertexOffset, uint32_t globalIndexOffset, bool useCache = true, bool deferUpload = false, bool streamTextures = false, bool cookTextures = false, bool optimizeMeshes = false, float weldEpsilon = 0.0f, JobSystem* jobs = nullptr);
 	~GLTFObj();
 
 private:
+	friend class ModelCache;
+
 	std::string gltfPath_;
+	bool useCache_;
+	bool streamTextures_;
+	bool cookTextures_;
+	bool optimizeMeshes_;
+	float weldEpsilon_;
+	JobSystem* pJobs_; // THE LOADER'S WORKERS, NULL LOADS ON THE CALLING THREAD ONLY
+	std::string meshReport_;
+	std::vector<PrimitiveFinisher::Pending> pendingPrimitives_;
 	DeviceHelper* pDevHelper_;
 	tinygltf::Model* pInputModel_;
 
 	void loadImages();
 	void loadTextures();
 	void loadMaterials();
+	void cookImages(uint64_t sourceHash);
 	void loadNode(const tinygltf::Node& nodeIn, SceneNode* parent, uint32_t globalVertexOffset, uint32_t globalIndexOffset);
 	void loadGLTF(uint32_t globalVertexOffset, uint32_t globalIndexOffset);
+	void flattenNode(SceneNode* node, int32_t parent, NodeHierarchy& hierarchy, std::vector<SceneNode*>& order);
+	void updateWorldTransforms();
+	void offsetNode(SceneNode* node, uint32_t globalVertexOffset, uint32_t globalIndexOffset);
+	TextureHelper* residentTexture(uint32_t textureIndex, uint32_t dummyOffset);
+	static bool keepEncodedImage(tinygltf::Image* image, const int imageIndex, std::string* error, std::string* warning, int requestedWidth, int requestedHeight, const unsigned char* bytes, int size, void* userData);
 
 	void recursiveDeleteNode(SceneNode* node);
 };
\ No newline at end of file
@@ -19,7 +19,13 @@ public:
 	};
 
 	void setGLTFObj(GLTFObj* obj) { this->renderTarget = obj; };
-	void setTransform(glm::mat4 newTransform) { this->renderTarget->localModelTransform = newTransform; };
+	// CALLED EVERY FRAME WHETHER THE OBJECT MOVED OR NOT, ONLY A CHANGED MATRIX MARKS ITS MODEL MATRICES FOR RECOMPUTE AND UPLOAD
+	void setTransform(glm::mat4 newTransform) {
+		if (newTransform != this->renderTarget->localModelTransform) {
+			this->renderTarget->localModelTransform = newTransform;
+			this->renderTarget->transformDirty_ = true;
+		}
+	};
 
 	void loopUpdate() {
 		setTransform(transform.to_matrix());
@@ -1,4 +1,5 @@
 #include "GraphicsManager.h"
+#include <chrono>
 
 void GraphicsManager::check_vk_result(VkResult err) {
     if (err == 0)
@@ -40,6 +41,9 @@ void GraphicsManager::startSDL() {
 }
 
 void GraphicsManager::setup() {
+    pJobSystem_ = new JobSystem();
+    std::cout << "job system: " << pJobSystem_->workerCount() << " workers" << std::endl;
+
     startSDL();
     startVulkan();
     setupImGUI();
@@ -48,6 +52,11 @@ void GraphicsManager::setup() {
 void GraphicsManager::shutDown() {
     vkDeviceWaitIdle(pVkR_->device_);
 
+    delete pTextureStreamer_;
+    pTextureStreamer_ = nullptr;
+    delete pJobSystem_;
+    pJobSystem_ = nullptr;
+
     //pVkR_->shutdown();
     
     ImGui_ImplSDL2_Shutdown();
@@ -67,6 +76,77 @@ void GraphicsManager::imGUIUpdate() {
     auto framesPerSecond = 1.0f / Time::getDeltaTime();
     ImGui::Text("rfps: %.0f", framesPerSecond);
     ImGui::Text("  ft: %.2f ms", Time::getDeltaTime() * 1000.0f);
+    ImGui::Text("models: %zu loaded in %.0f ms (%s)", pStaticModelPaths_.size() + pAnimatedModelPaths_.size(), modelLoadMs_, parallelModelLoad_ ? "job system" : "serial");
+    if (pTextureStreamer_) {
+        ImGui::Text("textures: %u / %u resident, %u failed (%.2f ms)", pTextureStreamer_->numResident_, pTextureStreamer_->numRequested_, pTextureStreamer_->numFailed_, pTextureStreamer_->lastUploadMs_);
+    }
+
+    // STATIC DRAWS ONLY, AS COUNTED BY frustrumCull.comp A FEW FRAMES AGO
+    const CullStats& stats = pVkR_->cullStats_;
+    ImGui::Checkbox("occlusion culling", &pVkR_->occlusionCulling_);
+    ImGui::Text("draws: %u visible (%u early + %u late)", stats.visibleEarly + stats.visibleLate, stats.visibleEarly, stats.visibleLate);
+    ImGui::Text("       %u occluded, %u outside frustum", stats.occluded, stats.frustumCulled);
+    ImGui::Text("shadow casters: %u / %u / %u / %u", stats.shadowCasters[0], stats.shadowCasters[1], stats.shadowCasters[2], stats.shadowCasters[3]);
+    ImGui::Text("model matrices: %zu / %zu uploaded", pVkR_->modelMatricesUploaded_, pVkR_->instanceTransforms_.size());
+    const SkinningStats& skinning = pVkR_->skinningStats_;
+    ImGui::Checkbox("conditional skinning", &pVkR_->conditionalSkinning_);
+    ImGui::Text("skinning: %u / %u instances (%u culled, %u unchanged), %llu vertices skipped, %u dispatches", skinning.instances - skinning.culled - skinning.unchanged, skinning.instances,
+                skinning.culled, skinning.unchanged, static_cast<unsigned long long>(skinning.skippedVertices), skinning.dispatches);
+    uint32_t lodLevels[AnimationLOD::LEVELS] = {};
+    uint32_t lodUpdated = 0;
+    for (const AnimatedGameObject* g : animatedObjects) {
+        lodLevels[g->lodLevel_]++;
+        lodUpdated += g->lodUpdated_ ? 1 : 0;
+    }
+    ImGui::Checkbox("animation lod", &animationLOD_.enabled);
+    ImGui::Text("animation: %u / %zu updated, levels %u / %u / %u / %u frozen", lodUpdated, animatedObjects.size(), lodLevels[0], lodLevels[1], lodLevels[2], lodLevels[3]);
+    ImGui::Text("materials: %s", pVkR_->pBindless_ ? "bindless, one set per pass" : "one set per batch");
+}
+
+// CPU HALF OF MODEL LOADING (TINYGLTF, UNPACKING, MIKKTSPACE, WELDING) FOR EVERY STATIC AND ANIMATED PATH, ONE MODEL PER CHUNK ON pJobSystem_. EACH
+// LOADER SPREADS ITS PRIMITIVES OVER THE SAME WORKERS, SO THE THREAD COUNT STAYS AT THE POOL'S HOWEVER MANY MODELS THERE ARE. MODELS ARE BUILT AT
+// OFFSET 0 WITH THEIR TEXTURE UPLOADS DEFERRED, startVulkan THEN UPLOADS AND ASSIGNS GLOBAL OFFSETS IN PATH ORDER
+void GraphicsManager::loadModels(std::vector<GLTFObj*>& staticModels, std::vector<AnimatedGLTFObj*>& animatedModels) {
+    size_t numJobs = pStaticModelPaths_.size() + pAnimatedModelPaths_.size();
+    staticModels.resize(pStaticModelPaths_.size(), nullptr);
+    animatedModels.resize(pAnimatedModelPaths_.size(), nullptr);
+
+    Animation::compressClips_ = compressClips_;
+
+    // THE JOB SYSTEM'S BODIES MUST NOT THROW, A FAILED LOAD IS RETHROWN HERE ONCE EVERY MODEL HAS FINISHED
+    std::vector<std::exception_ptr> jobErrors(numJobs);
+    JobSystem* jobs = parallelModelLoad_ ? pJobSystem_ : nullptr;
+    auto load = [&](size_t begin, size_t end) {
+        for (size_t job = begin; job < end; job++) {
+            try {
+                if (job < pStaticModelPaths_.size()) {
+                    staticModels[job] = new GLTFObj(pStaticModelPaths_[job], pVkR_->pDevHelper_, 0, 0, useModelCache_, true, streamTextures_, cookTextures_, optimizeMeshes_, weldEpsilon_, jobs);
+                }
+                else {
+                    size_t animIndex = job - pStaticModelPaths_.size();
+                    animatedModels[animIndex] = new AnimatedGLTFObj(pAnimatedModelPaths_[animIndex], pVkR_->pDevHelper_, 0, 0, true, optimizeMeshes_, weldEpsilon_, jobs);
+                }
+            }
+            catch (...) {
+                jobErrors[job] = std::current_exception();
+            }
+        }
+    };
+
+    auto start = std::chrono::high_resolution_clock::now();
+    if (jobs) {
+        jobs->parallelFor(numJobs, 1, load);
+    }
+    else {
+        load(0, numJobs);
+    }
+    modelLoadMs_ = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - start).count();
+
+    for (std::exception_ptr& e : jobErrors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
 }
 
 using namespace std::literals;
@@ -167,9 +247,20 @@ void GraphicsManager::startVulkan() {
 
     std::cout << std::endl << "loading: " << numModels_ << " models" << std::endl << std::endl;
 
-    for (std::string s : pStaticModelPaths_) {
+    if (streamTextures_) {
+        pTextureStreamer_ = new TextureStreamer(pVkR_->pDevHelper_, MAX_FRAMES_IN_FLIGHT);
+    }
+
+    std::vector<GLTFObj*> staticModels;
+    std::vector<AnimatedGLTFObj*> animatedModels;
+    loadModels(staticModels, animatedModels);
+
+    for (size_t i = 0; i < pStaticModelPaths_.size(); i++) {
+        const std::string& s = pStaticModelPaths_[i];
         GameObject* newGO = new GameObject();
-        GLTFObj* mod = new GLTFObj(s, pVkR_->pDevHelper_, globalVertexOffset, globalIndexOffset);
+        GLTFObj* mod = staticModels[i];
+        mod->uploadTextures(pTextureStreamer_);
+        mod->applyGlobalOffsets(globalVertexOffset, globalIndexOffset);
         newGO->setGLTFObj(mod);
         gameObjects.push_back(newGO);
 
@@ -189,47 +280,61 @@ void GraphicsManager::startVulkan() {
 
         newGO->isOutline = false;
 
-        std::cout << "\nloaded model: " << s << ": " << mod->totalVertices_ << " vertices, " << mod->totalIndices_ << " indices\n" << std::endl;
+        std::cout << "\nloaded model: " << s << (mod->loadedFromCache_ ? " (cached)" : "") << ": " << mod->totalVertices_ << " vertices, " << mod->totalIndices_ << " indices\n" << std::endl;
     }
 
     uint32_t globalSkinMatrixOffset = 0;
 
-    for (std::string s : pAnimatedModelPaths_) {
-        AnimatedGameObject* newAnimGO = new AnimatedGameObject(pVkR_->pDevHelper_);
-        AnimatedGLTFObj* mod = new AnimatedGLTFObj(s, pVkR_->pDevHelper_, globalVertexOffset, globalIndexOffset);
-        newAnimGO->setAnimatedGLTFObj(mod);
-        animatedObjects.push_back(newAnimGO);
+    for (size_t i = 0; i < pAnimatedModelPaths_.size(); i++) {
+        const std::string& s = pAnimatedModelPaths_[i];
+        AnimatedGLTFObj* mod = animatedModels[i];
+        mod->uploadTextures();
+        mod->applyGlobalOffsets(globalVertexOffset, globalIndexOffset);
+        mod->createBasePoseBuffer();
+        mod->computeJointPadding();
+        mod->computeBoneReduction(boneReductionExtent_);
 
         pVkR_->numMats_ += static_cast<uint32_t>(mod->mats_.size());
         pVkR_->numImages_ += static_cast<uint32_t>(mod->images_.size());
 
-        newAnimGO->basePoseVertices_.insert(newAnimGO->basePoseVertices_.end(), mod->vertices_.begin(), mod->vertices_.end());
-
-        pVkR_->vertices_.insert(pVkR_->vertices_.end(), mod->vertices_.begin(), mod->vertices_.end());
         pVkR_->indices_.insert(pVkR_->indices_.end(), mod->indices_.begin(), mod->indices_.end());
 
-        mod->globalSkinningMatrixOffset = globalSkinMatrixOffset;
-
-        for (auto& skin : mod->skins_) {
-            for (glm::mat4& matrix : *(skin.finalJointMatrices)) {
-                pVkR_->inverseBindMatrices.push_back(matrix);
-                globalSkinMatrixOffset++;
-                newAnimGO->numInverseBindMatrices++;
+        // THE INSTANCES SHARE THE MODEL'S INDICES AND BASE POSE, EACH ONLY ADDS ITS OWN JOINT PALETTE AND THE RANGE computeSkin WRITES ITS POSE TO
+        uint32_t instances = 1 + (i < animatedInstances_.size() ? animatedInstances_[i] : 0);
+        AnimatedGameObject* source = nullptr;
+        for (uint32_t instance = 0; instance < instances; instance++) {
+            AnimatedGameObject* newAnimGO = new AnimatedGameObject(pVkR_->pDevHelper_);
+            newAnimGO->setAnimatedGLTFObj(mod);
+            newAnimGO->pSource_ = source;
+            newAnimGO->firstVertex = static_cast<uint32_t>(pVkR_->vertices_.size());
+            newAnimGO->firstJointMatrix = globalSkinMatrixOffset;
+            animatedObjects.push_back(newAnimGO);
+
+            pVkR_->vertices_.insert(pVkR_->vertices_.end(), mod->vertices_.begin(), mod->vertices_.end());
+
+            for (auto& skin : mod->skins_) {
+                for (glm::mat4& matrix : *(skin.finalJointMatrices)) {
+                    pVkR_->inverseBindMatrices.push_back(matrix);
+                    globalSkinMatrixOffset++;
+                    newAnimGO->numInverseBindMatrices++;
+                }
             }
-        }
 
-        newAnimGO->isOutline = true;
-        newAnimGO->smoothDuration = 150ms;
-        newAnimGO->smoothAmount = FLT_MAX;
-        newAnimGO->src = new std::vector<AnimatedGameObject::secondaryTransform>(newAnimGO->renderTarget->walkAnim.numChannels);
-        newAnimGO->dst = new std::vector<AnimatedGameObject::secondaryTransform>(newAnimGO->renderTarget->walkAnim.numChannels);
+            newAnimGO->skinningMode_ = i < animatedSkinning_.size() ? animatedSkinning_[i] : AnimatedGameObject::SkinningMode::LINEAR;
+            newAnimGO->isOutline = true;
+            newAnimGO->hierarchy_ = mod->hierarchy_;
+            newAnimGO->stateMachine_.init(newAnimGO->hierarchy_);
+            source = source != nullptr ? source : newAnimGO;
+        }
 
         globalVertexOffset = pVkR_->vertices_.size();
         globalIndexOffset = pVkR_->indices_.size();
 
-        MeshHelper::createVertexBuffer(pVkR_->pDevHelper_, newAnimGO->basePoseVertices_, newAnimGO->vertexBuffer_, newAnimGO->vertexBufferMemory_);
-
-        std::cout << "\nloaded model: " << s << ": " << mod->totalVertices_ << " vertices, " << mod->totalIndices_ << " indices\n" << std::endl;
+        std::cout << "\nloaded model: " << s << ": " << mod->totalVertices_ << " vertices, " << mod->totalIndices_ << " indices";
+        if (instances > 1) {
+            std::cout << ", " << instances << " instances (" << source->numInverseBindMatrices << " joints each)";
+        }
+        std::cout << "\n" << std::endl;
     }
 
     // link renderable objects to member game objects
@@ -247,10 +352,10 @@ void GraphicsManager::startVulkan() {
     pVkR_->brdfLut = new BRDFLut(pVkR_->pDevHelper_);
     std::cout << "generated BRDFLUT" << std::endl;
 
-    pVkR_->irCube = new IrradianceCube(pVkR_->pDevHelper_, pVkR_->pSkyBox_, pVkR_->vertexBuffer_, pVkR_->indexBuffer_);
+    pVkR_->irCube = new IrradianceCube(pVkR_->pDevHelper_, pVkR_->pSkyBox_, pVkR_->positionBuffer_, pVkR_->indexBuffer_);
     std::cout << std::endl << "generated IrradianceCube" << std::endl;
 
-    pVkR_->prefEMap = new PrefilteredEnvMap(pVkR_->pDevHelper_, pVkR_->pSkyBox_, pVkR_->vertexBuffer_, pVkR_->indexBuffer_);
+    pVkR_->prefEMap = new PrefilteredEnvMap(pVkR_->pDevHelper_, pVkR_->pSkyBox_, pVkR_->positionBuffer_, pVkR_->indexBuffer_);
 
     std::cout << std::endl << "generated Prefiltered Environment Map" << std::endl;
 
@@ -259,12 +364,16 @@ void GraphicsManager::startVulkan() {
     }
 
     for (AnimatedGameObject* gO : animatedObjects) {
-        gO->renderTarget->createDescriptors();
+        if (gO->pSource_ == nullptr) {
+            gO->renderTarget->createDescriptors();
+        }
     }
 
     pVkR_->updateGeneratedImageDescriptorSets();
     std::cout << "\ncreated descriptor sets" << std::endl;
 
+    pVkR_->createBindlessMaterials(MAX_FRAMES_IN_FLIGHT);
+
     pVkR_->createGraphicsPipeline();
     std::cout << "created material graphics pipeline" << std::endl;
 
@@ -299,6 +408,13 @@ void GraphicsManager::startVulkan() {
 }
 
 void GraphicsManager::loopUpdate() {
+    if (pTextureStreamer_) {
+        pTextureStreamer_->update(frameCount);
+    }
+    if (pVkR_->pBindless_) {
+        pVkR_->pBindless_->update(frameCount);
+    }
+
     imGUIUpdate();
 
     pVkR_->drawNewFrame(pWindow_, MAX_FRAMES_IN_FLIGHT);
@@ -4,6 +4,7 @@
 #include <imgui_impl_sdl2.h>
 #include <imgui_impl_vulkan.h>
 #include "VulkanRenderer.h"
+#include "TextureStreamer.h"
 #include "PlayerObject.h"
 #include "TrainObject.h"
 #include "Time.h"
@@ -28,6 +29,7 @@ private:
 	static void check_vk_result(VkResult err);
 
 	void setupImGUI();
+	void loadModels(std::vector<GLTFObj*>& staticModels, std::vector<AnimatedGLTFObj*>& animatedModels);
 	void startVulkan();
 	void startSDL();
 
@@ -37,11 +39,25 @@ public:
 	SDL_Renderer* pRenderer_;
 
 	PlayerObject* player;
+	TextureStreamer* pTextureStreamer_ = nullptr;
+	JobSystem* pJobSystem_ = nullptr; // THE ANIMATION UPDATE AND THE MODEL LOADERS RUN ON THESE WORKERS
 
 	std::vector<GameObject*> gameObjects = {};
 	std::vector<AnimatedGameObject*> animatedObjects = {};
+	std::vector<uint32_t> animatedInstances_ = {}; // EXTRA COPIES OF EACH ANIMATED MODEL (BY PATH), DRAWN FROM ITS AnimatedGLTFObj RIGHT AFTER IT IN animatedObjects
+	std::vector<AnimatedGameObject::SkinningMode> animatedSkinning_ = {}; // HOW EACH ANIMATED MODEL (BY PATH) AND ITS INSTANCES ARE SKINNED, LINEAR WHERE MISSING
 
 	bool mousemode_ = true;
+	bool useModelCache_ = true;
+	bool parallelModelLoad_ = true;
+	float modelLoadMs_ = 0.0f; // WALL TIME OF loadModels, SHOWN IN THE FPS MENU
+	bool streamTextures_ = true;
+	bool cookTextures_ = true;
+	bool optimizeMeshes_ = true;
+	float weldEpsilon_ = 0.0f;
+	AnimationLOD::Settings animationLOD_; // HOW FAR EACH ANIMATED CHARACTER'S UPDATE IS THROTTLED BY ITS SIZE ON SCREEN
+	float boneReductionExtent_ = 0.1f; // SEE AnimatedGLTFObj::computeBoneReduction
+	bool compressClips_ = true;
 
 	GraphicsManager(std::vector<std::string> staticModelPaths, std::vector<std::string> animatedModelPaths, std::string skyboxModelPath, std::vector<std::string> skyboxTexturePaths, float windowWidth, float windowHeight);
 
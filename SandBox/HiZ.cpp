@@ -0,0 +1,288 @@
+#include "HiZ.h"
+
+HiZPyramid::HiZPyramid(DeviceHelper* devHelper, VkDescriptorPool descriptorPool) {
+    this->pDevHelper_ = devHelper;
+    this->descriptorPool_ = descriptorPool;
+    this->image_ = VK_NULL_HANDLE;
+
+    createPipelines();
+
+    VkSamplerCreateInfo samplerCInfo{};
+    samplerCInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerCInfo.magFilter = VK_FILTER_NEAREST;
+    samplerCInfo.minFilter = VK_FILTER_NEAREST;
+    samplerCInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerCInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCInfo.minLod = 0.0f;
+    samplerCInfo.maxLod = VK_LOD_CLAMP_NONE;
+    samplerCInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+
+    if (vkCreateSampler(pDevHelper_->device_, &samplerCInfo, nullptr, &sampler_) != VK_SUCCESS) {
+        std::_Xruntime_error("Failed to create the hi-z sampler!");
+    }
+}
+
+HiZPyramid::~HiZPyramid() {
+    destroy();
+    vkDestroySampler(pDevHelper_->device_, sampler_, nullptr);
+    vkDestroyPipeline(pDevHelper_->device_, depthPipeline_, nullptr);
+    vkDestroyPipeline(pDevHelper_->device_, reducePipeline_, nullptr);
+    vkDestroyPipelineLayout(pDevHelper_->device_, pipelineLayout_, nullptr);
+    delete setLayout_;
+}
+
+VkPipeline HiZPyramid::createPipeline(const std::string& path) {
+    VulkanPipelineBuilder::VulkanShaderModule compute = VulkanPipelineBuilder::VulkanShaderModule(pDevHelper_->device_, path);
+
+    VkPipelineShaderStageCreateInfo computeStageCInfo{};
+    computeStageCInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computeStageCInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computeStageCInfo.module = compute.module;
+    computeStageCInfo.pName = "main";
+
+    VkComputePipelineCreateInfo computePipelineCInfo{};
+    computePipelineCInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    computePipelineCInfo.stage = computeStageCInfo;
+    computePipelineCInfo.layout = pipelineLayout_;
+
+    VkPipeline pipeline;
+    if (vkCreateComputePipelines(pDevHelper_->device_, VK_NULL_HANDLE, 1, &computePipelineCInfo, nullptr, &pipeline) != VK_SUCCESS) {
+        std::_Xruntime_error("Failed to create a hi-z pipeline!");
+    }
+    return pipeline;
+}
+
+void HiZPyramid::createPipelines() {
+    // SOURCE LEVEL (OR THE DEPTH IMAGE) SAMPLED, DESTINATION LEVEL WRITTEN
+    std::vector<VulkanDescriptorLayoutBuilder::BindingStruct> bindings;
+    bindings.resize(2);
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[1].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+
+    setLayout_ = new VulkanDescriptorLayoutBuilder(pDevHelper_, bindings);
+
+    VkPushConstantRange pcRange{};
+    pcRange.offset = 0;
+    pcRange.size = sizeof(PushConstantHiZ);
+    pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkPipelineLayoutCreateInfo pipeLineLayoutCInfo{};
+    pipeLineLayoutCInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeLineLayoutCInfo.setLayoutCount = 1;
+    pipeLineLayoutCInfo.pSetLayouts = &(setLayout_->layout);
+    pipeLineLayoutCInfo.pushConstantRangeCount = 1;
+    pipeLineLayoutCInfo.pPushConstantRanges = &pcRange;
+
+    if (vkCreatePipelineLayout(pDevHelper_->device_, &pipeLineLayoutCInfo, nullptr, &pipelineLayout_) != VK_SUCCESS) {
+        std::_Xruntime_error("Failed to create the hi-z pipeline layout!");
+    }
+
+    // THE DEPTH PREPASS RENDERS AT THE MSAA SAMPLE COUNT, LEVEL 0 HAS TO TAKE EVERY SAMPLE INTO ACCOUNT
+    if (pDevHelper_->msaaSamples_ == VK_SAMPLE_COUNT_1_BIT) {
+        depthPipeline_ = createPipeline("./shaders/spv/hiZDepth.spv");
+    }
+    else {
+        depthPipeline_ = createPipeline("./shaders/spv/hiZDepthMS.spv");
+    }
+    reducePipeline_ = createPipeline("./shaders/spv/hiZReduce.spv");
+}
+
+void HiZPyramid::create(VkImage depthImage, VkImageView depthImageView, VkFormat depthFormat, VkExtent2D extent) {
+    this->depthImage_ = depthImage;
+    this->extent_ = extent;
+    this->depthAspect_ = VK_IMAGE_ASPECT_DEPTH_BIT;
+    if (depthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT || depthFormat == VK_FORMAT_D24_UNORM_S8_UINT) {
+        this->depthAspect_ |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    }
+
+    // POWER OF TWO SO EVERY LEVEL IS AN EXACT 2X2 REDUCTION OF THE ONE BELOW
+    width_ = 1;
+    while (width_ * 2 <= extent.width) {
+        width_ *= 2;
+    }
+    height_ = 1;
+    while (height_ * 2 <= extent.height) {
+        height_ *= 2;
+    }
+    levels_ = 1;
+    while ((std::max(width_, height_) >> levels_) > 0) {
+        levels_++;
+    }
+
+    pDevHelper_->createImage(width_, height_, levels_, 1, static_cast<VkImageCreateFlagBits>(0), VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image_, imageMemory_);
+    pDevHelper_->createImageView(image_, imageView_, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, levels_);
+
+    levelViews_.resize(levels_);
+    for (uint32_t mip = 0; mip < levels_; mip++) {
+        VkImageViewCreateInfo imageViewCInfo{};
+        imageViewCInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        imageViewCInfo.image = image_;
+        imageViewCInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        imageViewCInfo.format = VK_FORMAT_R32_SFLOAT;
+        imageViewCInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageViewCInfo.subresourceRange.baseMipLevel = mip;
+        imageViewCInfo.subresourceRange.levelCount = 1;
+        imageViewCInfo.subresourceRange.baseArrayLayer = 0;
+        imageViewCInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(pDevHelper_->device_, &imageViewCInfo, nullptr, &levelViews_[mip]) != VK_SUCCESS) {
+            std::cout << "could not create hi-z image view" << std::endl;
+            std::_Xruntime_error("could not create hi-z image view");
+        }
+    }
+
+    VkCommandBuffer commandBuffer = pDevHelper_->beginSingleTimeCommands();
+    VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, levels_, 0, 1 };
+    pDevHelper_->transitionImageLayout(commandBuffer, range, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, image_);
+    pDevHelper_->endSingleTimeCommands(commandBuffer);
+
+    // SET i WRITES LEVEL i, READING THE DEPTH IMAGE FOR LEVEL 0 AND LEVEL i - 1 OTHERWISE
+    levelSets_.resize(levels_);
+    for (uint32_t mip = 0; mip < levels_; mip++) {
+        VkDescriptorSetAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = descriptorPool_;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts = &(setLayout_->layout);
+
+        if (vkAllocateDescriptorSets(pDevHelper_->device_, &allocateInfo, &levelSets_[mip]) != VK_SUCCESS) {
+            std::_Xruntime_error("Failed to allocate the hi-z descriptor sets!");
+        }
+
+        VkDescriptorImageInfo srcInfo{};
+        srcInfo.sampler = sampler_;
+        srcInfo.imageView = (mip == 0) ? depthImageView : levelViews_[mip - 1];
+        srcInfo.imageLayout = (mip == 0) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+        VkDescriptorImageInfo dstInfo{};
+        dstInfo.imageView = levelViews_[mip];
+        dstInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        std::array<VkWriteDescriptorSet, 2> descriptors{};
+        descriptors[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptors[0].dstSet = levelSets_[mip];
+        descriptors[0].dstBinding = 0;
+        descriptors[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptors[0].descriptorCount = 1;
+        descriptors[0].pImageInfo = &srcInfo;
+
+        descriptors[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptors[1].dstSet = levelSets_[mip];
+        descriptors[1].dstBinding = 1;
+        descriptors[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        descriptors[1].descriptorCount = 1;
+        descriptors[1].pImageInfo = &dstInfo;
+
+        vkUpdateDescriptorSets(pDevHelper_->device_, static_cast<uint32_t>(descriptors.size()), descriptors.data(), 0, nullptr);
+    }
+}
+
+void HiZPyramid::destroy() {
+    if (image_ == VK_NULL_HANDLE) {
+        return;
+    }
+
+    vkFreeDescriptorSets(pDevHelper_->device_, descriptorPool_, static_cast<uint32_t>(levelSets_.size()), levelSets_.data());
+    for (VkImageView view : levelViews_) {
+        vkDestroyImageView(pDevHelper_->device_, view, nullptr);
+    }
+    levelSets_.clear();
+    levelViews_.clear();
+
+    vkDestroyImageView(pDevHelper_->device_, imageView_, nullptr);
+    vkDestroyImage(pDevHelper_->device_, image_, nullptr);
+    vkFreeMemory(pDevHelper_->device_, imageMemory_, nullptr);
+    image_ = VK_NULL_HANDLE;
+}
+
+void HiZPyramid::barrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess) {
+    VkMemoryBarrier2 memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    memoryBarrier.srcStageMask = srcStage;
+    memoryBarrier.srcAccessMask = srcAccess;
+    memoryBarrier.dstStageMask = dstStage;
+    memoryBarrier.dstAccessMask = dstAccess;
+
+    VkDependencyInfo dependencyInfo{};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.memoryBarrierCount = 1;
+    dependencyInfo.pMemoryBarriers = &memoryBarrier;
+
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+void HiZPyramid::transitionDepth(VkCommandBuffer commandBuffer, bool toShaderRead) {
+    VkImageMemoryBarrier2 imageBarrier{};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    imageBarrier.image = depthImage_;
+    imageBarrier.subresourceRange = { depthAspect_, 0, 1, 0, 1 };
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+    if (toShaderRead) {
+        imageBarrier.srcStageMask = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+        imageBarrier.srcAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        imageBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        imageBarrier.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+        imageBarrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        imageBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    }
+    else {
+        imageBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        imageBarrier.srcAccessMask = 0;
+        imageBarrier.dstStageMask = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+        imageBarrier.dstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        imageBarrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        imageBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    }
+
+    VkDependencyInfo dependencyInfo{};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.imageMemoryBarrierCount = 1;
+    dependencyInfo.pImageMemoryBarriers = &imageBarrier;
+
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+void HiZPyramid::build(VkCommandBuffer commandBuffer) {
+    transitionDepth(commandBuffer, true);
+    // EARLIER CULL DISPATCHES MAY STILL BE READING THE LAST PYRAMID
+    barrier(commandBuffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT);
+
+    uint32_t srcWidth = 0;
+    uint32_t srcHeight = 0;
+    for (uint32_t mip = 0; mip < levels_; mip++) {
+        uint32_t dstWidth = std::max(width_ >> mip, 1u);
+        uint32_t dstHeight = std::max(height_ >> mip, 1u);
+
+        PushConstantHiZ push{};
+        if (mip == 0) {
+            push.srcSize = glm::ivec2(extent_.width, extent_.height);
+            push.sampleCount = static_cast<int>(pDevHelper_->msaaSamples_);
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, depthPipeline_);
+        }
+        else {
+            push.srcSize = glm::ivec2(srcWidth, srcHeight);
+            push.sampleCount = 1;
+            if (mip == 1) {
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, reducePipeline_);
+            }
+            barrier(commandBuffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+        }
+        push.dstSize = glm::ivec2(dstWidth, dstHeight);
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_, 0, 1, &levelSets_[mip], 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstantHiZ), &push);
+        vkCmdDispatch(commandBuffer, (dstWidth + 7) / 8, (dstHeight + 7) / 8, 1);
+
+        srcWidth = dstWidth;
+        srcHeight = dstHeight;
+    }
+
+    barrier(commandBuffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+    transitionDepth(commandBuffer, false);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "VulkanUtils.h"
+
+// HIERARCHICAL Z PYRAMID FOR THE OCCLUSION TEST IN frustrumCull.comp. LEVEL 0 IS THE DEPTH PREPASS REDUCED TO THE POWER OF TWO BELOW THE SWAPCHAIN
+// EXTENT, EVERY TEXEL HOLDING THE FARTHEST DEPTH (OF ANY MSAA SAMPLE) IT COVERS. EACH LEVEL ABOVE IS THE MAX OF THE 2X2 TEXELS UNDER IT. THE PYRAMID
+// LIVES IN VK_IMAGE_LAYOUT_GENERAL FOR ITS WHOLE LIFE, SO BUILDING AND READING IT ONLY NEEDS EXECUTION/MEMORY BARRIERS
+class HiZPyramid {
+private:
+	struct PushConstantHiZ {
+		glm::ivec2 srcSize;
+		glm::ivec2 dstSize;
+		int sampleCount;
+	};
+
+	DeviceHelper* pDevHelper_;
+	VkDescriptorPool descriptorPool_;
+
+	VkImage depthImage_;
+	VkExtent2D extent_;
+	VkImageAspectFlags depthAspect_;
+
+	VkDeviceMemory imageMemory_;
+	std::vector<VkImageView> levelViews_;
+	std::vector<VkDescriptorSet> levelSets_;
+
+	VulkanDescriptorLayoutBuilder* setLayout_;
+	VkPipelineLayout pipelineLayout_;
+	VkPipeline depthPipeline_;
+	VkPipeline reducePipeline_;
+
+	void createPipelines();
+	VkPipeline createPipeline(const std::string& path);
+	void barrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess);
+	void transitionDepth(VkCommandBuffer commandBuffer, bool toShaderRead);
+
+public:
+	VkImage image_;
+	VkImageView imageView_; // EVERY LEVEL, WHAT THE CULL SHADER SAMPLES
+	VkSampler sampler_;
+	uint32_t width_;
+	uint32_t height_;
+	uint32_t levels_;
+
+	HiZPyramid(DeviceHelper* devHelper, VkDescriptorPool descriptorPool);
+	~HiZPyramid();
+
+	// SIZED OFF OF THE DEPTH IMAGE, CALLED AGAIN (AFTER destroy) WHEN THE SWAPCHAIN IS RECREATED
+	void create(VkImage depthImage, VkImageView depthImageView, VkFormat depthFormat, VkExtent2D extent);
+	void destroy();
+
+	// EXPECTS THE DEPTH IMAGE IN DEPTH_STENCIL_ATTACHMENT_OPTIMAL AFTER A DEPTH PASS AND LEAVES IT THAT WAY. THE PYRAMID IS READABLE BY COMPUTE AFTERWARDS
+	void build(VkCommandBuffer commandBuffer);
+};
@@ -0,0 +1,61 @@
+#include "InstanceTransforms.h"
+#include <cstring>
+
+void InstanceTransforms::addDraw(const glm::mat4* localModelTransform, bool* dirty, const glm::mat4& nodeTransform) {
+    uint32_t index = static_cast<uint32_t>(matrices_.size());
+    matrices_.push_back(*localModelTransform * nodeTransform);
+    nodeTransforms_.push_back(nodeTransform);
+
+    if (!ranges_.empty() && ranges_.back().localModelTransform == localModelTransform && ranges_.back().first + ranges_.back().count == index) {
+        ranges_.back().count++;
+        return;
+    }
+    // THE BUFFERS ARE FILLED WITH THE WHOLE TABLE WHEN THEY ARE CREATED, NOTHING IS STALE YET
+    ranges_.push_back(Range{ localModelTransform, dirty, index, 1, 0 });
+}
+
+size_t InstanceTransforms::update(uint32_t frameIndex, uint32_t framesInFlight, void* mapped) {
+    const uint32_t allFrames = (1u << framesInFlight) - 1;
+    const uint32_t frameBit = 1u << frameIndex;
+    glm::mat4* destination = static_cast<glm::mat4*>(mapped);
+
+    // NEIGHBOURING STALE RANGES GO OUT AS ONE COPY
+    size_t copied = 0;
+    uint32_t runFirst = 0;
+    uint32_t runEnd = 0;
+    auto flush = [&]() {
+        if (runEnd > runFirst) {
+            memcpy(destination + runFirst, matrices_.data() + runFirst, (runEnd - runFirst) * sizeof(glm::mat4));
+            copied += runEnd - runFirst;
+        }
+    };
+
+    dirtyRanges_.clear();
+    for (uint32_t r = 0; r < ranges_.size(); r++) {
+        Range& range = ranges_[r];
+        if (*range.dirty) {
+            const glm::mat4 localModelTransform = *range.localModelTransform;
+            for (uint32_t i = range.first; i < range.first + range.count; i++) {
+                matrices_[i] = localModelTransform * nodeTransforms_[i];
+            }
+            range.staleFrames = allFrames;
+            dirtyRanges_.push_back(r);
+        }
+        if (!(range.staleFrames & frameBit)) {
+            continue;
+        }
+        range.staleFrames &= ~frameBit;
+        if (range.first != runEnd) {
+            flush();
+            runFirst = range.first;
+        }
+        runEnd = range.first + range.count;
+    }
+    flush();
+
+    // AN OBJECT'S RANGES SHARE ONE FLAG, IT CAN ONLY BE CLEARED ONCE ALL OF THEM HAVE BEEN SEEN
+    for (uint32_t r : dirtyRanges_) {
+        *ranges_[r].dirty = false;
+    }
+    return copied;
+}
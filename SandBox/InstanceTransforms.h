@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// FLAT TABLE OF EVERY DRAW'S MODEL MATRIX IN firstInstance ORDER. EACH OBJECT OWNS ONE OR MORE CONTIGUOUS RANGES OF IT (MERGED BATCHES CAN SPLIT AN
+// OBJECT'S DRAWS) AND THE DIRTY FLAG ITS setTransform RAISES. update ONLY RECOMPUTES THE RANGES OF OBJECTS THAT MOVED AND ONLY COPIES THE RANGES THE
+// GIVEN FRAME'S MAPPED BUFFER HAS NOT SEEN YET, SO A STILL SCENE COSTS ONE PASS OVER THE RANGES AND NO COPIES
+class InstanceTransforms {
+public:
+	struct Range {
+		const glm::mat4* localModelTransform;
+		bool* dirty;
+		uint32_t first;
+		uint32_t count;
+		uint32_t staleFrames; // BIT i SET WHILE FRAME i'S BUFFER STILL HOLDS AN OLD COPY OF THE RANGE
+	};
+
+	std::vector<glm::mat4> matrices_;
+
+	// APPENDS THE NEXT DRAW, GROWING THE LAST RANGE WHEN IT BELONGS TO THE SAME OBJECT
+	void addDraw(const glm::mat4* localModelTransform, bool* dirty, const glm::mat4& nodeTransform);
+	size_t size() const { return matrices_.size(); }
+
+	// RETURNS HOW MANY MATRICES WERE COPIED INTO mapped (frameIndex'S PERSISTENTLY MAPPED BUFFER)
+	size_t update(uint32_t frameIndex, uint32_t framesInFlight, void* mapped);
+
+private:
+	std::vector<glm::mat4> nodeTransforms_;
+	std::vector<Range> ranges_;
+	std::vector<uint32_t> dirtyRanges_; // SCRATCH FOR update, KEPT TO AVOID A PER FRAME ALLOCATION
+};
@@ -212,8 +212,8 @@ void IrradianceCube::createPipeline() {
 
     std::array<VulkanPipelineBuilder::VulkanShaderModule, 2> shaderStages = { vertexShaderModule, fragmentShaderModule };
 
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getPositionAttributeDescription();
+    auto bindingDescriptions = VertexStreams::getBindingDescriptions();
+    auto attributeDescriptions = VertexStreams::getPositionAttributeDescription();
 
     VulkanPipelineBuilder::PipelineBuilderInfo pipelineInfo{};
     pipelineInfo.pDescriptorSetLayouts = &iRCubeDescriptorSetLayout_->layout;
@@ -222,7 +222,7 @@ void IrradianceCube::createPipeline() {
     pipelineInfo.numStages = static_cast<int>(shaderStages.size());
     pipelineInfo.pPushConstantRanges = &pcRange;
     pipelineInfo.numRanges = 1;
-    pipelineInfo.vertexBindingDescriptions = &bindingDescription;
+    pipelineInfo.vertexBindingDescriptions = &bindingDescriptions[0];
     pipelineInfo.numVertexBindingDescriptions = 1;
     pipelineInfo.vertexAttributeDescriptions = attributeDescriptions.data();
     pipelineInfo.numVertexAttributeDescriptions = static_cast<int>(attributeDescriptions.size());
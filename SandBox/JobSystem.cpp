@@ -0,0 +1,106 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+JobSystem::JobSystem(uint32_t workerCount) {
+    uint32_t numWorkers = workerCount > 0 ? workerCount : std::max(2u, std::thread::hardware_concurrency()) - 1;
+    activeWorkers_.store(numWorkers, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < numWorkers; i++) {
+        workers_.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void JobSystem::setActiveWorkers(uint32_t count) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        activeWorkers_.store(std::min(count, workerCount()), std::memory_order_relaxed);
+    }
+    wake_.notify_all();
+}
+
+void JobSystem::run(size_t count, size_t grain, RangeFunction function, void* context) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+
+    // NOT WORTH WAKING ANYONE FOR A SINGLE CHUNK
+    if (activeWorkers_.load(std::memory_order_relaxed) == 0 || count <= grain) {
+        function(context, 0, count);
+        return;
+    }
+
+    Job job;
+    job.function = function;
+    job.context = context;
+    job.count = count;
+    job.grain = grain;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job.nextJob = jobs_;
+        jobs_ = &job;
+    }
+    wake_.notify_all();
+
+    // THE CALLER CAN ALWAYS FINISH ITS OWN JOB ALONE, SO A NESTED CALL NEVER WAITS ON A WORKER THAT IS WAITING ON IT
+    drain(job);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&job] { return job.users == 0; });
+    Job** link = &jobs_;
+    while (*link != &job) {
+        link = &(*link)->nextJob;
+    }
+    *link = job.nextJob;
+}
+
+// CALLED UNDER mutex_
+JobSystem::Job* JobSystem::claimable() {
+    for (Job* job = jobs_; job != nullptr; job = job->nextJob) {
+        if (job->next.load(std::memory_order_relaxed) < job->count) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::drain(Job& job) {
+    while (true) {
+        size_t begin = job.next.fetch_add(job.grain, std::memory_order_relaxed);
+        if (begin >= job.count) {
+            return;
+        }
+        job.function(job.context, begin, std::min(begin + job.grain, job.count));
+    }
+}
+
+void JobSystem::workerLoop(uint32_t index) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // WORKERS PAST activeWorkers_ SIT IDLE UNTIL setActiveWorkers RAISES IT
+        Job* job = nullptr;
+        wake_.wait(lock, [&] { return stopping_ || (index < activeWorkers_.load(std::memory_order_relaxed) && (job = claimable()) != nullptr); });
+        if (stopping_) {
+            return;
+        }
+
+        job->users++;
+        lock.unlock();
+        drain(*job);
+        lock.lock();
+        if (--job->users == 0) {
+            done_.notify_all();
+        }
+    }
+}
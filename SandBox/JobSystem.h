@@ -0,0 +1,60 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+// A FIXED SET OF WORKER THREADS SHARED BY THE PER FRAME DATA PARALLEL WORK AND MODEL LOADING. parallelFor SPLITS [0, count) INTO CHUNKS OF grain ITEMS
+// THAT THE WORKERS AND THE CALLING THREAD CLAIM THROUGH ONE ATOMIC COUNTER, AND RETURNS ONCE EVERY CHUNK IS DONE. ANY THREAD MAY CALL IT, INCLUDING A
+// BODY ALREADY RUNNING ON A WORKER, SO NESTED LOOPS SHARE THE SAME WORKERS INSTEAD OF STARTING THREADS OF THEIR OWN. THE JOB LIVES ON THE CALLER'S STACK
+// AND THE BODY IS PASSED BY POINTER, NOT AS A std::function, SO DISPATCHING A FRAME'S WORK NEVER TOUCHES THE HEAP
+class JobSystem {
+public:
+	// 0 WORKERS MEANS ONE PER HARDWARE THREAD BESIDES THE CALLER
+	explicit JobSystem(uint32_t workerCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	uint32_t workerCount() const { return static_cast<uint32_t>(workers_.size()); }
+	// HOW MANY WORKERS parallelFor USES, CLAMPED TO workerCount(). 0 RUNS EVERYTHING ON THE CALLING THREAD
+	void setActiveWorkers(uint32_t count);
+	uint32_t activeWorkers() const { return activeWorkers_.load(std::memory_order_relaxed); }
+
+	// body(begin, end) IS CALLED FOR DISJOINT RANGES COVERING [0, count), FROM SEVERAL THREADS AT ONCE. IT MUST NOT THROW
+	template <typename Body>
+	void parallelFor(size_t count, size_t grain, Body& body) {
+		run(count, grain, [](void* context, size_t begin, size_t end) { (*static_cast<Body*>(context))(begin, end); }, &body);
+	}
+
+private:
+	typedef void (*RangeFunction)(void* context, size_t begin, size_t end);
+
+	// ONE parallelFor IN FLIGHT
+	struct Job {
+		RangeFunction function = nullptr;
+		void* context = nullptr;
+		size_t count = 0;
+		size_t grain = 1;
+		std::atomic<size_t> next{ 0 };
+		uint32_t users = 0; // WORKERS DRAINING IT, GUARDED BY mutex_. THE CALLER WAITS FOR 0 BEFORE ITS STACK FRAME GOES
+		Job* nextJob = nullptr;
+	};
+
+	std::vector<std::thread> workers_;
+	std::atomic<uint32_t> activeWorkers_{ 0 }; // WRITTEN UNDER mutex_, run READS IT WITHOUT
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
+	Job* jobs_ = nullptr; // NEWEST FIRST, SO A WORKER PICKS UP THE INNERMOST LOOP OF A NEST BEFORE ITS PARENT'S NEXT CHUNK
+	bool stopping_ = false;
+
+	void run(size_t count, size_t grain, RangeFunction function, void* context);
+	void workerLoop(uint32_t index);
+	Job* claimable();
+	static void drain(Job& job);
+};
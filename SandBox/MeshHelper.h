@@ -2,6 +2,7 @@
 
 #include "TextureHelper.h"
 #include "mikktspace.h"
+#include <glm/gtc/packing.hpp>
 
 struct Material {
 	glm::vec4 baseColor = glm::vec4(1.0f);
@@ -13,9 +14,11 @@ struct Material {
 	std::string alphaMode = "OPAQUE";
 	float alphaCutOff;
 	bool doubleSides = false;
-	VkDescriptorSet descriptorSet;
+	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+	uint32_t bindlessIndex = 0; // INTO BindlessMaterials' MATERIAL BUFFER, UNUSED ON THE PER MATERIAL SET PATH
 };
 
+// FULL PRECISION LOAD FORMAT (WELDING, MIKKTSPACE, PHYSICS, BOUNDS) AND THE SCREEN QUAD LAYOUT. SCENE GEOMETRY GOES TO THE GPU AS THE PACKED STREAMS BELOW
 struct Vertex {
 	glm::vec4 pos; // uv_x0 stored in w
 	glm::vec4 normal; // uv_y0 stored in w
@@ -40,36 +43,6 @@ struct Vertex {
 		return attributeDescriptions;
 	}
 
-	static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
-		std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
-		attributeDescriptions[0].binding = 0;
-		attributeDescriptions[0].location = 0;
-		attributeDescriptions[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		attributeDescriptions[0].offset = offsetof(Vertex, pos);
-		attributeDescriptions[1].binding = 0;
-		attributeDescriptions[1].location = 1;
-		attributeDescriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		attributeDescriptions[1].offset = offsetof(Vertex, normal);
-		attributeDescriptions[2].binding = 0;
-		attributeDescriptions[2].location = 2;
-		attributeDescriptions[2].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		attributeDescriptions[2].offset = offsetof(Vertex, tangent);
-		return attributeDescriptions;
-	}
-
-	static std::array<VkVertexInputAttributeDescription, 2> getDepthAttributeDescription() {
-		std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
-		attributeDescriptions[0].binding = 0;
-		attributeDescriptions[0].location = 0;
-		attributeDescriptions[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		attributeDescriptions[0].offset = offsetof(Vertex, pos);
-		attributeDescriptions[1].binding = 0;
-		attributeDescriptions[1].location = 1;
-		attributeDescriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		attributeDescriptions[1].offset = offsetof(Vertex, normal);
-		return attributeDescriptions;
-	}
-
 	bool operator==(const Vertex& other) const {
 		return pos == other.pos && normal == other.normal && tangent == other.tangent;
 	}
@@ -94,6 +67,142 @@ struct Vertex {
 	};
 };
 
+// SECOND VERTEX STREAM, EVERYTHING BUT THE POSITION IN 12 BYTES. NORMAL AND TANGENT ARE OCTAHEDRAL SNORM16 PAIRS, THE LOWEST BIT OF THE TANGENT X HOLDS
+// THE BITANGENT SIGN, UVS ARE HALF FLOATS. DECODED BY shaders/glsl/vertexPacking.glsl
+struct VertexAttributes {
+	int16_t normalOct[2];
+	int16_t tangentOct[2];
+	uint16_t uv[2];
+
+	static glm::vec2 octEncode(glm::vec3 n) {
+		float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+		if (l1 <= 0.0f) {
+			return glm::vec2(0.0f);
+		}
+		n /= l1;
+		if (n.z >= 0.0f) {
+			return glm::vec2(n.x, n.y);
+		}
+		return (1.0f - glm::abs(glm::vec2(n.y, n.x))) * glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	static int16_t toSnorm16(float v) {
+		return static_cast<int16_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	static VertexAttributes pack(const Vertex& v) {
+		VertexAttributes a{};
+		glm::vec2 n = octEncode(glm::vec3(v.normal));
+		glm::vec2 t = octEncode(glm::vec3(v.tangent));
+		a.normalOct[0] = toSnorm16(n.x);
+		a.normalOct[1] = toSnorm16(n.y);
+		a.tangentOct[0] = static_cast<int16_t>((toSnorm16(t.x) & ~1) | (v.tangent.w < 0.0f ? 1 : 0));
+		a.tangentOct[1] = toSnorm16(t.y);
+		uint32_t uv = glm::packHalf2x16(glm::vec2(v.pos.w, v.normal.w));
+		a.uv[0] = static_cast<uint16_t>(uv & 0xFFFF);
+		a.uv[1] = static_cast<uint16_t>(uv >> 16);
+		return a;
+	}
+};
+
+// BASE POSE INPUT OF THE SKINNING COMPUTE SHADER, THE ONLY PLACE JOINTS AND WEIGHTS LIVE ON THE GPU. 40 BYTES, MATCHES SkinnedVertex IN skinning.comp
+struct SkinnedVertex {
+	float pos[3];
+	VertexAttributes attributes;
+	uint16_t jointIndices[4];
+	uint16_t jointWeights[4];
+
+	static SkinnedVertex pack(const Vertex& v) {
+		SkinnedVertex s{};
+		s.pos[0] = v.pos.x;
+		s.pos[1] = v.pos.y;
+		s.pos[2] = v.pos.z;
+		s.attributes = VertexAttributes::pack(v);
+		float weightSum = v.jointWeights.x + v.jointWeights.y + v.jointWeights.z + v.jointWeights.w;
+		for (int i = 0; i < 4; i++) {
+			s.jointIndices[i] = static_cast<uint16_t>(v.jointIndices[i]);
+			s.jointWeights[i] = static_cast<uint16_t>(std::lround(std::clamp(weightSum > 0.0f ? v.jointWeights[i] / weightSum : 0.0f, 0.0f, 1.0f) * 65535.0f));
+		}
+		return s;
+	}
+};
+
+// THE SPLIT LAYOUT EVERY SCENE PIPELINE BINDS - BINDING 0 IS THE POSITION STREAM (FLOAT3), BINDING 1 THE PACKED ATTRIBUTE STREAM
+struct VertexStreams {
+	static std::array<VkVertexInputBindingDescription, 2> getBindingDescriptions() {
+		std::array<VkVertexInputBindingDescription, 2> bindingDescriptions{};
+		bindingDescriptions[0].binding = 0;
+		bindingDescriptions[0].stride = sizeof(glm::vec3);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		bindingDescriptions[1].binding = 1;
+		bindingDescriptions[1].stride = sizeof(VertexAttributes);
+		bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return bindingDescriptions;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 1> getPositionAttributeDescription() {
+		std::array<VkVertexInputAttributeDescription, 1> attributeDescriptions{};
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescriptions[0].offset = 0;
+		return attributeDescriptions;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescriptions[0].offset = 0;
+		attributeDescriptions[1].binding = 1;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].format = VK_FORMAT_R16G16B16A16_SINT;
+		attributeDescriptions[1].offset = offsetof(VertexAttributes, normalOct);
+		attributeDescriptions[2].binding = 1;
+		attributeDescriptions[2].location = 2;
+		attributeDescriptions[2].format = VK_FORMAT_R16G16_SFLOAT;
+		attributeDescriptions[2].offset = offsetof(VertexAttributes, uv);
+		return attributeDescriptions;
+	}
+
+	// ALPHA TESTED DEPTH ONLY PASSES - THE POSITION STREAM PLUS A TIGHT HALF FLOAT UV STREAM (4 BYTES) IN PLACE OF THE ATTRIBUTE STREAM
+	static std::array<VkVertexInputBindingDescription, 2> getDepthBindingDescriptions() {
+		std::array<VkVertexInputBindingDescription, 2> bindingDescriptions{};
+		bindingDescriptions[0].binding = 0;
+		bindingDescriptions[0].stride = sizeof(glm::vec3);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		bindingDescriptions[1].binding = 1;
+		bindingDescriptions[1].stride = sizeof(VertexAttributes::uv);
+		bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return bindingDescriptions;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 2> getDepthAttributeDescription() {
+		std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescriptions[0].offset = 0;
+		attributeDescriptions[1].binding = 1;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].format = VK_FORMAT_R16G16_SFLOAT;
+		attributeDescriptions[1].offset = 0;
+		return attributeDescriptions;
+	}
+};
+
+// ONE CLUSTER OF A STATIC PRIMITIVE (MeshletBuilder) - AT MOST 64 VERTICES / 124 TRIANGLES OVER A CONTIGUOUS RUN OF THE PRIMITIVE'S INDICES. SPHERE AND
+// NORMAL CONE ARE IN THE PRIMITIVE'S OWN SPACE, A CONE CUTOFF OF 1 MEANS THE TRIANGLES FACE TOO MANY WAYS FOR BACKFACE CULLING
+struct Meshlet {
+	glm::vec4 sphere; // center xyz, radius w
+	glm::vec4 cone; // axis xyz, cutoff w
+	uint32_t firstIndex; // LOCAL TO THE PRIMITIVE
+	uint32_t triangleCount;
+	uint32_t vertexCount;
+	uint32_t pad;
+};
+
 class MeshHelper {
 public:
 	uint32_t materialIndex;
@@ -101,6 +210,7 @@ public:
 	glm::mat4 worldTransformMatrix;
 	std::vector<uint32_t> stagingIndices_ = {};
 	std::vector<Vertex> stagingVertices_ = {};
+	std::vector<Meshlet> meshlets_ = {};
 	VkDrawIndexedIndirectCommand indirectInfo;
 	int32_t globalID;
 
@@ -116,8 +226,9 @@ public:
 		vkCmdDrawIndexed(commandBuffer, indexedDrawInfo.indexCount, indexedDrawInfo.instanceCount, indexedDrawInfo.firstIndex, indexedDrawInfo.vertexOffset, indexedDrawInfo.firstInstance);
 	}
 
-	static void createVertexBuffer(DeviceHelper* pDevHelper, std::vector<Vertex>& vertices, VkBuffer& vertexBuffer_, VkDeviceMemory& vertexBufferMemory_) {
-		VkDeviceSize bufferSize = sizeof(Vertex) * vertices.size();
+	template<typename T>
+	static void createVertexBuffer(DeviceHelper* pDevHelper, std::vector<T>& vertices, VkBuffer& vertexBuffer_, VkDeviceMemory& vertexBufferMemory_, VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) {
+		VkDeviceSize bufferSize = sizeof(T) * vertices.size();
 
 		VkBuffer stagingBuffer;
 		VkDeviceMemory stagingBufferMemory;
@@ -128,7 +239,7 @@ public:
 		memcpy(data, vertices.data(), (size_t)bufferSize);
 		vkUnmapMemory(pDevHelper->device_, stagingBufferMemory);
 
-		pDevHelper->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer_, vertexBufferMemory_);
+		pDevHelper->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer_, vertexBufferMemory_);
 		pDevHelper->copyBuffer(stagingBuffer, vertexBuffer_, bufferSize);
 
 		vkDestroyBuffer(pDevHelper->device_, stagingBuffer, nullptr);
@@ -143,59 +254,3 @@ namespace std {
 		}
 	};
 }
-
-// MIKKTSPACE TANGENT FUNCTIONS, REFERENCED OFF OF: https://github.com/Eearslya/glTFView. SUCH AN AMAZING PERSON
-class MikkTSpaceHelper {
-public:
-
-	struct MikkTContext {
-		MeshHelper* mesh;
-	};
-
-	static int MikkTGetNumFaces(const SMikkTSpaceContext* context) {
-		const auto data = reinterpret_cast<const MikkTContext*>(context->m_pUserData);
-		return data->mesh->stagingVertices_.size() / 3;
-	}
-
-	static int MikkTGetNumVerticesOfFace(const SMikkTSpaceContext* context, const int face) {
-		return 3;
-	}
-
-	static void MikkTGetPosition(const SMikkTSpaceContext* context, float fvPosOut[], const int face, const int vert) {
-		const auto data = reinterpret_cast<const MikkTContext*>(context->m_pUserData);
-		const glm::vec3 pos = data->mesh->stagingVertices_[face * 3 + vert].pos;
-		fvPosOut[0] = pos.x;
-		fvPosOut[1] = pos.y;
-		fvPosOut[2] = pos.z;
-	}
-
-	static void MikkTGetNormal(const SMikkTSpaceContext* context, float fvNormOut[], const int face, const int vert) {
-		const auto data = reinterpret_cast<const MikkTContext*>(context->m_pUserData);
-		const glm::vec3 norm = data->mesh->stagingVertices_[face * 3 + vert].normal;
-		fvNormOut[0] = norm.x;
-		fvNormOut[1] = norm.y;
-		fvNormOut[2] = norm.z;
-	}
-
-	static void MikkTGetTexCoord(const SMikkTSpaceContext* context, float fvTexcOut[], const int face, const int vert) {
-		const auto data = reinterpret_cast<const MikkTContext*>(context->m_pUserData);
-		glm::vec2 uv = glm::vec2(data->mesh->stagingVertices_[face * 3 + vert].pos.w, data->mesh->stagingVertices_[face * 3 + vert].normal.w);
-		fvTexcOut[0] = uv.x;
-		fvTexcOut[1] = 1.0 - uv.y;
-	}
-
-	static void MikkTSetTSpaceBasic(
-		const SMikkTSpaceContext* context, const float fvTangent[], const float fSign, const int face, const int vert) {
-		auto data = reinterpret_cast<MikkTContext*>(context->m_pUserData);
-
-		data->mesh->stagingVertices_[static_cast<std::vector<Vertex, std::allocator<Vertex>>::size_type>(face) * 3 + vert].tangent = glm::vec4(glm::make_vec3(fvTangent), fSign);
-	}
-};
-
-static SMikkTSpaceInterface MikkTInterface = { .m_getNumFaces = MikkTSpaceHelper::MikkTGetNumFaces,
-											   .m_getNumVerticesOfFace = MikkTSpaceHelper::MikkTGetNumVerticesOfFace,
-											   .m_getPosition = MikkTSpaceHelper::MikkTGetPosition,
-											   .m_getNormal = MikkTSpaceHelper::MikkTGetNormal,
-											   .m_getTexCoord = MikkTSpaceHelper::MikkTGetTexCoord,
-											   .m_setTSpaceBasic = MikkTSpaceHelper::MikkTSetTSpaceBasic,
-											   .m_setTSpace = nullptr };
@@ -0,0 +1,307 @@
+#include "MeshOptimizer.h"
+#include <sstream>
+#include <iomanip>
+
+// FIFO POST TRANSFORM CACHE, A VERTEX IS RESIDENT WHILE FEWER THAN size NEWER VERTICES HAVE BEEN INSERTED AFTER IT
+struct FifoCache {
+    std::vector<uint32_t> timestamps;
+    uint32_t time;
+    uint32_t size;
+
+    FifoCache(size_t vertexCount, uint32_t cacheSize) : timestamps(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+
+    uint32_t touch(uint32_t vertex) {
+        if (time - timestamps[vertex] > size) {
+            timestamps[vertex] = time++;
+            return 1;
+        }
+        return 0;
+    }
+
+    void reset() {
+        time += size + 1;
+    }
+};
+
+MeshOptimizer::CacheStats MeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+    CacheStats stats{};
+    if (indices.size() < 3 || vertexCount == 0) {
+        return stats;
+    }
+
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<uint8_t> used(vertexCount, 0);
+    uint32_t misses = 0;
+    uint32_t unique = 0;
+    for (uint32_t index : indices) {
+        misses += cache.touch(index);
+        if (!used[index]) {
+            used[index] = 1;
+            unique++;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(unique);
+    return stats;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint32_t>* hardBoundaries) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // VERTEX -> TRIANGLE ADJACENCY AS ONE FLAT ARRAY
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (uint32_t index : indices) {
+        liveTriangles[index]++;
+    }
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) {
+            adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnd;
+    deadEnd.reserve(indices.size());
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    uint32_t time = CACHE_SIZE + 1;
+    size_t cursor = 0;
+    int64_t fanning = 0;
+    bool jumped = true;
+
+    while (fanning >= 0) {
+        candidates.clear();
+
+        // EMIT EVERY REMAINING TRIANGLE AROUND THE FANNING VERTEX
+        for (uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++) {
+            uint32_t t = adjacency[a];
+            if (emitted[t]) {
+                continue;
+            }
+            if (jumped && hardBoundaries) {
+                hardBoundaries->push_back(static_cast<uint32_t>(result.size() / 3));
+            }
+            jumped = false;
+            for (int k = 0; k < 3; k++) {
+                uint32_t v = indices[t * 3 + k];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (time - cacheTime[v] > CACHE_SIZE) {
+                    cacheTime[v] = time;
+                    time++;
+                }
+            }
+            emitted[t] = 1;
+        }
+
+        // NEXT FAN - THE CANDIDATE THAT HAS BEEN IN CACHE LONGEST WHILE STILL FITTING ITS REMAINING TRIANGLES BEFORE EVICTION
+        int64_t next = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates) {
+            if (liveTriangles[v] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            if (time - cacheTime[v] + 2 * liveTriangles[v] <= CACHE_SIZE) {
+                priority = time - cacheTime[v];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+
+        // DEAD END - RECENTLY EMITTED VERTICES FIRST, THEN THE NEXT UNFINISHED VERTEX IN INPUT ORDER (A CACHE RESTART, SO A HARD CLUSTER BOUNDARY)
+        if (next == -1) {
+            while (!deadEnd.empty()) {
+                uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[v] > 0) {
+                    next = v;
+                    break;
+                }
+            }
+        }
+        if (next == -1) {
+            while (cursor < vertexCount && liveTriangles[cursor] == 0) {
+                cursor++;
+            }
+            next = cursor < vertexCount ? static_cast<int64_t>(cursor) : -1;
+            jumped = true;
+        }
+
+        fanning = next;
+    }
+
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& hardBoundaries, float threshold) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    std::vector<uint32_t> hard = hardBoundaries;
+    if (hard.empty() || hard[0] != 0) {
+        hard.insert(hard.begin(), 0);
+    }
+
+    // SOFT BOUNDARIES - SPLIT A HARD CLUSTER WHEREVER ITS RUNNING ACMR HAS ALREADY FALLEN WITHIN threshold OF THE WHOLE CLUSTER'S, SO REORDERING
+    // THE PIECES COSTS AT MOST threshold IN CACHE EFFICIENCY
+    std::vector<uint32_t> clusters;
+    FifoCache cache(vertices.size(), CACHE_SIZE);
+    for (size_t h = 0; h < hard.size(); h++) {
+        uint32_t start = hard[h];
+        uint32_t end = (h + 1 < hard.size()) ? hard[h + 1] : static_cast<uint32_t>(triangleCount);
+
+        cache.reset();
+        uint32_t clusterMisses = 0;
+        for (uint32_t t = start; t < end; t++) {
+            clusterMisses += cache.touch(indices[t * 3]) + cache.touch(indices[t * 3 + 1]) + cache.touch(indices[t * 3 + 2]);
+        }
+        float targetAcmr = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+        cache.reset();
+        clusters.push_back(start);
+        uint32_t softStart = start;
+        uint32_t misses = 0;
+        for (uint32_t t = start; t < end; t++) {
+            misses += cache.touch(indices[t * 3]) + cache.touch(indices[t * 3 + 1]) + cache.touch(indices[t * 3 + 2]);
+            if (t + 1 < end && static_cast<float>(misses) <= targetAcmr * static_cast<float>(t + 1 - softStart)) {
+                clusters.push_back(t + 1);
+                cache.reset();
+                softStart = t + 1;
+                misses = 0;
+            }
+        }
+    }
+
+    if (clusters.size() < 2) {
+        return;
+    }
+
+    // AREA WEIGHTED CENTROID AND NORMAL PER CLUSTER, CLUSTERS FACING AWAY FROM THE MESH CENTRE OCCLUDE THE REST SO THEY ARE DRAWN FIRST
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    std::vector<glm::vec3> clusterCentroids(clusters.size(), glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormals(clusters.size(), glm::vec3(0.0f));
+    std::vector<float> clusterAreas(clusters.size(), 0.0f);
+
+    for (size_t c = 0; c < clusters.size(); c++) {
+        uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : static_cast<uint32_t>(triangleCount);
+        for (uint32_t t = clusters[c]; t < end; t++) {
+            glm::vec3 a = glm::vec3(vertices[indices[t * 3]].pos);
+            glm::vec3 b = glm::vec3(vertices[indices[t * 3 + 1]].pos);
+            glm::vec3 d = glm::vec3(vertices[indices[t * 3 + 2]].pos);
+            glm::vec3 n = glm::cross(b - a, d - a);
+            float area = glm::length(n);
+            glm::vec3 centre = (a + b + d) / 3.0f;
+
+            clusterCentroids[c] += centre * area;
+            clusterNormals[c] += n;
+            clusterAreas[c] += area;
+            meshCentroid += centre * area;
+            meshArea += area;
+        }
+    }
+
+    if (meshArea <= 0.0f) {
+        return;
+    }
+    meshCentroid /= meshArea;
+
+    std::vector<float> sortKeys(clusters.size(), 0.0f);
+    for (size_t c = 0; c < clusters.size(); c++) {
+        float normalLength = glm::length(clusterNormals[c]);
+        if (clusterAreas[c] <= 0.0f || normalLength <= 0.0f) {
+            continue;
+        }
+        sortKeys[c] = glm::dot(clusterCentroids[c] / clusterAreas[c] - meshCentroid, clusterNormals[c] / normalLength);
+    }
+
+    std::vector<uint32_t> order(clusters.size());
+    for (uint32_t c = 0; c < order.size(); c++) {
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t l, uint32_t r) { return sortKeys[l] > sortKeys[r]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (uint32_t c : order) {
+        uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : static_cast<uint32_t>(triangleCount);
+        result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + end * 3);
+    }
+    indices.swap(result);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (uint32_t& index : indices) {
+        if (remap[index] == UINT32_MAX) {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(reordered);
+}
+
+MeshOptimizer::Report MeshOptimizer::optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t indexBase, float overdrawThreshold) {
+    Report report{};
+    if (indices.size() < 3 || indices.size() % 3 != 0 || vertices.empty()) {
+        return report;
+    }
+
+    for (uint32_t& index : indices) {
+        if (index < indexBase || index - indexBase >= vertices.size()) {
+            // OUT OF RANGE INDICES, LEAVE THE PRIMITIVE AS IT IS (TURN BACK ANY INDICES ALREADY MADE LOCAL)
+            for (uint32_t* i = indices.data(); i != &index; i++) {
+                *i += indexBase;
+            }
+            return report;
+        }
+        index -= indexBase;
+    }
+
+    report.before = analyzeVertexCache(indices, vertices.size());
+
+    std::vector<uint32_t> hardBoundaries;
+    optimizeVertexCache(indices, vertices.size(), &hardBoundaries);
+    optimizeOverdraw(indices, vertices, hardBoundaries, overdrawThreshold);
+    optimizeVertexFetch(vertices, indices);
+
+    report.after = analyzeVertexCache(indices, vertices.size());
+    report.optimized = true;
+
+    for (uint32_t& index : indices) {
+        index += indexBase;
+    }
+    return report;
+}
+
+std::string MeshOptimizer::formatReport(const std::string& meshName, size_t primitiveIndex, const Report& report) {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(3) << "mesh optimizer: " << (meshName.empty() ? "<unnamed>" : meshName) << " [" << primitiveIndex << "] ACMR "
+         << report.before.acmr << " -> " << report.after.acmr << ", ATVR " << report.before.atvr << " -> " << report.after.atvr << "\n";
+    return line.str();
+}
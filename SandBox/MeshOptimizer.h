@@ -0,0 +1,33 @@
+#pragma once
+
+#include "MeshHelper.h"
+
+// POST WELD REORDERING OF ONE PRIMITIVE. TIPSIFY VERTEX CACHE ORDER (SANDER ET AL. 2007), THEN AN OVERDRAW PASS THAT CUTS THE RESULT INTO CLUSTERS AND
+// DRAWS THE OUTWARD FACING ONES FIRST, THEN A VERTEX FETCH REMAP SO stagingVertices_ ENDS UP IN FIRST USE ORDER
+class MeshOptimizer {
+public:
+	static constexpr uint32_t CACHE_SIZE = 16;
+
+	// ACMR - TRANSFORMED VERTICES PER TRIANGLE (0.5 IS THE LIMIT FOR A REGULAR GRID, 3 IS THE WORST), ATVR - TRANSFORMED VERTICES PER UNIQUE VERTEX (1 IS IDEAL)
+	struct CacheStats {
+		float acmr = 0.0f;
+		float atvr = 0.0f;
+	};
+
+	struct Report {
+		CacheStats before;
+		CacheStats after;
+		bool optimized = false;
+	};
+
+	// INDICES ARE OFFSET BY indexBase (THE PRIMITIVE'S FIRST VERTEX IN THE MODEL), THE SAME BASE IS PUT BACK ON RETURN. VERTICES NO TRIANGLE USES ARE DROPPED
+	static Report optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t indexBase, float overdrawThreshold = 1.05f);
+
+	// THE STAGES BELOW WORK ON LOCAL (ZERO BASED) INDICES
+	static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, std::vector<uint32_t>* hardBoundaries = nullptr);
+	static void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& hardBoundaries, float threshold);
+	static void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+	static CacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = CACHE_SIZE);
+
+	static std::string formatReport(const std::string& meshName, size_t primitiveIndex, const Report& report);
+};
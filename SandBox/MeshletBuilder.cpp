@@ -0,0 +1,121 @@
+#include "MeshletBuilder.h"
+
+std::vector<Meshlet> MeshletBuilder::build(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+    std::vector<Meshlet> meshlets;
+    meshlets.reserve(indices.size() / (MAX_TRIANGLES * 3) + 1);
+
+    // stamp[v] == meshlet id WHEN v IS ALREADY PART OF THE OPEN MESHLET
+    std::vector<uint32_t> stamp(vertices.size(), UINT32_MAX);
+    uint32_t id = 0;
+    Meshlet current{};
+
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        uint32_t a = indices[t + 0];
+        uint32_t b = indices[t + 1];
+        uint32_t c = indices[t + 2];
+
+        uint32_t newVertices = (stamp[a] != id) + (stamp[b] != id && b != a) + (stamp[c] != id && c != a && c != b);
+        if (current.triangleCount == MAX_TRIANGLES || current.vertexCount + newVertices > MAX_VERTICES) {
+            meshlets.push_back(current);
+            id++;
+            current = {};
+            current.firstIndex = static_cast<uint32_t>(t);
+            newVertices = 1 + (b != a) + (c != a && c != b);
+        }
+
+        stamp[a] = id;
+        stamp[b] = id;
+        stamp[c] = id;
+        current.vertexCount += newVertices;
+        current.triangleCount++;
+    }
+    if (current.triangleCount > 0) {
+        meshlets.push_back(current);
+    }
+
+    for (Meshlet& meshlet : meshlets) {
+        computeBounds(vertices, indices, meshlet);
+    }
+    return meshlets;
+}
+
+// SPHERE AROUND THE BOUNDING BOX CENTER. CONE AXIS IS THE AVERAGE FRONT FACE NORMAL (CCW, SAME AS THE PIPELINES), ITS CUTOFF THE SINE OF THE WIDEST
+// NORMAL'S ANGLE TO THE AXIS - A VIEW DIRECTION INSIDE THAT COMPLEMENTARY CONE SEES THE BACK OF EVERY TRIANGLE
+void MeshletBuilder::computeBounds(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Meshlet& meshlet) {
+    const uint32_t first = meshlet.firstIndex;
+    const uint32_t last = first + meshlet.triangleCount * 3;
+
+    glm::vec3 minPos = glm::vec3(vertices[indices[first]].pos);
+    glm::vec3 maxPos = minPos;
+    for (uint32_t i = first; i < last; i++) {
+        glm::vec3 pos = glm::vec3(vertices[indices[i]].pos);
+        minPos = glm::min(minPos, pos);
+        maxPos = glm::max(maxPos, pos);
+    }
+
+    glm::vec3 center = (minPos + maxPos) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t i = first; i < last; i++) {
+        radius = std::max(radius, glm::length(glm::vec3(vertices[indices[i]].pos) - center));
+    }
+    meshlet.sphere = glm::vec4(center, radius);
+
+    std::vector<glm::vec3> normals;
+    normals.reserve(meshlet.triangleCount);
+    glm::vec3 axis = glm::vec3(0.0f);
+    for (uint32_t i = first; i < last; i += 3) {
+        glm::vec3 p0 = glm::vec3(vertices[indices[i + 0]].pos);
+        glm::vec3 p1 = glm::vec3(vertices[indices[i + 1]].pos);
+        glm::vec3 p2 = glm::vec3(vertices[indices[i + 2]].pos);
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float area = glm::length(normal);
+        // DEGENERATE TRIANGLES NEVER RASTERISE, THEY DON'T CONSTRAIN THE CONE
+        if (area > 0.0f) {
+            normals.push_back(normal / area);
+            axis += normal / area;
+        }
+    }
+
+    meshlet.cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    float axisLength = glm::length(axis);
+    if (normals.empty() || axisLength <= 0.0f) {
+        return;
+    }
+    axis /= axisLength;
+
+    float minDot = 1.0f;
+    for (const glm::vec3& normal : normals) {
+        minDot = std::min(minDot, glm::dot(normal, axis));
+    }
+    if (minDot <= MIN_CONE_DOT) {
+        meshlet.cone = glm::vec4(axis, 1.0f);
+        return;
+    }
+    meshlet.cone = glm::vec4(axis, std::sqrt(1.0f - minDot * minDot));
+}
+
+bool MeshletBuilder::clusterVisible(const Meshlet& meshlet, const glm::mat4& model, const glm::vec4 frustumPlanes[6], const glm::vec3& cameraPosition) {
+    glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(meshlet.sphere), 1.0f));
+    float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    float radius = meshlet.sphere.w * scale;
+
+    for (int i = 0; i < 6; i++) {
+        if (glm::dot(glm::vec4(center, 1.0f), frustumPlanes[i]) + radius < 0.0f) {
+            return false;
+        }
+    }
+
+    if (meshlet.cone.w < 1.0f) {
+        glm::mat3 basis = glm::mat3(model);
+        glm::vec3 axis = glm::normalize(basis * glm::vec3(meshlet.cone));
+        // A MIRRORING MATRIX FLIPS THE WINDING, THE FRONT FACES ARE THEN THE OTHER SIDE
+        if (glm::determinant(basis) < 0.0f) {
+            axis = -axis;
+        }
+        glm::vec3 toCenter = center - cameraPosition;
+        if (glm::dot(toCenter, axis) >= meshlet.cone.w * glm::length(toCenter) + radius) {
+            return false;
+        }
+    }
+    return true;
+}
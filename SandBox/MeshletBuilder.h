@@ -0,0 +1,22 @@
+#pragma once
+
+#include "MeshHelper.h"
+
+// SPLITS A STATIC PRIMITIVE INTO MESHLETS FOR clusterCull.comp. THE PRIMITIVE'S TRIANGLES ARE TAKEN IN THE ORDER MeshOptimizer LEFT THEM (ALREADY
+// VERTEX CACHE LOCAL) AND CUT GREEDILY, SO EVERY MESHLET IS A CONTIGUOUS INDEX RANGE AND THE UNCLUSTERED DRAW OF THE PRIMITIVE STAYS VALID AS IS
+class MeshletBuilder {
+public:
+	static constexpr uint32_t MAX_VERTICES = 64;
+	static constexpr uint32_t MAX_TRIANGLES = 124;
+	// BELOW THIS MIN(DOT(NORMAL, AXIS)) THE CONE IS TOO WIDE TO EVER CULL ANYTHING AND IS LEFT DISABLED
+	static constexpr float MIN_CONE_DOT = 0.1f;
+
+	static std::vector<Meshlet> build(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+
+	// CPU REFERENCE OF clusterCull.comp - SPHERE AGAINST THE SIX WORLD SPACE PLANES, THEN THE NORMAL CONE AGAINST THE CAMERA POSITION. THE CONE ASSUMES
+	// A UNIFORMLY SCALED (OR MIRRORED) MODEL MATRIX
+	static bool clusterVisible(const Meshlet& meshlet, const glm::mat4& model, const glm::vec4 frustumPlanes[6], const glm::vec3& cameraPosition);
+
+private:
+	static void computeBounds(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Meshlet& meshlet);
+};
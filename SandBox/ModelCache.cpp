@@ -0,0 +1,353 @@
+#include "ModelCache.h"
+#include <json.hpp>
+
+#define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES
+
+using json = nlohmann::json;
+
+static constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+static constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+
+template<typename T>
+static void writeArray(std::ofstream& file, const T* data, size_t count) {
+    if (count > 0) {
+        file.write(reinterpret_cast<const char*>(data), sizeof(T) * count);
+    }
+}
+
+template<typename T>
+static bool readArray(const char*& cursor, const char* end, T* data, size_t count) {
+    size_t byteSize = sizeof(T) * count;
+    if (static_cast<size_t>(end - cursor) < byteSize) {
+        return false;
+    }
+    if (count > 0) {
+        memcpy(data, cursor, byteSize);
+    }
+    cursor += byteSize;
+    return true;
+}
+
+static uint64_t fnv1a(const char* data, size_t size, uint64_t hash) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::string ModelCache::cachePath(const std::string& gltfPath) {
+    return gltfPath + ".orchidcache";
+}
+
+// HASHES THE SOURCE FILE CONTENTS, THEN MIXES IN THE NAME, SIZE AND WRITE TIME OF EVERY EXTERNAL BUFFER AND IMAGE THE JSON REFERENCES. ONLY
+// THOSE FILES COUNT, SO THE .orchidcache/.orchidclip/.otex FILES WRITTEN NEXT TO THE SOURCE (ALSO BY OTHER MODELS LOADING IN PARALLEL) NEVER
+// CHANGE THE HASH
+uint64_t ModelCache::hashSource(const std::string& gltfPath) {
+    std::ifstream file(gltfPath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    std::vector<char> contents(fileSize);
+    file.seekg(0);
+    file.read(contents.data(), fileSize);
+
+    uint64_t hash = fnv1a(contents.data(), contents.size(), 0xcbf29ce484222325ULL);
+
+    // A .glb KEEPS ITS JSON IN THE FIRST CHUNK, A .gltf IS ALL JSON
+    const char* jsonBegin = contents.data();
+    size_t jsonSize = contents.size();
+    uint32_t header[5] = {};
+    if (contents.size() >= sizeof(header)) {
+        memcpy(header, contents.data(), sizeof(header));
+    }
+    if (header[0] == GLB_MAGIC) {
+        if (header[4] != GLB_CHUNK_JSON || header[3] > contents.size() - sizeof(header)) {
+            return hash;
+        }
+        jsonBegin += sizeof(header);
+        jsonSize = header[3];
+    }
+
+    json doc = json::parse(jsonBegin, jsonBegin + jsonSize, nullptr, false);
+    if (doc.is_discarded()) {
+        return hash;
+    }
+
+    std::filesystem::path baseDir = std::filesystem::path(gltfPath).parent_path();
+    std::error_code ec;
+    for (const char* section : { "buffers", "images" }) {
+        auto it = doc.find(section);
+        if (it == doc.end() || !it->is_array()) {
+            continue;
+        }
+        for (const json& entry : *it) {
+            auto uri = entry.find("uri");
+            if (uri == entry.end() || !uri->is_string() || tinygltf::IsDataURI(uri->get<std::string>())) {
+                continue;
+            }
+            std::string name;
+            if (!tinygltf::URIDecode(uri->get<std::string>(), &name, nullptr)) {
+                name = uri->get<std::string>();
+            }
+            std::filesystem::path referenced = baseDir / name;
+            uint64_t size = std::filesystem::file_size(referenced, ec);
+            int64_t time = std::filesystem::last_write_time(referenced, ec).time_since_epoch().count();
+            hash = fnv1a(name.data(), name.size(), hash);
+            hash = fnv1a(reinterpret_cast<const char*>(&size), sizeof(size), hash);
+            hash = fnv1a(reinterpret_cast<const char*>(&time), sizeof(time), hash);
+        }
+    }
+
+    return hash;
+}
+
+void ModelCache::flattenNode(GLTFObj::SceneNode* node, int32_t parent, uint32_t globalIndexOffset, std::vector<CachedNode>& nodes, std::vector<CachedPrimitive>& primitives, std::vector<Meshlet>& meshlets) {
+    CachedNode cn{};
+    cn.worldTransform = node->worldTransform;
+    cn.parent = parent;
+    cn.firstPrimitive = static_cast<uint32_t>(primitives.size());
+    cn.primitiveCount = static_cast<uint32_t>(node->meshPrimitives.size());
+
+    for (MeshHelper* p : node->meshPrimitives) {
+        CachedPrimitive cp{};
+        cp.materialIndex = p->materialIndex;
+        cp.firstIndex = p->indirectInfo.firstIndex - globalIndexOffset;
+        cp.indexCount = p->indirectInfo.indexCount;
+        cp.meshletCount = static_cast<uint32_t>(p->meshlets_.size());
+        primitives.push_back(cp);
+        meshlets.insert(meshlets.end(), p->meshlets_.begin(), p->meshlets_.end());
+    }
+
+    int32_t nodeIndex = static_cast<int32_t>(nodes.size());
+    nodes.push_back(cn);
+
+    for (GLTFObj::SceneNode* child : node->children) {
+        flattenNode(child, nodeIndex, globalIndexOffset, nodes, primitives, meshlets);
+    }
+}
+
+void ModelCache::write(GLTFObj* obj, uint64_t sourceHash, uint32_t globalIndexOffset) {
+    std::vector<CachedNode> nodes;
+    std::vector<CachedPrimitive> primitives;
+    std::vector<Meshlet> meshlets;
+    for (GLTFObj::SceneNode* node : obj->pParentNodes) {
+        flattenNode(node, -1, globalIndexOffset, nodes, primitives, meshlets);
+    }
+
+    std::vector<CachedMaterial> materials(obj->mats_.size());
+    for (size_t i = 0; i < obj->mats_.size(); i++) {
+        const Material& m = obj->mats_[i];
+        CachedMaterial& cm = materials[i];
+        cm.baseColor = m.baseColor;
+        cm.baseColorTexIndex = m.baseColorTexIndex;
+        cm.normalTexIndex = m.normalTexIndex;
+        cm.metallicRoughnessIndex = m.metallicRoughnessIndex;
+        cm.aoIndex = m.aoIndex;
+        cm.emissionIndex = m.emissionIndex;
+        cm.alphaCutOff = m.alphaCutOff;
+        cm.doubleSides = m.doubleSides ? 1 : 0;
+        strncpy_s(cm.alphaMode, m.alphaMode.c_str(), sizeof(cm.alphaMode) - 1);
+    }
+
+    const std::vector<tinygltf::Image>& gltfImages = obj->pInputModel_->images;
+    std::vector<CachedImage> images(gltfImages.size());
+    uint64_t imageBytes = 0;
+    for (size_t i = 0; i < gltfImages.size(); i++) {
+        images[i].width = gltfImages[i].width;
+        images[i].height = gltfImages[i].height;
+        images[i].component = gltfImages[i].component;
+        images[i].bits = gltfImages[i].bits;
+        images[i].byteSize = gltfImages[i].image.size();
+        imageBytes += images[i].byteSize;
+    }
+
+    std::vector<VkFormat> imageFormats(obj->images_.size());
+    for (size_t i = 0; i < obj->images_.size(); i++) {
+        imageFormats[i] = obj->images_[i]->imageFormat_;
+    }
+
+    Header header{};
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.sourceHash = sourceHash;
+    header.vertexStride = sizeof(Vertex);
+    header.vertexCount = static_cast<uint32_t>(obj->vertices_.size());
+    header.indexCount = static_cast<uint32_t>(obj->indices_.size());
+    header.nodeCount = static_cast<uint32_t>(nodes.size());
+    header.primitiveCount = static_cast<uint32_t>(primitives.size());
+    header.materialCount = static_cast<uint32_t>(materials.size());
+    header.textureIndexCount = static_cast<uint32_t>(obj->textureIndices_.size());
+    header.imageCount = static_cast<uint32_t>(images.size());
+    header.imageFormatCount = static_cast<uint32_t>(imageFormats.size());
+    header.hasImages = obj->images_.empty() ? 0 : 1;
+    header.imagesEncoded = obj->streamTextures_ ? 1 : 0;
+    header.meshOptimized = obj->optimizeMeshes_ ? 1 : 0;
+    header.weldEpsilon = obj->weldEpsilon_;
+    header.meshletCount = static_cast<uint32_t>(meshlets.size());
+    header.totalSize = sizeof(Header)
+        + sizeof(Vertex) * header.vertexCount
+        + sizeof(uint32_t) * header.indexCount
+        + sizeof(CachedNode) * header.nodeCount
+        + sizeof(CachedPrimitive) * header.primitiveCount
+        + sizeof(Meshlet) * header.meshletCount
+        + sizeof(CachedMaterial) * header.materialCount
+        + sizeof(int32_t) * header.textureIndexCount
+        + sizeof(CachedImage) * header.imageCount
+        + sizeof(VkFormat) * header.imageFormatCount
+        + imageBytes;
+
+    std::ofstream file(cachePath(obj->gltfPath_), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "could not write model cache for: " << obj->gltfPath_ << std::endl;
+        return;
+    }
+
+    writeArray(file, &header, 1);
+    writeArray(file, obj->vertices_.data(), obj->vertices_.size());
+    writeArray(file, obj->indices_.data(), obj->indices_.size());
+    writeArray(file, nodes.data(), nodes.size());
+    writeArray(file, primitives.data(), primitives.size());
+    writeArray(file, meshlets.data(), meshlets.size());
+    writeArray(file, materials.data(), materials.size());
+    writeArray(file, obj->textureIndices_.data(), obj->textureIndices_.size());
+    writeArray(file, images.data(), images.size());
+    writeArray(file, imageFormats.data(), imageFormats.size());
+    for (const tinygltf::Image& image : gltfImages) {
+        writeArray(file, image.image.data(), image.image.size());
+    }
+
+    std::cout << "wrote model cache: " << cachePath(obj->gltfPath_) << " (" << header.totalSize << " bytes)" << std::endl;
+}
+
+bool ModelCache::read(GLTFObj* obj, uint64_t sourceHash, uint32_t globalVertexOffset, uint32_t globalIndexOffset) {
+    std::ifstream file(cachePath(obj->gltfPath_), std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    if (fileSize < sizeof(Header)) {
+        return false;
+    }
+
+    std::vector<char> blob(fileSize);
+    file.seekg(0);
+    file.read(blob.data(), fileSize);
+
+    Header header;
+    memcpy(&header, blob.data(), sizeof(Header));
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.sourceHash != sourceHash || header.vertexStride != sizeof(Vertex) || header.totalSize != fileSize || header.imagesEncoded != (obj->streamTextures_ ? 1u : 0u) || header.meshOptimized != (obj->optimizeMeshes_ ? 1u : 0u) || header.weldEpsilon != obj->weldEpsilon_) {
+        std::cout << "model cache out of date, rebuilding: " << obj->gltfPath_ << std::endl;
+        return false;
+    }
+
+    const char* cursor = blob.data() + sizeof(Header);
+    const char* end = blob.data() + blob.size();
+
+    std::vector<CachedNode> nodes(header.nodeCount);
+    std::vector<CachedPrimitive> primitives(header.primitiveCount);
+    std::vector<Meshlet> meshlets(header.meshletCount);
+    std::vector<CachedMaterial> materials(header.materialCount);
+    std::vector<CachedImage> images(header.imageCount);
+    std::vector<VkFormat> imageFormats(header.imageFormatCount);
+
+    obj->vertices_.resize(header.vertexCount);
+    obj->indices_.resize(header.indexCount);
+    obj->textureIndices_.resize(header.textureIndexCount);
+
+    bool ok = readArray(cursor, end, obj->vertices_.data(), obj->vertices_.size())
+        && readArray(cursor, end, obj->indices_.data(), obj->indices_.size())
+        && readArray(cursor, end, nodes.data(), nodes.size())
+        && readArray(cursor, end, primitives.data(), primitives.size())
+        && readArray(cursor, end, meshlets.data(), meshlets.size())
+        && readArray(cursor, end, materials.data(), materials.size())
+        && readArray(cursor, end, obj->textureIndices_.data(), obj->textureIndices_.size())
+        && readArray(cursor, end, images.data(), images.size())
+        && readArray(cursor, end, imageFormats.data(), imageFormats.size());
+
+    if (!ok) {
+        std::cout << "model cache truncated, rebuilding: " << obj->gltfPath_ << std::endl;
+        obj->vertices_.clear();
+        obj->indices_.clear();
+        obj->textureIndices_.clear();
+        return false;
+    }
+
+    // ONLY THE IMAGES ARE HANDED BACK TO TINYGLTF SO TextureHelper CAN UPLOAD THEM EXACTLY AS IT DOES FOR A PARSED MODEL,
+    // THE MODEL IS FREED BY GLTFObj::uploadTextures ONCE THE IMAGES ARE ON THE GPU
+    obj->pInputModel_ = new tinygltf::Model();
+    obj->pInputModel_->images.resize(header.imageCount);
+    for (size_t i = 0; i < images.size(); i++) {
+        tinygltf::Image& image = obj->pInputModel_->images[i];
+        image.width = images[i].width;
+        image.height = images[i].height;
+        image.component = images[i].component;
+        image.bits = images[i].bits;
+        image.image.resize(images[i].byteSize);
+        readArray(cursor, end, image.image.data(), image.image.size());
+    }
+
+    obj->mats_.resize(header.materialCount);
+    for (size_t i = 0; i < materials.size(); i++) {
+        const CachedMaterial& cm = materials[i];
+        Material& m = obj->mats_[i];
+        m.baseColor = cm.baseColor;
+        m.baseColorTexIndex = cm.baseColorTexIndex;
+        m.normalTexIndex = cm.normalTexIndex;
+        m.metallicRoughnessIndex = cm.metallicRoughnessIndex;
+        m.aoIndex = cm.aoIndex;
+        m.emissionIndex = cm.emissionIndex;
+        m.alphaCutOff = cm.alphaCutOff;
+        m.doubleSides = cm.doubleSides != 0;
+        m.alphaMode = std::string(cm.alphaMode);
+    }
+
+    if (header.hasImages) {
+        obj->loadImages();
+        for (size_t i = 0; i < obj->images_.size() && i < imageFormats.size(); i++) {
+            obj->images_[i]->imageFormat_ = imageFormats[i];
+        }
+    }
+
+    std::vector<GLTFObj::SceneNode*> sceneNodes(header.nodeCount);
+    uint32_t nextMeshlet = 0;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const CachedNode& cn = nodes[i];
+        GLTFObj::SceneNode* scNode = new GLTFObj::SceneNode{};
+        scNode->worldTransform = cn.worldTransform;
+        scNode->parent = cn.parent >= 0 ? sceneNodes[cn.parent] : nullptr;
+
+        for (uint32_t j = cn.firstPrimitive; j < cn.firstPrimitive + cn.primitiveCount; j++) {
+            const CachedPrimitive& cp = primitives[j];
+            MeshHelper* p = new MeshHelper();
+            p->indirectInfo.firstIndex = cp.firstIndex + globalIndexOffset;
+            p->indirectInfo.indexCount = cp.indexCount;
+            p->indirectInfo.firstInstance = 0;
+            p->indirectInfo.instanceCount = 1;
+            p->indirectInfo.vertexOffset = globalVertexOffset;
+            p->worldTransformMatrix = scNode->worldTransform;
+            p->materialIndex = cp.materialIndex;
+            if (nextMeshlet + cp.meshletCount <= meshlets.size()) {
+                p->meshlets_.assign(meshlets.begin() + nextMeshlet, meshlets.begin() + nextMeshlet + cp.meshletCount);
+            }
+            nextMeshlet += cp.meshletCount;
+            scNode->meshPrimitives.push_back(p);
+        }
+
+        sceneNodes[i] = scNode;
+        if (scNode->parent) {
+            scNode->parent->children.push_back(scNode);
+        }
+        else {
+            obj->pParentNodes.push_back(scNode);
+        }
+    }
+
+    obj->totalVertices_ = header.vertexCount;
+    obj->totalIndices_ = header.indexCount;
+
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "GLTFObject.h"
+
+// COOKED MODEL CACHE - A FLAT BINARY COPY OF EVERYTHING GLTFObj BUILDS AT LOAD TIME (WELDED VERTICES/INDICES, NODE HIERARCHY, PER PRIMITIVE
+// DRAW INFO, MATERIALS AND IMAGES). EVERY SECTION IS A POD ARRAY BEHIND THE HEADER SO A LOAD IS ONE READ AND A HANDFUL OF MEMCPYS.
+class ModelCache {
+public:
+	static constexpr uint32_t CACHE_MAGIC = 0x4D43524F; // "ORCM"
+	static constexpr uint32_t CACHE_VERSION = 6;
+
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceHash;
+		uint64_t totalSize;
+		uint32_t vertexStride;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t nodeCount;
+		uint32_t primitiveCount;
+		uint32_t materialCount;
+		uint32_t textureIndexCount;
+		uint32_t imageCount;
+		uint32_t imageFormatCount;
+		uint32_t hasImages;
+		uint32_t imagesEncoded; // PNG/JPG AS STREAMING KEEPS THEM, OTHERWISE DECODED PIXELS. A CACHE WRITTEN THE OTHER WAY IS REBUILT
+		uint32_t meshOptimized;
+		float weldEpsilon;
+		uint32_t meshletCount;
+	};
+
+	// NODES ARE STORED PRE-ORDER SO A PARENT IS ALWAYS REBUILT BEFORE ITS CHILDREN
+	struct CachedNode {
+		glm::mat4 worldTransform;
+		int32_t parent;
+		uint32_t firstPrimitive;
+		uint32_t primitiveCount;
+		uint32_t pad;
+	};
+
+	// FIRST INDEX IS LOCAL TO THE MODEL, THE GLOBAL OFFSETS ARE ADDED BACK ON LOAD. MESHLETS ARE STORED BACK TO BACK IN PRIMITIVE ORDER
+	struct CachedPrimitive {
+		uint32_t materialIndex;
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		uint32_t meshletCount;
+	};
+
+	struct CachedMaterial {
+		glm::vec4 baseColor;
+		uint32_t baseColorTexIndex;
+		uint32_t normalTexIndex;
+		uint32_t metallicRoughnessIndex;
+		uint32_t aoIndex;
+		uint32_t emissionIndex;
+		float alphaCutOff;
+		uint32_t doubleSides;
+		char alphaMode[16];
+	};
+
+	struct CachedImage {
+		int32_t width;
+		int32_t height;
+		int32_t component;
+		int32_t bits;
+		uint64_t byteSize;
+	};
+
+	static std::string cachePath(const std::string& gltfPath);
+	static uint64_t hashSource(const std::string& gltfPath);
+
+	static bool read(GLTFObj* obj, uint64_t sourceHash, uint32_t globalVertexOffset, uint32_t globalIndexOffset);
+	static void write(GLTFObj* obj, uint64_t sourceHash, uint32_t globalIndexOffset);
+
+private:
+	static void flattenNode(GLTFObj::SceneNode* node, int32_t parent, uint32_t globalIndexOffset, std::vector<CachedNode>& nodes, std::vector<CachedPrimitive>& primitives, std::vector<Meshlet>& meshlets);
+};
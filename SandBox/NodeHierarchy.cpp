@@ -0,0 +1,34 @@
+#include "NodeHierarchy.h"
+
+uint32_t NodeHierarchy::addNode(int32_t parent, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale, const glm::mat4& matrix) {
+    uint32_t index = static_cast<uint32_t>(parents_.size());
+    parents_.push_back(parent);
+    translations_.push_back(translation);
+    rotations_.push_back(rotation);
+    scales_.push_back(scale);
+    matrices_.push_back(matrix);
+    worldMatrices_.push_back(glm::mat4(1.0f));
+    return index;
+}
+
+// T * R * S BUILT IN PLACE, THE SAME AS glm::translate(T) * glm::mat4(R) * glm::scale(S) WITHOUT THE TWO FULL MATRIX MULTIPLIES
+glm::mat4 NodeHierarchy::localMatrix(uint32_t node) const {
+    glm::mat3 rotation = glm::mat3_cast(rotations_[node]);
+    const glm::vec3& scale = scales_[node];
+    glm::mat4 local(glm::vec4(rotation[0] * scale.x, 0.0f), glm::vec4(rotation[1] * scale.y, 0.0f), glm::vec4(rotation[2] * scale.z, 0.0f), glm::vec4(translations_[node], 1.0f));
+    return local * matrices_[node];
+}
+
+void NodeHierarchy::updateWorldMatrices() {
+    for (size_t i = 0; i < parents_.size(); i++) {
+        int32_t parent = parents_[i];
+        worldMatrices_[i] = parent < 0 ? localMatrix(static_cast<uint32_t>(i)) : worldMatrices_[parent] * localMatrix(static_cast<uint32_t>(i));
+    }
+}
+
+void NodeHierarchy::updateWorldMatrices(const std::vector<uint32_t>& nodes) {
+    for (uint32_t node : nodes) {
+        int32_t parent = parents_[node];
+        worldMatrices_[node] = parent < 0 ? localMatrix(node) : worldMatrices_[parent] * localMatrix(node);
+    }
+}
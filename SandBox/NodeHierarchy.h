@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// A glTF NODE TREE FLATTENED INTO PARALLEL ARRAYS. NODES ARE ADDED PARENTS FIRST, SO updateWorldMatrices IS ONE LINEAR PASS (world = world[parent] * local)
+// INSTEAD OF WALKING THE PARENT CHAIN AGAIN FOR EVERY NODE THAT NEEDS ITS WORLD MATRIX. ANIMATION CHANNELS WRITE THE LOCAL TRS ARRAYS DIRECTLY
+class NodeHierarchy {
+public:
+	std::vector<int32_t> parents_; // -1 FOR ROOTS, OTHERWISE ALWAYS LESS THAN THE NODE'S OWN INDEX
+	std::vector<glm::vec3> translations_;
+	std::vector<glm::quat> rotations_;
+	std::vector<glm::vec3> scales_;
+	std::vector<glm::mat4> matrices_; // THE NODE'S glTF matrix, APPLIED AFTER TRS
+	std::vector<glm::mat4> worldMatrices_;
+
+	// RETURNS THE NEW NODE'S INDEX, parent HAS TO HAVE BEEN ADDED ALREADY
+	uint32_t addNode(int32_t parent, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale, const glm::mat4& matrix);
+	size_t size() const { return parents_.size(); }
+
+	glm::mat4 localMatrix(uint32_t node) const;
+	void updateWorldMatrices();
+	// THE SAME PASS OVER nodes ONLY, IN INCREASING ORDER AND HOLDING THE PARENT OF EVERY NODE IN IT. THE OTHER NODES KEEP THEIR LAST WORLD MATRICES
+	void updateWorldMatrices(const std::vector<uint32_t>& nodes);
+};
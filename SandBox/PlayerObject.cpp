@@ -8,28 +8,20 @@ PlayerObject::PlayerObject(physx::PxMaterial* material, physx::PxScene* pScene)
 	this->setupPhysicsController();
 }
 
+// THE CLIPS ARE PICKED BY playerGameObject'S STATE MACHINE FROM THE speed PARAMETER, SEE loopUpdate
 void PlayerObject::transitionState(PLAYERSTATE newState) {
 	previousState = currentState;
-	playerGameObject->previousAnimation = playerGameObject->activeAnimation;
+	currentState = newState;
 	switch(newState) {
-	case PLAYERSTATE::IDLE:
-		currentState = PLAYERSTATE::IDLE;
-		playerGameObject->activeAnimation = &(playerGameObject->renderTarget->idleAnim);
-		break;
 	case PLAYERSTATE::WALKING:
-		currentState = PLAYERSTATE::WALKING;
 		currentSpeed = playerWalkSpeed;
-		playerGameObject->activeAnimation = &(playerGameObject->renderTarget->walkAnim);
 		break;
 	case PLAYERSTATE::RUNNING:
-		currentState = PLAYERSTATE::RUNNING;
 		currentSpeed = playerRunSpeed;
-		playerGameObject->activeAnimation = &(playerGameObject->renderTarget->runAnim);
 		break;
 	default:
 		break;
 	}
-	playerGameObject->needsSmooth = true;
 }
 
 void PlayerObject::setupPhysicsController() {
@@ -98,6 +90,10 @@ void PlayerObject::loopUpdate(FPSCam* camera) {
 			currentSpeed = 0.0f;
 		}
 
+		// EASED, SO THE WALK / RUN BLEND SPACE SLIDES BETWEEN THE TWO INSTEAD OF SNAPPING
+		animationSpeed = Time::lerp(animationSpeed, currentSpeed, std::min(1.0f, Time::getDeltaTime() * speedBlendRate));
+		playerGameObject->stateMachine_.setParameter(speedParameter, animationSpeed);
+
 		physx::PxFilterData filterData;
 		filterData.word0 = 0;
 		physx::PxControllerFilters data;
@@ -33,6 +33,9 @@ public:
 	float playerWalkSpeed = 0.0065f;
 	float playerRunSpeed = 0.0130f;
 	float currentSpeed = 0.0065f;
+	float animationSpeed = 0.0f;
+	float speedBlendRate = 10.0f;
+	int32_t speedParameter = -1; // playerGameObject->stateMachine_'S speed
 	AnimatedGameObject* playerGameObject;
 
 	inline glm::vec3 PxVec3toGlmVec3(physx::PxExtendedVec3 vec) {
@@ -0,0 +1,177 @@
+#include "PoseBlender.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+// QUATERNIONS AS xyzw vec4, THE LAYOUT CompiledAnimation SAMPLES
+static glm::vec4 quatMultiply(const glm::vec4& a, const glm::vec4& b) {
+    return glm::vec4(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                     a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                     a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                     a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+static glm::vec4 nlerp(const glm::vec4& a, const glm::vec4& b, float t) {
+    glm::vec4 target = glm::dot(a, b) < 0.0f ? -b : b;
+    glm::vec4 q = a + (target - a) * t;
+    float length = glm::length(q);
+    return length > 0.0f ? q / length : a;
+}
+
+void PoseBlender::restPose(const NodeHierarchy& hierarchy, glm::vec4* pose) {
+    for (size_t n = 0; n < hierarchy.size(); n++) {
+        const glm::quat& r = hierarchy.rotations_[n];
+        pose[n * VALUES_PER_NODE + 0] = glm::vec4(hierarchy.translations_[n], 0.0f);
+        pose[n * VALUES_PER_NODE + 1] = glm::vec4(r.x, r.y, r.z, r.w);
+        pose[n * VALUES_PER_NODE + 2] = glm::vec4(hierarchy.scales_[n], 0.0f);
+    }
+}
+
+void PoseBlender::applyPose(const glm::vec4* pose, NodeHierarchy& hierarchy) {
+    for (size_t n = 0; n < hierarchy.size(); n++) {
+        const glm::vec4& r = pose[n * VALUES_PER_NODE + 1];
+        hierarchy.translations_[n] = glm::vec3(pose[n * VALUES_PER_NODE + 0]);
+        hierarchy.rotations_[n] = glm::quat(r.w, r.x, r.y, r.z);
+        hierarchy.scales_[n] = glm::vec3(pose[n * VALUES_PER_NODE + 2]);
+    }
+}
+
+void PoseBlender::sampleClip(const CompiledAnimation& clip, float time, uint32_t* cursors, float* laneScratch, const glm::vec4* rest, size_t nodeCount, glm::vec4* trackScratch, glm::vec4* pose) {
+    memcpy(pose, rest, sizeof(glm::vec4) * nodeCount * VALUES_PER_NODE);
+    clip.sample(time, trackScratch, cursors, laneScratch);
+    for (size_t t = 0; t < clip.tracks_.size(); t++) {
+        const CompiledAnimation::Track& track = clip.tracks_[t];
+        uint32_t slot = track.path == CompiledAnimation::Path::TRANSLATION ? 0 : (track.path == CompiledAnimation::Path::ROTATION ? 1 : 2);
+        pose[track.node * VALUES_PER_NODE + slot] = trackScratch[t];
+    }
+}
+
+void PoseBlender::blend(const glm::vec4* const* poses, const float* weights, uint32_t count, size_t nodeCount, glm::vec4* out) {
+    float total = 0.0f;
+    for (uint32_t i = 0; i < count; i++) {
+        total += weights[i];
+    }
+    if (count == 0 || total <= 0.0f) {
+        if (count > 0 && out != poses[0]) {
+            memcpy(out, poses[0], sizeof(glm::vec4) * nodeCount * VALUES_PER_NODE);
+        }
+        return;
+    }
+
+    for (size_t n = 0; n < nodeCount; n++) {
+        const size_t v = n * VALUES_PER_NODE;
+        const glm::vec4 hemisphere = poses[0][v + 1];
+        glm::vec4 translation(0.0f);
+        glm::vec4 rotation(0.0f);
+        glm::vec4 scale(0.0f);
+        for (uint32_t i = 0; i < count; i++) {
+            const float w = weights[i] / total;
+            const glm::vec4& q = poses[i][v + 1];
+            translation += poses[i][v + 0] * w;
+            rotation += (glm::dot(q, hemisphere) < 0.0f ? -q : q) * w;
+            scale += poses[i][v + 2] * w;
+        }
+        float length = glm::length(rotation);
+        out[v + 0] = translation;
+        out[v + 1] = length > 0.0f ? rotation / length : hemisphere;
+        out[v + 2] = scale;
+    }
+}
+
+void PoseBlender::blendMasked(const glm::vec4* base, const glm::vec4* layer, float weight, const float* boneWeights, size_t nodeCount, glm::vec4* out) {
+    for (size_t n = 0; n < nodeCount; n++) {
+        const size_t v = n * VALUES_PER_NODE;
+        const float w = weight * (boneWeights != nullptr ? boneWeights[n] : 1.0f);
+        out[v + 0] = glm::mix(base[v + 0], layer[v + 0], w);
+        out[v + 1] = nlerp(base[v + 1], layer[v + 1], w);
+        out[v + 2] = glm::mix(base[v + 2], layer[v + 2], w);
+    }
+}
+
+void PoseBlender::addAdditive(const glm::vec4* base, const glm::vec4* layer, const glm::vec4* reference, float weight, const float* boneWeights, size_t nodeCount, glm::vec4* out) {
+    const glm::vec4 identity(0.0f, 0.0f, 0.0f, 1.0f);
+    for (size_t n = 0; n < nodeCount; n++) {
+        const size_t v = n * VALUES_PER_NODE;
+        const float w = weight * (boneWeights != nullptr ? boneWeights[n] : 1.0f);
+        if (w <= 0.0f) {
+            if (out != base) {
+                out[v + 0] = base[v + 0];
+                out[v + 1] = base[v + 1];
+                out[v + 2] = base[v + 2];
+            }
+            continue;
+        }
+
+        const glm::vec4& r = reference[v + 1];
+        glm::vec4 delta = quatMultiply(glm::vec4(-r.x, -r.y, -r.z, r.w), layer[v + 1]);
+        glm::vec3 ratio(1.0f);
+        for (int c = 0; c < 3; c++) {
+            if (std::abs(reference[v + 2][c]) > 1e-6f) {
+                ratio[c] = layer[v + 2][c] / reference[v + 2][c];
+            }
+        }
+
+        out[v + 0] = base[v + 0] + (layer[v + 0] - reference[v + 0]) * w;
+        out[v + 1] = glm::normalize(quatMultiply(base[v + 1], nlerp(identity, delta, w)));
+        out[v + 2] = base[v + 2] * glm::vec4(glm::mix(glm::vec3(1.0f), ratio, w), 0.0f);
+    }
+}
+
+void PoseBlender::blendSpace1D(const float* positions, uint32_t count, float parameter, float* weights) {
+    int32_t below = -1;
+    int32_t above = -1;
+    for (uint32_t i = 0; i < count; i++) {
+        weights[i] = 0.0f;
+        if (positions[i] <= parameter && (below < 0 || positions[i] > positions[below])) {
+            below = static_cast<int32_t>(i);
+        }
+        if (positions[i] >= parameter && (above < 0 || positions[i] < positions[above])) {
+            above = static_cast<int32_t>(i);
+        }
+    }
+
+    if (below < 0 || above < 0 || below == above) {
+        int32_t only = below >= 0 ? below : above;
+        if (only >= 0) {
+            weights[only] = 1.0f;
+        }
+        return;
+    }
+    float t = (parameter - positions[below]) / (positions[above] - positions[below]);
+    weights[below] = 1.0f - t;
+    weights[above] = t;
+}
+
+void PoseBlender::blendSpace2D(const glm::vec2* positions, uint32_t count, const glm::vec2& parameter, float* weights) {
+    float total = 0.0f;
+    for (uint32_t i = 0; i < count; i++) {
+        float w = 1.0f;
+        const glm::vec2 toParameter = parameter - positions[i];
+        for (uint32_t j = 0; j < count && w > 0.0f; j++) {
+            if (j == i) {
+                continue;
+            }
+            const glm::vec2 toSample = positions[j] - positions[i];
+            const float lengthSquared = glm::dot(toSample, toSample);
+            if (lengthSquared > 0.0f) {
+                w = std::min(w, std::clamp(1.0f - glm::dot(toParameter, toSample) / lengthSquared, 0.0f, 1.0f));
+            }
+        }
+        weights[i] = w;
+        total += w;
+    }
+
+    if (total > 0.0f) {
+        for (uint32_t i = 0; i < count; i++) {
+            weights[i] /= total;
+        }
+    }
+}
+
+void PoseBlender::subtreeMask(const NodeHierarchy& hierarchy, uint32_t root, float* boneWeights) {
+    // PARENTS COME FIRST, SO ONE PASS SEES EVERY PARENT'S WEIGHT BEFORE ITS CHILDREN
+    for (size_t n = 0; n < hierarchy.size(); n++) {
+        int32_t parent = hierarchy.parents_[n];
+        boneWeights[n] = (n == root || (parent >= 0 && boneWeights[parent] > 0.0f)) ? 1.0f : 0.0f;
+    }
+}
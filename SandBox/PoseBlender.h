@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CompiledAnimation.h"
+
+// BLENDING ON NODE SPACE POSES. A POSE HOLDS THREE vec4 PER NodeHierarchy NODE: TRANSLATION (xyz), ROTATION (xyzw QUATERNION) AND SCALE (xyz), SO CLIPS
+// THAT ANIMATE DIFFERENT NODES STILL BLEND NODE BY NODE. ROTATIONS ARE BLENDED WITH NLERP (SUMMED ON ONE HEMISPHERE, THEN RENORMALIZED)
+class PoseBlender {
+public:
+	static constexpr uint32_t VALUES_PER_NODE = 3;
+
+	static void restPose(const NodeHierarchy& hierarchy, glm::vec4* pose);
+	static void applyPose(const glm::vec4* pose, NodeHierarchy& hierarchy);
+
+	// NODES clip HAS NO TRACK FOR KEEP THEIR VALUE FROM rest. cursors AND laneScratch ARE AS FOR CompiledAnimation::sample, trackScratch HOLDS
+	// clip.size() VALUES
+	static void sampleClip(const CompiledAnimation& clip, float time, uint32_t* cursors, float* laneScratch, const glm::vec4* rest, size_t nodeCount, glm::vec4* trackScratch, glm::vec4* pose);
+
+	// N-WAY BLEND, weights ARE NORMALIZED HERE
+	static void blend(const glm::vec4* const* poses, const float* weights, uint32_t count, size_t nodeCount, glm::vec4* out);
+	// MOVES EVERY NODE weight * boneWeights[node] OF THE WAY FROM base TO layer. boneWeights MAY BE nullptr (EVERY NODE 1), out MAY BE base
+	static void blendMasked(const glm::vec4* base, const glm::vec4* layer, float weight, const float* boneWeights, size_t nodeCount, glm::vec4* out);
+	// ADDS layer'S DIFFERENCE FROM reference ON TOP OF base: ROTATIONS base * (inverse(reference) * layer), TRANSLATIONS base + (layer - reference),
+	// SCALES base * (layer / reference), EACH SCALED BY weight * boneWeights[node]. out MAY BE base
+	static void addAdditive(const glm::vec4* base, const glm::vec4* layer, const glm::vec4* reference, float weight, const float* boneWeights, size_t nodeCount, glm::vec4* out);
+
+	// BLEND SPACE WEIGHTS, ONE PER SAMPLE. 1D INTERPOLATES BETWEEN THE TWO SAMPLES AROUND parameter AND CLAMPS OUTSIDE THEM, 2D USES GRADIENT BAND
+	// INTERPOLATION SO ANY LAYOUT OF SAMPLES WORKS WITHOUT A TRIANGULATION
+	static void blendSpace1D(const float* positions, uint32_t count, float parameter, float* weights);
+	static void blendSpace2D(const glm::vec2* positions, uint32_t count, const glm::vec2& parameter, float* weights);
+
+	// 1 FOR root AND EVERY NODE BELOW IT, 0 ELSEWHERE
+	static void subtreeMask(const NodeHierarchy& hierarchy, uint32_t root, float* boneWeights);
+};
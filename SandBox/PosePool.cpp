@@ -0,0 +1,35 @@
+#include "PosePool.h"
+#include <iostream>
+#include <algorithm>
+
+void PosePool::init(size_t poseSize, size_t capacity) {
+    poseSize_ = poseSize;
+    capacity_ = capacity;
+    highWater_ = 0;
+    storage_.assign(poseSize * capacity, glm::vec4(0.0f));
+
+    // HANDED OUT LOWEST INDEX FIRST
+    free_.clear();
+    free_.reserve(capacity);
+    for (size_t i = capacity; i > 0; i--) {
+        free_.push_back(static_cast<uint32_t>(i - 1));
+    }
+}
+
+glm::vec4* PosePool::acquire() {
+    if (free_.empty()) {
+        std::cout << "pose pool exhausted (" << capacity_ << " poses)" << std::endl;
+        return nullptr;
+    }
+    uint32_t index = free_.back();
+    free_.pop_back();
+    highWater_ = std::max(highWater_, capacity_ - free_.size());
+    return storage_.data() + index * poseSize_;
+}
+
+void PosePool::release(glm::vec4* pose) {
+    if (pose == nullptr) {
+        return;
+    }
+    free_.push_back(static_cast<uint32_t>((pose - storage_.data()) / poseSize_));
+}
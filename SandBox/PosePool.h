@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// FIXED SIZE POSE BUFFERS FOR THE ANIMATION UPDATE. EVERY BUFFER IS ALLOCATED BY init, acquire AND release ONLY MOVE INDICES ON A FREE LIST THAT
+// WAS RESERVED UP FRONT, SO BLENDING NEVER ALLOCATES ONCE THE OBJECT IS SET UP
+class PosePool {
+public:
+	void init(size_t poseSize, size_t capacity);
+
+	// nullptr WHEN EVERY BUFFER IS IN USE
+	glm::vec4* acquire();
+	void release(glm::vec4* pose);
+
+	size_t poseSize() const { return poseSize_; }
+	size_t capacity() const { return capacity_; }
+	size_t highWater() const { return highWater_; } // MOST BUFFERS EVER IN USE AT ONCE, FOR SIZING capacity
+
+private:
+	std::vector<glm::vec4> storage_;
+	std::vector<uint32_t> free_;
+	size_t poseSize_ = 0;
+	size_t capacity_ = 0;
+	size_t highWater_ = 0;
+};
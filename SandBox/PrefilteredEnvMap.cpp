@@ -213,8 +213,8 @@ void PrefilteredEnvMap::createPipeline() {
 
     std::array<VulkanPipelineBuilder::VulkanShaderModule, 2> shaderStages = { vertexShaderModule, fragmentShaderModule };
 
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getPositionAttributeDescription();
+    auto bindingDescriptions = VertexStreams::getBindingDescriptions();
+    auto attributeDescriptions = VertexStreams::getPositionAttributeDescription();
 
     VulkanPipelineBuilder::PipelineBuilderInfo pipelineInfo{};
     pipelineInfo.pDescriptorSetLayouts = &prefEMapDescriptorSetLayout_->layout;
@@ -223,7 +223,7 @@ void PrefilteredEnvMap::createPipeline() {
     pipelineInfo.numStages = shaderStages.size();
     pipelineInfo.pPushConstantRanges = &pcRange;
     pipelineInfo.numRanges = 1;
-    pipelineInfo.vertexBindingDescriptions = &bindingDescription;
+    pipelineInfo.vertexBindingDescriptions = &bindingDescriptions[0];
     pipelineInfo.numVertexBindingDescriptions = 1;
     pipelineInfo.vertexAttributeDescriptions = attributeDescriptions.data();
     pipelineInfo.numVertexAttributeDescriptions = static_cast<int>(attributeDescriptions.size());
@@ -0,0 +1,80 @@
+#include "PrimitiveFinisher.h"
+#include "TangentGenerator.h"
+#include "VertexWelder.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+
+void PrimitiveFinisher::finishOne(Pending& pending, const Settings& settings, JobSystem* jobs) {
+    MeshHelper* p = pending.p;
+
+    // TANGENT SPACE CREATION - ALSO REFERENCED OFF OF: https://github.com/Eearslya/glTFView.
+    if (pending.generateTangents) {
+        //UNPACK VERTICES
+        std::vector<Vertex> unpacked(p->stagingIndices_.size());
+        uint32_t newInd = 0;
+        for (uint32_t index : p->stagingIndices_) {
+            unpacked[newInd] = p->stagingVertices_[index];
+            newInd++;
+        }
+        p->stagingVertices_ = std::move(unpacked);
+        p->stagingIndices_.clear();
+
+        // GEN TANGENT SPACE
+        TangentGenerator::generate(p->stagingVertices_, jobs);
+
+        //WELD VERTICES
+        VertexWelder::weld(p->stagingVertices_, p->stagingIndices_, 0, settings.weldEpsilon, jobs);
+    }
+
+    if (settings.optimizeMeshes) {
+        MeshOptimizer::Report report = MeshOptimizer::optimize(p->stagingVertices_, p->stagingIndices_, 0);
+        if (report.optimized) {
+            pending.report += MeshOptimizer::formatReport(pending.meshName, pending.primitiveIndex, report);
+        }
+    }
+
+    // CLUSTERS FOR GPU CLUSTER CULLING, CUT FROM THE FINAL TRIANGLE ORDER
+    if (settings.buildMeshlets) {
+        p->meshlets_ = MeshletBuilder::build(p->stagingVertices_, p->stagingIndices_);
+    }
+}
+
+void PrimitiveFinisher::finish(std::vector<Pending>& pending, const Settings& settings, JobSystem* jobs, uint32_t globalIndexOffset, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t& totalVertices, uint32_t& totalIndices, std::string& report) {
+    auto finishRange = [&](size_t begin, size_t end) {
+        for (size_t n = begin; n < end; n++) {
+            finishOne(pending[n], settings, jobs);
+        }
+    };
+    if (jobs) {
+        jobs->parallelFor(pending.size(), 1, finishRange);
+    }
+    else {
+        finishRange(0, pending.size());
+    }
+
+    for (Pending& primitive : pending) {
+        MeshHelper* p = primitive.p;
+        uint32_t firstVertex = totalVertices;
+        uint32_t currentNumIndices = static_cast<uint32_t>(p->stagingIndices_.size());
+        uint32_t currentNumVertices = static_cast<uint32_t>(p->stagingVertices_.size());
+
+        p->indirectInfo.firstIndex = totalIndices + globalIndexOffset;
+        p->indirectInfo.indexCount = currentNumIndices;
+
+        vertices.insert(vertices.end(), p->stagingVertices_.begin(), p->stagingVertices_.end());
+        indices.reserve(indices.size() + currentNumIndices);
+        for (uint32_t index : p->stagingIndices_) {
+            indices.push_back(index + firstVertex);
+        }
+
+        totalIndices += currentNumIndices;
+        totalVertices += currentNumVertices;
+        report += primitive.report;
+
+        p->stagingIndices_.clear();
+        p->stagingIndices_.shrink_to_fit();
+        p->stagingVertices_.clear();
+        p->stagingVertices_.shrink_to_fit();
+    }
+    pending.clear();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "MeshHelper.h"
+#include "JobSystem.h"
+
+// THE CPU WORK BOTH LOADERS DO ON A PRIMITIVE ONCE loadNode HAS READ IT (UNPACK, TANGENTS, WELD, OPTIMISATION, MESHLETS) AND THE IN ORDER PASS THAT
+// PLACES THE RESULTS IN THE MODEL'S BUFFERS
+class PrimitiveFinisher {
+public:
+	// A PRIMITIVE loadNode HAS READ BUT NOT YET FINISHED. INDICES ARE STILL LOCAL TO THE PRIMITIVE
+	struct Pending {
+		MeshHelper* p;
+		std::string meshName;
+		size_t primitiveIndex;
+		bool generateTangents;
+		std::string report;
+	};
+
+	struct Settings {
+		bool optimizeMeshes = false;
+		bool buildMeshlets = false; // ONLY THE STATIC MODELS ARE CLUSTER CULLED
+		float weldEpsilon = 0.0f; // SEE VertexWelder::weld
+	};
+
+	// PRIMITIVES ARE INDEPENDENT UNTIL THEY'RE PLACED IN THE MODEL BUFFERS, SO THEY ARE FINISHED ACROSS jobs (NULL FINISHES THEM ON THE CALLING THREAD)
+	// AT INDEX BASE 0 AND ONE IN ORDER PASS HANDS OUT firstIndex/firstVertex AFTERWARDS. BUFFERS AND REPORT COME OUT THE SAME HOWEVER MANY THREADS RAN.
+	// EMPTIES pending
+	static void finish(std::vector<Pending>& pending, const Settings& settings, JobSystem* jobs, uint32_t globalIndexOffset, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t& totalVertices, uint32_t& totalIndices, std::string& report);
+
+private:
+	static void finishOne(Pending& pending, const Settings& settings, JobSystem* jobs);
+};
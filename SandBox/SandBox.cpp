@@ -67,20 +67,31 @@ int main(int argc, char* argv[]) {
     graphicsManager.gameObjects[1]->transform.scale = scale;
 
     for (GameObject* g : graphicsManager.gameObjects) {
-        g->renderTarget->localModelTransform = g->transform.to_matrix();
+        g->setTransform(g->transform.to_matrix());
     }
 
     graphicsManager.animatedObjects[0]->isPlayerObj = true;
      
     graphicsManager.animatedObjects[0]->transform.rotation = glm::vec3(PI / 2.0f, 0.0f, 0.0f);
     graphicsManager.animatedObjects[0]->transform.scale = glm::vec3(0.00615f, 0.00615f, 0.00615f);
-    graphicsManager.animatedObjects[0]->renderTarget->runAnim.loadAnimation(std::string("./goro/goroRun2.glb"), graphicsManager.animatedObjects[0]->renderTarget->pParentNodes);
-    graphicsManager.animatedObjects[0]->renderTarget->idleAnim.loadAnimation(std::string("./goro/goroIdle.glb"), graphicsManager.animatedObjects[0]->renderTarget->pParentNodes);
-    graphicsManager.animatedObjects[0]->activeAnimation = &(graphicsManager.animatedObjects[0]->renderTarget->idleAnim);
-    graphicsManager.animatedObjects[0]->previousAnimation = &(graphicsManager.animatedObjects[0]->renderTarget->idleAnim);
+    AnimatedGLTFObj* goro = graphicsManager.animatedObjects[0]->renderTarget;
+    goro->animations_.loadFile(std::string("./goro/goroRun2.glb"), goro->pParentNodes);
+    goro->animations_.loadFile(std::string("./goro/goroIdle.glb"), goro->pParentNodes);
+    goro->runAnim = goro->animations_.find("goroRun2");
+    goro->idleAnim = goro->animations_.find("goroIdle");
+
+    // Extra goro instances (animatedInstances_) stand in a row beside the spawn point
+    uint32_t goroInstance = 0;
+    for (AnimatedGameObject* g : graphicsManager.animatedObjects) {
+        if (g->pSource_ == graphicsManager.animatedObjects[0]) {
+            goroInstance++;
+            g->transform = graphicsManager.animatedObjects[0]->transform;
+            g->transform.position = glm::vec3(1.5f * static_cast<float>(goroInstance), 0.0f, 3.0f);
+        }
+    }
 
     for (AnimatedGameObject* g : graphicsManager.animatedObjects) {
-        g->renderTarget->localModelTransform = g->transform.to_matrix();
+        g->setTransform(g->transform.to_matrix());
     }
 
     // Model Matrices TODO: MOVE THIS SOMEWHERE ELSE LOL
@@ -88,6 +99,7 @@ int main(int argc, char* argv[]) {
     graphicsManager.pVkR_->createDrawCallBuffer();
     graphicsManager.pVkR_->createModelMatrixBuffer(MAX_FRAMES_IN_FLIGHT);
     graphicsManager.pVkR_->createComputeCullResources(MAX_FRAMES_IN_FLIGHT);
+    graphicsManager.pVkR_->createClusterCullResources(MAX_FRAMES_IN_FLIGHT);
    
     physicsManager.addCubeToGameObject(graphicsManager.gameObjects[0], physx::PxVec3(2.25, 40, 0), 0.85f);
     scale = glm::vec3(1.0f);
@@ -104,6 +116,26 @@ int main(int argc, char* argv[]) {
     player->playerGameObject = graphicsManager.animatedObjects[0];
     player->currentState = PLAYERSTATE::IDLE;
 
+    // Player animation: idle, and a walk / run blend space over the player's speed
+    AnimationStateMachine& playerAnimation = player->playerGameObject->stateMachine_;
+    playerAnimation.addParameter("speed");
+    playerAnimation.addState({ "idle", { { goro->idleAnim } } });
+    playerAnimation.addState({ "locomotion", { { goro->walkAnim, glm::vec2(player->playerWalkSpeed, 0.0f) }, { goro->runAnim, glm::vec2(player->playerRunSpeed, 0.0f) } }, "speed" });
+    playerAnimation.addTransition({ "idle", "locomotion", 0.15f, -1.0f, { { "speed", AnimationStateMachine::Compare::GREATER, 0.001f } } });
+    playerAnimation.addTransition({ "locomotion", "idle", 0.15f, -1.0f, { { "speed", AnimationStateMachine::Compare::LESS, 0.001f } } });
+    playerAnimation.start("idle");
+    player->speedParameter = playerAnimation.parameterIndex("speed");
+    for (AnimatedGameObject* g : graphicsManager.animatedObjects) {
+        if (g->pSource_ == player->playerGameObject) {
+            g->stateMachine_ = playerAnimation;
+            g->stateMachine_.setHierarchy(g->hierarchy_);
+            g->stateMachine_.setParameter(player->speedParameter, player->playerWalkSpeed);
+        }
+    }
+
+    // Characters too small on screen to animate hold goro's first idle frame
+    goro->bakeFrozenPose(playerAnimation);
+
     // Right Train setup
     TrainObject* rightTrain = new TrainObject(glm::vec3(-50.0f, 0.0f, 0.0f), 10000, 5000, 1500, 10000);
     rightTrain->trainBodyObject = graphicsManager.gameObjects[2];
@@ -123,6 +155,7 @@ int main(int argc, char* argv[]) {
     graphicsManager.player = player;
 
     bool running = true;
+    uint64_t frameIndex = 0;
     while (running) {
         // Core SDL Loop
         SDL_Event event;
@@ -181,7 +214,8 @@ int main(int argc, char* argv[]) {
 
         // player animation -------------
 
-        graphicsManager.animatedObjects[0]->updateAnimation(graphicsManager.pVkR_->inverseBindMatrices, Time::getDeltaTime());
+        AnimationLOD::View animationView = AnimationLOD::fromCamera(graphicsManager.pVkR_->camera_, frameIndex++);
+        AnimatedGameObject::updateAnimations(graphicsManager.animatedObjects, graphicsManager.pVkR_->inverseBindMatrices, graphicsManager.pVkR_->jointDualQuaternions, Time::getDeltaTime(), graphicsManager.animationLOD_, animationView, *graphicsManager.pJobSystem_);
         graphicsManager.pVkR_->updateBindMatrices();
 
         // update physics -------------------
@@ -0,0 +1,213 @@
+#include "TangentGenerator.h"
+#include <numeric>
+
+SMikkTSpaceInterface TangentGenerator::interface_ = { .m_getNumFaces = TangentGenerator::getNumFaces,
+                                                     .m_getNumVerticesOfFace = TangentGenerator::getNumVerticesOfFace,
+                                                     .m_getPosition = TangentGenerator::getPosition,
+                                                     .m_getNormal = TangentGenerator::getNormal,
+                                                     .m_getTexCoord = TangentGenerator::getTexCoord,
+                                                     .m_setTSpaceBasic = TangentGenerator::setTSpaceBasic,
+                                                     .m_setTSpace = nullptr };
+
+// MIKKTSPACE CALLBACKS, REFERENCED OFF OF: https://github.com/Eearslya/glTFView
+const Vertex& TangentGenerator::corner(const Context* data, const int face, const int vert) {
+    size_t index = static_cast<size_t>(face) * 3 + vert;
+    return (*data->vertices)[data->corners ? (*data->corners)[index] : index];
+}
+
+int TangentGenerator::getNumFaces(const SMikkTSpaceContext* context) {
+    return reinterpret_cast<const Context*>(context->m_pUserData)->numFaces;
+}
+
+int TangentGenerator::getNumVerticesOfFace(const SMikkTSpaceContext* context, const int face) {
+    return 3;
+}
+
+void TangentGenerator::getPosition(const SMikkTSpaceContext* context, float fvPosOut[], const int face, const int vert) {
+    const glm::vec3 pos = corner(reinterpret_cast<const Context*>(context->m_pUserData), face, vert).pos;
+    fvPosOut[0] = pos.x;
+    fvPosOut[1] = pos.y;
+    fvPosOut[2] = pos.z;
+}
+
+void TangentGenerator::getNormal(const SMikkTSpaceContext* context, float fvNormOut[], const int face, const int vert) {
+    const glm::vec3 norm = corner(reinterpret_cast<const Context*>(context->m_pUserData), face, vert).normal;
+    fvNormOut[0] = norm.x;
+    fvNormOut[1] = norm.y;
+    fvNormOut[2] = norm.z;
+}
+
+// UV LIVES IN pos.w/normal.w, V IS FLIPPED FOR MIKKTSPACE
+void TangentGenerator::getTexCoord(const SMikkTSpaceContext* context, float fvTexcOut[], const int face, const int vert) {
+    const Vertex& v = corner(reinterpret_cast<const Context*>(context->m_pUserData), face, vert);
+    glm::vec2 uv = glm::vec2(v.pos.w, v.normal.w);
+    fvTexcOut[0] = uv.x;
+    fvTexcOut[1] = 1.0 - uv.y;
+}
+
+void TangentGenerator::setTSpaceBasic(const SMikkTSpaceContext* context, const float fvTangent[], const float fSign, const int face, const int vert) {
+    const Context* data = reinterpret_cast<const Context*>(context->m_pUserData);
+    size_t index = static_cast<size_t>(face) * 3 + vert;
+    (*data->vertices)[data->corners ? (*data->corners)[index] : index].tangent = glm::vec4(glm::make_vec3(fvTangent), fSign);
+}
+
+void TangentGenerator::CornerArrays::fill(const std::vector<Vertex>& vertices, const std::vector<uint32_t>* corners, size_t count) {
+    posX.resize(count); posY.resize(count); posZ.resize(count);
+    normX.resize(count); normY.resize(count); normZ.resize(count);
+    texU.resize(count); texV.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const Vertex& v = vertices[corners ? (*corners)[i] : i];
+        posX[i] = v.pos.x;
+        posY[i] = v.pos.y;
+        posZ[i] = v.pos.z;
+        normX[i] = v.normal.x;
+        normY[i] = v.normal.y;
+        normZ[i] = v.normal.z;
+        texU[i] = v.pos.w;
+        texV[i] = static_cast<float>(1.0 - v.normal.w); // SAME DOUBLE SUBTRACTION AS getTexCoord
+    }
+    soa = { posX.data(), posY.data(), posZ.data(), normX.data(), normY.data(), normZ.data(), texU.data(), texV.data() };
+}
+
+void TangentGenerator::run(std::vector<Vertex>& vertices, const std::vector<uint32_t>* corners, bool batched) {
+    size_t count = corners ? corners->size() : vertices.size();
+    Context data{ &vertices, corners, static_cast<int>(count / 3) };
+    SMikkTSpaceContext mikktContext = { .m_pInterface = &interface_, .m_pUserData = &data, .m_pSoA = nullptr };
+
+    CornerArrays arrays;
+    if (batched) {
+        arrays.fill(vertices, corners, static_cast<size_t>(data.numFaces) * 3);
+        mikktContext.m_pSoA = &arrays.soa;
+    }
+    genTangSpaceDefault(&mikktContext);
+}
+
+// CONNECTED COMPONENTS OF TRIANGLES THAT SHARE A POSITION. POSITIONS ARE COMPARED BY THEIR BITS (-0 FOLDED INTO +0), WHICH CAN ONLY MERGE MORE THAN
+// MIKKTSPACE'S == DOES (NaN), NEVER LESS. ISLANDS ARE NUMBERED BY THEIR FIRST FACE
+size_t TangentGenerator::findIslands(const std::vector<Vertex>& vertices, std::vector<uint32_t>& faceIsland, std::vector<uint32_t>& islandFaces) {
+    const size_t numFaces = vertices.size() / 3;
+    const size_t count = numFaces * 3;
+
+    std::vector<uint32_t> parent(numFaces);
+    std::iota(parent.begin(), parent.end(), 0u);
+    auto find = [&parent](uint32_t f) {
+        while (parent[f] != f) {
+            parent[f] = parent[parent[f]];
+            f = parent[f];
+        }
+        return f;
+    };
+
+    auto positionKey = [](const Vertex& v, uint32_t key[3]) {
+        float x = v.pos.x + 0.0f, y = v.pos.y + 0.0f, z = v.pos.z + 0.0f;
+        memcpy(&key[0], &x, sizeof(uint32_t));
+        memcpy(&key[1], &y, sizeof(uint32_t));
+        memcpy(&key[2], &z, sizeof(uint32_t));
+    };
+
+    size_t capacity = 16;
+    while (capacity < count * 2) {
+        capacity <<= 1;
+    }
+    const size_t mask = capacity - 1;
+    std::vector<uint32_t> slots(capacity, UINT32_MAX);
+
+    uint32_t key[3];
+    uint32_t otherKey[3];
+    for (size_t c = 0; c < count; c++) {
+        positionKey(vertices[c], key);
+        uint64_t h = 0x9E3779B97F4A7C15ull;
+        for (uint32_t i = 0; i < 3; i++) {
+            h ^= key[i];
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 32;
+        }
+        size_t slot = static_cast<size_t>(h) & mask;
+        while (true) {
+            uint32_t occupant = slots[slot];
+            if (occupant == UINT32_MAX) {
+                slots[slot] = static_cast<uint32_t>(c);
+                break;
+            }
+            positionKey(vertices[occupant], otherKey);
+            if (memcmp(key, otherKey, sizeof(key)) == 0) {
+                uint32_t a = find(static_cast<uint32_t>(c / 3));
+                uint32_t b = find(occupant / 3);
+                if (a != b) {
+                    parent[std::max(a, b)] = std::min(a, b);
+                }
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    faceIsland.assign(numFaces, UINT32_MAX);
+    islandFaces.clear();
+    std::vector<uint32_t> rootIsland(numFaces, UINT32_MAX);
+    for (uint32_t f = 0; f < numFaces; f++) {
+        uint32_t root = find(f);
+        if (rootIsland[root] == UINT32_MAX) {
+            rootIsland[root] = static_cast<uint32_t>(islandFaces.size());
+            islandFaces.push_back(0);
+        }
+        faceIsland[f] = rootIsland[root];
+        islandFaces[faceIsland[f]]++;
+    }
+    return islandFaces.size();
+}
+
+size_t TangentGenerator::generate(std::vector<Vertex>& vertices, JobSystem* jobs) {
+    const uint32_t threads = jobs ? jobs->activeWorkers() + 1 : 1;
+    if (vertices.size() < SPLIT_THRESHOLD || threads < 2) {
+        run(vertices, nullptr, true);
+        return 1;
+    }
+
+    std::vector<uint32_t> faceIsland;
+    std::vector<uint32_t> islandFaces;
+    const size_t numIslands = findIslands(vertices, faceIsland, islandFaces);
+    if (numIslands < 2) {
+        run(vertices, nullptr, true);
+        return 1;
+    }
+
+    // LARGEST ISLAND FIRST ONTO THE LIGHTEST BATCH, ONE BATCH PER THREAD
+    const size_t numBatches = std::min<size_t>(threads, numIslands);
+    std::vector<uint32_t> order(numIslands);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&islandFaces](uint32_t a, uint32_t b) { return islandFaces[a] > islandFaces[b]; });
+
+    std::vector<size_t> batchFaces(numBatches, 0);
+    std::vector<uint32_t> islandBatch(numIslands);
+    for (uint32_t island : order) {
+        size_t lightest = std::min_element(batchFaces.begin(), batchFaces.end()) - batchFaces.begin();
+        islandBatch[island] = static_cast<uint32_t>(lightest);
+        batchFaces[lightest] += islandFaces[island];
+    }
+
+    // EVERY BATCH KEEPS ITS TRIANGLES IN THEIR ORIGINAL ORDER
+    std::vector<std::vector<uint32_t>> batchCorners(numBatches);
+    for (size_t b = 0; b < numBatches; b++) {
+        batchCorners[b].reserve(batchFaces[b] * 3);
+    }
+    for (uint32_t f = 0; f < faceIsland.size(); f++) {
+        std::vector<uint32_t>& corners = batchCorners[islandBatch[faceIsland[f]]];
+        corners.push_back(f * 3 + 0);
+        corners.push_back(f * 3 + 1);
+        corners.push_back(f * 3 + 2);
+    }
+
+    // BATCHES TOUCH DISJOINT CORNERS, EACH ONLY WRITES THE TANGENTS OF ITS OWN
+    auto runBatches = [&vertices, &batchCorners](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++) {
+            run(vertices, &batchCorners[b], true);
+        }
+    };
+    jobs->parallelFor(numBatches, 1, runBatches);
+    return numIslands;
+}
+
+void TangentGenerator::generateSerial(std::vector<Vertex>& vertices) {
+    run(vertices, nullptr, false);
+}
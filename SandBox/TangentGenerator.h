@@ -0,0 +1,48 @@
+#pragma once
+
+#include "MeshHelper.h"
+#include "JobSystem.h"
+
+// MIKKTSPACE TANGENTS FOR THE UNPACKED (ONE VERTEX PER INDEX) PRIMITIVES THE LOADERS BUILD. THE CORNERS ARE HANDED TO mikktspace.cpp AS PLAIN FLOAT ARRAYS
+// (SMikkTSpaceSoA) INSTEAD OF ONE CALLBACK PER CORNER READ. LARGE PRIMITIVES ARE CUT INTO ISLANDS - TRIANGLE SETS THAT SHARE NO POSITION - AND THE ISLANDS
+// RUN ACROSS THE LOADER'S JOB SYSTEM. MIKKTSPACE NEVER LOOKS ACROSS AN ISLAND AND THE TRIANGLES KEEP THEIR RELATIVE ORDER, SO THE OUTPUT MATCHES THE SERIAL PASS
+class TangentGenerator {
+public:
+	// PRIMITIVES WITH FEWER CORNERS THAN THIS, OR WITHOUT A JOB SYSTEM, ARE GENERATED IN ONE PIECE ON THE CALLING THREAD
+	static constexpr size_t SPLIT_THRESHOLD = 1 << 16;
+
+	// RETURNS THE NUMBER OF ISLANDS THAT RAN (1 WHEN THE PRIMITIVE WASN'T SPLIT)
+	static size_t generate(std::vector<Vertex>& vertices, JobSystem* jobs = nullptr);
+	// ONE genTangSpaceDefault CALL OVER THE WHOLE PRIMITIVE THROUGH THE PER CORNER CALLBACKS, THE REFERENCE THE BATCHED PATH HAS TO MATCH
+	static void generateSerial(std::vector<Vertex>& vertices);
+
+private:
+	static SMikkTSpaceInterface interface_;
+
+	struct Context {
+		std::vector<Vertex>* vertices;
+		const std::vector<uint32_t>* corners; // FACE CORNER -> CORNER IN vertices, NULL WHEN THE WHOLE PRIMITIVE RUNS
+		int numFaces;
+	};
+
+	// ONE FLOAT ARRAY PER COMPONENT, FILLED WITH EXACTLY WHAT THE CALLBACKS BELOW WOULD RETURN
+	struct CornerArrays {
+		std::vector<float> posX, posY, posZ;
+		std::vector<float> normX, normY, normZ;
+		std::vector<float> texU, texV;
+		SMikkTSpaceSoA soa;
+
+		void fill(const std::vector<Vertex>& vertices, const std::vector<uint32_t>* corners, size_t count);
+	};
+
+	static int getNumFaces(const SMikkTSpaceContext* context);
+	static int getNumVerticesOfFace(const SMikkTSpaceContext* context, const int face);
+	static void getPosition(const SMikkTSpaceContext* context, float fvPosOut[], const int face, const int vert);
+	static void getNormal(const SMikkTSpaceContext* context, float fvNormOut[], const int face, const int vert);
+	static void getTexCoord(const SMikkTSpaceContext* context, float fvTexcOut[], const int face, const int vert);
+	static void setTSpaceBasic(const SMikkTSpaceContext* context, const float fvTangent[], const float fSign, const int face, const int vert);
+
+	static const Vertex& corner(const Context* data, const int face, const int vert);
+	static void run(std::vector<Vertex>& vertices, const std::vector<uint32_t>* corners, bool batched);
+	static size_t findIslands(const std::vector<Vertex>& vertices, std::vector<uint32_t>& faceIsland, std::vector<uint32_t>& islandFaces);
+};
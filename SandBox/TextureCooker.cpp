@@ -0,0 +1,676 @@
+#include "TextureCooker.h"
+#include <thread>
+#include <cfloat>
+#include <climits>
+
+static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static void putBits(unsigned char* out, uint32_t& pos, uint32_t value, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++, pos++) {
+        if ((value >> i) & 1) {
+            out[pos >> 3] |= static_cast<unsigned char>(1 << (pos & 7));
+        }
+    }
+}
+
+static uint32_t getBits(const unsigned char* in, uint32_t& pos, uint32_t count) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < count; i++, pos++) {
+        value |= static_cast<uint32_t>((in[pos >> 3] >> (pos & 7)) & 1) << i;
+    }
+    return value;
+}
+
+static float srgbToLinear(unsigned char value) {
+    float c = value / 255.0f;
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static unsigned char linearToSrgb(float value) {
+    float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    return static_cast<unsigned char>(std::clamp(std::lround(c * 255.0f), 0l, 255l));
+}
+
+// BC7 ENDPOINTS ARE 7 BITS PER CHANNEL PLUS ONE SHARED P-BIT, TRY BOTH P-BITS AND KEEP WHICHEVER LANDS CLOSER
+static void quantizeBC7Endpoint(const float endpoint[4], int quantized[4], int& pBit) {
+    int bestError = INT_MAX;
+    for (int p = 0; p < 2; p++) {
+        int q[4];
+        int error = 0;
+        for (int c = 0; c < 4; c++) {
+            int v = std::clamp(static_cast<int>(std::lround(endpoint[c])), 0, 255);
+            q[c] = std::clamp((v - p + 1) >> 1, 0, 127);
+            int diff = ((q[c] << 1) | p) - v;
+            error += diff * diff;
+        }
+        if (error < bestError) {
+            bestError = error;
+            pBit = p;
+            memcpy(quantized, q, sizeof(q));
+        }
+    }
+}
+
+static int selectBC7Indices(const unsigned char block[64], const int q0[4], int p0, const int q1[4], int p1, int indices[16]) {
+    int palette[16][4];
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            int e0 = (q0[c] << 1) | p0;
+            int e1 = (q1[c] << 1) | p1;
+            palette[i][c] = ((64 - BC7_WEIGHTS[i]) * e0 + BC7_WEIGHTS[i] * e1 + 32) >> 6;
+        }
+    }
+
+    int totalError = 0;
+    for (int p = 0; p < 16; p++) {
+        int bestError = INT_MAX;
+        for (int i = 0; i < 16; i++) {
+            int error = 0;
+            for (int c = 0; c < 4; c++) {
+                int diff = palette[i][c] - block[p * 4 + c];
+                error += diff * diff;
+            }
+            if (error < bestError) {
+                bestError = error;
+                indices[p] = i;
+            }
+        }
+        totalError += bestError;
+    }
+    return totalError;
+}
+
+// MODE 6 ONLY - ONE SUBSET, RGBA ENDPOINTS ALONG THE PRINCIPAL AXIS OF THE BLOCK, 4 BIT INDICES, THEN A LEAST SQUARES PASS ON THE ENDPOINTS
+void TextureCooker::encodeBC7Block(const unsigned char block[64], unsigned char out[16]) {
+    float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float minC[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+    float maxC[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int p = 0; p < 16; p++) {
+        for (int c = 0; c < 4; c++) {
+            float v = block[p * 4 + c];
+            mean[c] += v / 16.0f;
+            minC[c] = std::min(minC[c], v);
+            maxC[c] = std::max(maxC[c], v);
+        }
+    }
+
+    float cov[4][4] = {};
+    for (int p = 0; p < 16; p++) {
+        float d[4];
+        for (int c = 0; c < 4; c++) {
+            d[c] = block[p * 4 + c] - mean[c];
+        }
+        for (int r = 0; r < 4; r++) {
+            for (int c = 0; c < 4; c++) {
+                cov[r][c] += d[r] * d[c];
+            }
+        }
+    }
+
+    float axis[4];
+    for (int c = 0; c < 4; c++) {
+        axis[c] = maxC[c] - minC[c];
+    }
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {};
+        for (int r = 0; r < 4; r++) {
+            for (int c = 0; c < 4; c++) {
+                next[r] += cov[r][c] * axis[c];
+            }
+        }
+        float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+        if (length < 1e-6f) {
+            break;
+        }
+        for (int c = 0; c < 4; c++) {
+            axis[c] = next[c] / length;
+        }
+    }
+    float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3]);
+    if (axisLength > 1e-6f) {
+        for (int c = 0; c < 4; c++) {
+            axis[c] /= axisLength;
+        }
+    }
+
+    float minT = FLT_MAX;
+    float maxT = -FLT_MAX;
+    for (int p = 0; p < 16; p++) {
+        float t = 0.0f;
+        for (int c = 0; c < 4; c++) {
+            t += (block[p * 4 + c] - mean[c]) * axis[c];
+        }
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    float e0[4], e1[4];
+    for (int c = 0; c < 4; c++) {
+        e0[c] = std::clamp(mean[c] + minT * axis[c], 0.0f, 255.0f);
+        e1[c] = std::clamp(mean[c] + maxT * axis[c], 0.0f, 255.0f);
+    }
+
+    int q0[4], q1[4], p0 = 0, p1 = 0;
+    int indices[16];
+    quantizeBC7Endpoint(e0, q0, p0);
+    quantizeBC7Endpoint(e1, q1, p1);
+    int bestError = selectBC7Indices(block, q0, p0, q1, p1, indices);
+
+    // REFIT THE ENDPOINTS TO THE CHOSEN WEIGHTS, KEEP THE RESULT ONLY IF IT ACTUALLY LOWERS THE ERROR
+    for (int iteration = 0; iteration < 2 && bestError > 0; iteration++) {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[4] = {}, bx[4] = {};
+        for (int p = 0; p < 16; p++) {
+            float b = BC7_WEIGHTS[indices[p]] / 64.0f;
+            float a = 1.0f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < 4; c++) {
+                ax[c] += a * block[p * 4 + c];
+                bx[c] += b * block[p * 4 + c];
+            }
+        }
+        float det = aa * bb - ab * ab;
+        if (std::abs(det) < 1e-6f) {
+            break;
+        }
+        for (int c = 0; c < 4; c++) {
+            e0[c] = std::clamp((bb * ax[c] - ab * bx[c]) / det, 0.0f, 255.0f);
+            e1[c] = std::clamp((aa * bx[c] - ab * ax[c]) / det, 0.0f, 255.0f);
+        }
+
+        int r0[4], r1[4], rp0 = 0, rp1 = 0;
+        int refitIndices[16];
+        quantizeBC7Endpoint(e0, r0, rp0);
+        quantizeBC7Endpoint(e1, r1, rp1);
+        int error = selectBC7Indices(block, r0, rp0, r1, rp1, refitIndices);
+        if (error >= bestError) {
+            break;
+        }
+        bestError = error;
+        memcpy(q0, r0, sizeof(q0));
+        memcpy(q1, r1, sizeof(q1));
+        p0 = rp0;
+        p1 = rp1;
+        memcpy(indices, refitIndices, sizeof(indices));
+    }
+
+    // THE FIRST INDEX IS STORED WITH ITS TOP BIT IMPLIED ZERO, SWAP THE ENDPOINTS IF IT WOULD BE SET
+    if (indices[0] & 8) {
+        std::swap(q0, q1);
+        std::swap(p0, p1);
+        for (int p = 0; p < 16; p++) {
+            indices[p] = 15 - indices[p];
+        }
+    }
+
+    memset(out, 0, 16);
+    uint32_t pos = 0;
+    putBits(out, pos, 1 << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        putBits(out, pos, q0[c], 7);
+        putBits(out, pos, q1[c], 7);
+    }
+    putBits(out, pos, p0, 1);
+    putBits(out, pos, p1, 1);
+    putBits(out, pos, indices[0], 3);
+    for (int p = 1; p < 16; p++) {
+        putBits(out, pos, indices[p], 4);
+    }
+}
+
+// ONLY MODE 6 IS EVER WRITTEN BY THE COOKER, ANY OTHER MODE DECODES TO TRANSPARENT BLACK
+void TextureCooker::decodeBC7Block(const unsigned char in[16], unsigned char block[64]) {
+    if ((in[0] & 0x7F) != 0x40) {
+        memset(block, 0, 64);
+        return;
+    }
+
+    uint32_t pos = 7;
+    int e0[4], e1[4];
+    for (int c = 0; c < 4; c++) {
+        e0[c] = getBits(in, pos, 7) << 1;
+        e1[c] = getBits(in, pos, 7) << 1;
+    }
+    int p0 = getBits(in, pos, 1);
+    int p1 = getBits(in, pos, 1);
+    for (int c = 0; c < 4; c++) {
+        e0[c] |= p0;
+        e1[c] |= p1;
+    }
+
+    for (int p = 0; p < 16; p++) {
+        int index = getBits(in, pos, p == 0 ? 3 : 4);
+        for (int c = 0; c < 4; c++) {
+            block[p * 4 + c] = static_cast<unsigned char>(((64 - BC7_WEIGHTS[index]) * e0[c] + BC7_WEIGHTS[index] * e1[c] + 32) >> 6);
+        }
+    }
+}
+
+static void bc4Palette(int r0, int r1, int palette[8]) {
+    palette[0] = r0;
+    palette[1] = r1;
+    if (r0 > r1) {
+        for (int i = 2; i < 8; i++) {
+            palette[i] = ((8 - i) * r0 + (i - 1) * r1 + 3) / 7;
+        }
+    }
+    else {
+        for (int i = 2; i < 6; i++) {
+            palette[i] = ((6 - i) * r0 + (i - 1) * r1 + 2) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+// MIN/MAX ENDPOINTS IN THE 8 VALUE MODE, EACH TEXEL TAKES THE NEAREST OF THE 8 INTERPOLATED VALUES
+void TextureCooker::encodeBC4Block(const unsigned char values[16], unsigned char out[8]) {
+    int minV = 255;
+    int maxV = 0;
+    for (int p = 0; p < 16; p++) {
+        minV = std::min(minV, static_cast<int>(values[p]));
+        maxV = std::max(maxV, static_cast<int>(values[p]));
+    }
+
+    memset(out, 0, 8);
+    out[0] = static_cast<unsigned char>(maxV);
+    out[1] = static_cast<unsigned char>(minV);
+    if (maxV == minV) {
+        return;
+    }
+
+    int palette[8];
+    bc4Palette(maxV, minV, palette);
+
+    uint64_t bits = 0;
+    for (int p = 0; p < 16; p++) {
+        int bestIndex = 0;
+        int bestError = INT_MAX;
+        for (int i = 0; i < 8; i++) {
+            int error = std::abs(palette[i] - values[p]);
+            if (error < bestError) {
+                bestError = error;
+                bestIndex = i;
+            }
+        }
+        bits |= static_cast<uint64_t>(bestIndex) << (3 * p);
+    }
+    for (int b = 0; b < 6; b++) {
+        out[2 + b] = static_cast<unsigned char>(bits >> (8 * b));
+    }
+}
+
+void TextureCooker::decodeBC4Block(const unsigned char in[8], unsigned char values[16]) {
+    int palette[8];
+    bc4Palette(in[0], in[1], palette);
+
+    uint64_t bits = 0;
+    for (int b = 0; b < 6; b++) {
+        bits |= static_cast<uint64_t>(in[2 + b]) << (8 * b);
+    }
+    for (int p = 0; p < 16; p++) {
+        values[p] = static_cast<unsigned char>(palette[(bits >> (3 * p)) & 7]);
+    }
+}
+
+bool TextureCooker::isBlockCompressed(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+        return true;
+    default:
+        return false;
+    }
+}
+
+const char* TextureCooker::formatName(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        return "BC7 SRGB";
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+        return "BC7";
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        return "BC5";
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+        return "BC4";
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        return "RGBA8 SRGB";
+    default:
+        return "RGBA8";
+    }
+}
+
+size_t TextureCooker::levelSize(uint32_t width, uint32_t height, VkFormat format) {
+    size_t blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+    switch (format) {
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+        return blocks * 16;
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+        return blocks * 8;
+    default:
+        return static_cast<size_t>(width) * height * 4;
+    }
+}
+
+// 2X2 BOX FILTER DOWN TO 1X1. COLOUR IS AVERAGED IN LINEAR SPACE AND NORMALS (XY IN RG) ARE RENORMALISED AFTER AVERAGING
+void TextureCooker::buildMipChain(std::vector<std::vector<unsigned char>>& mips, uint32_t width, uint32_t height, bool srgb, bool normalMap) {
+    while (width > 1 || height > 1) {
+        uint32_t mipWidth = std::max(1u, width / 2);
+        uint32_t mipHeight = std::max(1u, height / 2);
+        const std::vector<unsigned char>& src = mips.back();
+        std::vector<unsigned char> dst(static_cast<size_t>(mipWidth) * mipHeight * 4);
+
+        for (uint32_t y = 0; y < mipHeight; y++) {
+            for (uint32_t x = 0; x < mipWidth; x++) {
+                const unsigned char* texels[4] = {
+                    &src[(static_cast<size_t>(std::min(2 * y, height - 1)) * width + std::min(2 * x, width - 1)) * 4],
+                    &src[(static_cast<size_t>(std::min(2 * y, height - 1)) * width + std::min(2 * x + 1, width - 1)) * 4],
+                    &src[(static_cast<size_t>(std::min(2 * y + 1, height - 1)) * width + std::min(2 * x, width - 1)) * 4],
+                    &src[(static_cast<size_t>(std::min(2 * y + 1, height - 1)) * width + std::min(2 * x + 1, width - 1)) * 4],
+                };
+                unsigned char* out = &dst[(static_cast<size_t>(y) * mipWidth + x) * 4];
+
+                if (normalMap) {
+                    glm::vec3 sum = glm::vec3(0.0f);
+                    for (const unsigned char* t : texels) {
+                        glm::vec2 xy = glm::vec2(t[0], t[1]) / 255.0f * 2.0f - 1.0f;
+                        sum += glm::vec3(xy, std::sqrt(std::max(0.0f, 1.0f - glm::dot(xy, xy))));
+                    }
+                    glm::vec3 n = glm::length(sum) > 1e-6f ? glm::normalize(sum) : glm::vec3(0.0f, 0.0f, 1.0f);
+                    out[0] = static_cast<unsigned char>(std::lround((n.x * 0.5f + 0.5f) * 255.0f));
+                    out[1] = static_cast<unsigned char>(std::lround((n.y * 0.5f + 0.5f) * 255.0f));
+                    out[2] = 0;
+                    out[3] = 255;
+                }
+                else {
+                    for (int c = 0; c < 4; c++) {
+                        if (srgb && c < 3) {
+                            float sum = 0.0f;
+                            for (const unsigned char* t : texels) {
+                                sum += srgbToLinear(t[c]);
+                            }
+                            out[c] = linearToSrgb(sum / 4.0f);
+                        }
+                        else {
+                            out[c] = static_cast<unsigned char>((texels[0][c] + texels[1][c] + texels[2][c] + texels[3][c] + 2) / 4);
+                        }
+                    }
+                }
+            }
+        }
+
+        mips.push_back(std::move(dst));
+        width = mipWidth;
+        height = mipHeight;
+    }
+}
+
+// BLOCK ROWS ARE SPLIT ACROSS THREADS, EDGE BLOCKS CLAMP TO THE LAST ROW/COLUMN FOR SIZES THAT ARE NOT A MULTIPLE OF 4
+void TextureCooker::encodeLevel(const unsigned char* rgba, uint32_t width, uint32_t height, VkFormat format, unsigned char* out) {
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    size_t blockBytes = format == VK_FORMAT_BC4_UNORM_BLOCK ? 8 : 16;
+
+    auto encodeRows = [&](uint32_t firstRow, uint32_t rowStep) {
+        unsigned char block[64];
+        unsigned char channel[2][16];
+        for (uint32_t by = firstRow; by < blocksY; by += rowStep) {
+            for (uint32_t bx = 0; bx < blocksX; bx++) {
+                for (uint32_t p = 0; p < 16; p++) {
+                    uint32_t x = std::min(bx * 4 + (p & 3), width - 1);
+                    uint32_t y = std::min(by * 4 + (p >> 2), height - 1);
+                    memcpy(&block[p * 4], &rgba[(static_cast<size_t>(y) * width + x) * 4], 4);
+                    channel[0][p] = block[p * 4];
+                    channel[1][p] = block[p * 4 + 1];
+                }
+
+                unsigned char* dst = out + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+                switch (format) {
+                case VK_FORMAT_BC4_UNORM_BLOCK:
+                    encodeBC4Block(channel[0], dst);
+                    break;
+                case VK_FORMAT_BC5_UNORM_BLOCK:
+                    encodeBC4Block(channel[0], dst);
+                    encodeBC4Block(channel[1], dst + 8);
+                    break;
+                default:
+                    encodeBC7Block(block, dst);
+                    break;
+                }
+            }
+        }
+    };
+
+    uint32_t numThreads = std::min(std::max(1u, std::thread::hardware_concurrency()), blocksY);
+    if (static_cast<size_t>(blocksX) * blocksY < 1024 || numThreads <= 1) {
+        encodeRows(0, 1);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < numThreads; t++) {
+        threads.emplace_back(encodeRows, t, numThreads);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void TextureCooker::decodeLevel(const unsigned char* blocks, uint32_t width, uint32_t height, VkFormat format, unsigned char* rgba) {
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    size_t blockBytes = format == VK_FORMAT_BC4_UNORM_BLOCK ? 8 : 16;
+
+    unsigned char block[64];
+    unsigned char channel[2][16];
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            const unsigned char* src = blocks + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+            switch (format) {
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+                decodeBC4Block(src, channel[0]);
+                for (int p = 0; p < 16; p++) {
+                    block[p * 4] = channel[0][p];
+                    block[p * 4 + 1] = 0;
+                    block[p * 4 + 2] = 0;
+                    block[p * 4 + 3] = 255;
+                }
+                break;
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+                decodeBC4Block(src, channel[0]);
+                decodeBC4Block(src + 8, channel[1]);
+                for (int p = 0; p < 16; p++) {
+                    block[p * 4] = channel[0][p];
+                    block[p * 4 + 1] = channel[1][p];
+                    block[p * 4 + 2] = 0;
+                    block[p * 4 + 3] = 255;
+                }
+                break;
+            default:
+                decodeBC7Block(src, block);
+                break;
+            }
+
+            for (uint32_t p = 0; p < 16; p++) {
+                uint32_t x = bx * 4 + (p & 3);
+                uint32_t y = by * 4 + (p >> 2);
+                if (x < width && y < height) {
+                    memcpy(&rgba[(static_cast<size_t>(y) * width + x) * 4], &block[p * 4], 4);
+                }
+            }
+        }
+    }
+}
+
+// PICKS THE FORMAT FROM HOW THE IMAGE IS SAMPLED. SINGLE AND TWO CHANNEL DATA IS PACKED INTO R(G) FOR BC4/BC5 AND THE VIEW SWIZZLE PUTS IT BACK WHERE
+// THE SHADERS EXPECT IT, IMAGES SHARED BETWEEN DIFFERENT SLOTS KEEP ALL FOUR CHANNELS IN BC7
+float TextureCooker::cook(const unsigned char* rgba, uint32_t width, uint32_t height, uint32_t usage, CookedTexture& out) {
+    int sourceChannels[2] = { 0, 1 };
+    int numChannels = 4;
+    bool srgb = false;
+    bool normalMap = false;
+
+    out.swizzle = {};
+    if (usage == USAGE_COLOR) {
+        out.format = VK_FORMAT_BC7_SRGB_BLOCK;
+        srgb = true;
+    }
+    else if (usage == USAGE_NORMAL) {
+        out.format = VK_FORMAT_BC5_UNORM_BLOCK;
+        numChannels = 2;
+        normalMap = true;
+    }
+    else if (usage == USAGE_OCCLUSION) {
+        out.format = VK_FORMAT_BC4_UNORM_BLOCK;
+        numChannels = 1;
+        out.swizzle = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_ONE };
+    }
+    else if (usage == USAGE_METALLIC_ROUGHNESS) {
+        // GLTF KEEPS ROUGHNESS IN G AND METALLIC IN B, BOTH GO THROUGH ONE BC5 (TWO BC4 BLOCKS) AND THE VIEW MAPS THEM BACK TO G AND B
+        out.format = VK_FORMAT_BC5_UNORM_BLOCK;
+        numChannels = 2;
+        sourceChannels[0] = 1;
+        sourceChannels[1] = 2;
+        out.swizzle = { VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_ONE };
+    }
+    else {
+        out.format = VK_FORMAT_BC7_UNORM_BLOCK;
+    }
+    out.width = width;
+    out.height = height;
+
+    std::vector<std::vector<unsigned char>> mips(1);
+    mips[0].resize(static_cast<size_t>(width) * height * 4);
+    if (numChannels == 4) {
+        memcpy(mips[0].data(), rgba, mips[0].size());
+    }
+    else {
+        for (size_t p = 0; p < static_cast<size_t>(width) * height; p++) {
+            mips[0][p * 4] = rgba[p * 4 + sourceChannels[0]];
+            mips[0][p * 4 + 1] = numChannels > 1 ? rgba[p * 4 + sourceChannels[1]] : 0;
+            mips[0][p * 4 + 2] = 0;
+            mips[0][p * 4 + 3] = 255;
+        }
+    }
+    buildMipChain(mips, width, height, srgb, normalMap);
+
+    out.levels.resize(mips.size());
+    size_t totalSize = 0;
+    for (size_t level = 0; level < mips.size(); level++) {
+        out.levels[level].byteOffset = totalSize;
+        out.levels[level].byteLength = levelSize(std::max(1u, width >> level), std::max(1u, height >> level), out.format);
+        totalSize += out.levels[level].byteLength;
+    }
+
+    out.data.resize(totalSize);
+    for (size_t level = 0; level < mips.size(); level++) {
+        encodeLevel(mips[level].data(), std::max(1u, width >> level), std::max(1u, height >> level), out.format, out.data.data() + out.levels[level].byteOffset);
+    }
+
+    std::vector<unsigned char> decoded(mips[0].size());
+    decodeLevel(out.data.data(), width, height, out.format, decoded.data());
+    double squaredError = 0.0;
+    for (size_t p = 0; p < static_cast<size_t>(width) * height; p++) {
+        for (int c = 0; c < numChannels; c++) {
+            double diff = static_cast<double>(decoded[p * 4 + c]) - mips[0][p * 4 + c];
+            squaredError += diff * diff;
+        }
+    }
+    return static_cast<float>(std::sqrt(squaredError / (static_cast<double>(width) * height * numChannels)));
+}
+
+void TextureCooker::decompress(const CookedTexture& in, CookedTexture& out) {
+    out.format = in.format == VK_FORMAT_BC7_SRGB_BLOCK ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    out.swizzle = in.swizzle;
+    out.width = in.width;
+    out.height = in.height;
+
+    out.levels.resize(in.levels.size());
+    size_t totalSize = 0;
+    for (size_t level = 0; level < in.levels.size(); level++) {
+        out.levels[level].byteOffset = totalSize;
+        out.levels[level].byteLength = levelSize(std::max(1u, in.width >> level), std::max(1u, in.height >> level), out.format);
+        totalSize += out.levels[level].byteLength;
+    }
+
+    out.data.resize(totalSize);
+    for (size_t level = 0; level < in.levels.size(); level++) {
+        decodeLevel(in.data.data() + in.levels[level].byteOffset, std::max(1u, in.width >> level), std::max(1u, in.height >> level), in.format, out.data.data() + out.levels[level].byteOffset);
+    }
+}
+
+std::string TextureCooker::cookedPath(const std::string& gltfPath, size_t imageIndex) {
+    return gltfPath + "." + std::to_string(imageIndex) + ".otex";
+}
+
+void TextureCooker::write(const std::string& path, uint64_t sourceHash, const CookedTexture& tex) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "could not write cooked texture: " << path << std::endl;
+        return;
+    }
+
+    Header header{};
+    header.magic = COOKED_MAGIC;
+    header.version = COOKED_VERSION;
+    header.sourceHash = sourceHash;
+    header.vkFormat = static_cast<uint32_t>(tex.format);
+    header.width = tex.width;
+    header.height = tex.height;
+    header.levelCount = static_cast<uint32_t>(tex.levels.size());
+    header.swizzle[0] = static_cast<uint32_t>(tex.swizzle.r);
+    header.swizzle[1] = static_cast<uint32_t>(tex.swizzle.g);
+    header.swizzle[2] = static_cast<uint32_t>(tex.swizzle.b);
+    header.swizzle[3] = static_cast<uint32_t>(tex.swizzle.a);
+    header.dataSize = tex.data.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(tex.levels.data()), sizeof(LevelIndex) * tex.levels.size());
+    file.write(reinterpret_cast<const char*>(tex.data.data()), tex.data.size());
+}
+
+bool TextureCooker::read(const std::string& path, uint64_t sourceHash, CookedTexture& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    Header header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(Header));
+    if (!file || header.magic != COOKED_MAGIC || header.version != COOKED_VERSION || header.levelCount == 0 || header.levelCount > 32) {
+        return false;
+    }
+    if (header.sourceHash != sourceHash) {
+        std::cout << "cooked texture out of date, recooking: " << path << std::endl;
+        return false;
+    }
+
+    out.levels.resize(header.levelCount);
+    file.read(reinterpret_cast<char*>(out.levels.data()), sizeof(LevelIndex) * header.levelCount);
+    out.data.resize(header.dataSize);
+    file.read(reinterpret_cast<char*>(out.data.data()), header.dataSize);
+    if (!file) {
+        std::cout << "cooked texture truncated, recooking: " << path << std::endl;
+        return false;
+    }
+    for (const LevelIndex& level : out.levels) {
+        if (level.byteOffset + level.byteLength > header.dataSize) {
+            return false;
+        }
+    }
+
+    out.format = static_cast<VkFormat>(header.vkFormat);
+    out.width = header.width;
+    out.height = header.height;
+    out.swizzle.r = static_cast<VkComponentSwizzle>(header.swizzle[0]);
+    out.swizzle.g = static_cast<VkComponentSwizzle>(header.swizzle[1]);
+    out.swizzle.b = static_cast<VkComponentSwizzle>(header.swizzle[2]);
+    out.swizzle.a = static_cast<VkComponentSwizzle>(header.swizzle[3]);
+    return true;
+}
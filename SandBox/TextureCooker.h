@@ -0,0 +1,69 @@
+#pragma once
+
+#include "DeviceHelper.h"
+
+// OFFLINE BLOCK COMPRESSION FOR MODEL TEXTURES. EVERY IMAGE IS ENCODED ON THE CPU (BC7 FOR COLOUR, BC5 FOR NORMALS, BC4 PER SCALAR CHANNEL) WITH ITS
+// WHOLE MIP CHAIN PREBUILT AND WRITTEN TO A SMALL KTX2 STYLE CONTAINER, SO TextureHelper CAN COPY THE LEVELS STRAIGHT INTO THE IMAGE WITHOUT A BLIT CHAIN
+class TextureCooker {
+public:
+	static constexpr uint32_t COOKED_MAGIC = 0x5845544F; // "OTEX"
+	static constexpr uint32_t COOKED_VERSION = 1;
+
+	// HOW MATERIALS SAMPLE AN IMAGE, AN IMAGE SHARED BETWEEN SLOTS (E.G. PACKED OCCLUSION/ROUGHNESS/METALLIC) GETS THE BITWISE OR
+	enum Usage : uint32_t {
+		USAGE_COLOR = 1 << 0,
+		USAGE_NORMAL = 1 << 1,
+		USAGE_METALLIC_ROUGHNESS = 1 << 2,
+		USAGE_OCCLUSION = 1 << 3,
+	};
+
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceHash;
+		uint32_t vkFormat;
+		uint32_t width;
+		uint32_t height;
+		uint32_t levelCount;
+		uint32_t swizzle[4];
+		uint64_t dataSize;
+	};
+
+	// ONE ENTRY PER MIP LIKE THE KTX2 LEVEL INDEX, OFFSETS ARE FROM THE START OF THE LEVEL DATA
+	struct LevelIndex {
+		uint64_t byteOffset;
+		uint64_t byteLength;
+	};
+
+	struct CookedTexture {
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		VkComponentMapping swizzle = {};
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<LevelIndex> levels;
+		std::vector<unsigned char> data;
+	};
+
+	static std::string cookedPath(const std::string& gltfPath, size_t imageIndex);
+	static bool read(const std::string& path, uint64_t sourceHash, CookedTexture& out);
+	static void write(const std::string& path, uint64_t sourceHash, const CookedTexture& tex);
+
+	// ENCODES AN RGBA8 IMAGE FOR THE GIVEN USAGE MASK AND RETURNS THE RMS ERROR OF THE TOP MIP OVER THE ENCODED CHANNELS
+	static float cook(const unsigned char* rgba, uint32_t width, uint32_t height, uint32_t usage, CookedTexture& out);
+	// EXPANDS A COOKED TEXTURE BACK TO RGBA8 WITH THE SAME MIPS, USED ON GPUS WITHOUT textureCompressionBC
+	static void decompress(const CookedTexture& in, CookedTexture& out);
+
+	static void encodeBC7Block(const unsigned char block[64], unsigned char out[16]);
+	static void encodeBC4Block(const unsigned char values[16], unsigned char out[8]);
+	static void decodeBC7Block(const unsigned char in[16], unsigned char block[64]);
+	static void decodeBC4Block(const unsigned char in[8], unsigned char values[16]);
+
+	static bool isBlockCompressed(VkFormat format);
+	static const char* formatName(VkFormat format);
+
+private:
+	static void buildMipChain(std::vector<std::vector<unsigned char>>& mips, uint32_t width, uint32_t height, bool srgb, bool normalMap);
+	static void encodeLevel(const unsigned char* rgba, uint32_t width, uint32_t height, VkFormat format, unsigned char* out);
+	static void decodeLevel(const unsigned char* blocks, uint32_t width, uint32_t height, VkFormat format, unsigned char* rgba);
+	static size_t levelSize(uint32_t width, uint32_t height, VkFormat format);
+};
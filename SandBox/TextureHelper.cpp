@@ -7,8 +7,9 @@
 #define TINYGLTF_IMPLEMENTATION
 #include <tiny_gltf.h>
 
-void TextureHelper::copyBufferToImage(VkCommandBuffer& cmdBuff, VkBuffer& buffer, VkImage& image, VkImageLayout finalLayout, DeviceHelper* pD, int layerCount, uint32_t width, uint32_t height) {
+void TextureHelper::copyBufferToImage(VkCommandBuffer& cmdBuff, VkBuffer& buffer, VkImage& image, VkImageLayout finalLayout, DeviceHelper* pD, int layerCount, uint32_t width, uint32_t height, VkDeviceSize bufferOffset) {
     VkBufferImageCopy region{};
+    region.bufferOffset = bufferOffset;
     region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     region.imageSubresource.mipLevel = 0;
     region.imageSubresource.baseArrayLayer = 0;
@@ -41,7 +42,8 @@ void TextureHelper::createTextureImages() {
     if (pInputModel_->images.size() == 0) {
         return;
     }
-    tinygltf::Image& curImage = pInputModel_->images[0];
+    // BOUND TO THE IMAGE BEING LOADED. ASSIGNING THROUGH A REFERENCE TO images[0] WOULD OVERWRITE images[0] WITH EVERY OTHER IMAGE
+    tinygltf::Image& curImage = pInputModel_->images[index_ >= 0 ? index_ : 0];
     VkDeviceSize imageSize;
     bool dummy = false;
     stbi_uc* pixels = nullptr;
@@ -91,7 +93,18 @@ void TextureHelper::createTextureImages() {
         dummy = true;
         break;
     default:
-        curImage = pInputModel_->images[index_];
+        // IMAGES KEPT ENCODED FOR THE TEXTURE STREAMER (OR READ BACK THAT WAY FROM THE MODEL CACHE) ARE DECODED HERE WHEN LOADED SYNCHRONOUSLY
+        if (curImage.component == 0) {
+            stbi_uc* decoded = stbi_load_from_memory(curImage.image.data(), static_cast<int>(curImage.image.size()), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            if (!decoded) {
+                throw std::runtime_error("failed to decode texture image!");
+            }
+            curImage.image.assign(decoded, decoded + static_cast<size_t>(texWidth) * texHeight * 4);
+            curImage.width = texWidth;
+            curImage.height = texHeight;
+            curImage.component = 4;
+            stbi_image_free(decoded);
+        }
 
         if (curImage.component == 3) {
             buffSize = static_cast<VkDeviceSize>(curImage.width) * curImage.height * 4;
@@ -135,7 +148,7 @@ void TextureHelper::createTextureImages() {
         VkCommandBuffer cmdBuff = pDevHelper_->beginSingleTimeCommands();
         pDevHelper_->transitionImageLayout(cmdBuff, subresource, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, textureImage_);
         copyBufferToImage(cmdBuff, stagingBuffer, textureImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, pDevHelper_, 1, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-        generateMipmaps(cmdBuff, textureImage_, pDevHelper_, 1, imageFormat_, curImage.width, curImage.height, this->mipLevels_);
+        generateMipmaps(cmdBuff, textureImage_, pDevHelper_, 1, imageFormat_, texWidth, texHeight, this->mipLevels_);
         pDevHelper_->endSingleTimeCommands(cmdBuff);
 
         vkDestroyBuffer(pDevHelper_->device_, stagingBuffer, nullptr);
@@ -189,6 +202,62 @@ void TextureHelper::createTextureImages() {
 }
 
 
+// COOKED TEXTURES ALREADY CARRY EVERY MIP, SO ALL LEVELS GO UP IN ONE COPY WITH NO BLIT CHAIN. GPUS WITHOUT BC SUPPORT GET THE SAME MIPS DECOMPRESSED ON THE CPU
+void TextureHelper::createCookedTextureImage() {
+    TextureCooker::CookedTexture* cooked = pCooked_;
+    TextureCooker::CookedTexture expanded;
+    if (TextureCooker::isBlockCompressed(cooked->format) && !pDevHelper_->textureCompressionBC_) {
+        TextureCooker::decompress(*cooked, expanded);
+        cooked = &expanded;
+    }
+
+    this->imageFormat_ = cooked->format;
+    this->swizzle_ = cooked->swizzle;
+    this->mipLevels_ = static_cast<uint32_t>(cooked->levels.size());
+
+    VkDeviceSize buffSize = cooked->data.size();
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    pDevHelper_->createBuffer(buffSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+    void* data;
+    vkMapMemory(pDevHelper_->device_, stagingBufferMemory, 0, buffSize, 0, &data);
+    memcpy(data, cooked->data.data(), static_cast<size_t>(buffSize));
+    vkUnmapMemory(pDevHelper_->device_, stagingBufferMemory);
+
+    VkImageSubresourceRange subresource{};
+    subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    subresource.levelCount = mipLevels_;
+    subresource.layerCount = 1;
+
+    pDevHelper_->createImage(cooked->width, cooked->height, mipLevels_, 1, static_cast<VkImageCreateFlagBits>(0), VK_SAMPLE_COUNT_1_BIT, imageFormat_, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage_, textureImageMemory_);
+
+    std::vector<VkBufferImageCopy> regions(mipLevels_);
+    for (uint32_t level = 0; level < mipLevels_; level++) {
+        VkBufferImageCopy& region = regions[level];
+        region = {};
+        region.bufferOffset = cooked->levels[level].byteOffset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent.width = std::max(1u, cooked->width >> level);
+        region.imageExtent.height = std::max(1u, cooked->height >> level);
+        region.imageExtent.depth = 1;
+    }
+
+    VkCommandBuffer cmdBuff = pDevHelper_->beginSingleTimeCommands();
+    pDevHelper_->transitionImageLayout(cmdBuff, subresource, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, textureImage_);
+    vkCmdCopyBufferToImage(cmdBuff, stagingBuffer, textureImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+    pDevHelper_->transitionImageLayout(cmdBuff, subresource, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textureImage_);
+    pDevHelper_->endSingleTimeCommands(cmdBuff);
+
+    vkDestroyBuffer(pDevHelper_->device_, stagingBuffer, nullptr);
+    vkFreeMemory(pDevHelper_->device_, stagingBufferMemory, nullptr);
+
+    std::cout << "loaded: cooked " << TextureCooker::formatName(imageFormat_) << " " << cooked->width << "x" << cooked->height << ", " << mipLevels_ << " mips" << std::endl;
+}
+
 void TextureHelper::generateMipmaps(VkCommandBuffer& commandBuffer, VkImage& image, DeviceHelper* pD, int arrayLayers, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels) {
     VkFormatProperties formatProperties;
     vkGetPhysicalDeviceFormatProperties(pD->gpu_, imageFormat, &formatProperties);
@@ -272,7 +341,7 @@ void TextureHelper::generateMipmaps(VkCommandBuffer& commandBuffer, VkImage& ima
 }
 
 void TextureHelper::createTextureImageView(VkFormat f) {
-    pDevHelper_->createImageView(textureImage_, textureImageView_, imageFormat_, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels_);
+    pDevHelper_->createImageView(textureImage_, textureImageView_, imageFormat_, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels_, swizzle_);
 }
 
 void TextureHelper::createTextureImageSampler() {
@@ -303,7 +372,14 @@ void TextureHelper::createTextureImageSampler() {
 }
 
 void TextureHelper::load() {
-    createTextureImages();
+    if (pCooked_) {
+        createCookedTextureImage();
+        delete pCooked_;
+        pCooked_ = nullptr;
+    }
+    else {
+        createTextureImages();
+    }
     createTextureImageView();
     createTextureImageSampler();
 }
@@ -338,6 +414,7 @@ TextureHelper::~TextureHelper() {
     vkDestroyImage(pDevHelper_->device_, this->textureImage_, nullptr);
     vkDestroyImageView(pDevHelper_->device_, this->textureImageView_, nullptr);
     vkDestroySampler(pDevHelper_->device_, this->textureSampler_, nullptr);
+    delete pCooked_;
     delete pInputModel_;
     this->pDevHelper_ = nullptr;
 }
\ No newline at end of file
@@ -1,11 +1,14 @@
 #pragma once
 
 #include "DeviceHelper.h"
+#include "TextureCooker.h"
 #include "stb_image.h"
 #include <tiny_gltf.h>
 
 class TextureHelper {
 private:
+    friend class TextureStreamer;
+
     uint32_t mipLevels_;
     std::string texPath_;
     int index_;
@@ -14,20 +17,24 @@ private:
     VkDeviceMemory textureImageMemory_;
     DeviceHelper* pDevHelper_;
     tinygltf::Model* pInputModel_;
+    VkComponentMapping swizzle_ = {};
 
     void createTextureImages();
+    void createCookedTextureImage();
     void createTextureImageView(VkFormat f = VK_FORMAT_R8G8B8A8_SRGB);
     void createTextureImageSampler();
 
 public:
     VkFormat imageFormat_ = VK_FORMAT_R8G8B8A8_UNORM;
+    bool resident_ = true;
+    TextureCooker::CookedTexture* pCooked_ = nullptr;
 
     VkImageView textureImageView_;
     VkSampler textureSampler_;
     VkDescriptorSet descriptorSet_;
 
     static void generateMipmaps(VkCommandBuffer& commandBuffer, VkImage& image, DeviceHelper* pD, int arrayLayers, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
-    static void copyBufferToImage(VkCommandBuffer& cmdBuff, VkBuffer& buffer, VkImage& image, VkImageLayout finalLayout, DeviceHelper* pD, int layerCount, uint32_t width, uint32_t height);
+    static void copyBufferToImage(VkCommandBuffer& cmdBuff, VkBuffer& buffer, VkImage& image, VkImageLayout finalLayout, DeviceHelper* pD, int layerCount, uint32_t width, uint32_t height, VkDeviceSize bufferOffset = 0);
     void load();
 
     TextureHelper(tinygltf::Model& mod, int32_t textureIndex, DeviceHelper* pD);
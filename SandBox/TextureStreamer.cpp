@@ -0,0 +1,366 @@
+#include "TextureStreamer.h"
+
+constexpr uint32_t MATERIAL_TEXTURE_BINDINGS = 5;
+constexpr uint32_t MATERIAL_SET_BINDINGS = 9;
+
+void TextureStreamer::enqueue(TextureHelper* texture, GLTFObj* owner, tinygltf::Image& image) {
+    // AN IMAGE stb CAN'T EVEN READ THE HEADER OF FAILS AT LOAD, AS IT DOES WITHOUT STREAMING
+    int texWidth, texHeight, texChannels;
+    if (image.component == 0 && !stbi_info_from_memory(image.image.data(), static_cast<int>(image.image.size()), &texWidth, &texHeight, &texChannels)) {
+        throw std::runtime_error("failed to decode texture image!");
+    }
+
+    StreamRequest* request = new StreamRequest{};
+    request->texture = texture;
+    request->owner = owner;
+    request->pixels = std::move(image.image);
+    request->width = image.width;
+    request->height = image.height;
+    request->component = image.component;
+
+    texture->resident_ = false;
+    numRequested_++;
+
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        pendingDecode_.push_back(request);
+    }
+    pendingCondition_.notify_one();
+}
+
+// DECODES (OR EXPANDS RGB TO RGBA) OFF THE MAIN THREAD, THE RESULT IS ALWAYS TIGHTLY PACKED RGBA8
+void TextureStreamer::workerLoop() {
+    while (true) {
+        StreamRequest* request = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(pendingMutex_);
+            pendingCondition_.wait(lock, [this] { return stopping_ || !pendingDecode_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            request = pendingDecode_.front();
+            pendingDecode_.pop_front();
+        }
+
+        if (request->component == 0) {
+            int texWidth, texHeight, texChannels;
+            stbi_uc* decoded = stbi_load_from_memory(request->pixels.data(), static_cast<int>(request->pixels.size()), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            if (decoded) {
+                request->pixels.assign(decoded, decoded + static_cast<size_t>(texWidth) * texHeight * 4);
+                request->width = texWidth;
+                request->height = texHeight;
+                request->component = 4;
+                stbi_image_free(decoded);
+            }
+            else {
+                request->failed = true;
+            }
+        }
+        else if (request->component == 3) {
+            std::vector<unsigned char> rgba(static_cast<size_t>(request->width) * request->height * 4, 255);
+            for (size_t j = 0; j < static_cast<size_t>(request->width) * request->height; j++) {
+                memcpy(&rgba[j * 4], &request->pixels[j * 3], 3);
+            }
+            request->pixels = std::move(rgba);
+            request->component = 4;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(decodedMutex_);
+            decoded_.push_back(request);
+        }
+    }
+}
+
+bool TextureStreamer::allocateRing(VkDeviceSize size, VkDeviceSize& offset) {
+    size = (size + 15) & ~static_cast<VkDeviceSize>(15);
+    if (ringHead_ >= ringTail_) {
+        if (ringHead_ + size <= ringSize_) {
+            offset = ringHead_;
+            ringHead_ += size;
+            return true;
+        }
+        if (size < ringTail_) {
+            offset = 0;
+            ringHead_ = size;
+            return true;
+        }
+        return false;
+    }
+    if (ringHead_ + size < ringTail_) {
+        offset = ringHead_;
+        ringHead_ += size;
+        return true;
+    }
+    return false;
+}
+
+void TextureStreamer::recordUpload(VkCommandBuffer commandBuffer, StreamRequest* request, VkBuffer stagingBuffer, VkDeviceSize stagingOffset) {
+    TextureHelper* t = request->texture;
+    t->mipLevels_ = static_cast<uint32_t>(std::floor(std::log2(std::max(request->width, request->height)))) + 1;
+
+    VkImageSubresourceRange subresource{};
+    subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    subresource.levelCount = t->mipLevels_;
+    subresource.layerCount = 1;
+
+    pDevHelper_->createImage(request->width, request->height, t->mipLevels_, 1, static_cast<VkImageCreateFlagBits>(0), VK_SAMPLE_COUNT_1_BIT, t->imageFormat_, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, t->textureImage_, t->textureImageMemory_);
+
+    pDevHelper_->transitionImageLayout(commandBuffer, subresource, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, t->textureImage_);
+    TextureHelper::copyBufferToImage(commandBuffer, stagingBuffer, t->textureImage_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, pDevHelper_, 1, request->width, request->height, stagingOffset);
+    TextureHelper::generateMipmaps(commandBuffer, t->textureImage_, pDevHelper_, 1, t->imageFormat_, request->width, request->height, t->mipLevels_);
+
+    t->createTextureImageView();
+    t->createTextureImageSampler();
+}
+
+// MATERIAL SETS MAY STILL BE BOUND BY FRAMES IN FLIGHT, SO INSTEAD OF WRITING INTO THEM A NEW SET IS ALLOCATED, THE OLD ONE IS COPIED ACROSS,
+// THE NOW RESIDENT TEXTURES ARE WRITTEN ON TOP AND THE OLD SET IS FREED ONCE EVERY FRAME THAT COULD HAVE USED IT HAS RETIRED
+void TextureStreamer::patchMaterials(const std::vector<StreamRequest*>& requests, uint64_t frameNumber) {
+    std::unordered_map<Material*, std::vector<std::pair<uint32_t, TextureHelper*>>> patches;
+    for (StreamRequest* request : requests) {
+        GLTFObj* owner = request->owner;
+        for (Material& m : owner->mats_) {
+            if (m.descriptorSet == VK_NULL_HANDLE) {
+                continue;
+            }
+            uint32_t texIndices[MATERIAL_TEXTURE_BINDINGS] = { m.baseColorTexIndex, m.normalTexIndex, m.metallicRoughnessIndex, m.aoIndex, m.emissionIndex };
+            for (uint32_t binding = 0; binding < MATERIAL_TEXTURE_BINDINGS; binding++) {
+                if (owner->images_[owner->textureIndices_[texIndices[binding]]] == request->texture) {
+                    patches[&m].push_back(std::make_pair(binding, request->texture));
+                }
+            }
+        }
+    }
+
+    for (auto& [material, bindings] : patches) {
+        VkDescriptorSetAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocateInfo.descriptorPool = pDevHelper_->descPool_;
+        allocateInfo.descriptorSetCount = 1;
+        allocateInfo.pSetLayouts = &(pDevHelper_->texDescSetLayout_);
+
+        VkDescriptorSet newSet;
+        if (vkAllocateDescriptorSets(pDevHelper_->device_, &allocateInfo, &newSet) != VK_SUCCESS) {
+            std::cout << "texture streamer could not allocate a material set" << std::endl;
+            continue;
+        }
+
+        std::array<VkCopyDescriptorSet, MATERIAL_SET_BINDINGS> copies{};
+        for (uint32_t i = 0; i < MATERIAL_SET_BINDINGS; i++) {
+            copies[i].sType = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET;
+            copies[i].srcSet = material->descriptorSet;
+            copies[i].srcBinding = i;
+            copies[i].dstSet = newSet;
+            copies[i].dstBinding = i;
+            copies[i].descriptorCount = 1;
+        }
+        vkUpdateDescriptorSets(pDevHelper_->device_, 0, nullptr, static_cast<uint32_t>(copies.size()), copies.data());
+
+        std::vector<VkDescriptorImageInfo> imageInfos(bindings.size());
+        std::vector<VkWriteDescriptorSet> writes(bindings.size());
+        for (size_t i = 0; i < bindings.size(); i++) {
+            imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageInfos[i].imageView = bindings[i].second->textureImageView_;
+            imageInfos[i].sampler = bindings[i].second->textureSampler_;
+
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = newSet;
+            writes[i].dstBinding = bindings[i].first;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[i].descriptorCount = 1;
+            writes[i].pImageInfo = &imageInfos[i];
+        }
+        vkUpdateDescriptorSets(pDevHelper_->device_, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+        retiredSets_.push_back(RetiredSet{ material->descriptorSet, frameNumber + maxFramesInFlight_ + 1 });
+        material->descriptorSet = newSet;
+    }
+}
+
+void TextureStreamer::retireBatches(uint64_t frameNumber) {
+    while (!inFlight_.empty() && vkGetFenceStatus(pDevHelper_->device_, inFlight_.front().fence) == VK_SUCCESS) {
+        UploadBatch& batch = inFlight_.front();
+
+        for (StreamRequest* request : batch.requests) {
+            request->texture->resident_ = true;
+            numResident_++;
+        }
+        patchMaterials(batch.requests, frameNumber);
+
+        vkFreeCommandBuffers(pDevHelper_->device_, pDevHelper_->commandPool_, 1, &batch.commandBuffer);
+        vkDestroyFence(pDevHelper_->device_, batch.fence, nullptr);
+        for (auto& staging : batch.dedicatedStaging) {
+            vkDestroyBuffer(pDevHelper_->device_, staging.first, nullptr);
+            vkFreeMemory(pDevHelper_->device_, staging.second, nullptr);
+        }
+        for (StreamRequest* request : batch.requests) {
+            delete request;
+        }
+
+        inFlight_.pop_front();
+    }
+
+    if (inFlight_.empty()) {
+        ringHead_ = 0;
+        ringTail_ = 0;
+    }
+    else {
+        ringTail_ = inFlight_.front().ringStart;
+    }
+}
+
+// CALLED ONCE PER FRAME FROM THE MAIN THREAD, ALL QUEUE AND DESCRIPTOR WORK STAYS HERE
+void TextureStreamer::update(uint64_t frameNumber) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    retireBatches(frameNumber);
+
+    for (size_t i = 0; i < retiredSets_.size();) {
+        if (retiredSets_[i].freeAfterFrame <= frameNumber) {
+            vkFreeDescriptorSets(pDevHelper_->device_, pDevHelper_->descPool_, 1, &retiredSets_[i].set);
+            retiredSets_[i] = retiredSets_.back();
+            retiredSets_.pop_back();
+        }
+        else {
+            i++;
+        }
+    }
+
+    UploadBatch batch{};
+    batch.ringStart = ringHead_;
+    VkDeviceSize bytesThisFrame = 0;
+
+    while (bytesThisFrame < maxBytesPerFrame_) {
+        StreamRequest* request = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(decodedMutex_);
+            if (decoded_.empty()) {
+                break;
+            }
+            request = decoded_.front();
+            decoded_.pop_front();
+        }
+
+        if (request->failed) {
+            numFailed_++;
+            delete request;
+            continue;
+        }
+
+        VkDeviceSize size = request->pixels.size();
+        VkBuffer stagingBuffer = ringBuffer_;
+        VkDeviceSize stagingOffset = 0;
+
+        if (size > ringSize_) {
+            VkDeviceMemory stagingMemory;
+            pDevHelper_->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingMemory);
+            void* data;
+            vkMapMemory(pDevHelper_->device_, stagingMemory, 0, size, 0, &data);
+            memcpy(data, request->pixels.data(), size);
+            vkUnmapMemory(pDevHelper_->device_, stagingMemory);
+            batch.dedicatedStaging.push_back(std::make_pair(stagingBuffer, stagingMemory));
+        }
+        else if (allocateRing(size, stagingOffset)) {
+            memcpy(ringMapped_ + stagingOffset, request->pixels.data(), size);
+        }
+        else {
+            std::lock_guard<std::mutex> lock(decodedMutex_);
+            decoded_.push_front(request);
+            break;
+        }
+
+        if (batch.requests.empty()) {
+            batch.commandBuffer = pDevHelper_->beginSingleTimeCommands();
+        }
+
+        recordUpload(batch.commandBuffer, request, stagingBuffer, stagingOffset);
+
+        request->pixels.clear();
+        request->pixels.shrink_to_fit();
+        batch.requests.push_back(request);
+        bytesThisFrame += size;
+    }
+
+    if (!batch.requests.empty()) {
+        vkEndCommandBuffer(batch.commandBuffer);
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        vkCreateFence(pDevHelper_->device_, &fenceInfo, nullptr, &batch.fence);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &batch.commandBuffer;
+
+        if (vkQueueSubmit(pDevHelper_->graphicsQueue_, 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+            std::_Xruntime_error("Failed to submit a texture streaming batch!");
+        }
+
+        inFlight_.push_back(std::move(batch));
+    }
+
+    lastUploadMs_ = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void TextureStreamer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    pendingCondition_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+TextureStreamer::TextureStreamer(DeviceHelper* pD, int maxFramesInFlight, VkDeviceSize ringSize, VkDeviceSize maxBytesPerFrame) {
+    this->pDevHelper_ = pD;
+    this->maxFramesInFlight_ = maxFramesInFlight;
+    this->ringSize_ = ringSize;
+    this->maxBytesPerFrame_ = maxBytesPerFrame;
+
+    pDevHelper_->createBuffer(ringSize_, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, ringBuffer_, ringMemory_);
+    void* data;
+    vkMapMemory(pDevHelper_->device_, ringMemory_, 0, ringSize_, 0, &data);
+    ringMapped_ = static_cast<unsigned char*>(data);
+
+    uint32_t numWorkers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    for (uint32_t i = 0; i < numWorkers; i++) {
+        workers_.emplace_back(&TextureStreamer::workerLoop, this);
+    }
+}
+
+TextureStreamer::~TextureStreamer() {
+    stop();
+
+    for (UploadBatch& batch : inFlight_) {
+        vkWaitForFences(pDevHelper_->device_, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+        vkFreeCommandBuffers(pDevHelper_->device_, pDevHelper_->commandPool_, 1, &batch.commandBuffer);
+        vkDestroyFence(pDevHelper_->device_, batch.fence, nullptr);
+        for (auto& staging : batch.dedicatedStaging) {
+            vkDestroyBuffer(pDevHelper_->device_, staging.first, nullptr);
+            vkFreeMemory(pDevHelper_->device_, staging.second, nullptr);
+        }
+        for (StreamRequest* request : batch.requests) {
+            delete request;
+        }
+    }
+    for (StreamRequest* request : pendingDecode_) {
+        delete request;
+    }
+    for (StreamRequest* request : decoded_) {
+        delete request;
+    }
+
+    vkUnmapMemory(pDevHelper_->device_, ringMemory_);
+    vkDestroyBuffer(pDevHelper_->device_, ringBuffer_, nullptr);
+    vkFreeMemory(pDevHelper_->device_, ringMemory_, nullptr);
+    pDevHelper_ = nullptr;
+}
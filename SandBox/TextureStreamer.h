@@ -0,0 +1,76 @@
+#pragma once
+
+#include "GLTFObject.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+// STREAMS MODEL TEXTURES IN AFTER STARTUP. MATERIALS ARE FIRST BOUND TO THE DUMMY TEXTURES, IMAGES ARE DECODED ON WORKER THREADS,
+// COPIED THROUGH A PERSISTENTLY MAPPED RING STAGING BUFFER AND THE MATERIAL DESCRIPTOR SETS ARE SWAPPED ONCE THE UPLOAD FENCE SIGNALS
+class TextureStreamer {
+public:
+	struct StreamRequest {
+		TextureHelper* texture;
+		GLTFObj* owner;
+		std::vector<unsigned char> pixels; // ENCODED (PNG/JPG) UNTIL A WORKER DECODES IT TO RGBA
+		int32_t width;
+		int32_t height;
+		int32_t component;
+		bool failed = false; // THE WORKER COULD NOT DECODE IT, update COUNTS IT AND THE TEXTURE KEEPS ITS PLACEHOLDER
+	};
+
+	uint32_t numRequested_ = 0;
+	uint32_t numResident_ = 0;
+	uint32_t numFailed_ = 0; // numResident_ + numFailed_ REACHES numRequested_ ONCE EVERYTHING IS STREAMED
+	float lastUploadMs_ = 0.0f;
+
+	void enqueue(TextureHelper* texture, GLTFObj* owner, tinygltf::Image& image);
+	void update(uint64_t frameNumber);
+	void stop();
+
+	TextureStreamer(DeviceHelper* pD, int maxFramesInFlight, VkDeviceSize ringSize = 64 * 1024 * 1024, VkDeviceSize maxBytesPerFrame = 32 * 1024 * 1024);
+	~TextureStreamer();
+
+private:
+	struct UploadBatch {
+		VkCommandBuffer commandBuffer;
+		VkFence fence;
+		VkDeviceSize ringStart;
+		std::vector<StreamRequest*> requests;
+		std::vector<std::pair<VkBuffer, VkDeviceMemory>> dedicatedStaging;
+	};
+
+	struct RetiredSet {
+		VkDescriptorSet set;
+		uint64_t freeAfterFrame;
+	};
+
+	DeviceHelper* pDevHelper_;
+	int maxFramesInFlight_;
+
+	VkBuffer ringBuffer_;
+	VkDeviceMemory ringMemory_;
+	unsigned char* ringMapped_;
+	VkDeviceSize ringSize_;
+	VkDeviceSize ringHead_ = 0;
+	VkDeviceSize ringTail_ = 0;
+	VkDeviceSize maxBytesPerFrame_;
+
+	std::vector<std::thread> workers_;
+	std::mutex pendingMutex_;
+	std::condition_variable pendingCondition_;
+	std::deque<StreamRequest*> pendingDecode_;
+	std::mutex decodedMutex_;
+	std::deque<StreamRequest*> decoded_;
+	bool stopping_ = false;
+
+	std::deque<UploadBatch> inFlight_;
+	std::vector<RetiredSet> retiredSets_;
+
+	void workerLoop();
+	bool allocateRing(VkDeviceSize size, VkDeviceSize& offset);
+	void retireBatches(uint64_t frameNumber);
+	void patchMaterials(const std::vector<StreamRequest*>& requests, uint64_t frameNumber);
+	void recordUpload(VkCommandBuffer commandBuffer, StreamRequest* request, VkBuffer stagingBuffer, VkDeviceSize stagingOffset);
+};
@@ -15,9 +15,9 @@ void TrainObject::updatePosition() {
 	trainBodyObject->transform.position = transform.position;
 	trainLeftDoorObject->transform.position = transform.position + leftDoorTransform.position;
 	trainRightDoorObject->transform.position = transform.position + rightDoorTransform.position;
-	trainBodyObject->renderTarget->localModelTransform = trainBodyObject->transform.to_matrix();
-	trainLeftDoorObject->renderTarget->localModelTransform = trainLeftDoorObject->transform.to_matrix();
-	trainRightDoorObject->renderTarget->localModelTransform = trainRightDoorObject->transform.to_matrix();
+	trainBodyObject->setTransform(trainBodyObject->transform.to_matrix());
+	trainLeftDoorObject->setTransform(trainLeftDoorObject->transform.to_matrix());
+	trainRightDoorObject->setTransform(trainRightDoorObject->transform.to_matrix());
 }
 
 void TrainObject::loopUpdate() {
@@ -0,0 +1,154 @@
+#include "VertexWelder.h"
+
+void VertexWelder::makeKey(const Vertex& v, double inverseEpsilon, uint64_t key[KEY_WORDS]) {
+    const double CELL_LIMIT = 4611686018427387904.0; // 2^62
+    const float* components[3] = { &v.pos.x, &v.normal.x, &v.tangent.x };
+    for (uint32_t c = 0; c < 3; c++) {
+        for (uint32_t i = 0; i < 4; i++) {
+            float f = components[c][i] + 0.0f; // -0 -> +0 SO THE KEY AGREES WITH operator==
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(uint32_t));
+            int64_t q = bits;
+            if (inverseEpsilon > 0.0) {
+                double cell = std::floor(static_cast<double>(f) * inverseEpsilon + 0.5);
+                if (std::abs(cell) < CELL_LIMIT) {
+                    q = static_cast<int64_t>(cell);
+                }
+                else {
+                    // OUT OF RANGE OR NaN, ABOVE EVERY CELL AND BELOW EVERY NEGATIVE ONE
+                    q = static_cast<int64_t>(CELL_LIMIT) + (bits & 0x7FFFFFFFu);
+                    q = (bits >> 31) ? -q : q;
+                }
+            }
+            key[c * 4 + i] = static_cast<uint64_t>(q);
+        }
+    }
+}
+
+// PER WORD MULTIPLY/XOR MIX WITH A MURMUR3 FINALISER, EVERY INPUT BIT REACHES THE TOP BITS THAT PICK THE SHARD
+uint64_t VertexWelder::hashKey(const uint64_t key[KEY_WORDS]) {
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (uint32_t i = 0; i < KEY_WORDS; i++) {
+        h ^= key[i];
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+void VertexWelder::weldShard(const std::vector<Vertex>& vertices, const std::vector<uint64_t>& hashes, const std::vector<uint32_t>& members, double inverseEpsilon, std::vector<uint32_t>& representative) {
+    size_t capacity = 16;
+    while (capacity < members.size() * 2) {
+        capacity <<= 1;
+    }
+    const size_t mask = capacity - 1;
+    std::vector<uint32_t> slots(capacity, UINT32_MAX);
+
+    uint64_t key[KEY_WORDS];
+    uint64_t otherKey[KEY_WORDS];
+    for (uint32_t i : members) {
+        if (inverseEpsilon > 0.0) {
+            makeKey(vertices[i], inverseEpsilon, key);
+        }
+        size_t slot = static_cast<size_t>(hashes[i]) & mask;
+        while (true) {
+            uint32_t occupant = slots[slot];
+            if (occupant == UINT32_MAX) {
+                slots[slot] = i;
+                representative[i] = i;
+                break;
+            }
+            if (hashes[occupant] == hashes[i]) {
+                // EXACT MODE COMPARES THE VERTICES DIRECTLY, ONLY THE SNAPPED KEYS NEED REBUILDING
+                bool same = false;
+                if (inverseEpsilon > 0.0) {
+                    makeKey(vertices[occupant], inverseEpsilon, otherKey);
+                    same = memcmp(key, otherKey, sizeof(key)) == 0;
+                }
+                else {
+                    same = vertices[occupant] == vertices[i];
+                }
+                if (same) {
+                    representative[i] = occupant;
+                    break;
+                }
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+}
+
+void VertexWelder::weld(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t indexBase, float epsilon, JobSystem* jobs) {
+    const size_t count = vertices.size();
+    const double inverseEpsilon = epsilon > 0.0f ? 1.0 / static_cast<double>(epsilon) : 0.0;
+
+    std::vector<uint64_t> hashes(count);
+    std::vector<uint32_t> representative(count);
+
+    uint32_t numShards = 1;
+    if (count >= PARALLEL_THRESHOLD && jobs) {
+        const uint32_t threads = jobs->activeWorkers() + 1;
+        while (numShards < threads && numShards < 64) {
+            numShards <<= 1;
+        }
+    }
+
+    if (numShards == 1) {
+        uint64_t key[KEY_WORDS];
+        std::vector<uint32_t> members(count);
+        for (size_t i = 0; i < count; i++) {
+            makeKey(vertices[i], inverseEpsilon, key);
+            hashes[i] = hashKey(key);
+            members[i] = static_cast<uint32_t>(i);
+        }
+        weldShard(vertices, hashes, members, inverseEpsilon, representative);
+    }
+    else {
+        uint32_t shardShift = 64;
+        for (uint32_t s = numShards; s > 1; s >>= 1) {
+            shardShift--;
+        }
+
+        // HASH IN CONTIGUOUS CHUNKS, THEN BUCKET BY THE TOP BITS (MEMBERS STAY IN ASCENDING ORDER SO THE FIRST OCCURRENCE WINS IN EVERY SHARD)
+        auto hashRange = [&](size_t begin, size_t end) {
+            uint64_t key[KEY_WORDS];
+            for (size_t i = begin; i < end; i++) {
+                makeKey(vertices[i], inverseEpsilon, key);
+                hashes[i] = hashKey(key);
+            }
+        };
+        jobs->parallelFor(count, (count + numShards - 1) / numShards, hashRange);
+
+        std::vector<std::vector<uint32_t>> shards(numShards);
+        for (std::vector<uint32_t>& shard : shards) {
+            shard.reserve(count / numShards + count / (numShards * 4) + 16);
+        }
+        for (size_t i = 0; i < count; i++) {
+            shards[hashes[i] >> shardShift].push_back(static_cast<uint32_t>(i));
+        }
+
+        auto weldShards = [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; t++) {
+                weldShard(vertices, hashes, shards[t], inverseEpsilon, representative);
+            }
+        };
+        jobs->parallelFor(numShards, 1, weldShards);
+    }
+
+    // REPRESENTATIVES ALWAYS COME FIRST, SO ONE IN ORDER PASS NUMBERS THE UNIQUE VERTICES AND COMPACTS THEM IN PLACE
+    std::vector<uint32_t> remap(count);
+    uint32_t unique = 0;
+    indices.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        if (representative[i] == i) {
+            remap[i] = unique;
+            vertices[unique] = vertices[i];
+            unique++;
+        }
+        indices[i] = remap[representative[i]] + indexBase;
+    }
+    vertices.resize(unique);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "MeshHelper.h"
+#include "JobSystem.h"
+
+// WELDS THE UNPACKED (ONE VERTEX PER INDEX) PRIMITIVES MIKKTSPACE WORKS ON BACK INTO AN INDEXED MESH. OPEN ADDRESSING TABLE OF uint32 SLOTS OVER A
+// MIXED 64 BIT HASH OF THE POSITION/NORMAL/TANGENT WORDS - NO PER VERTEX ALLOCATION. LARGE PRIMITIVES ARE SHARDED BY THE TOP HASH BITS ACROSS A JOB SYSTEM,
+// EACH SHARD OWNS ITS OWN TABLE AND THE FINAL NUMBERING IS STILL FIRST OCCURRENCE ORDER, SO THE OUTPUT IS IDENTICAL TO A SERIAL WELD
+class VertexWelder {
+public:
+	// PRIMITIVES SMALLER THAN THIS, OR WITHOUT A JOB SYSTEM, ARE WELDED ON THE CALLING THREAD
+	static constexpr size_t PARALLEL_THRESHOLD = 1 << 16;
+	static constexpr uint32_t KEY_WORDS = 12;
+
+	// EPSILON 0 WELDS BIT IDENTICAL VERTICES (-0 AND +0 ARE EQUAL), OTHERWISE EVERY COMPONENT IS SNAPPED TO AN epsilon GRID FIRST
+	static void weld(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t indexBase, float epsilon = 0.0f, JobSystem* jobs = nullptr);
+
+private:
+	// SNAPPED COMPONENTS ARE 64 BIT GRID CELLS. ONE TOO FAR OUT FOR THAT IS FURTHER FROM THE ORIGIN THAN epsilon TIMES 2^62, WHERE FLOATS ARE ALREADY
+	// COARSER THAN THE GRID, SO IT KEEPS ITS EXACT VALUE, TAGGED SO IT CAN'T EQUAL A CELL
+	static void makeKey(const Vertex& v, double inverseEpsilon, uint64_t key[KEY_WORDS]);
+	static uint64_t hashKey(const uint64_t key[KEY_WORDS]);
+	static void weldShard(const std::vector<Vertex>& vertices, const std::vector<uint64_t>& hashes, const std::vector<uint32_t>& members, double inverseEpsilon, std::vector<uint32_t>& representative);
+};
@@ -32,6 +32,9 @@ void VulkanRenderer::updateUniformBuffer(uint32_t currentImage) {
     ubo.gammaExposure.w = nDotVSpec;
 
     memcpy(mappedFrustrumPlaneBuffers[currentFrame_], camera_.frustumPlanes.data(), (6 * sizeof(glm::vec4)));
+    for (int i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++) {
+        memcpy(static_cast<glm::vec4*>(mappedShadowCascadePlaneBuffers_[currentFrame_]) + i * 6, pDirectionalLight_->cascades[currentFrame_][i].frustumPlanes.data(), 6 * sizeof(glm::vec4));
+    }
     memcpy(mappedBuffers_[currentFrame_], &ubo, sizeof(UniformBufferObject));
 }
 
@@ -57,9 +60,10 @@ void VulkanRenderer::drawNewFrame(SDL_Window * window, int maxFramesInFlight) {
     recordCommandBuffer(commandBuffers_[currentFrame_], imageIndex_);
 }
 
-void VulkanRenderer::fullDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, int materialPosition) {
-    for (IndirectBatch& draw : drawBatches)
+void VulkanRenderer::fullDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, const VkBuffer& countBuffer, int materialPosition) {
+    for (int i = 0; i < drawBatches.size(); i++)
     {
+        IndirectBatch& draw = drawBatches[i];
         if (draw.material->doubleSides) {
             vkCmdSetCullMode(commandBuffer, VK_CULL_MODE_BACK_BIT);
         }
@@ -73,7 +77,12 @@ void VulkanRenderer::fullDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout*
         VkDeviceSize indirect_offset = draw.first * sizeof(VkDrawIndexedIndirectCommand);
         uint32_t draw_stride = sizeof(VkDrawIndexedIndirectCommand);
 
-        vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, indirect_offset, draw.count, draw_stride);
+        if (i < animatedBatchIndex) {
+            vkCmdDrawIndexedIndirectCount(commandBuffer, drawBuffer, indirect_offset, countBuffer, i * sizeof(uint32_t), draw.count, draw_stride);
+        }
+        else {
+            vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, indirect_offset, draw.count, draw_stride);
+        }
     }
 }
 
@@ -91,7 +100,8 @@ void VulkanRenderer::animatedDraw(VkCommandBuffer& commandBuffer, VkPipelineLayo
     }
 }
 
-void VulkanRenderer::nonAnimatedDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, int materialPosition) {
+// THE CULL PACKS EVERY BATCH'S VISIBLE DRAWS FROM ITS FIRST SLOT, countBuffer HOLDS HOW MANY THERE ARE (ONE uint32_t PER STATIC BATCH)
+void VulkanRenderer::nonAnimatedDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, const VkBuffer& countBuffer, int materialPosition) {
     for (int i = 0; i < animatedBatchIndex; i++) {
         IndirectBatch& draw = drawBatches[i];
         VkDeviceSize indirect_offset = draw.first * sizeof(VkDrawIndexedIndirectCommand);
@@ -108,12 +118,14 @@ void VulkanRenderer::nonAnimatedDraw(VkCommandBuffer& commandBuffer, VkPipelineL
             vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *layout, materialPosition, 1, &(draw.material->descriptorSet), 0, nullptr);
         }
 
-        vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, indirect_offset, draw.count, draw_stride);
+        vkCmdDrawIndexedIndirectCount(commandBuffer, drawBuffer, indirect_offset, countBuffer, i * sizeof(uint32_t), draw.count, draw_stride);
     }
 }
 
-void VulkanRenderer::shadowDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, int materialPosition) {
-    for (IndirectBatch& draw : drawBatches) {
+// STATIC BATCHES DRAW THE CASCADE'S CULLED CASTERS OUT OF ITS REGION OF drawBuffer, THE ANIMATED ONES EVERYTHING FROM drawCallBuffer
+void VulkanRenderer::shadowDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, const VkBuffer& countBuffer, uint32_t cascadeIndex, int materialPosition) {
+    for (int i = 0; i < drawBatches.size(); i++) {
+        IndirectBatch& draw = drawBatches[i];
         if (draw.material->doubleSides) {
             vkCmdSetCullMode(commandBuffer, VK_CULL_MODE_NONE);
         }
@@ -124,10 +136,65 @@ void VulkanRenderer::shadowDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout
         VkDeviceSize indirect_offset = draw.first * sizeof(VkDrawIndexedIndirectCommand);
         uint32_t draw_stride = sizeof(VkDrawIndexedIndirectCommand);
 
-        vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, indirect_offset, draw.count, draw_stride);
+        if (i < animatedBatchIndex) {
+            VkDeviceSize cascadeOffset = cascadeIndex * drawCommands.size() * sizeof(VkDrawIndexedIndirectCommand);
+            VkDeviceSize countOffset = (cascadeIndex * animatedBatchIndex + i) * sizeof(uint32_t);
+            vkCmdDrawIndexedIndirectCount(commandBuffer, drawBuffer, cascadeOffset + indirect_offset, countBuffer, countOffset, draw.count, draw_stride);
+        }
+        else {
+            vkCmdDrawIndexedIndirect(commandBuffer, drawCallBuffer, indirect_offset, draw.count, draw_stride);
+        }
     }
 }
 
+// OPAQUE BATCHES ONLY FETCH THE POSITION STREAM, ALPHA TESTED ONES SWITCH TO THE POSITION + UV PIPELINE FOR THE CUTOUT. STATIC BATCHES DRAW THE
+// CULL'S PACKED COMMANDS UP TO countBuffer'S COUNT, THE ANIMATED ONES (SKIPPED WITHOUT includeAnimated) ARE NEVER CULLED
+void VulkanRenderer::depthDraw(VkCommandBuffer& commandBuffer, const VkBuffer& drawBuffer, const VkBuffer& countBuffer, bool includeAnimated) {
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, prepassPipeline_->pipeline);
+    vkCmdSetCullMode(commandBuffer, VK_CULL_MODE_BACK_BIT);
+
+    const int numBatches = includeAnimated ? static_cast<int>(drawBatches.size()) : animatedBatchIndex;
+    uint32_t draw_stride = sizeof(VkDrawIndexedIndirectCommand);
+    auto drawBatch = [&](int i) {
+        IndirectBatch& draw = drawBatches[i];
+        VkDeviceSize indirect_offset = draw.first * sizeof(VkDrawIndexedIndirectCommand);
+        if (i < animatedBatchIndex) {
+            vkCmdDrawIndexedIndirectCount(commandBuffer, drawBuffer, indirect_offset, countBuffer, i * sizeof(uint32_t), draw.count, draw_stride);
+        }
+        else {
+            vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, indirect_offset, draw.count, draw_stride);
+        }
+    };
+
+    bool hasAlphaTested = false;
+    for (int i = 0; i < numBatches; i++) {
+        if (drawBatches[i].alphaTested) {
+            hasAlphaTested = true;
+            continue;
+        }
+        drawBatch(i);
+    }
+
+    if (!hasAlphaTested) {
+        return;
+    }
+
+    VkDeviceSize offset = 0;
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, alphaPrepassPipeline_->pipeline);
+    vkCmdBindVertexBuffers(commandBuffer, 1, 1, &uvBuffer_, &offset);
+
+    for (int i = 0; i < numBatches; i++) {
+        IndirectBatch& draw = drawBatches[i];
+        if (!draw.alphaTested) {
+            continue;
+        }
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, alphaPrepassPipeline_->layout, 1, 1, &(draw.material->descriptorSet), 0, nullptr);
+        drawBatch(i);
+    }
+
+    vkCmdBindVertexBuffers(commandBuffer, 1, 1, &attributeBuffer_, &offset);
+}
+
 void VulkanRenderer::renderBloom(VkCommandBuffer& commandBuffer) {
     VkDeviceSize offsets[] = { 0 };
     vkCmdBindVertexBuffers(commandBuffer, 0, 1, &screenQuadVertexBuffer, offsets);
@@ -180,37 +247,58 @@ void VulkanRenderer::renderBloom(VkCommandBuffer& commandBuffer) {
     }
 }
 
-void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
-    VkCommandBufferBeginInfo CBBeginInfo{};
-    CBBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    CBBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+// FRUSTUM/OCCLUSION CULL, THEN CLUSTER CULL. THE VISIBLE STATIC DRAWS ARE PACKED PER BATCH INTO THE FULL LAYOUT BUFFER THE INDIRECT DRAWS READ
+// AND COUNTED PER BATCH FOR vkCmdDrawIndexedIndirectCount. PHASE 0 FILLS finalDrawCallBuffers_/drawCountBuffers_, PHASE 1 lateFinalDrawCallBuffers_/
+// lateDrawCountBuffers_ WITH THE DRAWS THE EARLY PHASE CALLED OCCLUDED BUT THIS FRAME'S DEPTH DOESN'T HIDE. BOTH COUNT BUFFERS ARE ZEROED AT FRAME START
+void VulkanRenderer::recordCullPasses(VkCommandBuffer commandBuffer, int phase, const glm::mat4& viewProjection) {
+    VkDescriptorSet cullSet = (phase == 0) ? computeCullingDescriptorSets_[this->currentFrame_] : lateCullDescriptorSets_[this->currentFrame_];
+    VkDescriptorSet clusterSet = (phase == 0) ? clusterCullDescriptorSets_[this->currentFrame_] : lateClusterCullDescriptorSets_[this->currentFrame_];
 
-    if (vkBeginCommandBuffer(commandBuffer, &CBBeginInfo) != VK_SUCCESS) {
-        std::_Xruntime_error("Failed to start recording with the command buffer!");
+    if (phase == 1) {
+        // THE EARLY PREPASS IS STILL READING THE INDEX COPY THE LATE CLUSTER CULL WRITES (OTHER RANGES, BUT THE WRITES MUST NOT GET AHEAD OF IT)
+        VkMemoryBarrier2 lateMemoryBarrier{};
+        lateMemoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        lateMemoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
+        lateMemoryBarrier.srcAccessMask = 0;
+        lateMemoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        lateMemoryBarrier.dstAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+
+        VkDependencyInfo lateDependencyInfo{};
+        lateDependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        lateDependencyInfo.memoryBarrierCount = 1;
+        lateDependencyInfo.pMemoryBarriers = &lateMemoryBarrier;
+
+        vkCmdPipelineBarrier2(commandBuffer, &lateDependencyInfo);
     }
 
      // COMPUTE CULL PASS ////////////////////////////////////////////////////////////////////////
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computeCullPipeline_);
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computeCullPipelineLayout_, 0, 1, &computeCullingDescriptorSets_[this->currentFrame_], 0, nullptr);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computeCullPipelineLayout_, 0, 1, &cullSet, 0, nullptr);
 
     int numDraws = static_cast<int>(drawCommands.size()) - 2 - (drawCommands.size() - animatedIndex);
 
     ComputeCullPushConstant cmp{};
-    cmp.viewMatrix = camera_.viewMatrix;
+    cmp.viewProjection = viewProjection;
     cmp.numDraws = numDraws;
+    cmp.phase = phase;
+    cmp.occlusionEnabled = (phase == 1) || (occlusionCulling_ && hiZValid_);
+    cmp.numBatches = animatedBatchIndex;
+    cmp.pyramidSize = glm::vec4(pHiZ_->width_, pHiZ_->height_, pHiZ_->levels_, 0.0f);
+    cmp.cascadeStride = static_cast<int>(drawCommands.size());
 
     vkCmdPushConstants(commandBuffer, computeCullPipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ComputeCullPushConstant), &cmp);
     static const auto workgroupSize = 256;
     const auto groupSizeX = (uint32_t)std::ceil(numDraws / (float)workgroupSize);
     vkCmdDispatch(commandBuffer, groupSizeX, 1, 1);
 
+    // HOST FOR THE STATS, READ BACK WHEN THIS FRAME SLOT COMES AROUND AGAIN. DRAW_INDIRECT FOR THE PACKED COMMANDS AND COUNTS
     VkMemoryBarrier2 cullMemoryBarrier{};
     cullMemoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
     cullMemoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
     cullMemoryBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
-    cullMemoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-    cullMemoryBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+    cullMemoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_HOST_BIT;
+    cullMemoryBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT | VK_ACCESS_2_HOST_READ_BIT;
 
     VkDependencyInfo cullDependencyInfo{};
     cullDependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
@@ -219,45 +307,146 @@ void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
 
     vkCmdPipelineBarrier2(commandBuffer, &cullDependencyInfo);
 
-    VkBufferCopy copyRegion{};
-    copyRegion.size = sizeof(VkDrawIndexedIndirectCommand) * ((drawCommands.size() - (drawCommands.size() - animatedIndex)) - 2);
-    copyRegion.srcOffset = 0;
-    copyRegion.dstOffset = sizeof(VkDrawIndexedIndirectCommand) * 2;
-    vkCmdCopyBuffer(commandBuffer, mainCameraFinalDrawCallBuffer_[this->currentFrame_], finalDrawCallBuffers_[this->currentFrame_], 1, &copyRegion);
+    // CLUSTER CULL PASS - ONE WORKGROUP PER CLUSTER OF A VISIBLE DRAW, SURVIVING TRIANGLES ARE APPENDED TO THE DRAW'S RANGE IN THIS FRAME'S INDEX COPY
+    if (!clusters_.empty()) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, clusterCullPipeline_);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, clusterCullPipelineLayout_, 0, 1, &clusterSet, 0, nullptr);
 
-    VkMemoryBarrier2 copyMemoryBarrier{};
-    copyMemoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
-    copyMemoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
-    copyMemoryBarrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
-    copyMemoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
-    copyMemoryBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+        ClusterCullPushConstant ccp{};
+        ccp.cameraPosition = glm::vec4(camera_.transform.position, 1.0f);
+        ccp.numClusters = static_cast<uint32_t>(clusters_.size());
+        vkCmdPushConstants(commandBuffer, clusterCullPipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ClusterCullPushConstant), &ccp);
 
-    VkDependencyInfo copyDependencyInfo{};
-    copyDependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
-    copyDependencyInfo.memoryBarrierCount = 1;
-    copyDependencyInfo.pMemoryBarriers = &copyMemoryBarrier;
+        const uint32_t clusterGroupsX = std::min<uint32_t>(ccp.numClusters, 65535);
+        const uint32_t clusterGroupsY = (ccp.numClusters + clusterGroupsX - 1) / clusterGroupsX;
+        vkCmdDispatch(commandBuffer, clusterGroupsX, clusterGroupsY, 1);
 
-    vkCmdPipelineBarrier2(commandBuffer, &copyDependencyInfo);
+        VkMemoryBarrier2 clusterMemoryBarrier{};
+        clusterMemoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        clusterMemoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        clusterMemoryBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+        clusterMemoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT;
+        clusterMemoryBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
 
-    // COMPUTE SKINNING PASS //////////////////////////////////////////////////////////////////////////////////////////////
+        VkDependencyInfo clusterDependencyInfo{};
+        clusterDependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        clusterDependencyInfo.memoryBarrierCount = 1;
+        clusterDependencyInfo.pMemoryBarriers = &clusterMemoryBarrier;
+
+        vkCmdPipelineBarrier2(commandBuffer, &clusterDependencyInfo);
+    }
+}
+
+// THE SAME TESTS AS frustrumCull.comp: OUTSIDE WHEN THE SPHERE IS FULLY BEHIND A PLANE. THE SHADOW CASCADES SKIP THEIR NEAR PLANE, WHATEVER LIES
+// BETWEEN THE LIGHT AND IT STILL CASTS
+static bool sphereOutside(const std::array<glm::vec4, 6>& planes, const glm::vec4& sphere, bool skipNear) {
+    for (int i = 0; i < 6; i++) {
+        if ((!skipNear || i != 4) && glm::dot(glm::vec4(glm::vec3(sphere), 1.0f), planes[i]) + sphere.w < 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VulkanRenderer::needsSkinning(const AnimatedGameObject* g) {
+    if (!conditionalSkinning_ || !g->skinned_) {
+        return true;
+    }
+    if (g->paletteHash_ == g->skinnedHash_) {
+        skinningStats_.unchanged++;
+        return false;
+    }
+
+    const glm::vec4 sphere = g->worldBounds();
+    if (!sphereOutside(camera_.frustumPlanes, sphere, false)) {
+        return true;
+    }
+    for (int i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++) {
+        if (!sphereOutside(pDirectionalLight_->cascades[currentFrame_][i].frustumPlanes, sphere, true)) {
+            return true;
+        }
+    }
+    skinningStats_.culled++;
+    return false;
+}
+
+void VulkanRenderer::recordSkinningPass(VkCommandBuffer commandBuffer) {
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
 
-    int skinCount = 0;
-    for (AnimatedGameObject* g : *animatedObjects) {
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipelineLayout, 0, 1, &computeDescriptorSets_[skinCount][this->currentFrame_], 0, nullptr);
+    skinningStats_ = SkinningStats{};
+    static const auto workgroupSize = 256;
+    for (size_t m = 0; m < skinnedModels_.size(); m++) {
+        const SkinnedModel& skinned = skinnedModels_[m];
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipelineLayout, 0, 1, &computeDescriptorSets_[m][this->currentFrame_], 0, nullptr);
+        const auto groupSizeX = (uint32_t)std::ceil(skinned.model->totalVertices_ / (float)workgroupSize);
+
+        // ONE DISPATCH PER RUN OF INSTANCES THAT NEED SKINNING, AN INSTANCE THAT DOESN'T (OR THE END OF THE MODEL) CLOSES THE RUN BEFORE IT
+        const uint32_t end = skinned.firstInstance + skinned.instanceCount;
+        uint32_t runStart = skinned.firstInstance;
+        for (uint32_t instance = skinned.firstInstance; instance <= end; instance++) {
+            if (instance < end) {
+                AnimatedGameObject* g = skinInstanceObjects_[instance];
+                skinningStats_.instances++;
+                if (needsSkinning(g)) {
+                    g->skinnedHash_ = g->paletteHash_;
+                    g->skinned_ = true;
+                    continue;
+                }
+                skinningStats_.skippedVertices += skinned.model->totalVertices_;
+            }
 
-        const auto cs = ComputePushConstant{
-            .jointMatrixStart = g->renderTarget->globalSkinningMatrixOffset,
-            .numVertices = g->renderTarget->totalVertices_
-        };
-        vkCmdPushConstants(commandBuffer, computePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ComputePushConstant), &cs);
+            if (instance > runStart) {
+                const auto cs = ComputePushConstant{
+                    .firstInstance = runStart,
+                    .numVertices = skinned.model->totalVertices_
+                };
+                vkCmdPushConstants(commandBuffer, computePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ComputePushConstant), &cs);
+                vkCmdDispatch(commandBuffer, groupSizeX, instance - runStart, 1);
+                skinningStats_.dispatches++;
+            }
+            runStart = instance + 1;
+        }
+    }
+}
+
+void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+    VkCommandBufferBeginInfo CBBeginInfo{};
+    CBBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    CBBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-        static const auto workgroupSize = 256;
-        const auto groupSizeX = (uint32_t)std::ceil(g->renderTarget->totalVertices_ / (float)workgroupSize);
-        vkCmdDispatch(commandBuffer, groupSizeX, 1, 1);
-        skinCount++;
+    if (vkBeginCommandBuffer(commandBuffer, &CBBeginInfo) != VK_SUCCESS) {
+        std::_Xruntime_error("Failed to start recording with the command buffer!");
     }
 
+    // THE COUNTS THIS FRAME SLOT WROTE LAST TIME, ITS FENCE HAS SIGNALED. ZEROED FOR THIS FRAME BEFORE THE CULL ADDS TO THEM, ALONG WITH THE PER BATCH
+    // DRAW COUNTS OF BOTH PHASES (THE LATE ONES STAY 0 WITH OCCLUSION CULLING OFF) AND THE SHADOW CASTER COUNTS
+    memcpy(&cullStats_, mappedCullStatsBuffers_[this->currentFrame_], sizeof(CullStats));
+    vkCmdFillBuffer(commandBuffer, cullStatsBuffers_[this->currentFrame_], 0, sizeof(CullStats), 0);
+    vkCmdFillBuffer(commandBuffer, drawCountBuffers_[this->currentFrame_], 0, VK_WHOLE_SIZE, 0);
+    vkCmdFillBuffer(commandBuffer, lateDrawCountBuffers_[this->currentFrame_], 0, VK_WHOLE_SIZE, 0);
+    vkCmdFillBuffer(commandBuffer, shadowDrawCountBuffers_[this->currentFrame_], 0, VK_WHOLE_SIZE, 0);
+
+    VkMemoryBarrier2 statsMemoryBarrier{};
+    statsMemoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    statsMemoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    statsMemoryBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    statsMemoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    statsMemoryBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+
+    VkDependencyInfo statsDependencyInfo{};
+    statsDependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    statsDependencyInfo.memoryBarrierCount = 1;
+    statsDependencyInfo.pMemoryBarriers = &statsMemoryBarrier;
+
+    vkCmdPipelineBarrier2(commandBuffer, &statsDependencyInfo);
+
+    // EARLY CULL AGAINST LAST FRAME'S PYRAMID, WITH THE CAMERA IT WAS BUILT FROM
+    glm::mat4 viewProjection = camera_.projectionMatrix * camera_.viewMatrix;
+    recordCullPasses(commandBuffer, 0, hiZViewProjection_);
+
+    // COMPUTE SKINNING PASS //////////////////////////////////////////////////////////////////////////////////////////////
+    recordSkinningPass(commandBuffer);
+
     VkMemoryBarrier2 memoryBarrier{};
     memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
     memoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
@@ -273,10 +462,12 @@ void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
     vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
 
     // DEPTH PREPASS //////////////////////////////////////////////////////////////////////////////////////////////
-    VkBuffer vertexBuffers[] = { vertexBuffer_ };
-    VkDeviceSize offsets[] = { 0 };
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-    vkCmdBindIndexBuffer(commandBuffer, indexBuffer_, 0, VK_INDEX_TYPE_UINT32);
+    VkBuffer vertexBuffers[] = { positionBuffer_, attributeBuffer_ };
+    VkDeviceSize offsets[] = { 0, 0 };
+    vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+    // THE CAMERA PASSES DRAW THE CLUSTER CULLED COPY, THE SHADOW CASCADES NEED EVERY TRIANGLE
+    VkBuffer cameraIndexBuffer = clusters_.empty() ? indexBuffer_ : clusterIndexBuffers_[this->currentFrame_];
+    vkCmdBindIndexBuffer(commandBuffer, cameraIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
     VkClearValue clearValues[1];
     clearValues[0].depthStencil = { 1.0f, 0 };
@@ -306,16 +497,41 @@ void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
 
     vkCmdBeginRenderPass(commandBuffer, &depthPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, prepassPipeline_->pipeline);
-
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, prepassPipeline_->layout, 0, 1, &descriptorSets_[this->currentFrame_], 0, nullptr);
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, prepassPipeline_->layout, 2, 1, &modelMatrixDescriptorSets_[this->currentFrame_], 0, nullptr);
 
-    fullDraw(commandBuffer, &(prepassPipeline_->layout), finalDrawCallBuffers_[this->currentFrame_], 1);
+    depthDraw(commandBuffer, finalDrawCallBuffers_[this->currentFrame_], drawCountBuffers_[this->currentFrame_], true);
 
     vkCmdEndRenderPass(commandBuffer);
 
+    // OCCLUSION CULL, LATE PHASE ///////////////////////////////////////////////////////////////////////////////////////////////////
+    if (occlusionCulling_) {
+        pHiZ_->build(commandBuffer);
+        recordCullPasses(commandBuffer, 1, viewProjection);
+
+        depthPassBeginInfo.renderPass = depthPrepassLoad_;
+        depthPassBeginInfo.clearValueCount = 0;
+        depthPassBeginInfo.pClearValues = nullptr;
+        vkCmdBeginRenderPass(commandBuffer, &depthPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, prepassPipeline_->layout, 0, 1, &descriptorSets_[this->currentFrame_], 0, nullptr);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, prepassPipeline_->layout, 2, 1, &modelMatrixDescriptorSets_[this->currentFrame_], 0, nullptr);
+
+        depthDraw(commandBuffer, lateFinalDrawCallBuffers_[this->currentFrame_], lateDrawCountBuffers_[this->currentFrame_], false);
+
+        vkCmdEndRenderPass(commandBuffer);
+
+        // AGAIN WITH THE LATE DRAWS IN IT, FOR NEXT FRAME'S EARLY CULL
+        pHiZ_->build(commandBuffer);
+        hiZViewProjection_ = viewProjection;
+        hiZValid_ = true;
+    }
+    else {
+        hiZValid_ = false;
+    }
+
     // SHAODW PASS ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer_, 0, VK_INDEX_TYPE_UINT32);
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pDirectionalLight_->sMPipeline_->pipeline);
 
     for (uint32_t j = 0; j < SHADOW_MAP_CASCADE_COUNT; j++) {
@@ -325,7 +541,7 @@ void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
 
         vkCmdPushConstants(commandBuffer, pDirectionalLight_->sMPipeline_->layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(int), &j);
 
-        shadowDraw(commandBuffer, nullptr, drawCallBuffer, -1);
+        shadowDraw(commandBuffer, nullptr, shadowDrawCallBuffers_[this->currentFrame_], shadowDrawCountBuffers_[this->currentFrame_], j, -1);
 
         vkCmdEndRenderPass(cmdBuf.commandBuffer);
     }
@@ -352,13 +568,24 @@ void VulkanRenderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
 
     vkCmdBeginRenderPass(commandBuffer, &RPBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
+    vkCmdBindIndexBuffer(commandBuffer, cameraIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
     recordSkyBoxCommandBuffer(commandBuffer, imageIndex);
 
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, opaquePipeline_->pipeline);
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, opaquePipeline_->layout, 0, 1, &descriptorSets_[this->currentFrame_], 0, nullptr);
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, opaquePipeline_->layout, 2, 1, &modelMatrixDescriptorSets_[this->currentFrame_], 0, nullptr);
 
-    nonAnimatedDraw(commandBuffer, &(opaquePipeline_->layout), finalDrawCallBuffers_[this->currentFrame_], 1);
+    // BINDLESS: EVERY MATERIAL IS IN THE ONE SET, THE BATCHES DON'T REBIND
+    int colorMaterialPosition = 1;
+    if (pBindless_) {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, opaquePipeline_->layout, 1, 1, &(pBindless_->set_), 0, nullptr);
+        colorMaterialPosition = -1;
+    }
+
+    nonAnimatedDraw(commandBuffer, &(opaquePipeline_->layout), finalDrawCallBuffers_[this->currentFrame_], drawCountBuffers_[this->currentFrame_], colorMaterialPosition);
+    if (occlusionCulling_) {
+        nonAnimatedDraw(commandBuffer, &(opaquePipeline_->layout), lateFinalDrawCallBuffers_[this->currentFrame_], lateDrawCountBuffers_[this->currentFrame_], colorMaterialPosition);
+    }
 
     // TOON PASS ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, toonPipeline_->pipeline);
@@ -870,15 +1097,36 @@ void VulkanRenderer::createLogicalDevice() {
         queuecInfos.push_back(queuecInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(GPU_, &supportedFeatures);
+
     VkPhysicalDeviceFeatures gpuFeatures{};
     gpuFeatures.samplerAnisotropy = VK_TRUE;
     gpuFeatures.depthClamp = VK_TRUE;
     gpuFeatures.imageCubeArray = VK_TRUE;
     gpuFeatures.multiDrawIndirect = VK_TRUE;
+    gpuFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    pDevHelper_->textureCompressionBC_ = supportedFeatures.textureCompressionBC == VK_TRUE;
+
+    VkPhysicalDeviceVulkan12Features supportedVk12Features{};
+    supportedVk12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 supportedFeatures2{};
+    supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures2.pNext = &supportedVk12Features;
+    vkGetPhysicalDeviceFeatures2(GPU_, &supportedFeatures2);
+
+    VkPhysicalDeviceVulkan12Features vk12Features{};
+    vk12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vk12Features.drawIndirectCount = VK_TRUE;
+    // NON UNIFORM INDEXING INTO AN UNSIZED SAMPLER ARRAY IS ALL THE BINDLESS MATERIAL SHADERS NEED
+    descriptorIndexing_ = supportedVk12Features.shaderSampledImageArrayNonUniformIndexing == VK_TRUE && supportedVk12Features.runtimeDescriptorArray == VK_TRUE;
+    vk12Features.shaderSampledImageArrayNonUniformIndexing = descriptorIndexing_ ? VK_TRUE : VK_FALSE;
+    vk12Features.runtimeDescriptorArray = descriptorIndexing_ ? VK_TRUE : VK_FALSE;
 
     VkPhysicalDeviceVulkan13Features vk13Features{};
     vk13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
     vk13Features.synchronization2 = VK_TRUE;
+    vk13Features.pNext = &vk12Features;
 
     VkDeviceCreateInfo deviceCInfo{};
     deviceCInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -1153,6 +1401,14 @@ void VulkanRenderer::createRenderPass() {
         std::_Xruntime_error("Failed to create render pass!");
     }
 
+    // LATE PREPASS, ADDS THE DRAWS THE OCCLUSION CULL BROUGHT BACK ON TOP OF THE EARLY DEPTH. COMPATIBLE WITH depthPrepass_, SAME FRAMEBUFFERS
+    depthZAttachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    depthZAttachmentDescription.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    if (vkCreateRenderPass(device_, &depthPrePassCInfo, nullptr, &depthPrepassLoad_) != VK_SUCCESS) {
+        std::_Xruntime_error("Failed to create render pass!");
+    }
+
 
 }
 
@@ -1213,19 +1469,30 @@ void VulkanRenderer::createDescriptorSetLayout() {
 }
 
 void VulkanRenderer::createVertexBuffer() {
-    VkDeviceSize bufferSize = sizeof(Vertex) * vertices_.size();
+    // SPLIT THE FULL PRECISION LOAD VERTICES INTO THE POSITION AND PACKED ATTRIBUTE STREAMS, BOTH ARE ALSO WRITTEN BY THE SKINNING SHADER
+    std::vector<glm::vec3> positions(vertices_.size());
+    std::vector<VertexAttributes> attributes(vertices_.size());
+    for (size_t i = 0; i < vertices_.size(); i++) {
+        positions[i] = glm::vec3(vertices_[i].pos);
+        attributes[i] = VertexAttributes::pack(vertices_[i]);
+    }
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    pDevHelper_->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    MeshHelper::createVertexBuffer(pDevHelper_, positions, positionBuffer_, positionBufferMemory_, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    MeshHelper::createVertexBuffer(pDevHelper_, attributes, attributeBuffer_, attributeBufferMemory_, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
 
-    void* data;
-    vkMapMemory(device_, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, vertices_.data(), (size_t)bufferSize);
-    vkUnmapMemory(device_, stagingBufferMemory);
+    // UVS DON'T CHANGE UNDER SKINNING, SO THE ALPHA TESTED DEPTH STREAM IS WRITTEN ONCE
+    std::vector<uint32_t> uvs(vertices_.size());
+    for (size_t i = 0; i < vertices_.size(); i++) {
+        uvs[i] = glm::packHalf2x16(glm::vec2(vertices_[i].pos.w, vertices_[i].normal.w));
+    }
+    MeshHelper::createVertexBuffer(pDevHelper_, uvs, uvBuffer_, uvBufferMemory_, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
 
-    pDevHelper_->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer_, vertexBufferMemory_);
-    pDevHelper_->copyBuffer(stagingBuffer, this->vertexBuffer_, bufferSize);
+    const double toMB = 1.0 / (1024.0 * 1024.0);
+    const size_t packedStride = sizeof(glm::vec3) + sizeof(VertexAttributes);
+    std::cout << "vertex streams: " << vertices_.size() << " vertices, " << (sizeof(Vertex) * vertices_.size()) * toMB << " MB -> " << (packedStride * vertices_.size()) * toMB << " MB ("
+              << sizeof(Vertex) << " -> " << packedStride << " bytes/vertex)" << std::endl;
+    std::cout << "vertex streams: depth prepass/shadow fetch " << sizeof(Vertex) << " -> " << sizeof(glm::vec3) << " bytes/vertex, alpha tested prepass "
+              << sizeof(Vertex) << " -> " << sizeof(glm::vec3) + sizeof(uint32_t) << " bytes/vertex" << std::endl;
 
     createQuadVertexBuffer();
 }
@@ -1242,7 +1509,8 @@ void VulkanRenderer::createIndexBuffer() {
     memcpy(data, indices_.data(), (size_t)bufferSize);
     vkUnmapMemory(device_, stagingBufferMemory);
 
-    pDevHelper_->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer_, indexBufferMemory_);
+    // STORAGE/TRANSFER SRC SO clusterCull.comp CAN READ IT AND THE PER FRAME CLUSTER INDEX BUFFERS CAN START AS A COPY OF IT
+    pDevHelper_->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer_, indexBufferMemory_);
     pDevHelper_->copyBuffer(stagingBuffer, indexBuffer_, bufferSize);
 
     createQuadIndexBuffer();
@@ -1381,6 +1649,9 @@ void VulkanRenderer::separateDrawCalls() {
         }
     }
     for (AnimatedGameObject* g : *animatedObjects) {
+        if (g->pSource_ != nullptr) {
+            continue;
+        }
         AnimatedGLTFObj* obj = g->renderTarget;
         for (auto& node : obj->pParentNodes) {
             sortDraw(obj, node);
@@ -1411,76 +1682,147 @@ void VulkanRenderer::addToDrawCalls() {
 
     drawCommands.push_back(skyBoxIndirect);
 
-    for (auto& gameObject : *gameObjects) {
-        for (auto& mat : gameObject->renderTarget->opaqueDraws) {
+    auto addDraw = [&](IndirectBatch& indirect, glm::mat4* localModelTransform, bool* transformDirty, MeshHelper* dC, Material* material, bool isStatic, int32_t vertexOffset) {
+        instanceTransforms_.addDraw(localModelTransform, transformDirty, dC->worldTransformMatrix);
+        drawMaterials_.push_back(material->bindlessIndex);
+        dC->indirectInfo.firstInstance = baseInstanceID;
+        drawCommands.push_back(dC->indirectInfo);
+        drawCommands.back().vertexOffset = vertexOffset;
+        if (isStatic) {
+            addClusters(dC, material, count - 2);
+        }
+        indirect.count++;
+        count++;
+        baseInstanceID++;
+    };
+
+    if (pBindless_) {
+        // NOTHING IS REBOUND BETWEEN OPAQUE STATIC DRAWS ANY MORE, THEY ONLY STAY SPLIT ON doubleSides BECAUSE THE SHADOW PASS PICKS ITS CULL MODE
+        // PER BATCH. ALPHA TESTED BATCHES STAY PER MATERIAL, THE CUTOUT PREPASS STILL BINDS THE MATERIAL'S OWN SET
+        for (int doubleSided = 0; doubleSided < 2; doubleSided++) {
             IndirectBatch indirect{};
-            indirect.material = mat.first;
+            indirect.material = nullptr;
             indirect.first = count;
             indirect.count = 0;
-            for (auto& dC : mat.second) {
-                modelMatrices.emplace_back(gameObject->renderTarget->localModelTransform * dC->worldTransformMatrix);
-                dC->indirectInfo.firstInstance = baseInstanceID;
-                drawCommands.push_back(dC->indirectInfo);
-                indirect.count++;
-                count++;
-                baseInstanceID++;
+            for (auto& gameObject : *gameObjects) {
+                for (auto& mat : gameObject->renderTarget->opaqueDraws) {
+                    if (mat.first->doubleSides != (doubleSided == 1)) {
+                        continue;
+                    }
+                    if (indirect.material == nullptr) {
+                        indirect.material = mat.first;
+                    }
+                    for (auto& dC : mat.second) {
+                        addDraw(indirect, &(gameObject->renderTarget->localModelTransform), &(gameObject->renderTarget->transformDirty_), dC, mat.first, true, dC->indirectInfo.vertexOffset);
+                    }
+                }
+            }
+            if (indirect.count > 0) {
+                drawBatches.push_back(indirect);
             }
-            drawBatches.push_back(indirect);
         }
-        for (auto& mat : gameObject->renderTarget->transparentDraws) {
-            IndirectBatch indirect{};
-            indirect.material = mat.first;
-            indirect.first = count;
-            indirect.count = 0;
-            for (auto& dC : mat.second) {
-                modelMatrices.emplace_back(gameObject->renderTarget->localModelTransform * dC->worldTransformMatrix);
-                dC->indirectInfo.firstInstance = baseInstanceID;
-                drawCommands.push_back(dC->indirectInfo);
-                indirect.count++;
-                count++;
-                baseInstanceID++;
+        for (auto& gameObject : *gameObjects) {
+            for (auto& mat : gameObject->renderTarget->transparentDraws) {
+                IndirectBatch indirect{};
+                indirect.material = mat.first;
+                indirect.alphaTested = true;
+                indirect.first = count;
+                indirect.count = 0;
+                for (auto& dC : mat.second) {
+                    addDraw(indirect, &(gameObject->renderTarget->localModelTransform), &(gameObject->renderTarget->transformDirty_), dC, mat.first, true, dC->indirectInfo.vertexOffset);
+                }
+                drawBatches.push_back(indirect);
+            }
+        }
+    }
+    else {
+        for (auto& gameObject : *gameObjects) {
+            for (auto& mat : gameObject->renderTarget->opaqueDraws) {
+                IndirectBatch indirect{};
+                indirect.material = mat.first;
+                indirect.first = count;
+                indirect.count = 0;
+                for (auto& dC : mat.second) {
+                    addDraw(indirect, &(gameObject->renderTarget->localModelTransform), &(gameObject->renderTarget->transformDirty_), dC, mat.first, true, dC->indirectInfo.vertexOffset);
+                }
+                drawBatches.push_back(indirect);
+            }
+            for (auto& mat : gameObject->renderTarget->transparentDraws) {
+                IndirectBatch indirect{};
+                indirect.material = mat.first;
+                indirect.alphaTested = true;
+                indirect.first = count;
+                indirect.count = 0;
+                for (auto& dC : mat.second) {
+                    addDraw(indirect, &(gameObject->renderTarget->localModelTransform), &(gameObject->renderTarget->transformDirty_), dC, mat.first, true, dC->indirectInfo.vertexOffset);
+                }
+                drawBatches.push_back(indirect);
             }
-            drawBatches.push_back(indirect);
         }
     }
     animatedIndex = static_cast<int>(drawCommands.size());
     animatedBatchIndex = static_cast<int>(drawBatches.size());
+    // A MODEL'S INSTANCES SHARE ITS BATCHES, EACH DRAWS THE SAME INDICES FROM THE VERTEX RANGE ITS POSE WAS SKINNED INTO
     for (auto& animGameObject : *animatedObjects) {
+        if (animGameObject->pSource_ != nullptr) {
+            continue;
+        }
+        auto addInstanceDraws = [&](IndirectBatch& indirect, Material* material, const std::vector<MeshHelper*>& meshes) {
+            for (auto& instance : *animatedObjects) {
+                if (instance != animGameObject && instance->pSource_ != animGameObject) {
+                    continue;
+                }
+                for (auto& dC : meshes) {
+                    addDraw(indirect, &(instance->localModelTransform), &(instance->transformDirty_), dC, material, false, static_cast<int32_t>(instance->firstVertex));
+                }
+            }
+        };
         for (auto& mat : animGameObject->renderTarget->opaqueDraws) {
             IndirectBatch indirect{};
             indirect.material = mat.first;
             indirect.first = count;
             indirect.count = 0;
-            for (auto& dC : mat.second) {
-                modelMatrices.emplace_back(animGameObject->renderTarget->localModelTransform * dC->worldTransformMatrix);
-                dC->indirectInfo.firstInstance = baseInstanceID;
-                drawCommands.push_back(dC->indirectInfo);
-                indirect.count++;
-                count++;
-                baseInstanceID++;
-            }
+            addInstanceDraws(indirect, mat.first, mat.second);
             drawBatches.push_back(indirect);
         }
         for (auto& mat : animGameObject->renderTarget->transparentDraws) {
             IndirectBatch indirect{};
             indirect.material = mat.first;
+            indirect.alphaTested = true;
             indirect.first = count;
             indirect.count = 0;
-            for (auto& dC : mat.second) {
-                modelMatrices.emplace_back(animGameObject->renderTarget->localModelTransform * dC->worldTransformMatrix);
-                dC->indirectInfo.firstInstance = baseInstanceID;
-                drawCommands.push_back(dC->indirectInfo);
-                indirect.count++;
-                count++;
-                baseInstanceID++;
-            }
+            addInstanceDraws(indirect, mat.first, mat.second);
             drawBatches.push_back(indirect);
         }
     }
 
+    if (pBindless_) {
+        pBindless_->setDrawMaterials(drawMaterials_);
+    }
+
     createBoundingBoxes();
 }
 
+// STATIC DRAWS THAT SPLIT INTO MORE THAN ONE MESHLET HAVE THEIR CLUSTERS CULLED ON THE GPU, A SINGLE MESHLET WOULD ONLY REPEAT THE PER DRAW TEST
+void VulkanRenderer::addClusters(MeshHelper* dC, Material* material, uint32_t drawIndex) {
+    bool clustered = clusterCulling_ && dC->meshlets_.size() > 1;
+    clusteredDraws_.push_back(clustered ? 1 : 0);
+    if (!clustered) {
+        return;
+    }
+
+    for (const Meshlet& meshlet : dC->meshlets_) {
+        GPUCluster cluster{};
+        cluster.sphere = meshlet.sphere;
+        // DOUBLE SIDED MATERIALS CAN SHOW EITHER FACE, ONLY THE SPHERE TEST APPLIES
+        cluster.cone = material->doubleSides ? glm::vec4(glm::vec3(meshlet.cone), 1.0f) : meshlet.cone;
+        cluster.drawIndex = drawIndex;
+        cluster.firstIndex = dC->indirectInfo.firstIndex + meshlet.firstIndex;
+        cluster.indexCount = meshlet.triangleCount * 3;
+        clusters_.push_back(cluster);
+    }
+}
+
 void VulkanRenderer::createDrawCallBuffer() {
     VkDeviceSize bufferSize = sizeof(VkDrawIndexedIndirectCommand) * drawCommands.size();
 
@@ -1504,12 +1846,12 @@ void VulkanRenderer::createModelMatrixBuffer(int maxFramesInFlight) {
     modelMatrixDescriptorSets_.resize(maxFramesInFlight);
 
     for (int i = 0; i < maxFramesInFlight; i++) {
-        VkDeviceSize bufferSize = sizeof(glm::mat4) * modelMatrices.size();
+        VkDeviceSize bufferSize = sizeof(glm::mat4) * instanceTransforms_.size();
 
         pDevHelper_->createBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, modelMatrixBuffers[i], modelMatrixBufferMemorys[i]);
 
         vkMapMemory(pDevHelper_->device_, modelMatrixBufferMemorys[i], 0, bufferSize, 0, &(mappedModelMatrixBuffers[i]));
-        memcpy(mappedModelMatrixBuffers[i], modelMatrices.data(), bufferSize);
+        memcpy(mappedModelMatrixBuffers[i], instanceTransforms_.matrices_.data(), bufferSize);
 
         VkDescriptorSetAllocateInfo mmAllocateInfo{};
         mmAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -1526,7 +1868,7 @@ void VulkanRenderer::createModelMatrixBuffer(int maxFramesInFlight) {
         VkDescriptorBufferInfo descriptorBufferInfo{};
         descriptorBufferInfo.buffer = modelMatrixBuffers[i];
         descriptorBufferInfo.offset = 0;
-        descriptorBufferInfo.range = sizeof(glm::mat4) * modelMatrices.size();
+        descriptorBufferInfo.range = sizeof(glm::mat4) * instanceTransforms_.size();
 
         VkWriteDescriptorSet mmDescriptorWriteSet{};
         mmDescriptorWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -1544,27 +1886,37 @@ void VulkanRenderer::createModelMatrixBuffer(int maxFramesInFlight) {
 }
 
 void VulkanRenderer::createDepthPipeline() {
+    VulkanPipelineBuilder::VulkanShaderModule positionShaderModule = VulkanPipelineBuilder::VulkanShaderModule(device_, "./shaders/spv/depthPassPosition.spv");
     VulkanPipelineBuilder::VulkanShaderModule vertexShaderModule = VulkanPipelineBuilder::VulkanShaderModule(device_, "./shaders/spv/depthPass.spv");
     VulkanPipelineBuilder::VulkanShaderModule fragmentShaderModule = VulkanPipelineBuilder::VulkanShaderModule(device_, "./shaders/spv/depthPassAlpha.spv");
 
-    std::array<VulkanPipelineBuilder::VulkanShaderModule, 2> shaderStages = { vertexShaderModule, fragmentShaderModule };
+    std::array<VulkanPipelineBuilder::VulkanShaderModule, 1> positionShaderStages = { positionShaderModule };
+    std::array<VulkanPipelineBuilder::VulkanShaderModule, 2> alphaShaderStages = { vertexShaderModule, fragmentShaderModule };
 
+    // BOTH PIPELINES SHARE THE SAME SET LAYOUTS SO THE UNIFORM AND MODEL MATRIX SETS STAY BOUND WHEN depthDraw SWITCHES BETWEEN THEM
     std::array<VkDescriptorSetLayout, 3> sets = { uniformDescriptorSetLayout_->layout, textureDescriptorSetLayout_->layout, modelMatrixSetLayout_->layout };
 
-    auto bindings = Vertex::getBindingDescription();
-    auto attributes = Vertex::getDepthAttributeDescription();
+    std::vector<VkDynamicState> dynaStates = {
+    VK_DYNAMIC_STATE_VIEWPORT,
+    VK_DYNAMIC_STATE_SCISSOR,
+    VK_DYNAMIC_STATE_CULL_MODE
+    };
+
+    // OPAQUE - POSITION STREAM ONLY, NO FRAGMENT SHADER
+    auto positionBindings = VertexStreams::getBindingDescriptions();
+    auto positionAttributes = VertexStreams::getPositionAttributeDescription();
 
     VulkanPipelineBuilder::PipelineBuilderInfo pipelineInfo{};
     pipelineInfo.pDescriptorSetLayouts = sets.data();
     pipelineInfo.numSets = sets.size();
-    pipelineInfo.pShaderStages = shaderStages.data();
-    pipelineInfo.numStages = shaderStages.size();
+    pipelineInfo.pShaderStages = positionShaderStages.data();
+    pipelineInfo.numStages = positionShaderStages.size();
     pipelineInfo.pPushConstantRanges = nullptr;
     pipelineInfo.numRanges = 0;
-    pipelineInfo.vertexBindingDescriptions = &bindings;
+    pipelineInfo.vertexBindingDescriptions = &positionBindings[0];
     pipelineInfo.numVertexBindingDescriptions = 1;
-    pipelineInfo.vertexAttributeDescriptions = attributes.data();
-    pipelineInfo.numVertexAttributeDescriptions = static_cast<int>(attributes.size());
+    pipelineInfo.vertexAttributeDescriptions = positionAttributes.data();
+    pipelineInfo.numVertexAttributeDescriptions = static_cast<int>(positionAttributes.size());
 
     prepassPipeline_ = new VulkanPipelineBuilder(device_, pipelineInfo, pDevHelper_);
 
@@ -1574,16 +1926,39 @@ void VulkanRenderer::createDepthPipeline() {
     prepassPipeline_->info.pColorBlendState->attachmentCount = 0;
     prepassPipeline_->info.pColorBlendState->pAttachments = nullptr;
 
-    std::vector<VkDynamicState> dynaStates = {
-    VK_DYNAMIC_STATE_VIEWPORT,
-    VK_DYNAMIC_STATE_SCISSOR,
-    VK_DYNAMIC_STATE_CULL_MODE
-    };
-
     prepassPipeline_->info.pDynamicState->dynamicStateCount = static_cast<uint32_t>(dynaStates.size());
     prepassPipeline_->info.pDynamicState->pDynamicStates = dynaStates.data();
 
     prepassPipeline_->generate(pipelineInfo, depthPrepass_);
+
+    // ALPHA TESTED - POSITION + UV STREAMS, DISCARDS ON THE BASE COLOR ALPHA
+    auto alphaBindings = VertexStreams::getDepthBindingDescriptions();
+    auto alphaAttributes = VertexStreams::getDepthAttributeDescription();
+
+    VulkanPipelineBuilder::PipelineBuilderInfo alphaPipelineInfo{};
+    alphaPipelineInfo.pDescriptorSetLayouts = sets.data();
+    alphaPipelineInfo.numSets = sets.size();
+    alphaPipelineInfo.pShaderStages = alphaShaderStages.data();
+    alphaPipelineInfo.numStages = alphaShaderStages.size();
+    alphaPipelineInfo.pPushConstantRanges = nullptr;
+    alphaPipelineInfo.numRanges = 0;
+    alphaPipelineInfo.vertexBindingDescriptions = alphaBindings.data();
+    alphaPipelineInfo.numVertexBindingDescriptions = static_cast<int>(alphaBindings.size());
+    alphaPipelineInfo.vertexAttributeDescriptions = alphaAttributes.data();
+    alphaPipelineInfo.numVertexAttributeDescriptions = static_cast<int>(alphaAttributes.size());
+
+    alphaPrepassPipeline_ = new VulkanPipelineBuilder(device_, alphaPipelineInfo, pDevHelper_);
+
+    alphaPrepassPipeline_->info.pDepthStencilState->depthWriteEnable = VK_TRUE;
+    alphaPrepassPipeline_->info.pDepthStencilState->depthCompareOp = VK_COMPARE_OP_LESS;
+
+    alphaPrepassPipeline_->info.pColorBlendState->attachmentCount = 0;
+    alphaPrepassPipeline_->info.pColorBlendState->pAttachments = nullptr;
+
+    alphaPrepassPipeline_->info.pDynamicState->dynamicStateCount = static_cast<uint32_t>(dynaStates.size());
+    alphaPrepassPipeline_->info.pDynamicState->pDynamicStates = dynaStates.data();
+
+    alphaPrepassPipeline_->generate(alphaPipelineInfo, depthPrepass_);
 }
 
 void VulkanRenderer::createOutlinePipeline() {
@@ -1594,8 +1969,8 @@ void VulkanRenderer::createOutlinePipeline() {
 
     std::array<VkDescriptorSetLayout, 2> sets = { uniformDescriptorSetLayout_->layout, modelMatrixSetLayout_->layout };
 
-    auto bindings = Vertex::getBindingDescription();
-    auto attributes = Vertex::getDepthAttributeDescription();
+    auto bindings = VertexStreams::getBindingDescriptions();
+    auto attributes = VertexStreams::getAttributeDescriptions();
 
     VulkanPipelineBuilder::PipelineBuilderInfo pipelineInfo{};
     pipelineInfo.pDescriptorSetLayouts = sets.data();
@@ -1604,8 +1979,8 @@ void VulkanRenderer::createOutlinePipeline() {
     pipelineInfo.numStages = shaderStages.size();
     pipelineInfo.pPushConstantRanges = nullptr;
     pipelineInfo.numRanges = 0;
-    pipelineInfo.vertexBindingDescriptions = &bindings;
-    pipelineInfo.numVertexBindingDescriptions = 1;
+    pipelineInfo.vertexBindingDescriptions = bindings.data();
+    pipelineInfo.numVertexBindingDescriptions = static_cast<int>(bindings.size());
     pipelineInfo.vertexAttributeDescriptions = attributes.data();
     pipelineInfo.numVertexAttributeDescriptions = static_cast<int>(attributes.size());
 
@@ -1625,8 +2000,8 @@ void VulkanRenderer::createToonPipeline() {
 
     std::array<VkDescriptorSetLayout, 3> sets = { uniformDescriptorSetLayout_->layout, textureDescriptorSetLayout_->layout, modelMatrixSetLayout_->layout };
 
-    auto bindings = Vertex::getBindingDescription();
-    auto attributes = Vertex::getAttributeDescriptions();
+    auto bindings = VertexStreams::getBindingDescriptions();
+    auto attributes = VertexStreams::getAttributeDescriptions();
 
     VulkanPipelineBuilder::PipelineBuilderInfo pipelineInfo{};
     pipelineInfo.pDescriptorSetLayouts = sets.data();
@@ -1635,8 +2010,8 @@ void VulkanRenderer::createToonPipeline() {
     pipelineInfo.numStages = shaderStages.size();
     pipelineInfo.pPushConstantRanges = nullptr;
     pipelineInfo.numRanges = 0;
-    pipelineInfo.vertexBindingDescriptions = &bindings;
-    pipelineInfo.numVertexBindingDescriptions = 1;
+    pipelineInfo.vertexBindingDescriptions = bindings.data();
+    pipelineInfo.numVertexBindingDescriptions = static_cast<int>(bindings.size());
     pipelineInfo.vertexAttributeDescriptions = attributes.data();
     pipelineInfo.numVertexAttributeDescriptions = static_cast<int>(attributes.size());
 
@@ -1677,15 +2052,15 @@ void VulkanRenderer::createToneMappingPipeline() {
 }
 
 void VulkanRenderer::createGraphicsPipeline() {
-    VulkanPipelineBuilder::VulkanShaderModule vertexShaderModule = VulkanPipelineBuilder::VulkanShaderModule(device_, "./shaders/spv/vert.spv");
-    VulkanPipelineBuilder::VulkanShaderModule fragmentShaderModule = VulkanPipelineBuilder::VulkanShaderModule(device_, "./shaders/spv/frag.spv");
+    VulkanPipelineBuilder::VulkanShaderModule vertexShaderModule = VulkanPipelineBuilder::VulkanShaderModule(device_, pBindless_ ? "./shaders/spv/vertBindless.spv" : "./shaders/spv/vert.spv");
+    VulkanPipelineBuilder::VulkanShaderModule fragmentShaderModule = VulkanPipelineBuilder::VulkanShaderModule(device_, pBindless_ ? "./shaders/spv/fragBindless.spv" : "./shaders/spv/frag.spv");
 
     std::array<VulkanPipelineBuilder::VulkanShaderModule, 2> shaderStages = { vertexShaderModule, fragmentShaderModule };
 
-    std::array<VkDescriptorSetLayout, 3> sets = { uniformDescriptorSetLayout_->layout, textureDescriptorSetLayout_->layout, modelMatrixSetLayout_->layout };
+    std::array<VkDescriptorSetLayout, 3> sets = { uniformDescriptorSetLayout_->layout, pBindless_ ? pBindless_->layout_ : textureDescriptorSetLayout_->layout, modelMatrixSetLayout_->layout };
 
-    auto bindings = Vertex::getBindingDescription();
-    auto attributes = Vertex::getAttributeDescriptions();
+    auto bindings = VertexStreams::getBindingDescriptions();
+    auto attributes = VertexStreams::getAttributeDescriptions();
 
     VulkanPipelineBuilder::PipelineBuilderInfo pipelineInfo{};
     pipelineInfo.pDescriptorSetLayouts = sets.data();
@@ -1694,8 +2069,8 @@ void VulkanRenderer::createGraphicsPipeline() {
     pipelineInfo.numStages = shaderStages.size();
     pipelineInfo.pPushConstantRanges = nullptr;
     pipelineInfo.numRanges = 0;
-    pipelineInfo.vertexBindingDescriptions = &bindings;
-    pipelineInfo.numVertexBindingDescriptions = 1;
+    pipelineInfo.vertexBindingDescriptions = bindings.data();
+    pipelineInfo.numVertexBindingDescriptions = static_cast<int>(bindings.size());
     pipelineInfo.vertexAttributeDescriptions = attributes.data();
     pipelineInfo.numVertexAttributeDescriptions = static_cast<int>(attributes.size());
 
@@ -1728,8 +2103,8 @@ void VulkanRenderer::createSkyBoxPipeline() {
 
     std::array<VkDescriptorSetLayout, 2> sets = { uniformDescriptorSetLayout_->layout, pSkyBox_->skyBoxDescriptorSetLayout_ };
 
-    auto bindings = Vertex::getBindingDescription();
-    auto attributes = Vertex::getPositionAttributeDescription();
+    auto bindings = VertexStreams::getBindingDescriptions();
+    auto attributes = VertexStreams::getPositionAttributeDescription();
 
     VulkanPipelineBuilder::PipelineBuilderInfo pipelineInfo{};
     pipelineInfo.pDescriptorSetLayouts = sets.data();
@@ -1738,7 +2113,7 @@ void VulkanRenderer::createSkyBoxPipeline() {
     pipelineInfo.numStages = shaderStages.size();
     pipelineInfo.pPushConstantRanges = ranges.data();
     pipelineInfo.numRanges = 1;
-    pipelineInfo.vertexBindingDescriptions = &bindings;
+    pipelineInfo.vertexBindingDescriptions = &bindings[0];
     pipelineInfo.numVertexBindingDescriptions = 1;
     pipelineInfo.vertexAttributeDescriptions = attributes.data();
     pipelineInfo.numVertexAttributeDescriptions = static_cast<int>(attributes.size());
@@ -1827,6 +2202,11 @@ void VulkanRenderer::createUniformBuffers() {
     frustrumPlaneBufferMemorys.resize(SWChainImages_.size());
     mappedFrustrumPlaneBuffers.resize(SWChainImages_.size());
 
+    size_t shadowPlaneSize = SHADOW_MAP_CASCADE_COUNT * 6 * sizeof(glm::vec4);
+    shadowCascadePlaneBuffers_.resize(SWChainImages_.size());
+    shadowCascadePlaneBufferMemorys_.resize(SWChainImages_.size());
+    mappedShadowCascadePlaneBuffers_.resize(SWChainImages_.size());
+
     for (size_t i = 0; i < SWChainImages_.size(); i++) {
         pDevHelper_->createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffers_[i], uniformBuffersMemory_[i]);
         vkMapMemory(this->device_, this->uniformBuffersMemory_[i], 0, VK_WHOLE_SIZE, 0, &mappedBuffers_[i]);
@@ -1834,19 +2214,24 @@ void VulkanRenderer::createUniformBuffers() {
         pDevHelper_->createBuffer(frustrumPlaneSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frustrumPlaneBuffers[i], frustrumPlaneBufferMemorys[i]);
         vkMapMemory(device_, frustrumPlaneBufferMemorys[i], 0, frustrumPlaneSize, 0, &mappedFrustrumPlaneBuffers[i]);
 
+        pDevHelper_->createBuffer(shadowPlaneSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, shadowCascadePlaneBuffers_[i], shadowCascadePlaneBufferMemorys_[i]);
+        vkMapMemory(device_, shadowCascadePlaneBufferMemorys_[i], 0, shadowPlaneSize, 0, &mappedShadowCascadePlaneBuffers_[i]);
+
         updateUniformBuffer(i);
     }
 }
 
 void VulkanRenderer::createDescriptorPool() {
-    std::array<VkDescriptorPoolSize, 3> poolSizes{};
+    std::array<VkDescriptorPoolSize, 4> poolSizes{};
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     poolSizes[0].descriptorCount = 1000; //static_cast<uint32_t>(SWChainImages_.size());
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
     // Multiplied by 2 for imgui, needs to render separate font atlas, so needs double the image space // 5 samplers + 3 generated images + 1 shadow map
     poolSizes[1].descriptorCount = 1000; //(this->numMats_) * 10 + static_cast<uint32_t>(SWChainImages_.size()) + 6; // plus one for the skybox descriptor
     poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSizes[2].descriptorCount = 3;
+    poolSizes[2].descriptorCount = 1000;
+    poolSizes[3].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSizes[3].descriptorCount = 100;
 
     VkDescriptorPoolCreateInfo poolCInfo{};
     poolCInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -2054,12 +2439,31 @@ void VulkanRenderer::updateGeneratedImageDescriptorSets() {
         }
     }
     for (AnimatedGameObject* aGO : *animatedObjects) {
+        if (aGO->pSource_ != nullptr) {
+            continue;
+        }
         for (Material& m : aGO->renderTarget->mats_) {
             updateIndividualDescriptorSet(m);
         }
     }
 }
 
+// ONLY THE STATIC MATERIALS GO IN, THE ANIMATED OBJECTS ARE DRAWN BY THE TOON PIPELINE WHICH KEEPS ITS PER MATERIAL SETS
+void VulkanRenderer::createBindlessMaterials(int maxFramesInFlight) {
+    std::vector<Material*> materials;
+    for (GameObject* gO : *gameObjects) {
+        for (Material& m : gO->renderTarget->mats_) {
+            materials.push_back(&m);
+        }
+    }
+
+    if (!bindlessMaterials_ || !BindlessMaterials::supported(GPU_, descriptorIndexing_, static_cast<uint32_t>(materials.size()))) {
+        std::cout << "bindless materials unavailable, binding one material set per batch" << std::endl;
+        return;
+    }
+    pBindless_ = new BindlessMaterials(pDevHelper_, maxFramesInFlight, materials);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /*
 CREATE THE DEPTH RESOURCES
@@ -2106,7 +2510,7 @@ void VulkanRenderer::createColorResources() {
 
 void VulkanRenderer::createDepthResources() {
     VkFormat depthFormat = findDepthFormat();
-    pDevHelper_->createImage(SWChainExtent_.width, SWChainExtent_.height, 1, 1, static_cast<VkImageCreateFlagBits>(0), pDevHelper_->msaaSamples_, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImage_, depthImageMemory_);
+    pDevHelper_->createImage(SWChainExtent_.width, SWChainExtent_.height, 1, 1, static_cast<VkImageCreateFlagBits>(0), pDevHelper_->msaaSamples_, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImage_, depthImageMemory_);
     pDevHelper_->createImageView(depthImage_, depthImageView_, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
 }
 
@@ -2187,40 +2591,13 @@ COMPUTE
 
 void VulkanRenderer::updateBindMatrices() {
     memcpy(mappedSkinBuffers[currentFrame_], inverseBindMatrices.data(), inverseBindMatrices.size() * sizeof(glm::mat4));
+    if (dualQuaternionSkinning_) {
+        memcpy(mappedDualQuaternionBuffers[currentFrame_], jointDualQuaternions.data(), jointDualQuaternions.size() * sizeof(DualQuaternionSkinning::DualQuat));
+    }
 }
 
 void VulkanRenderer::updateModelMatrices() {
-    int modelMatrixID = 0;
-    for (auto& gameObject : *gameObjects) {
-        for (auto& mat : gameObject->renderTarget->opaqueDraws) {
-            for (auto& dC : mat.second) {
-                modelMatrices[modelMatrixID] = gameObject->renderTarget->localModelTransform * dC->worldTransformMatrix;
-                modelMatrixID++;
-            }
-        }
-        for (auto& mat : gameObject->renderTarget->transparentDraws) {
-            for (auto& dC : mat.second) {
-                modelMatrices[modelMatrixID] = gameObject->renderTarget->localModelTransform * dC->worldTransformMatrix;
-                modelMatrixID++;
-            }
-        }
-    }
-    for (auto& animGameObject : *animatedObjects) {
-        for (auto& mat : animGameObject->renderTarget->opaqueDraws) {
-            for (auto& dC : mat.second) {
-                modelMatrices[modelMatrixID] = animGameObject->renderTarget->localModelTransform * dC->worldTransformMatrix;
-                modelMatrixID++;
-            }
-        }
-        for (auto& mat : animGameObject->renderTarget->transparentDraws) {
-            for (auto& dC : mat.second) {
-                modelMatrices[modelMatrixID] = animGameObject->renderTarget->localModelTransform * dC->worldTransformMatrix;
-                modelMatrixID++;
-            }
-        }
-    }
-
-    memcpy(mappedModelMatrixBuffers[currentFrame_], modelMatrices.data(), modelMatrices.size() * sizeof(glm::mat4));
+    modelMatricesUploaded_ = instanceTransforms_.update(static_cast<uint32_t>(currentFrame_), static_cast<uint32_t>(mappedModelMatrixBuffers.size()), mappedModelMatrixBuffers[currentFrame_]);
 }
 
 void VulkanRenderer::setupCompute(int framesInFlight) {
@@ -2236,15 +2613,52 @@ void VulkanRenderer::setupCompute(int framesInFlight) {
         memcpy(mappedSkinBuffers[i], inverseBindMatrices.data(), bufferSize);
     }
 
+    // THE DUAL QUATERNION PALETTE MIRRORS THE MATRIX ONE, STARTING FROM THE REST POSE
+    jointDualQuaternions.resize(inverseBindMatrices.size());
+    DualQuaternionSkinning::fromMatrices(inverseBindMatrices.data(), inverseBindMatrices.size(), jointDualQuaternions.data());
+    size_t dualQuaternionBufferSize = std::max<size_t>(jointDualQuaternions.size(), 1) * sizeof(DualQuaternionSkinning::DualQuat);
+    dualQuaternionBuffers.resize(framesInFlight);
+    dualQuaternionBufferMemorys.resize(framesInFlight);
+    mappedDualQuaternionBuffers.resize(framesInFlight);
+
+    for (int i = 0; i < framesInFlight; i++) {
+        pDevHelper_->createBuffer(dualQuaternionBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, dualQuaternionBuffers[i], dualQuaternionBufferMemorys[i]);
+
+        vkMapMemory(pDevHelper_->device_, dualQuaternionBufferMemorys[i], 0, dualQuaternionBufferSize, 0, &(mappedDualQuaternionBuffers[i]));
+        memcpy(mappedDualQuaternionBuffers[i], jointDualQuaternions.data(), jointDualQuaternions.size() * sizeof(DualQuaternionSkinning::DualQuat));
+    }
+
+    // GROUP THE ANIMATED OBJECTS BY MODEL, EACH MODEL'S INSTANCES GET CONSECUTIVE SkinInstance ENTRIES
+    std::vector<SkinInstance> skinInstances;
+    skinnedModels_.clear();
+    skinInstanceObjects_.clear();
+    for (AnimatedGameObject* source : *animatedObjects) {
+        if (source->pSource_ != nullptr) {
+            continue;
+        }
+        SkinnedModel skinned{ source->renderTarget, static_cast<uint32_t>(skinInstances.size()), 0 };
+        for (AnimatedGameObject* instance : *animatedObjects) {
+            if (instance == source || instance->pSource_ == source) {
+                float bindScale = DualQuaternionSkinning::uniformScale(inverseBindMatrices.data() + instance->firstJointMatrix, instance->numInverseBindMatrices);
+                skinInstances.push_back({ instance->firstJointMatrix, instance->firstVertex, static_cast<uint32_t>(instance->skinningMode_), bindScale });
+                skinInstanceObjects_.push_back(instance);
+                dualQuaternionSkinning_ = dualQuaternionSkinning_ || instance->skinningMode_ == AnimatedGameObject::SkinningMode::DUAL_QUATERNION;
+                skinned.instanceCount++;
+            }
+        }
+        skinnedModels_.push_back(skinned);
+    }
+    if (!skinInstances.empty()) {
+        MeshHelper::createVertexBuffer(pDevHelper_, skinInstances, skinInstanceBuffer_, skinInstanceBufferMemory_);
+    }
+
     std::vector<VulkanDescriptorLayoutBuilder::BindingStruct> bindings;
-    bindings.resize(3);
+    bindings.resize(6);
 
-    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    bindings[0].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
-    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    bindings[1].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
-    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    bindings[2].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+    for (auto& binding : bindings) {
+        binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        binding.stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+    }
 
     computeDescriptorSetLayout_ = new VulkanDescriptorLayoutBuilder(pDevHelper_, bindings);
 
@@ -2265,9 +2679,9 @@ void VulkanRenderer::setupCompute(int framesInFlight) {
         std::_Xruntime_error("Failed to create brdfLUT pipeline layout!");
     }
 
-    computeDescriptorSets_.resize(animatedObjects->size());
+    computeDescriptorSets_.resize(skinnedModels_.size());
 
-    for (int j = 0; j < animatedObjects->size(); j++) {
+    for (int j = 0; j < skinnedModels_.size(); j++) {
         computeDescriptorSets_[j].resize(framesInFlight);
         for (int i = 0; i < framesInFlight; i++) {
             VkDescriptorSetAllocateInfo allocateInfo{};
@@ -2280,8 +2694,8 @@ void VulkanRenderer::setupCompute(int framesInFlight) {
 
             VkDescriptorBufferInfo skinMatrixDescriptorBufferInfo{};
             skinMatrixDescriptorBufferInfo.buffer = skinBindMatricsBuffers[i];
-            skinMatrixDescriptorBufferInfo.offset = (sizeof(glm::mat4) * (*animatedObjects)[j]->renderTarget->globalSkinningMatrixOffset);
-            skinMatrixDescriptorBufferInfo.range = (sizeof(glm::mat4) * (*animatedObjects)[j]->numInverseBindMatrices);
+            skinMatrixDescriptorBufferInfo.offset = 0;
+            skinMatrixDescriptorBufferInfo.range = VK_WHOLE_SIZE;
 
             VkWriteDescriptorSet skinMatrixWriteSet{};
             skinMatrixWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -2293,9 +2707,9 @@ void VulkanRenderer::setupCompute(int framesInFlight) {
             skinMatrixWriteSet.pBufferInfo = &skinMatrixDescriptorBufferInfo;
 
             VkDescriptorBufferInfo vertexDescriptorBufferInfo{};
-            vertexDescriptorBufferInfo.buffer = (*animatedObjects)[j]->vertexBuffer_;
+            vertexDescriptorBufferInfo.buffer = skinnedModels_[j].model->basePoseBuffer_;
             vertexDescriptorBufferInfo.offset = 0;
-            vertexDescriptorBufferInfo.range = (sizeof(Vertex) * (*animatedObjects)[j]->renderTarget->totalVertices_);
+            vertexDescriptorBufferInfo.range = (sizeof(SkinnedVertex) * skinnedModels_[j].model->totalVertices_);
 
             VkWriteDescriptorSet vertexInputWriteSet{};
             vertexInputWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -2306,23 +2720,66 @@ void VulkanRenderer::setupCompute(int framesInFlight) {
             vertexInputWriteSet.descriptorCount = 1;
             vertexInputWriteSet.pBufferInfo = &vertexDescriptorBufferInfo;
 
-            VkDescriptorBufferInfo vertexOutputDescriptorBufferInfo{};
-            vertexOutputDescriptorBufferInfo.buffer = vertexBuffer_;
-            vertexOutputDescriptorBufferInfo.offset = (sizeof(Vertex) * (*animatedObjects)[j]->renderTarget->globalFirstVertex);
-            vertexOutputDescriptorBufferInfo.range = (sizeof(Vertex) * (*animatedObjects)[j]->renderTarget->totalVertices_);
-
-            VkWriteDescriptorSet vertexOutputWriteSet{};
-            vertexOutputWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            vertexOutputWriteSet.dstSet = computeDescriptorSets_[j][i];
-            vertexOutputWriteSet.dstBinding = 2;
-            vertexOutputWriteSet.dstArrayElement = 0;
-            vertexOutputWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            vertexOutputWriteSet.descriptorCount = 1;
-            vertexOutputWriteSet.pBufferInfo = &vertexOutputDescriptorBufferInfo;
-
-            std::array<VkWriteDescriptorSet, 3> descriptors = { skinMatrixWriteSet, vertexInputWriteSet, vertexOutputWriteSet };
-
-            vkUpdateDescriptorSets(device_, 3, descriptors.data(), 0, NULL);
+            // THE 12 BYTE STREAM STRIDES CAN'T MEET minStorageBufferOffsetAlignment, SO THE OUTPUT STREAMS ARE BOUND WHOLE AND THE SHADER OFFSETS BY firstVertex
+            VkDescriptorBufferInfo positionOutputDescriptorBufferInfo{};
+            positionOutputDescriptorBufferInfo.buffer = positionBuffer_;
+            positionOutputDescriptorBufferInfo.offset = 0;
+            positionOutputDescriptorBufferInfo.range = VK_WHOLE_SIZE;
+
+            VkWriteDescriptorSet positionOutputWriteSet{};
+            positionOutputWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            positionOutputWriteSet.dstSet = computeDescriptorSets_[j][i];
+            positionOutputWriteSet.dstBinding = 2;
+            positionOutputWriteSet.dstArrayElement = 0;
+            positionOutputWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            positionOutputWriteSet.descriptorCount = 1;
+            positionOutputWriteSet.pBufferInfo = &positionOutputDescriptorBufferInfo;
+
+            VkDescriptorBufferInfo attributeOutputDescriptorBufferInfo{};
+            attributeOutputDescriptorBufferInfo.buffer = attributeBuffer_;
+            attributeOutputDescriptorBufferInfo.offset = 0;
+            attributeOutputDescriptorBufferInfo.range = VK_WHOLE_SIZE;
+
+            VkWriteDescriptorSet attributeOutputWriteSet{};
+            attributeOutputWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            attributeOutputWriteSet.dstSet = computeDescriptorSets_[j][i];
+            attributeOutputWriteSet.dstBinding = 3;
+            attributeOutputWriteSet.dstArrayElement = 0;
+            attributeOutputWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            attributeOutputWriteSet.descriptorCount = 1;
+            attributeOutputWriteSet.pBufferInfo = &attributeOutputDescriptorBufferInfo;
+
+            VkDescriptorBufferInfo instanceDescriptorBufferInfo{};
+            instanceDescriptorBufferInfo.buffer = skinInstanceBuffer_;
+            instanceDescriptorBufferInfo.offset = 0;
+            instanceDescriptorBufferInfo.range = VK_WHOLE_SIZE;
+
+            VkWriteDescriptorSet instanceWriteSet{};
+            instanceWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            instanceWriteSet.dstSet = computeDescriptorSets_[j][i];
+            instanceWriteSet.dstBinding = 4;
+            instanceWriteSet.dstArrayElement = 0;
+            instanceWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            instanceWriteSet.descriptorCount = 1;
+            instanceWriteSet.pBufferInfo = &instanceDescriptorBufferInfo;
+
+            VkDescriptorBufferInfo dualQuaternionDescriptorBufferInfo{};
+            dualQuaternionDescriptorBufferInfo.buffer = dualQuaternionBuffers[i];
+            dualQuaternionDescriptorBufferInfo.offset = 0;
+            dualQuaternionDescriptorBufferInfo.range = VK_WHOLE_SIZE;
+
+            VkWriteDescriptorSet dualQuaternionWriteSet{};
+            dualQuaternionWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            dualQuaternionWriteSet.dstSet = computeDescriptorSets_[j][i];
+            dualQuaternionWriteSet.dstBinding = 5;
+            dualQuaternionWriteSet.dstArrayElement = 0;
+            dualQuaternionWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            dualQuaternionWriteSet.descriptorCount = 1;
+            dualQuaternionWriteSet.pBufferInfo = &dualQuaternionDescriptorBufferInfo;
+
+            std::array<VkWriteDescriptorSet, 6> descriptors = { skinMatrixWriteSet, vertexInputWriteSet, positionOutputWriteSet, attributeOutputWriteSet, instanceWriteSet, dualQuaternionWriteSet };
+
+            vkUpdateDescriptorSets(device_, static_cast<uint32_t>(descriptors.size()), descriptors.data(), 0, NULL);
         }
     }
 
@@ -2357,6 +2814,8 @@ void VulkanRenderer::createComputeCullResources(int framesInFlight) {
     bbBuffers.resize(framesInFlight);
     bbBufferMemorys.resize(framesInFlight);
 
+    // mainCameraFinalDrawCallBuffer_ IS THE CULL'S READ ONLY SOURCE (THE STATIC RANGE), finalDrawCallBuffers_ KEEPS THE QUAD, SKYBOX AND ANIMATED
+    // ENTRIES AS COPIED HERE AND GETS ITS STATIC RANGE REPACKED EVERY FRAME
     for (int i = 0; i < framesInFlight; i++) {
         pDevHelper_->createBuffer(altBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mainCameraFinalDrawCallBuffer_[i], mainCameraFinalDrawCallBufferMemory_[i]);
         pDevHelper_->copyBuffer(drawCallBuffer, mainCameraFinalDrawCallBuffer_[i], altBufferSize, (sizeof(VkDrawIndexedIndirectCommand) * 2));
@@ -2377,8 +2836,64 @@ void VulkanRenderer::createComputeCullResources(int framesInFlight) {
         pDevHelper_->copyBuffer(stagingBuffer, bbBuffers[i], bbSize);
     }
 
+    // THE CULL RESETS THE INDEX COUNT OF EVERY CLUSTERED DRAW, clusterCull.comp COUNTS THE SURVIVING TRIANGLES BACK IN
+    MeshHelper::createVertexBuffer(pDevHelper_, clusteredDraws_, clusteredDrawBuffer_, clusteredDrawBufferMemory_);
+
+    pHiZ_ = new HiZPyramid(pDevHelper_, descriptorPool_);
+    pHiZ_->create(depthImage_, depthImageView_, findDepthFormat(), SWChainExtent_);
+
+    // EVERY STATIC DRAW'S BATCH AND THE SLOT THE BATCH STARTS AT IN THE FULL LAYOUT, THE CULL PACKS THE VISIBLE DRAWS OF A BATCH FROM THERE
+    size_t numStaticDraws = drawCommands.size() - 2 - (drawCommands.size() - animatedIndex);
+    std::vector<glm::uvec2> drawBatchInfo(std::max<size_t>(numStaticDraws, 1), glm::uvec2(0));
+    for (int b = 0; b < animatedBatchIndex; b++) {
+        for (uint32_t d = 0; d < drawBatches[b].count; d++) {
+            drawBatchInfo[drawBatches[b].first - 2 + d] = glm::uvec2(b, drawBatches[b].first);
+        }
+    }
+    MeshHelper::createVertexBuffer(pDevHelper_, drawBatchInfo, drawBatchBuffer_, drawBatchBufferMemory_);
+
+    // THE LATE PHASE OUTPUT ONLY EVER HOLDS PACKED STATIC DRAWS, THE LATE PREPASS NEVER READS THE QUAD, SKYBOX OR ANIMATED ENTRIES
+    size_t countBufferSize = sizeof(uint32_t) * std::max(animatedBatchIndex, 1);
+    lateFinalDrawCallBuffers_.resize(framesInFlight);
+    lateFinalDrawCallBufferMemorys_.resize(framesInFlight);
+    occlusionStateBuffers_.resize(framesInFlight);
+    occlusionStateBufferMemorys_.resize(framesInFlight);
+    cullStatsBuffers_.resize(framesInFlight);
+    mappedCullStatsBuffers_.resize(framesInFlight);
+    cullStatsBufferMemorys_.resize(framesInFlight);
+    drawCountBuffers_.resize(framesInFlight);
+    drawCountBufferMemorys_.resize(framesInFlight);
+    lateDrawCountBuffers_.resize(framesInFlight);
+    lateDrawCountBufferMemorys_.resize(framesInFlight);
+    drawSlotBuffers_.resize(framesInFlight);
+    drawSlotBufferMemorys_.resize(framesInFlight);
+    size_t shadowPlaneSize = SHADOW_MAP_CASCADE_COUNT * 6 * sizeof(glm::vec4);
+    shadowDrawCallBuffers_.resize(framesInFlight);
+    shadowDrawCallBufferMemorys_.resize(framesInFlight);
+    shadowDrawCountBuffers_.resize(framesInFlight);
+    shadowDrawCountBufferMemorys_.resize(framesInFlight);
+
+    for (int i = 0; i < framesInFlight; i++) {
+        pDevHelper_->createBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, lateFinalDrawCallBuffers_[i], lateFinalDrawCallBufferMemorys_[i]);
+
+        pDevHelper_->createBuffer(countBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, drawCountBuffers_[i], drawCountBufferMemorys_[i]);
+        pDevHelper_->createBuffer(countBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, lateDrawCountBuffers_[i], lateDrawCountBufferMemorys_[i]);
+
+        // WRITTEN BY EACH PHASE'S CULL BEFORE ITS CLUSTER CULL READS IT, SO BOTH PHASES SHARE ONE
+        pDevHelper_->createBuffer(sizeof(uint32_t) * std::max<size_t>(numStaticDraws, 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, drawSlotBuffers_[i], drawSlotBufferMemorys_[i]);
+
+        pDevHelper_->createBuffer(sizeof(uint32_t) * std::max<size_t>(numStaticDraws, 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, occlusionStateBuffers_[i], occlusionStateBufferMemorys_[i]);
+
+        pDevHelper_->createBuffer(sizeof(CullStats), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, cullStatsBuffers_[i], cullStatsBufferMemorys_[i]);
+        vkMapMemory(device_, cullStatsBufferMemorys_[i], 0, sizeof(CullStats), 0, &mappedCullStatsBuffers_[i]);
+        memset(mappedCullStatsBuffers_[i], 0, sizeof(CullStats));
+
+        pDevHelper_->createBuffer(bufferSize * SHADOW_MAP_CASCADE_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, shadowDrawCallBuffers_[i], shadowDrawCallBufferMemorys_[i]);
+        pDevHelper_->createBuffer(countBufferSize * SHADOW_MAP_CASCADE_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, shadowDrawCountBuffers_[i], shadowDrawCountBufferMemorys_[i]);
+    }
+
     std::vector<VulkanDescriptorLayoutBuilder::BindingStruct> bindings;
-    bindings.resize(4);
+    bindings.resize(15);
 
     bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     bindings[0].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
@@ -2388,6 +2903,18 @@ void VulkanRenderer::createComputeCullResources(int framesInFlight) {
     bindings[2].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
     bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     bindings[3].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+    bindings[4].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[4].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+    bindings[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[5].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+    bindings[6].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[6].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+    bindings[7].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[7].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+    for (int b = 8; b < 15; b++) {
+        bindings[b].descriptorType = (b == 12) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[b].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+    }
 
     computeCullDescriptorSetLayout_ = new VulkanDescriptorLayoutBuilder(pDevHelper_, bindings);
 
@@ -2411,80 +2938,150 @@ void VulkanRenderer::createComputeCullResources(int framesInFlight) {
     }
 
     computeCullingDescriptorSets_.resize(framesInFlight);
+    lateCullDescriptorSets_.resize(framesInFlight);
 
     for (int i = 0; i < framesInFlight; i++) {
+        // PHASE 0 WRITES THE EARLY DRAWS AND COUNTS, PHASE 1 THE LATE ONES. EVERYTHING ELSE IS SHARED
+        for (int phase = 0; phase < 2; phase++) {
+            VkDescriptorSet& cullSet = (phase == 0) ? computeCullingDescriptorSets_[i] : lateCullDescriptorSets_[i];
 
-        VkDescriptorSetAllocateInfo allocateInfo{};
-        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocateInfo.descriptorPool = descriptorPool_;
-        allocateInfo.descriptorSetCount = 1;
-        allocateInfo.pSetLayouts = &(computeCullDescriptorSetLayout_->layout);
-
-        VkResult res2 = vkAllocateDescriptorSets(device_, &allocateInfo, &computeCullingDescriptorSets_[i]);
-
-        // BINDINGS //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-        VkDescriptorBufferInfo frustrumPlaneUniformBufferInfo{};
-        frustrumPlaneUniformBufferInfo.buffer = frustrumPlaneBuffers[i];
-        frustrumPlaneUniformBufferInfo.offset = 0;
-        frustrumPlaneUniformBufferInfo.range = frustrumPlaneSize;
-
-        VkWriteDescriptorSet frustrumPlaneWriteSet{};
-        frustrumPlaneWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        frustrumPlaneWriteSet.dstSet = computeCullingDescriptorSets_[i];
-        frustrumPlaneWriteSet.dstBinding = 0;
-        frustrumPlaneWriteSet.dstArrayElement = 0;
-        frustrumPlaneWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        frustrumPlaneWriteSet.descriptorCount = 1;
-        frustrumPlaneWriteSet.pBufferInfo = &frustrumPlaneUniformBufferInfo;
-
-        VkDescriptorBufferInfo outputDrawsDescriptorBufferInfo{};
-        outputDrawsDescriptorBufferInfo.buffer = mainCameraFinalDrawCallBuffer_[i];
-        outputDrawsDescriptorBufferInfo.offset = 0;
-        outputDrawsDescriptorBufferInfo.range = sizeof(VkDrawIndexedIndirectCommand) * (drawCommands.size() - 2 - (drawCommands.size() - animatedIndex));
-
-        VkWriteDescriptorSet outputDrawsWriteSet{};
-        outputDrawsWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        outputDrawsWriteSet.dstSet = computeCullingDescriptorSets_[i];
-        outputDrawsWriteSet.dstBinding = 1;
-        outputDrawsWriteSet.dstArrayElement = 0;
-        outputDrawsWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        outputDrawsWriteSet.descriptorCount = 1;
-        outputDrawsWriteSet.pBufferInfo = &outputDrawsDescriptorBufferInfo;
-
-        VkDescriptorBufferInfo BBDescriptorBufferInfo{};
-        BBDescriptorBufferInfo.buffer = bbBuffers[i];
-        BBDescriptorBufferInfo.offset = 0;
-        BBDescriptorBufferInfo.range = sizeof(glm::vec4) * boundingBoxes.size();
-
-        VkWriteDescriptorSet BBWriteSet{};
-        BBWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        BBWriteSet.dstSet = computeCullingDescriptorSets_[i];
-        BBWriteSet.dstBinding = 2;
-        BBWriteSet.dstArrayElement = 0;
-        BBWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        BBWriteSet.descriptorCount = 1;
-        BBWriteSet.pBufferInfo = &BBDescriptorBufferInfo;
-
-        VkDescriptorBufferInfo mmDescriptorBufferInfo{};
-        mmDescriptorBufferInfo.buffer = modelMatrixBuffers[i];
-        mmDescriptorBufferInfo.offset = 0;
-        mmDescriptorBufferInfo.range = sizeof(glm::mat4) * (modelMatrices.size() - 2 - (modelMatrices.size() - animatedIndex));
-
-        VkWriteDescriptorSet mmDescriptorWriteSet{};
-        mmDescriptorWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        mmDescriptorWriteSet.dstSet = computeCullingDescriptorSets_[i];
-        mmDescriptorWriteSet.dstBinding = 3;
-        mmDescriptorWriteSet.dstArrayElement = 0;
-        mmDescriptorWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        mmDescriptorWriteSet.descriptorCount = 1;
-        mmDescriptorWriteSet.pBufferInfo = &mmDescriptorBufferInfo;
-
-        std::array<VkWriteDescriptorSet, 4> descriptors = { frustrumPlaneWriteSet, outputDrawsWriteSet, BBWriteSet, mmDescriptorWriteSet };
+            VkDescriptorSetAllocateInfo allocateInfo{};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocateInfo.descriptorPool = descriptorPool_;
+            allocateInfo.descriptorSetCount = 1;
+            allocateInfo.pSetLayouts = &(computeCullDescriptorSetLayout_->layout);
+
+            VkResult res2 = vkAllocateDescriptorSets(device_, &allocateInfo, &cullSet);
+
+            // BINDINGS //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+            VkDescriptorBufferInfo frustrumPlaneUniformBufferInfo{};
+            frustrumPlaneUniformBufferInfo.buffer = frustrumPlaneBuffers[i];
+            frustrumPlaneUniformBufferInfo.offset = 0;
+            frustrumPlaneUniformBufferInfo.range = frustrumPlaneSize;
+
+            VkWriteDescriptorSet frustrumPlaneWriteSet{};
+            frustrumPlaneWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            frustrumPlaneWriteSet.dstSet = cullSet;
+            frustrumPlaneWriteSet.dstBinding = 0;
+            frustrumPlaneWriteSet.dstArrayElement = 0;
+            frustrumPlaneWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            frustrumPlaneWriteSet.descriptorCount = 1;
+            frustrumPlaneWriteSet.pBufferInfo = &frustrumPlaneUniformBufferInfo;
+
+            VkDescriptorBufferInfo outputDrawsDescriptorBufferInfo{};
+            outputDrawsDescriptorBufferInfo.buffer = (phase == 0) ? finalDrawCallBuffers_[i] : lateFinalDrawCallBuffers_[i];
+            outputDrawsDescriptorBufferInfo.offset = 0;
+            outputDrawsDescriptorBufferInfo.range = bufferSize;
+
+            VkWriteDescriptorSet outputDrawsWriteSet{};
+            outputDrawsWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            outputDrawsWriteSet.dstSet = cullSet;
+            outputDrawsWriteSet.dstBinding = 1;
+            outputDrawsWriteSet.dstArrayElement = 0;
+            outputDrawsWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            outputDrawsWriteSet.descriptorCount = 1;
+            outputDrawsWriteSet.pBufferInfo = &outputDrawsDescriptorBufferInfo;
+
+            VkDescriptorBufferInfo BBDescriptorBufferInfo{};
+            BBDescriptorBufferInfo.buffer = bbBuffers[i];
+            BBDescriptorBufferInfo.offset = 0;
+            BBDescriptorBufferInfo.range = sizeof(glm::vec4) * boundingBoxes.size();
+
+            VkWriteDescriptorSet BBWriteSet{};
+            BBWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            BBWriteSet.dstSet = cullSet;
+            BBWriteSet.dstBinding = 2;
+            BBWriteSet.dstArrayElement = 0;
+            BBWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            BBWriteSet.descriptorCount = 1;
+            BBWriteSet.pBufferInfo = &BBDescriptorBufferInfo;
+
+            VkDescriptorBufferInfo mmDescriptorBufferInfo{};
+            mmDescriptorBufferInfo.buffer = modelMatrixBuffers[i];
+            mmDescriptorBufferInfo.offset = 0;
+            mmDescriptorBufferInfo.range = sizeof(glm::mat4) * (instanceTransforms_.size() - 2 - (instanceTransforms_.size() - animatedIndex));
+
+            VkWriteDescriptorSet mmDescriptorWriteSet{};
+            mmDescriptorWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            mmDescriptorWriteSet.dstSet = cullSet;
+            mmDescriptorWriteSet.dstBinding = 3;
+            mmDescriptorWriteSet.dstArrayElement = 0;
+            mmDescriptorWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            mmDescriptorWriteSet.descriptorCount = 1;
+            mmDescriptorWriteSet.pBufferInfo = &mmDescriptorBufferInfo;
+
+            VkDescriptorBufferInfo clusteredDrawsBufferInfo{};
+            clusteredDrawsBufferInfo.buffer = clusteredDrawBuffer_;
+            clusteredDrawsBufferInfo.offset = 0;
+            clusteredDrawsBufferInfo.range = sizeof(uint32_t) * clusteredDraws_.size();
+
+            VkWriteDescriptorSet clusteredDrawsWriteSet{};
+            clusteredDrawsWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            clusteredDrawsWriteSet.dstSet = cullSet;
+            clusteredDrawsWriteSet.dstBinding = 4;
+            clusteredDrawsWriteSet.dstArrayElement = 0;
+            clusteredDrawsWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            clusteredDrawsWriteSet.descriptorCount = 1;
+            clusteredDrawsWriteSet.pBufferInfo = &clusteredDrawsBufferInfo;
+
+            // BINDING 5 (THE PYRAMID) IS WRITTEN BY writeHiZDescriptors, IT CHANGES WITH THE SWAPCHAIN
+            VkDescriptorBufferInfo occlusionStateBufferInfo{};
+            occlusionStateBufferInfo.buffer = occlusionStateBuffers_[i];
+            occlusionStateBufferInfo.offset = 0;
+            occlusionStateBufferInfo.range = VK_WHOLE_SIZE;
+
+            VkWriteDescriptorSet occlusionStateWriteSet{};
+            occlusionStateWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            occlusionStateWriteSet.dstSet = cullSet;
+            occlusionStateWriteSet.dstBinding = 6;
+            occlusionStateWriteSet.dstArrayElement = 0;
+            occlusionStateWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            occlusionStateWriteSet.descriptorCount = 1;
+            occlusionStateWriteSet.pBufferInfo = &occlusionStateBufferInfo;
+
+            VkDescriptorBufferInfo cullStatsBufferInfo{};
+            cullStatsBufferInfo.buffer = cullStatsBuffers_[i];
+            cullStatsBufferInfo.offset = 0;
+            cullStatsBufferInfo.range = sizeof(CullStats);
+
+            VkWriteDescriptorSet cullStatsWriteSet{};
+            cullStatsWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            cullStatsWriteSet.dstSet = cullSet;
+            cullStatsWriteSet.dstBinding = 7;
+            cullStatsWriteSet.dstArrayElement = 0;
+            cullStatsWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            cullStatsWriteSet.descriptorCount = 1;
+            cullStatsWriteSet.pBufferInfo = &cullStatsBufferInfo;
+
+            // SOURCE COMMANDS, BATCH OF EVERY DRAW, PER BATCH COUNTS, WHERE EVERY DRAW LANDED, THEN THE SHADOW CASCADES (ONLY THE EARLY PHASE WRITES THEM)
+            std::array<VkDescriptorBufferInfo, 7> compactionBufferInfos{};
+            compactionBufferInfos[0] = { mainCameraFinalDrawCallBuffer_[i], 0, altBufferSize };
+            compactionBufferInfos[1] = { drawBatchBuffer_, 0, VK_WHOLE_SIZE };
+            compactionBufferInfos[2] = { (phase == 0) ? drawCountBuffers_[i] : lateDrawCountBuffers_[i], 0, countBufferSize };
+            compactionBufferInfos[3] = { drawSlotBuffers_[i], 0, VK_WHOLE_SIZE };
+            compactionBufferInfos[4] = { shadowCascadePlaneBuffers_[i], 0, shadowPlaneSize };
+            compactionBufferInfos[5] = { shadowDrawCallBuffers_[i], 0, VK_WHOLE_SIZE };
+            compactionBufferInfos[6] = { shadowDrawCountBuffers_[i], 0, VK_WHOLE_SIZE };
+
+            std::array<VkWriteDescriptorSet, 14> descriptors = { frustrumPlaneWriteSet, outputDrawsWriteSet, BBWriteSet, mmDescriptorWriteSet, clusteredDrawsWriteSet, occlusionStateWriteSet, cullStatsWriteSet };
+            for (uint32_t b = 0; b < 7; b++) {
+                VkWriteDescriptorSet& compactionWriteSet = descriptors[7 + b];
+                compactionWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                compactionWriteSet.dstSet = cullSet;
+                compactionWriteSet.dstBinding = 8 + b;
+                compactionWriteSet.dstArrayElement = 0;
+                compactionWriteSet.descriptorType = bindings[8 + b].descriptorType;
+                compactionWriteSet.descriptorCount = 1;
+                compactionWriteSet.pBufferInfo = &compactionBufferInfos[b];
+            }
 
-        vkUpdateDescriptorSets(device_, 4, descriptors.data(), 0, NULL);
+            vkUpdateDescriptorSets(device_, static_cast<uint32_t>(descriptors.size()), descriptors.data(), 0, NULL);
+        }
     }
 
+    writeHiZDescriptors();
+
     // COMPUTE PIPELINE CREATION
 
     VulkanPipelineBuilder::VulkanShaderModule compute = VulkanPipelineBuilder::VulkanShaderModule(device_, "./shaders/spv/frustrumCull.spv");
@@ -2504,6 +3101,142 @@ void VulkanRenderer::createComputeCullResources(int framesInFlight) {
     vkCreateComputePipelines(device_, VK_NULL_HANDLE, 1, &computePipelineCInfo, nullptr, &computeCullPipeline_);
 }
 
+// THE PYRAMID IS REBUILT WITH THE SWAPCHAIN, EVERY CULL SET HAS TO POINT AT THE NEW ONE
+void VulkanRenderer::writeHiZDescriptors() {
+    VkDescriptorImageInfo pyramidInfo{};
+    pyramidInfo.sampler = pHiZ_->sampler_;
+    pyramidInfo.imageView = pHiZ_->imageView_;
+    pyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    std::vector<VkWriteDescriptorSet> descriptors;
+    for (size_t i = 0; i < computeCullingDescriptorSets_.size(); i++) {
+        for (VkDescriptorSet set : { computeCullingDescriptorSets_[i], lateCullDescriptorSets_[i] }) {
+            VkWriteDescriptorSet pyramidWriteSet{};
+            pyramidWriteSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            pyramidWriteSet.dstSet = set;
+            pyramidWriteSet.dstBinding = 5;
+            pyramidWriteSet.dstArrayElement = 0;
+            pyramidWriteSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            pyramidWriteSet.descriptorCount = 1;
+            pyramidWriteSet.pImageInfo = &pyramidInfo;
+            descriptors.push_back(pyramidWriteSet);
+        }
+    }
+
+    vkUpdateDescriptorSets(device_, static_cast<uint32_t>(descriptors.size()), descriptors.data(), 0, NULL);
+}
+
+void VulkanRenderer::createClusterCullResources(int framesInFlight) {
+    size_t numStaticDraws = clusteredDraws_.size();
+
+    // NOTHING TO CLUSTER, THE DRAWS KEEP USING indexBuffer_ AND THE PASS IS NEVER RECORDED
+    if (clusters_.empty()) {
+        return;
+    }
+
+    VkDeviceSize indexBufferSize = sizeof(uint32_t) * indices_.size();
+    VkDeviceSize clusterBufferSize = sizeof(GPUCluster) * clusters_.size();
+
+    MeshHelper::createVertexBuffer(pDevHelper_, clusters_, clusterBuffer_, clusterBufferMemory_);
+
+    // EVERY FRAME IN FLIGHT DRAWS FROM ITS OWN COPY, ONLY THE RANGES OF CLUSTERED DRAWS ARE EVER REWRITTEN SO THE REST STAYS A PLAIN COPY OF indexBuffer_
+    clusterIndexBuffers_.resize(framesInFlight);
+    clusterIndexBufferMemorys_.resize(framesInFlight);
+    for (int i = 0; i < framesInFlight; i++) {
+        pDevHelper_->createBuffer(indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, clusterIndexBuffers_[i], clusterIndexBufferMemorys_[i]);
+        pDevHelper_->copyBuffer(indexBuffer_, clusterIndexBuffers_[i], indexBufferSize);
+    }
+
+    std::vector<VulkanDescriptorLayoutBuilder::BindingStruct> bindings;
+    bindings.resize(7);
+
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    bindings[0].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+    for (int b = 1; b < 7; b++) {
+        bindings[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[b].stageBits = static_cast<VkShaderStageFlagBits>(VK_SHADER_STAGE_COMPUTE_BIT);
+    }
+
+    clusterCullDescriptorSetLayout_ = new VulkanDescriptorLayoutBuilder(pDevHelper_, bindings);
+
+    VkPushConstantRange pcRange{};
+    pcRange.offset = 0;
+    pcRange.size = sizeof(ClusterCullPushConstant);
+    pcRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkPipelineLayoutCreateInfo pipeLineLayoutCInfo{};
+    pipeLineLayoutCInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeLineLayoutCInfo.setLayoutCount = 1;
+    pipeLineLayoutCInfo.pSetLayouts = &(clusterCullDescriptorSetLayout_->layout);
+    pipeLineLayoutCInfo.pushConstantRangeCount = 1;
+    pipeLineLayoutCInfo.pPushConstantRanges = &pcRange;
+
+    if (vkCreatePipelineLayout(device_, &pipeLineLayoutCInfo, nullptr, &(clusterCullPipelineLayout_)) != VK_SUCCESS) {
+        std::_Xruntime_error("Failed to create cluster cull pipeline layout!");
+    }
+
+    clusterCullDescriptorSets_.resize(framesInFlight);
+    lateClusterCullDescriptorSets_.resize(framesInFlight);
+
+    for (int i = 0; i < framesInFlight; i++) {
+        // THE LATE SET REFILLS THE RANGES OF THE DRAWS THE LATE CULL BROUGHT BACK, THOSE WERE HIDDEN IN THE EARLY PASS SO NO RANGE IS WRITTEN TWICE
+        for (int phase = 0; phase < 2; phase++) {
+            VkDescriptorSet& clusterSet = (phase == 0) ? clusterCullDescriptorSets_[i] : lateClusterCullDescriptorSets_[i];
+
+            VkDescriptorSetAllocateInfo allocateInfo{};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocateInfo.descriptorPool = descriptorPool_;
+            allocateInfo.descriptorSetCount = 1;
+            allocateInfo.pSetLayouts = &(clusterCullDescriptorSetLayout_->layout);
+
+            if (vkAllocateDescriptorSets(device_, &allocateInfo, &clusterSet) != VK_SUCCESS) {
+                std::_Xruntime_error("Failed to allocate the cluster cull descriptor sets!");
+            }
+
+            // FRUSTUM PLANES, PACKED DRAWS (INDEX COUNTS ARE ACCUMULATED IN PLACE), CLUSTERS, STATIC MODEL MATRICES, SOURCE INDICES, COMPACTED INDICES,
+            // EVERY DRAW'S PACKED SLOT
+            std::array<VkDescriptorBufferInfo, 7> bufferInfos{};
+            bufferInfos[0] = { frustrumPlaneBuffers[i], 0, 6 * sizeof(glm::vec4) };
+            bufferInfos[1] = { (phase == 0) ? finalDrawCallBuffers_[i] : lateFinalDrawCallBuffers_[i], 0, VK_WHOLE_SIZE };
+            bufferInfos[2] = { clusterBuffer_, 0, clusterBufferSize };
+            bufferInfos[3] = { modelMatrixBuffers[i], 0, sizeof(glm::mat4) * numStaticDraws };
+            bufferInfos[4] = { indexBuffer_, 0, indexBufferSize };
+            bufferInfos[5] = { clusterIndexBuffers_[i], 0, indexBufferSize };
+            bufferInfos[6] = { drawSlotBuffers_[i], 0, VK_WHOLE_SIZE };
+
+            std::array<VkWriteDescriptorSet, 7> descriptors{};
+            for (uint32_t b = 0; b < 7; b++) {
+                descriptors[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                descriptors[b].dstSet = clusterSet;
+                descriptors[b].dstBinding = b;
+                descriptors[b].dstArrayElement = 0;
+                descriptors[b].descriptorType = bindings[b].descriptorType;
+                descriptors[b].descriptorCount = 1;
+                descriptors[b].pBufferInfo = &bufferInfos[b];
+            }
+
+            vkUpdateDescriptorSets(device_, static_cast<uint32_t>(descriptors.size()), descriptors.data(), 0, NULL);
+        }
+    }
+
+    VulkanPipelineBuilder::VulkanShaderModule compute = VulkanPipelineBuilder::VulkanShaderModule(device_, "./shaders/spv/clusterCull.spv");
+
+    VkPipelineShaderStageCreateInfo computeStageCInfo{};
+    computeStageCInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computeStageCInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computeStageCInfo.module = compute.module;
+    computeStageCInfo.pName = "main";
+
+    VkComputePipelineCreateInfo computePipelineCInfo{};
+    computePipelineCInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    computePipelineCInfo.stage = computeStageCInfo;
+    computePipelineCInfo.layout = clusterCullPipelineLayout_;
+
+    if (vkCreateComputePipelines(device_, VK_NULL_HANDLE, 1, &computePipelineCInfo, nullptr, &clusterCullPipeline_) != VK_SUCCESS) {
+        std::_Xruntime_error("Failed to create the cluster cull pipeline!");
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /*
 SWAPCHAIN RECREATION
@@ -2559,6 +3292,14 @@ void VulkanRenderer::recreateSwapChain(SDL_Window* window) {
     createFrameBuffer();
     createDescriptorSets();
 
+    // THE OLD PYRAMID IS THE WRONG SIZE AND WAS BUILT FROM A DIFFERENT PROJECTION, THE NEXT EARLY CULL IS FRUSTUM ONLY
+    if (pHiZ_ != nullptr) {
+        pHiZ_->destroy();
+        pHiZ_->create(depthImage_, depthImageView_, findDepthFormat(), SWChainExtent_);
+        writeHiZDescriptors();
+        hiZValid_ = false;
+    }
+
     delete bloomHelper;
 
     bloomHelper = new BloomHelper(pDevHelper_);
@@ -2580,11 +3321,14 @@ void VulkanRenderer::shutdown() {
     delete prefEMap;
     delete opaquePipeline_;
     delete prepassPipeline_;
+    delete alphaPrepassPipeline_;
     delete toonPipeline_;
     delete outlinePipeline_;
     delete toneMappingPipeline_;
 
     delete pDirectionalLight_;
+    delete pHiZ_;
+    delete pBindless_;
 
     vkDestroyDescriptorPool(device_, descriptorPool_, nullptr);
 
@@ -2593,6 +3337,7 @@ void VulkanRenderer::shutdown() {
     vkDestroyRenderPass(device_, renderPass_, nullptr);
     vkDestroyRenderPass(device_, toneMapPass_, nullptr);
     vkDestroyRenderPass(device_, depthPrepass_, nullptr);
+    vkDestroyRenderPass(device_, depthPrepassLoad_, nullptr);
 
     delete pDevHelper_;
 
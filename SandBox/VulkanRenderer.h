@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Bloom.h"
+#include "HiZ.h"
+#include "BindlessMaterials.h"
+#include "InstanceTransforms.h"
 #include "Camera.h"
 
 #ifdef NDEBUG
@@ -60,11 +63,50 @@ struct IndirectBatch {
 	Material* material;
 	uint32_t first;
 	uint32_t count;
+	bool alphaTested = false;
 };
 
 struct ComputeCullPushConstant {
-	glm::mat4 viewMatrix;
+	glm::mat4 viewProjection;
 	int numDraws;
+	int phase;
+	int occlusionEnabled;
+	int numBatches;
+	glm::vec4 pyramidSize;
+	int cascadeStride;
+};
+
+// WHAT frustrumCull.comp COUNTED FOR THE STATIC DRAWS OF ONE FRAME, READ BACK ONCE THAT FRAME'S FENCE HAS SIGNALED
+struct CullStats {
+	uint32_t frustumCulled;
+	uint32_t visibleEarly;
+	uint32_t visibleLate;
+	uint32_t occluded;
+	uint32_t shadowCasters[SHADOW_MAP_CASCADE_COUNT];
+};
+
+// WHAT THE LAST RECORDED SKINNING PASS LEFT OUT, COUNTED ON THE CPU AS IT PICKS THE INSTANCES TO DISPATCH
+struct SkinningStats {
+	uint32_t instances;
+	uint32_t culled; // OUTSIDE THE CAMERA AND EVERY SHADOW CASCADE
+	uint32_t unchanged; // SAME JOINT PALETTE AS THE LAST TIME THEY WERE SKINNED
+	uint32_t dispatches;
+	uint64_t skippedVertices;
+};
+
+// ONE MESHLET OF A STATIC DRAW AS clusterCull.comp READS IT. SPHERE AND CONE ARE IN THE DRAW'S MODEL SPACE, firstIndex POINTS INTO THE GLOBAL INDEX BUFFER
+struct GPUCluster {
+	glm::vec4 sphere;
+	glm::vec4 cone;
+	uint32_t drawIndex;
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t pad;
+};
+
+struct ClusterCullPushConstant {
+	glm::vec4 cameraPosition;
+	uint32_t numClusters;
 };
 
 class VulkanRenderer {
@@ -109,8 +151,11 @@ private:
 	std::vector<VkDeviceMemory> uniformBuffersMemory_;
 
 	std::vector<VkDescriptorSet> descriptorSets_;
-	std::vector<std::vector<VkDescriptorSet>> computeDescriptorSets_;
+	std::vector<std::vector<VkDescriptorSet>> computeDescriptorSets_; // PER SKINNED MODEL, PER FRAME
 	std::vector<VkDescriptorSet> computeCullingDescriptorSets_;
+	std::vector<VkDescriptorSet> clusterCullDescriptorSets_;
+	std::vector<VkDescriptorSet> lateCullDescriptorSets_;
+	std::vector<VkDescriptorSet> lateClusterCullDescriptorSets_;
 	VkDescriptorSet toneMappingDescriptorSet_;
 	std::vector<VkDescriptorSet> modelMatrixDescriptorSets_;
 
@@ -131,6 +176,11 @@ private:
 	void cleanupSWChain();
 	void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 	void recordSkyBoxCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+	void recordCullPasses(VkCommandBuffer commandBuffer, int phase, const glm::mat4& viewProjection);
+	// false (AND COUNTED IN skinningStats_) WHEN g IS UNCHANGED OR OUT OF SIGHT, SEE conditionalSkinning_
+	bool needsSkinning(const AnimatedGameObject* g);
+	void recordSkinningPass(VkCommandBuffer commandBuffer);
+	void writeHiZDescriptors();
 
 public:
 	int numModels_;
@@ -150,8 +200,14 @@ public:
 
 	VkExtent2D SWChainExtent_;
 
-	VkBuffer vertexBuffer_;
-	VkDeviceMemory vertexBufferMemory_;
+	VkBuffer positionBuffer_;
+	VkDeviceMemory positionBufferMemory_;
+
+	VkBuffer attributeBuffer_;
+	VkDeviceMemory attributeBufferMemory_;
+
+	VkBuffer uvBuffer_;
+	VkDeviceMemory uvBufferMemory_;
 
 	VkBuffer indexBuffer_;
 	VkDeviceMemory indexBufferMemory_;
@@ -176,7 +232,10 @@ public:
 	std::vector<uint32_t>indices_;
 
 	std::vector<glm::mat4> inverseBindMatrices;
-	std::vector<glm::mat4> modelMatrices;
+	std::vector<DualQuaternionSkinning::DualQuat> jointDualQuaternions; // inverseBindMatrices AS DUAL QUATERNIONS, ONLY KEPT UP TO DATE FOR DUAL_QUATERNION OBJECTS
+	// EVERY DRAW'S MODEL MATRIX BY firstInstance, ONLY THE OBJECTS THAT MOVED ARE RECOMPUTED AND UPLOADED
+	InstanceTransforms instanceTransforms_;
+	size_t modelMatricesUploaded_ = 0; // BY THE LAST updateModelMatrices
 
 	std::vector<IndirectBatch> drawBatches;
 	std::vector<VkDrawIndexedIndirectCommand> drawCommands;
@@ -185,6 +244,11 @@ public:
 	std::vector<void*> mappedSkinBuffers;
 	std::vector<VkDeviceMemory> skinBindMatricesBufferMemorys;
 
+	std::vector<VkBuffer> dualQuaternionBuffers;
+	std::vector<void*> mappedDualQuaternionBuffers;
+	std::vector<VkDeviceMemory> dualQuaternionBufferMemorys;
+	bool dualQuaternionSkinning_ = false; // SOME OBJECT SKINS WITH DUAL QUATERNIONS, jointDualQuaternions IS ONLY UPLOADED THEN
+
 	std::vector<glm::vec4> boundingBoxes;
 
 	std::vector<VkBuffer> frustrumPlaneBuffers;
@@ -194,14 +258,97 @@ public:
 	std::vector<VkBuffer> bbBuffers;
 	std::vector<VkDeviceMemory> bbBufferMemorys;
 
+	// GPU CLUSTER CULLING - STATIC DRAWS WITH MORE THAN ONE MESHLET ARE DRAWN OUT OF A PER FRAME COPY OF THE INDEX BUFFER THAT clusterCull.comp
+	// REFILLS WITH THE TRIANGLES OF THE CLUSTERS THAT SURVIVE. clusteredDraws_ HOLDS A 1 FOR EVERY STATIC DRAW THAT IS CLUSTERED
+	bool clusterCulling_ = true;
+	std::vector<GPUCluster> clusters_;
+	std::vector<uint32_t> clusteredDraws_;
+
+	VkBuffer clusterBuffer_;
+	VkDeviceMemory clusterBufferMemory_;
+	VkBuffer clusteredDrawBuffer_;
+	VkDeviceMemory clusteredDrawBufferMemory_;
+	std::vector<VkBuffer> clusterIndexBuffers_;
+	std::vector<VkDeviceMemory> clusterIndexBufferMemorys_;
+
+	// TWO PHASE OCCLUSION CULLING. THE EARLY CULL TESTS EVERY STATIC DRAW AGAINST LAST FRAME'S HI-Z PYRAMID (REPROJECTED WITH LAST FRAME'S CAMERA),
+	// THE PREPASS DRAWS WHAT PASSED AND THE PYRAMID IS REBUILT FROM IT. THE LATE CULL RETESTS ONLY THE DRAWS THE EARLY ONE CALLED OCCLUDED AGAINST
+	// THAT FRESH PYRAMID AND THE LATE PREPASS ADDS THE ONES THAT CAME BACK, SO NOTHING VISIBLE THIS FRAME STAYS MISSING
+	bool occlusionCulling_ = true;
+	bool hiZValid_ = false; // FALSE UNTIL A PYRAMID EXISTS (FIRST FRAME, AFTER A RESIZE), THE EARLY CULL IS FRUSTUM ONLY UNTIL THEN
+	glm::mat4 hiZViewProjection_ = glm::mat4(1.0f);
+	HiZPyramid* pHiZ_ = nullptr;
+	CullStats cullStats_{};
+
+	std::vector<VkBuffer> lateFinalDrawCallBuffers_;
+	std::vector<VkDeviceMemory> lateFinalDrawCallBufferMemorys_;
+	std::vector<VkBuffer> occlusionStateBuffers_;
+	std::vector<VkDeviceMemory> occlusionStateBufferMemorys_;
+	std::vector<VkBuffer> cullStatsBuffers_;
+	std::vector<void*> mappedCullStatsBuffers_;
+	std::vector<VkDeviceMemory> cullStatsBufferMemorys_;
+
+	// DRAW COMPACTION. THE CULL PACKS EVERY STATIC BATCH'S VISIBLE COMMANDS FROM THE BATCH'S FIRST SLOT AND COUNTS THEM, THE STATIC BATCHES ARE DRAWN
+	// WITH vkCmdDrawIndexedIndirectCount SO CULLED DRAWS COST NOTHING
+	VkBuffer drawBatchBuffer_;
+	VkDeviceMemory drawBatchBufferMemory_;
+	std::vector<VkBuffer> drawCountBuffers_;
+	std::vector<VkDeviceMemory> drawCountBufferMemorys_;
+	std::vector<VkBuffer> lateDrawCountBuffers_;
+	std::vector<VkDeviceMemory> lateDrawCountBufferMemorys_;
+	std::vector<VkBuffer> drawSlotBuffers_;
+	std::vector<VkDeviceMemory> drawSlotBufferMemorys_;
+
+	// SHADOW CASTER CULLING. THE EARLY CULL ALSO TESTS EVERY STATIC DRAW AGAINST EACH CASCADE'S LIGHT FRUSTUM AND PACKS THE CASTERS INTO THAT
+	// CASCADE'S FULL LAYOUT REGION OF shadowDrawCallBuffers_ (AT cascade * drawCommands.size()), COUNTED PER CASCADE AND BATCH
+	std::vector<VkBuffer> shadowCascadePlaneBuffers_;
+	std::vector<void*> mappedShadowCascadePlaneBuffers_;
+	std::vector<VkDeviceMemory> shadowCascadePlaneBufferMemorys_;
+	std::vector<VkBuffer> shadowDrawCallBuffers_;
+	std::vector<VkDeviceMemory> shadowDrawCallBufferMemorys_;
+	std::vector<VkBuffer> shadowDrawCountBuffers_;
+	std::vector<VkDeviceMemory> shadowDrawCountBufferMemorys_;
+
+	// BINDLESS MATERIALS. WITH DESCRIPTOR INDEXING THE COLOR PASS BINDS ONE SET HOLDING EVERY STATIC MATERIAL, SO THE OPAQUE STATIC DRAWS ARE MERGED
+	// INTO (AT MOST) TWO BATCHES. WITHOUT IT pBindless_ STAYS NULL AND EVERY BATCH BINDS ITS MATERIAL'S OWN SET AS BEFORE
+	bool bindlessMaterials_ = true;
+	bool descriptorIndexing_ = false;
+	BindlessMaterials* pBindless_ = nullptr;
+	std::vector<uint32_t> drawMaterials_; // BINDLESS MATERIAL INDEX PER DRAW, BY firstInstance
+
 	std::vector<GameObject*>* gameObjects;
 	std::vector<AnimatedGameObject*>* animatedObjects;
 
 	struct ComputePushConstant {
-		uint32_t jointMatrixStart;
+		uint32_t firstInstance;
 		uint32_t numVertices;
 	};
 
+	// computeSkin RUNS ONCE PER MODEL, ONE ROW OF WORKGROUPS PER INSTANCE. THE INSTANCE TABLE HOLDS EVERY ANIMATED OBJECT'S PALETTE AND OUTPUT
+	// RANGE, THE INSTANCES OF ONE MODEL NEXT TO EACH OTHER
+	struct SkinInstance {
+		uint32_t firstJointMatrix;
+		uint32_t firstVertex;
+		uint32_t skinningMode; // AnimatedGameObject::SkinningMode
+		float bindScale; // THE SKIN'S UNIFORM SCALE AT ITS REST POSE, WHAT THE DUAL QUATERNION PATH SCALES THE BASE POSE BY
+	};
+
+	struct SkinnedModel {
+		AnimatedGLTFObj* model;
+		uint32_t firstInstance;
+		uint32_t instanceCount;
+	};
+
+	std::vector<SkinnedModel> skinnedModels_;
+	std::vector<AnimatedGameObject*> skinInstanceObjects_; // THE OBJECT BEHIND EACH SkinInstance
+	VkBuffer skinInstanceBuffer_;
+	VkDeviceMemory skinInstanceBufferMemory_;
+
+	// INSTANCES OUTSIDE THE CAMERA AND THE SHADOW CASCADES, OR WHOSE PALETTE HASN'T CHANGED SINCE THEY WERE LAST SKINNED, ARE LEFT OUT OF THE DISPATCH
+	// AND KEEP THEIR LAST SKINNED VERTICES. EACH RUN OF INSTANCES THAT ARE SKINNED IS ONE DISPATCH
+	bool conditionalSkinning_ = true;
+	SkinningStats skinningStats_{};
+
 	BloomHelper* bloomHelper;
 
 	DeviceHelper* pDevHelper_;
@@ -217,6 +364,7 @@ public:
 	VkDebugUtilsMessengerEXT debugMessenger_;
 	VulkanPipelineBuilder* opaquePipeline_;
 	VulkanPipelineBuilder* prepassPipeline_;
+	VulkanPipelineBuilder* alphaPrepassPipeline_;
 	VulkanPipelineBuilder* toonPipeline_;
 	VulkanPipelineBuilder* outlinePipeline_;
 	VulkanPipelineBuilder* toneMappingPipeline_;
@@ -231,6 +379,10 @@ public:
 	VulkanDescriptorLayoutBuilder* computeCullDescriptorSetLayout_;
 	VkDescriptorSet primaryCameraComputeCullDescriptorSet;
 
+	VkPipeline clusterCullPipeline_;
+	VkPipelineLayout clusterCullPipelineLayout_;
+	VulkanDescriptorLayoutBuilder* clusterCullDescriptorSetLayout_;
+
 	std::vector<VkBuffer> mainCameraFinalDrawCallBuffer_;
 	std::vector<VkDeviceMemory> mainCameraFinalDrawCallBufferMemory_;
 
@@ -241,6 +393,7 @@ public:
 
 	VkRenderPass renderPass_;
 	VkRenderPass depthPrepass_;
+	VkRenderPass depthPrepassLoad_;
 	VkRenderPass toneMapPass_;
 	std::vector<VkCommandBuffer> commandBuffers_;
 	VkDescriptorPool descriptorPool_;
@@ -309,17 +462,21 @@ public:
 	void sortDraw(AnimatedGLTFObj* animObj, AnimSceneNode* node);
 	void setupCompute(int framesInFlight);
 	void createBoundingBoxes();
+	void addClusters(MeshHelper* dC, Material* material, uint32_t drawIndex);
 	void createVertexBuffer();
 	void createQuadVertexBuffer();
 	void createIndexBuffer();
 	void createQuadIndexBuffer();
 	void updateBindMatrices();
 	void updateGeneratedImageDescriptorSets();
+	void createBindlessMaterials(int maxFramesInFlight);
 	void renderBloom(VkCommandBuffer& commandBuffer);
-	void fullDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, int materialPosition);
+	void fullDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, const VkBuffer& countBuffer, int materialPosition);
 	void animatedDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, int materialPosition);
-	void nonAnimatedDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, int materialPosition);
-	void shadowDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, int materialPosition);
+	void nonAnimatedDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, const VkBuffer& countBuffer, int materialPosition);
+	void shadowDraw(VkCommandBuffer& commandBuffer, VkPipelineLayout* layout, const VkBuffer& drawBuffer, const VkBuffer& countBuffer, uint32_t cascadeIndex, int materialPosition);
+	void depthDraw(VkCommandBuffer& commandBuffer, const VkBuffer& drawBuffer, const VkBuffer& countBuffer, bool includeAnimated);
 	void createComputeCullResources(int framesInFlight);
+	void createClusterCullResources(int framesInFlight);
 	void shutdown();
 };
\ No newline at end of file
@@ -278,7 +278,27 @@ tbool genTangSpace(const SMikkTSpaceContext* pContext, const float fAngularThres
 	// Mark all degenerate triangles
 	iTotTris = iNrTrianglesIn;
 	iDegenTriangles = 0;
-	for (t = 0; t < iTotTris; t++)
+	if (pContext->m_pSoA != NULL)
+	{
+		// welding only merges corners whose positions compare equal, so testing the
+		// triangle's own corners 3t..3t+2 in place gives the same answer
+		const SMikkTSpaceSoA* pSoA = pContext->m_pSoA;
+		for (t = 0; t < iTotTris; t++)
+		{
+			const float* pX = &pSoA->m_pPosX[t * 3];
+			const float* pY = &pSoA->m_pPosY[t * 3];
+			const float* pZ = &pSoA->m_pPosZ[t * 3];
+			const tbool b01 = pX[0] == pX[1] && pY[0] == pY[1] && pZ[0] == pZ[1];
+			const tbool b02 = pX[0] == pX[2] && pY[0] == pY[2] && pZ[0] == pZ[2];
+			const tbool b12 = pX[1] == pX[2] && pY[1] == pY[2] && pZ[1] == pZ[2];
+			if (b01 || b02 || b12)	// degenerate
+			{
+				pTriInfos[t].iFlag |= MARK_DEGENERATE;
+				++iDegenTriangles;
+			}
+		}
+	}
+	else for (t = 0; t < iTotTris; t++)
 	{
 		const int i0 = piTriListIn[t * 3 + 0];
 		const int i1 = piTriListIn[t * 3 + 1];
@@ -458,7 +478,21 @@ static void GenerateSharedVerticesIndexList(int piTriList_in_and_out[], const SM
 	int iMaxCount = 0;
 	SVec3 vMin = GetPosition(pContext, 0), vMax = vMin, vDim;
 	float fMin, fMax;
-	for (i = 1; i < (iNrTrianglesIn * 3); i++)
+	if (pContext->m_pSoA != NULL)
+	{
+		// with batched input the initial list is the identity over corners, so the bounds
+		// are a branch free min/max over the position arrays (same result as the loop below)
+		const SMikkTSpaceSoA* pSoA = pContext->m_pSoA;
+		const int iNrCorners = iNrTrianglesIn * 3;
+		for (i = 1; i < iNrCorners; i++)
+		{
+			const float fX = pSoA->m_pPosX[i], fY = pSoA->m_pPosY[i], fZ = pSoA->m_pPosZ[i];
+			vMin.x = fX < vMin.x ? fX : vMin.x; vMax.x = vMax.x < fX ? fX : vMax.x;
+			vMin.y = fY < vMin.y ? fY : vMin.y; vMax.y = vMax.y < fY ? fY : vMax.y;
+			vMin.z = fZ < vMin.z ? fZ : vMin.z; vMax.z = vMax.z < fZ ? fZ : vMax.z;
+		}
+	}
+	else for (i = 1; i < (iNrTrianglesIn * 3); i++)
 	{
 		const int index = piTriList_in_and_out[i];
 
@@ -882,10 +916,23 @@ static int GenerateInitialVerticesIndexList(STriInfo pTriInfos[], int piTriList_
 	return iTSpacesOffs;
 }
 
+// corner of a triangle only mesh in the batched input arrays
+static int SoACorner(const int index)
+{
+	return (index >> 2) * 3 + (index & 0x3);
+}
+
 static SVec3 GetPosition(const SMikkTSpaceContext* pContext, const int index)
 {
 	int iF, iI;
 	SVec3 res; float pos[3];
+	if (pContext->m_pSoA != NULL)
+	{
+		const SMikkTSpaceSoA* pSoA = pContext->m_pSoA;
+		const int iC = SoACorner(index);
+		res.x = pSoA->m_pPosX[iC]; res.y = pSoA->m_pPosY[iC]; res.z = pSoA->m_pPosZ[iC];
+		return res;
+	}
 	IndexToData(&iF, &iI, index);
 	pContext->m_pInterface->m_getPosition(pContext, pos, iF, iI);
 	res.x = pos[0]; res.y = pos[1]; res.z = pos[2];
@@ -896,6 +943,13 @@ static SVec3 GetNormal(const SMikkTSpaceContext* pContext, const int index)
 {
 	int iF, iI;
 	SVec3 res; float norm[3];
+	if (pContext->m_pSoA != NULL)
+	{
+		const SMikkTSpaceSoA* pSoA = pContext->m_pSoA;
+		const int iC = SoACorner(index);
+		res.x = pSoA->m_pNormX[iC]; res.y = pSoA->m_pNormY[iC]; res.z = pSoA->m_pNormZ[iC];
+		return res;
+	}
 	IndexToData(&iF, &iI, index);
 	pContext->m_pInterface->m_getNormal(pContext, norm, iF, iI);
 	res.x = norm[0]; res.y = norm[1]; res.z = norm[2];
@@ -906,6 +960,13 @@ static SVec3 GetTexCoord(const SMikkTSpaceContext* pContext, const int index)
 {
 	int iF, iI;
 	SVec3 res; float texc[2];
+	if (pContext->m_pSoA != NULL)
+	{
+		const SMikkTSpaceSoA* pSoA = pContext->m_pSoA;
+		const int iC = SoACorner(index);
+		res.x = pSoA->m_pTexU[iC]; res.y = pSoA->m_pTexV[iC]; res.z = 1.0f;
+		return res;
+	}
 	IndexToData(&iF, &iI, index);
 	pContext->m_pInterface->m_getTexCoord(pContext, texc, iF, iI);
 	res.x = texc[0]; res.y = texc[1]; res.z = 1.0f;
@@ -104,10 +104,20 @@ extern "C" {
 			const tbool bIsOrientationPreserving, const int iFace, const int iVert);
 	} SMikkTSpaceInterface;
 
+	// Optional batched input. When set on the context every face must be a triangle and the arrays are
+	// indexed by corner (iFace * 3 + iVert). The values must be exactly what m_getPosition/m_getNormal/
+	// m_getTexCoord would have returned, the callbacks are then only used for face counts and output.
+	typedef struct {
+		const float* m_pPosX; const float* m_pPosY; const float* m_pPosZ;
+		const float* m_pNormX; const float* m_pNormY; const float* m_pNormZ;
+		const float* m_pTexU; const float* m_pTexV;
+	} SMikkTSpaceSoA;
+
 	struct SMikkTSpaceContext
 	{
 		SMikkTSpaceInterface* m_pInterface;	// initialized with callback functions
 		void* m_pUserData;						// pointer to client side mesh data etc. (passed as the first parameter with every interface call)
+		const SMikkTSpaceSoA* m_pSoA;			// optional, NULL reads every corner through the callbacks
 	};
 
 	// these are both thread safe!
@@ -1,28 +0,0 @@
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/shader.vert -o spv/vert.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/shader.frag -o spv/frag.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/outline.vert -o spv/outlineVert.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/outline.frag -o spv/outlineFrag.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/persona.frag -o spv/toonFrag.spv -O
-
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/shadowMap.vert -o spv/shadowMap.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/depthPrePass.vert -o spv/depthPass.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/depthPrePassFrag.frag -o spv/depthPassAlpha.spv -O
-
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/brdfLUT.vert -o spv/brdfLUTVert.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/brdfLUT.frag -o spv/brdfLUTFrag.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/filterCube.vert -o spv/filterCubeVert.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/irradianceCube.frag -o spv/irradianceCubeFrag.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/prefEnvMap.frag -o spv/prefilteredEnvMapFrag.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/skybox.vert -o spv/skyboxVert.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/skybox.frag -o spv/skyboxFrag.spv -O
-
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/screenQuad.vert -o spv/screenQuadVert.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/tonemapping.frag -o spv/tonemappingFrag.spv -O
-
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/downSample.frag -o spv/downSample.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/upSample.frag -o spv/upSample.spv -O
-
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/skinning.comp -o spv/computeSkin.spv -O
-C:/VulkanSDK/1.3.268.0/Bin/glslc.exe glsl/frustrumCull.comp -o spv/frustrumCull.spv -O
-
-pause
\ No newline at end of file
@@ -19,13 +19,13 @@ layout(std430, set = 2, binding = 0) readonly buffer ModelMatrices {
 
 invariant gl_Position;
 
-layout(location = 0) in vec4 inPosition;
-layout(location = 1) in vec4 inNormal;
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
 
 layout(location = 0) out vec2 fragTexCoord;
  
 void main()
 {
-	fragTexCoord = vec2(inPosition.w, inNormal.w);
+	fragTexCoord = inTexCoord;
 	gl_Position = ubo.proj * ubo.view * modelMatrices[gl_BaseInstance] * vec4(inPosition.xyz, 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#version 460
+
+#define SHADOW_MAP_CASCADE_COUNT 4
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+    vec4 lightPos;
+    vec4 viewPos;
+    vec4 gammaExposure;
+    vec4 cascadeSplits;
+    mat4 cascadeViewProj[SHADOW_MAP_CASCADE_COUNT];
+    vec4 cascadeBiases;
+} ubo;
+
+layout(std430, set = 2, binding = 0) readonly buffer ModelMatrices {
+	mat4 modelMatrices[];
+};
+
+invariant gl_Position;
+
+layout(location = 0) in vec3 inPosition;
+ 
+void main()
+{
+	gl_Position = ubo.proj * ubo.view * modelMatrices[gl_BaseInstance] * vec4(inPosition.xyz, 1.0f);
+}
@@ -17,11 +17,13 @@ layout(std430, set = 1, binding = 0) readonly buffer ModelMatrices {
 	mat4 modelMatrices[];
 };
 
-layout(location = 0) in vec4 inPosition;
-layout(location = 1) in vec4 inNormal;
+#include "vertexPacking.glsl"
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in ivec4 inNormalTangent;
 
 invariant gl_Position;
 
 void main() {
-	gl_Position = ubo.proj * ubo.view * modelMatrices[gl_BaseInstance] * vec4((inPosition + (inNormal * vec4(0.0035f))).xyz, 1.0f);
+	gl_Position = ubo.proj * ubo.view * modelMatrices[gl_BaseInstance] * vec4(inPosition + (decodeNormal(inNormalTangent.xy) * 0.0035f), 1.0f);
 }
\ No newline at end of file
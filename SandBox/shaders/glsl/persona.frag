@@ -38,7 +38,8 @@ layout(location = 1) out vec4 bloomColor;
 layout (depth_unchanged) out float gl_FragDepth;
 
 vec4 albedoAlpha = texture(colorSampler, fragTexCoord);
-vec3 tangentNormal = texture(normalSampler, fragTexCoord).xyz * 2.0 - 1.0;
+vec2 tangentNormalXY = texture(normalSampler, fragTexCoord).xy * 2.0 - 1.0; // BC5 NORMALS ONLY STORE XY
+vec3 tangentNormal = vec3(tangentNormalXY, sqrt(max(1.0 - dot(tangentNormalXY, tangentNormalXY), 0.0)));
 vec4 metallicRoughness = texture(metallicRoughnessSampler, fragTexCoord);
 vec3 aoVec = texture(aoSampler, fragTexCoord).rrr;
 vec3 emissionVec = texture(emissionSampler, fragTexCoord).rgb;
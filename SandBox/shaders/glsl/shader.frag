@@ -2,6 +2,10 @@
 
 #define SHADOW_MAP_CASCADE_COUNT 4
 
+#ifdef BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+#endif
+
 #include "aces.glsl"
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
@@ -22,11 +26,32 @@ const mat4 biasMat = mat4(
 	0.5, 0.5, 0.0, 1.0 
 );
 
+#ifdef BINDLESS
+// every static material in one set, textures[materials[i].textures[n]] is texture n of material i. must match BindlessMaterials::GPUMaterial
+struct Material {
+    uint textures[5];
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer Materials {
+    Material materials[];
+};
+layout(set = 1, binding = 2) uniform sampler2D textures[];
+
+layout(location = 5) flat in uint fragMaterialIndex;
+
+// the index comes from the draw, it can differ inside a subgroup
+#define colorSampler textures[nonuniformEXT(materials[fragMaterialIndex].textures[0])]
+#define normalSampler textures[nonuniformEXT(materials[fragMaterialIndex].textures[1])]
+#define metallicRoughnessSampler textures[nonuniformEXT(materials[fragMaterialIndex].textures[2])]
+#define aoSampler textures[nonuniformEXT(materials[fragMaterialIndex].textures[3])]
+#define emissionSampler textures[nonuniformEXT(materials[fragMaterialIndex].textures[4])]
+#else
 layout(set = 1, binding = 0) uniform sampler2D colorSampler;
 layout(set = 1, binding = 1) uniform sampler2D normalSampler;
 layout(set = 1, binding = 2) uniform sampler2D metallicRoughnessSampler;
 layout(set = 1, binding = 3) uniform sampler2D aoSampler;
 layout(set = 1, binding = 4) uniform sampler2D emissionSampler;
+#endif
 layout(set = 1, binding = 5) uniform sampler2D brdfTexture;
 layout(set = 1, binding = 6) uniform samplerCube irradianceCube;
 layout(set = 1, binding = 7) uniform samplerCube prefilteredEnvMap;
@@ -41,7 +66,8 @@ layout(location = 1) out vec4 bloomColor;
 layout (depth_unchanged) out float gl_FragDepth;
 
 vec4 albedoAlpha = texture(colorSampler, fragTexCoord);
-vec3 tangentNormal = texture(normalSampler, fragTexCoord).xyz * 2.0 - 1.0;
+vec2 tangentNormalXY = texture(normalSampler, fragTexCoord).xy * 2.0 - 1.0; // BC5 NORMALS ONLY STORE XY
+vec3 tangentNormal = vec3(tangentNormalXY, sqrt(max(1.0 - dot(tangentNormalXY, tangentNormalXY), 0.0)));
 vec4 metallicRoughness = texture(metallicRoughnessSampler, fragTexCoord);
 vec3 aoVec = texture(aoSampler, fragTexCoord).rrr;
 vec3 emissionVec = texture(emissionSampler, fragTexCoord).rgb;
@@ -17,18 +17,35 @@ layout(std430, set = 2, binding = 0) readonly buffer ModelMatrices {
 	mat4 modelMatrices[];
 };
 
-layout(location = 0) in vec4 inPosition;
-layout(location = 1) in vec4 inNormal;
-layout(location = 2) in vec4 inTangent;
+#include "vertexPacking.glsl"
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in ivec4 inNormalTangent;
+layout(location = 2) in vec2 inTexCoord;
 
 layout(location = 0) out vec4 fragPosition;
 layout(location = 1) out vec2 fragTexCoord;
 layout(location = 2) out mat3 TBNMatrix;
 
+#ifdef BINDLESS
+// bindless material index per draw, indexed like the model matrices
+layout(std430, set = 1, binding = 1) readonly buffer DrawMaterials {
+	uint drawMaterials[];
+};
+
+layout(location = 5) flat out uint fragMaterialIndex;
+#endif
+
 invariant gl_Position;
 
 void main() {
-    fragTexCoord = vec2(inPosition.w, inNormal.w);
+    vec3 inNormal = decodeNormal(inNormalTangent.xy);
+    vec4 inTangent = decodeTangent(inNormalTangent.zw);
+
+    fragTexCoord = inTexCoord;
+#ifdef BINDLESS
+    fragMaterialIndex = drawMaterials[gl_BaseInstance];
+#endif
 
     vec4 pos = modelMatrices[gl_BaseInstance] * vec4(inPosition.xyz, 1.0f);
 
@@ -14,7 +14,7 @@ layout(std430, set = 1, binding = 0) readonly buffer ModelMatrices {
 	mat4 modelMatrices[];
 };
 
-layout(location = 0) in vec4 inPosition;
+layout(location = 0) in vec3 inPosition;
  
 void main()
 {
@@ -13,7 +13,7 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
     vec4 cascadeBiases;
 } ubo;
 
-layout(location = 0) in vec4 inPosition;
+layout(location = 0) in vec3 inPosition;
 
 layout (location = 0) out vec3 outUVW;
 
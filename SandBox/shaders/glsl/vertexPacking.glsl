@@ -0,0 +1,43 @@
+// DECODE/ENCODE FOR THE PACKED VERTEX ATTRIBUTE STREAM (VertexAttributes IN MeshHelper.h)
+// NORMAL AND TANGENT ARE OCTAHEDRAL SNORM16 PAIRS, THE LOWEST BIT OF THE TANGENT X IS THE BITANGENT SIGN (1 = NEGATIVE)
+
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+vec2 octEncode(vec3 n) {
+    n /= (abs(n.x) + abs(n.y) + abs(n.z));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return n.xy;
+}
+
+vec3 decodeNormal(ivec2 q) {
+    return octDecode(max(vec2(q) / 32767.0, vec2(-1.0)));
+}
+
+vec4 decodeTangent(ivec2 q) {
+    return vec4(octDecode(max(vec2(q) / 32767.0, vec2(-1.0))), (q.x & 1) != 0 ? -1.0 : 1.0);
+}
+
+// STORAGE BUFFER VARIANTS, ONE uint PER SNORM16 PAIR
+vec3 unpackNormalWord(uint w) {
+    return octDecode(unpackSnorm2x16(w));
+}
+
+vec4 unpackTangentWord(uint w) {
+    return vec4(octDecode(unpackSnorm2x16(w)), (w & 1u) != 0u ? -1.0 : 1.0);
+}
+
+uint packNormalWord(vec3 n) {
+    return packSnorm2x16(octEncode(n));
+}
+
+uint packTangentWord(vec4 t) {
+    return (packSnorm2x16(octEncode(t.xyz)) & ~1u) | (t.w < 0.0 ? 1u : 0u);
+}
@@ -0,0 +1,163 @@
+#include "Test.h"
+#include "AnimationLOD.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// selectLevel FOR EACH SIZE IN TURN, EACH STARTING FROM THE LEVEL THE ONE BEFORE PICKED. RETURNS HOW OFTEN THE LEVEL CHANGED
+static size_t levelChanges(const AnimationLOD::Settings& settings, const std::vector<float>& sizes, uint32_t& level) {
+    size_t changes = 0;
+    for (float size : sizes) {
+        const uint32_t next = AnimationLOD::selectLevel(settings, size, level);
+        changes += next != level ? 1 : 0;
+        level = next;
+    }
+    return changes;
+}
+
+void runAnimationLODTests() {
+    const AnimationLOD::Settings settings;
+
+    // GOING DOWN THERE IS NO HYSTERESIS, A CHARACTER AT A THRESHOLD STAYS ABOVE IT AND ONE JUST UNDER DROPS PAST IT
+    Test::context_ = "thresholds";
+    {
+        CHECK(AnimationLOD::selectLevel(settings, 1.0f, 0) == 0);
+        for (uint32_t level = 0; level < AnimationLOD::FROZEN; level++) {
+            const float threshold = settings.minScreenSize[level];
+            CHECK(AnimationLOD::selectLevel(settings, threshold, 0) == level);
+            CHECK(AnimationLOD::selectLevel(settings, std::nextafter(threshold, 0.0f), 0) == level + 1);
+            CHECK(AnimationLOD::selectLevel(settings, std::nextafter(threshold, 0.0f), level) == level + 1);
+        }
+        CHECK(AnimationLOD::selectLevel(settings, 0.0f, 0) == AnimationLOD::FROZEN);
+        CHECK(AnimationLOD::selectLevel(settings, std::numeric_limits<float>::max(), AnimationLOD::FROZEN) == 0);
+    }
+
+    // GOING UP A CHARACTER HAS TO PASS EACH THRESHOLD ABOVE ITS LEVEL BY THE HYSTERESIS, THOSE AT OR BELOW IT ONLY NEED TO BE MET
+    Test::context_ = "hysteresis";
+    {
+        for (uint32_t level = 0; level < AnimationLOD::FROZEN; level++) {
+            const float threshold = settings.minScreenSize[level];
+            const float raised = threshold * (1.0f + settings.hysteresis);
+            CHECK(AnimationLOD::selectLevel(settings, threshold, level + 1) == level + 1);
+            CHECK(AnimationLOD::selectLevel(settings, raised * 0.999f, level + 1) == level + 1);
+            CHECK(AnimationLOD::selectLevel(settings, raised * 1.001f, level + 1) == level);
+            CHECK(AnimationLOD::selectLevel(settings, threshold, AnimationLOD::FROZEN) == level + 1);
+        }
+        // STARTING FROZEN, A SIZE BETWEEN TWO THRESHOLDS BUT UNDER THE RAISED ONE LANDS ONE LEVEL LOWER THAN STARTING FROM THE TOP
+        CHECK(AnimationLOD::selectLevel(settings, 0.26f, 0) == 0);
+        CHECK(AnimationLOD::selectLevel(settings, 0.26f, AnimationLOD::FROZEN) == 1);
+
+        AnimationLOD::Settings none = settings;
+        none.hysteresis = 0.0f;
+        CHECK(AnimationLOD::selectLevel(none, settings.minScreenSize[1], AnimationLOD::FROZEN) == 1);
+    }
+
+    // A CHARACTER WOBBLING ABOUT A THRESHOLD BY LESS THAN THE HYSTERESIS DROPS ONCE AND STAYS, WITHOUT IT IT CHANGES LEVEL EVERY FRAME
+    Test::context_ = "boundary";
+    {
+        std::vector<float> sizes;
+        for (int frame = 0; frame < 100; frame++) {
+            sizes.push_back(settings.minScreenSize[0] * (frame % 2 == 0 ? 0.99f : 1.05f));
+        }
+        uint32_t level = 0;
+        CHECK(levelChanges(settings, sizes, level) == 1);
+        CHECK(level == 1);
+
+        AnimationLOD::Settings none = settings;
+        none.hysteresis = 0.0f;
+        level = 0;
+        CHECK(levelChanges(none, sizes, level) == sizes.size());
+    }
+
+    // A CAMERA AT THE ORIGIN LOOKING DOWN -z, THE DIAMETER OVER THE HEIGHT OF THE VIEW AT THE SPHERE'S DEPTH
+    Test::context_ = "screen size";
+    {
+        AnimationLOD::View view;
+        view.viewMatrix = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        view.projectionScale = 2.0f;
+        CHECK(std::abs(AnimationLOD::screenSize(view, glm::vec4(0.0f, 0.0f, -10.0f, 1.0f)) - 0.2f) <= 1e-6f);
+        CHECK(std::abs(AnimationLOD::screenSize(view, glm::vec4(3.0f, -2.0f, -20.0f, 1.0f)) - 0.1f) <= 1e-6f);
+        CHECK(AnimationLOD::screenSize(view, glm::vec4(0.0f, 0.0f, -0.5f, 1.0f)) == std::numeric_limits<float>::max());
+
+        // THE SAME SPHERE SEEN FROM A CAMERA THAT HAS MOVED AND TURNED
+        view.viewMatrix = glm::lookAt(glm::vec3(5.0f, 1.0f, 5.0f), glm::vec3(5.0f, 1.0f, 15.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        CHECK(std::abs(AnimationLOD::screenSize(view, glm::vec4(5.0f, 1.0f, 25.0f, 2.0f)) - 0.2f) <= 1e-6f);
+    }
+
+    // EVERY CHARACTER AT A LEVEL UPDATES ONCE PER INTERVAL, AND THE STAGGER SPREADS A CROWD EVENLY OVER THE FRAMES OF IT
+    Test::context_ = "update intervals";
+    {
+        for (uint32_t level = 0; level < AnimationLOD::FROZEN; level++) {
+            const uint32_t interval = settings.updateInterval[level];
+            const size_t crowd = 8 * interval;
+            size_t uneven = 0;
+            std::vector<size_t> updates(crowd, 0);
+            for (uint64_t frame = 100; frame < 100 + 3 * interval; frame++) {
+                size_t updated = 0;
+                for (size_t stagger = 0; stagger < crowd; stagger++) {
+                    const bool update = AnimationLOD::updatesThisFrame(settings, level, frame, stagger);
+                    updated += update ? 1 : 0;
+                    updates[stagger] += update ? 1 : 0;
+                }
+                uneven += updated != crowd / interval ? 1 : 0;
+            }
+            CHECK(uneven == 0);
+            CHECK(std::count(updates.begin(), updates.end(), size_t(3)) == static_cast<ptrdiff_t>(crowd));
+        }
+
+        // AN INTERVAL OF 0 IS EVERY FRAME
+        AnimationLOD::Settings zero = settings;
+        zero.updateInterval[1] = 0;
+        CHECK(AnimationLOD::updatesThisFrame(zero, 1, 7, 0));
+    }
+
+    // WHILE FROZEN THE PENDING TIME GROWS TO ONE INTERVAL OF THE SLOWEST ANIMATED LEVEL AND NO FURTHER, LESS THAN THAT IS LEFT ALONE
+    Test::context_ = "frozen time cap";
+    {
+        const float deltaTime = 1.0f / 60.0f;
+        const float cap = deltaTime * static_cast<float>(settings.updateInterval[AnimationLOD::FROZEN - 1]);
+        CHECK(AnimationLOD::frozenPendingTime(settings, 0.5f * cap, deltaTime) == 0.5f * cap);
+        CHECK(AnimationLOD::frozenPendingTime(settings, 10.0f, deltaTime) == cap);
+
+        // updateAnimation ADDS THE FRAME'S TIME, THEN CAPS IT
+        float pending = 0.0f;
+        float largest = 0.0f;
+        for (int frame = 0; frame < 600; frame++) {
+            pending = AnimationLOD::frozenPendingTime(settings, pending + deltaTime, deltaTime);
+            largest = std::max(largest, pending);
+        }
+        CHECK(pending == cap);
+        CHECK(largest == cap);
+
+        // A LONGER FRAME RAISES THE CAP WITH IT, AN INTERVAL OF 0 CAPS AT ONE FRAME
+        CHECK(AnimationLOD::frozenPendingTime(settings, 10.0f, 4.0f * deltaTime) == 4.0f * cap);
+        AnimationLOD::Settings zero = settings;
+        zero.updateInterval[AnimationLOD::FROZEN - 1] = 0;
+        CHECK(AnimationLOD::frozenPendingTime(zero, 10.0f, deltaTime) == deltaTime);
+    }
+
+    // THE INTERPOLATED PALETTE AND BOUNDS START AT from, END AT to AND ARE LINEAR BETWEEN
+    Test::context_ = "interpolation";
+    {
+        const glm::mat4 from[2] = { glm::mat4(1.0f), glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 2.0f, 3.0f)) };
+        const glm::mat4 to[2] = { glm::rotate(glm::mat4(1.0f), 0.5f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::translate(glm::mat4(1.0f), glm::vec3(-3.0f, 2.0f, 7.0f)) };
+        glm::mat4 out[2];
+        AnimationLOD::interpolatePalette(from, to, 0.0f, 2, out);
+        CHECK(out[0] == from[0] && out[1] == from[1]);
+        AnimationLOD::interpolatePalette(from, to, 1.0f, 2, out);
+        float error = 0.0f;
+        for (int m = 0; m < 2; m++) {
+            for (int c = 0; c < 4; c++) {
+                const glm::vec4 difference = glm::abs(out[m][c] - to[m][c]);
+                error = std::max(error, std::max(std::max(difference.x, difference.y), std::max(difference.z, difference.w)));
+            }
+        }
+        CHECK(error <= 1e-6f);
+        AnimationLOD::interpolatePalette(from, to, 0.25f, 2, out);
+        CHECK(out[1][3] == glm::vec4(0.0f, 2.0f, 4.0f, 1.0f));
+        CHECK(AnimationLOD::interpolateBounds(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), glm::vec4(4.0f, 0.0f, -8.0f, 3.0f), 0.25f) == glm::vec4(1.0f, 0.0f, -2.0f, 1.5f));
+    }
+    Test::context_.clear();
+}
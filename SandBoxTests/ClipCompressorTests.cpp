@@ -0,0 +1,194 @@
+#include "Test.h"
+#include "ClipCompressor.h"
+#include <random>
+
+// 15 BITS OVER [-1 / sqrt(2), 1 / sqrt(2)]. A STORED COMPONENT IS OFF BY AT MOST HALF A STEP, THE REBUILT LARGEST ONE BY WHAT THE OTHER THREE'S
+// ERRORS DO TO 1 - SUM OF SQUARES
+static const float ROTATION_STEP = 2.0f * 0.70710678f / 32767.0f;
+static const float ROTATION_QUANTIZATION = 1e-4f;
+
+static glm::vec4 randomRotation(std::mt19937& generator) {
+    std::normal_distribution<float> normal;
+    return glm::normalize(glm::vec4(normal(generator), normal(generator), normal(generator), normal(generator)));
+}
+
+// q AND -q ARE THE SAME ROTATION, ONE SIGN FOR THE WHOLE QUATERNION
+static float rotationError(const glm::vec4& a, const glm::vec4& b) {
+    const glm::vec4 difference = glm::abs(a - (glm::dot(a, b) < 0.0f ? -b : b));
+    return std::max(std::max(difference.x, difference.y), std::max(difference.z, difference.w));
+}
+
+// A SMOOTH CURVE WITH A LITTLE NOISE, SAMPLED AT 30 HZ, THE WAY AN EXPORTER BAKES A CLIP. flip NEGATES EVERY OTHER ROTATION KEY, THE SAME ROTATIONS
+// WITH NEIGHBOURS IN OPPOSITE HEMISPHERES
+static void addTrack(CompiledAnimation& clip, CompiledAnimation::Path path, uint32_t node, float length, std::mt19937& generator, bool flip = false) {
+    std::uniform_real_distribution<float> phase(0.0f, 6.0f);
+    std::uniform_real_distribution<float> noise(-1e-3f, 1e-3f);
+    const glm::vec4 phases(phase(generator), phase(generator), phase(generator), phase(generator));
+    const uint32_t keyCount = static_cast<uint32_t>(length * 30.0f) + 1;
+    std::vector<float> times;
+    std::vector<glm::vec4> values;
+    for (uint32_t k = 0; k < keyCount; k++) {
+        const float time = static_cast<float>(k) / 30.0f;
+        const glm::vec4 wave = glm::sin(glm::vec4(time) * glm::vec4(1.0f, 1.7f, 2.3f, 0.6f) + phases);
+        glm::vec4 value;
+        switch (path) {
+        case CompiledAnimation::Path::ROTATION:
+            value = glm::normalize(wave * 0.3f + glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+            value = flip && k % 2 == 1 ? -value : value;
+            break;
+        case CompiledAnimation::Path::TRANSLATION:
+            value = glm::vec4(glm::vec3(wave) * 20.0f + glm::vec3(noise(generator), noise(generator), noise(generator)), 0.0f);
+            break;
+        case CompiledAnimation::Path::SCALE:
+            value = glm::vec4(glm::vec3(1.0f) + glm::vec3(wave) * 0.1f, 0.0f);
+            break;
+        }
+        times.push_back(time);
+        values.push_back(value);
+    }
+    clip.addTrack(path, CompiledAnimation::Interpolation::LINEAR, node, times.data(), values.data(), keyCount);
+}
+
+// ONE PATH'S TRACKS COMPRESSED WITH THE DEFAULT SETTINGS. KEYS MUST BE DROPPED, evaluate'S maxTrackError MUST AGREE WITH A SEPARATE SAMPLING OF
+// BOTH CLIPS AND STAY WITHIN THE PATH'S TOLERANCE
+static void checkBound(const std::string& name, CompiledAnimation::Path path, float tolerance, std::mt19937& generator) {
+    Test::context_ = name;
+    const float length = 4.0f;
+    CompiledAnimation source;
+    for (uint32_t node = 0; node < 6; node++) {
+        addTrack(source, path, node, length, generator, node % 2 == 1);
+    }
+    source.finalize();
+    CompiledAnimation compressed = ClipCompressor::compress(source, ClipCompressor::Settings{});
+    CHECK(compressed.size() == source.size());
+
+    const size_t frames = 997;
+    const ClipCompressor::Report report = ClipCompressor::evaluate(source, compressed, nullptr, length, frames);
+    CHECK(report.keptKeys < report.sourceKeys);
+    CHECK(report.compressedBytes < report.sourceBytes);
+    CHECK(report.maxPoseError == 0.0f);
+
+    std::vector<glm::vec4> sourcePose(source.size());
+    std::vector<glm::vec4> compressedPose(compressed.size());
+    float measured = 0.0f;
+    for (size_t frame = 0; frame <= frames; frame++) {
+        const float time = length * static_cast<float>(frame) / static_cast<float>(frames);
+        source.sample(time, sourcePose.data());
+        compressed.sample(time, compressedPose.data());
+        for (size_t t = 0; t < source.size(); t++) {
+            const glm::vec3 difference = glm::abs(glm::vec3(sourcePose[t] - compressedPose[t]));
+            measured = std::max(measured, path == CompiledAnimation::Path::ROTATION ? rotationError(sourcePose[t], compressedPose[t]) : std::max(std::max(difference.x, difference.y), difference.z));
+        }
+    }
+    CHECK(report.maxTrackError == measured);
+    CHECK(report.maxTrackError > 0.0f);
+    CHECK(report.maxTrackError <= tolerance);
+}
+
+void runClipCompressorTests() {
+    std::mt19937 generator(18);
+
+    // SMALLEST THREE: EVERY COMPONENT THE LARGEST IN TURN, EITHER SIGN, THE AXES THEMSELVES, TIES, AND RANDOM ROTATIONS. THE PACKED KEY IS 2 + 3 * 15 BITS
+    Test::context_ = "smallest three";
+    {
+        std::vector<glm::vec4> rotations;
+        for (int axis = 0; axis < 4; axis++) {
+            glm::vec4 q(0.0f);
+            q[axis] = 1.0f;
+            rotations.push_back(q);
+            rotations.push_back(-q);
+            q = glm::vec4(0.1f, -0.2f, 0.3f, -0.1f);
+            q[axis] = -0.9f;
+            rotations.push_back(glm::normalize(q));
+        }
+        rotations.push_back(glm::vec4(0.5f, 0.5f, -0.5f, 0.5f));
+        rotations.push_back(glm::normalize(glm::vec4(0.7071f, 0.7071f, 0.0f, 0.0f)));
+        for (int i = 0; i < 20000; i++) {
+            rotations.push_back(randomRotation(generator));
+        }
+
+        float maxError = 0.0f;
+        float maxStoredError = 0.0f;
+        float maxLengthError = 0.0f;
+        size_t overflow = 0;
+        size_t notLargest = 0;
+        for (const glm::vec4& q : rotations) {
+            uint16_t packed[3];
+            CompiledAnimation::packRotation(q, packed);
+            overflow += (packed[0] & 0x8000) ? 1 : 0;
+            const uint32_t largest = (packed[0] >> 13) & 3;
+            notLargest += std::abs(q[largest]) < std::max(std::max(std::abs(q.x), std::abs(q.y)), std::max(std::abs(q.z), std::abs(q.w))) ? 1 : 0;
+
+            glm::vec4 unpacked = CompiledAnimation::unpackRotation(packed);
+            maxError = std::max(maxError, rotationError(unpacked, q));
+            maxLengthError = std::max(maxLengthError, std::abs(glm::length(unpacked) - 1.0f));
+            unpacked = glm::dot(unpacked, q) < 0.0f ? -unpacked : unpacked;
+            for (uint32_t i = 0; i < 4; i++) {
+                maxStoredError = i == largest ? maxStoredError : std::max(maxStoredError, std::abs(unpacked[i] - q[i]));
+            }
+        }
+        CHECK(overflow == 0);
+        CHECK(notLargest == 0);
+        CHECK(maxStoredError <= ROTATION_STEP * 0.5f + 1e-6f);
+        CHECK(maxError <= ROTATION_QUANTIZATION);
+        CHECK(maxLengthError <= ROTATION_QUANTIZATION);
+    }
+
+    // 16 BITS PER COMPONENT: THE ENDS OF THE RANGE PACK TO 0 AND 65535, EVERYTHING IN BETWEEN WITHIN HALF A STEP, OUTSIDE IT CLAMPS TO THE ENDS, AND A
+    // COMPONENT WITH NO EXTENT IS ITS MINIMUM
+    Test::context_ = "16 bit vectors";
+    {
+        const glm::vec3 rangeMin(-30.0f, 0.5f, 100.0f);
+        const glm::vec3 rangeExtent(60.0f, 0.0009765625f, 0.0f);
+        uint16_t packed[3];
+        CompiledAnimation::packVector(glm::vec4(rangeMin, 0.0f), rangeMin, rangeExtent, packed);
+        CHECK(packed[0] == 0 && packed[1] == 0 && packed[2] == 0);
+        CHECK(glm::vec3(CompiledAnimation::unpackVector(packed, rangeMin, rangeExtent)) == rangeMin);
+
+        CompiledAnimation::packVector(glm::vec4(rangeMin + rangeExtent, 0.0f), rangeMin, rangeExtent, packed);
+        CHECK(packed[0] == 65535 && packed[1] == 65535 && packed[2] == 0);
+
+        CompiledAnimation::packVector(glm::vec4(rangeMin - 5.0f, 0.0f), rangeMin, rangeExtent, packed);
+        CHECK(packed[0] == 0 && packed[1] == 0);
+        CompiledAnimation::packVector(glm::vec4(rangeMin + rangeExtent + 5.0f, 0.0f), rangeMin, rangeExtent, packed);
+        CHECK(packed[0] == 65535 && packed[1] == 65535);
+
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        glm::vec3 maxError(0.0f);
+        for (int i = 0; i < 20000; i++) {
+            const glm::vec3 value = rangeMin + rangeExtent * glm::vec3(unit(generator), unit(generator), unit(generator));
+            CompiledAnimation::packVector(glm::vec4(value, 0.0f), rangeMin, rangeExtent, packed);
+            maxError = glm::max(maxError, glm::abs(glm::vec3(CompiledAnimation::unpackVector(packed, rangeMin, rangeExtent)) - value));
+        }
+        // HALF A STEP, AND A LITTLE FOR THE FLOAT ROUNDING OF rangeMin + packed * step
+        const glm::vec3 halfStep = rangeExtent / 65535.0f * 0.5f;
+        CHECK(maxError.x <= halfStep.x + 1e-5f);
+        CHECK(maxError.y <= halfStep.y + 1e-7f);
+        CHECK(maxError.z == 0.0f);
+    }
+
+    // THE KEYS ARE FITTED AGAINST THE SOURCE KEYS, BETWEEN THEM BOTH CLIPS ARE LINEAR, SO THE SAMPLED ERROR STAYS WITHIN THE SETTINGS PLUS
+    // WHAT THE CORRECTED NLERP ADDS ON THE ROTATIONS
+    const ClipCompressor::Settings settings;
+    checkBound("rotation bound", CompiledAnimation::Path::ROTATION, settings.rotationError + ROTATION_QUANTIZATION, generator);
+    checkBound("translation bound", CompiledAnimation::Path::TRANSLATION, settings.translationError * 1.001f, generator);
+    checkBound("scale bound", CompiledAnimation::Path::SCALE, settings.scaleError * 1.001f, generator);
+
+    // A CHAIN OF NODES MOVED BY TRANSLATION TRACKS, THE LAST NODE'S WORLD POSITION CARRIES EVERY TRACK'S ERROR, NO MORE
+    Test::context_ = "pose error";
+    {
+        const float length = 2.0f;
+        NodeHierarchy hierarchy;
+        CompiledAnimation source;
+        for (uint32_t node = 0; node < 5; node++) {
+            hierarchy.addNode(static_cast<int32_t>(node) - 1, glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f), glm::mat4(1.0f));
+            addTrack(source, CompiledAnimation::Path::TRANSLATION, node, length, generator);
+        }
+        source.finalize();
+        CompiledAnimation compressed = ClipCompressor::compress(source, ClipCompressor::Settings{});
+        const ClipCompressor::Report report = ClipCompressor::evaluate(source, compressed, &hierarchy, length, 240);
+        CHECK(report.maxPoseError > 0.0f);
+        CHECK(report.maxPoseError <= 5.0f * std::sqrt(3.0f) * report.maxTrackError * 1.001f);
+    }
+    Test::context_.clear();
+}
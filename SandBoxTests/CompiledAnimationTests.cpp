@@ -0,0 +1,206 @@
+#include "Test.h"
+#include "CompiledAnimation.h"
+#include <random>
+
+static const float ROTATION_TOLERANCE = 5e-4f; // THE CORRECTED NLERP AGAINST glm::slerp
+static const float VECTOR_TOLERANCE = 1e-5f;
+
+static glm::vec4 randomRotation(std::mt19937& generator) {
+    std::normal_distribution<float> normal;
+    return glm::normalize(glm::vec4(normal(generator), normal(generator), normal(generator), normal(generator)));
+}
+
+// keyCount UNEVENLY SPACED TIMES FROM 0 TO length
+static std::vector<float> keyTimes(uint32_t keyCount, float length, std::mt19937& generator) {
+    std::uniform_real_distribution<float> gap(0.2f, 1.0f);
+    std::vector<float> times(keyCount, 0.0f);
+    for (uint32_t k = 1; k < keyCount; k++) {
+        times[k] = times[k - 1] + gap(generator);
+    }
+    for (float& t : times) {
+        t *= keyCount > 1 ? length / times.back() : 1.0f;
+    }
+    return times;
+}
+
+// ROTATION KEYS A SMALL TURN APART, EVERY OTHER ONE NEGATED WHEN flip IS SET SO NEIGHBOURS SIT IN OPPOSITE HEMISPHERES
+static std::vector<glm::vec4> rotationKeys(uint32_t keyCount, bool flip, std::mt19937& generator) {
+    std::uniform_real_distribution<float> turn(-0.4f, 0.4f);
+    std::vector<glm::vec4> keys;
+    const glm::vec4 start = randomRotation(generator);
+    glm::quat q(start.w, start.x, start.y, start.z);
+    for (uint32_t k = 0; k < keyCount; k++) {
+        q = glm::normalize(q * glm::quat(glm::vec3(turn(generator), turn(generator), turn(generator))));
+        glm::vec4 key(q.x, q.y, q.z, q.w);
+        keys.push_back(flip && k % 2 == 1 ? -key : key);
+    }
+    return keys;
+}
+
+static std::vector<glm::vec4> vectorKeys(uint32_t keyCount, std::mt19937& generator) {
+    std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+    std::vector<glm::vec4> keys;
+    for (uint32_t k = 0; k < keyCount; k++) {
+        keys.push_back(glm::vec4(value(generator), value(generator), value(generator), 0.0f));
+    }
+    return keys;
+}
+
+// IN TANGENT, VALUE, OUT TANGENT PER KEY
+static std::vector<glm::vec4> cubicKeys(const std::vector<glm::vec4>& values, std::mt19937& generator) {
+    std::uniform_real_distribution<float> tangent(-0.5f, 0.5f);
+    std::vector<glm::vec4> keys;
+    for (const glm::vec4& v : values) {
+        keys.push_back(glm::vec4(tangent(generator), tangent(generator), tangent(generator), tangent(generator)));
+        keys.push_back(v);
+        keys.push_back(glm::vec4(tangent(generator), tangent(generator), tangent(generator), tangent(generator)));
+    }
+    return keys;
+}
+
+// q AND -q ARE THE SAME ROTATION, ONE SIGN FOR THE WHOLE QUATERNION
+static float rotationError(const glm::vec4& a, const glm::vec4& b) {
+    const glm::vec4 difference = glm::abs(a - (glm::dot(a, b) < 0.0f ? -b : b));
+    return std::max(std::max(difference.x, difference.y), std::max(difference.z, difference.w));
+}
+
+// EVERY TRACK OF clip SAMPLED THROUGH cursors AND scratch AT time AGAINST THE SCALAR sampleTrack
+static void checkSample(const CompiledAnimation& clip, float time, uint32_t* cursors, float* scratch, float& maxRotationError, float& maxVectorError) {
+    std::vector<glm::vec4> pose(clip.size());
+    clip.sample(time, pose.data(), cursors, scratch);
+    for (uint32_t t = 0; t < clip.size(); t++) {
+        const glm::vec4 reference = clip.sampleTrack(t, time);
+        if (clip.tracks_[t].path == CompiledAnimation::Path::ROTATION) {
+            maxRotationError = std::max(maxRotationError, rotationError(pose[t], reference));
+        }
+        else {
+            const glm::vec3 difference = glm::abs(glm::vec3(pose[t] - reference));
+            maxVectorError = std::max(maxVectorError, std::max(std::max(difference.x, difference.y), difference.z));
+        }
+    }
+}
+
+// FORWARD THROUGH THE CLIP TWICE AT 60 HZ, WRAPPING AT length SO THE CURSORS RESTART, THEN AT EVERY KEY TIME EXACTLY
+static void checkClip(const std::string& name, const CompiledAnimation& clip, float length) {
+    Test::context_ = name;
+    std::vector<uint32_t> cursors(clip.size(), 0);
+    std::vector<float> scratch(clip.laneScratchSize());
+    float maxRotationError = 0.0f;
+    float maxVectorError = 0.0f;
+    float time = 0.0f;
+    for (int frame = 0; frame < static_cast<int>(2.0f * length * 60.0f); frame++) {
+        checkSample(clip, time, cursors.data(), scratch.data(), maxRotationError, maxVectorError);
+        time += 1.0f / 60.0f;
+        if (time > length) {
+            time -= length;
+        }
+    }
+    std::fill(cursors.begin(), cursors.end(), 0);
+    for (float keyTime : clip.keyTimes_) {
+        checkSample(clip, keyTime, cursors.data(), scratch.data(), maxRotationError, maxVectorError);
+    }
+    checkSample(clip, length + 1.0f, cursors.data(), scratch.data(), maxRotationError, maxVectorError);
+    CHECK(maxRotationError <= ROTATION_TOLERANCE);
+    CHECK(maxVectorError <= VECTOR_TOLERANCE);
+}
+
+void runCompiledAnimationTests() {
+    std::mt19937 generator(17);
+    const float length = 3.0f;
+    using Path = CompiledAnimation::Path;
+    using Interpolation = CompiledAnimation::Interpolation;
+
+    // EVERY PATH AND INTERPOLATION, MORE THAN FOUR TRACKS IN SOME GROUPS SO THERE ARE PADDING LANES, DIFFERENT KEY COUNTS, ONE SINGLE KEY TRACK AND
+    // QUANTIZED KEYS
+    CompiledAnimation clip;
+    uint32_t node = 0;
+    for (uint32_t keyCount : { 2u, 5u, 9u, 17u, 33u, 4u }) {
+        clip.addTrack(Path::ROTATION, Interpolation::LINEAR, node++, keyTimes(keyCount, length, generator).data(), rotationKeys(keyCount, false, generator).data(), keyCount);
+    }
+    for (uint32_t keyCount : { 3u, 12u, 7u, 25u, 2u }) {
+        clip.addTrack(keyCount % 2 ? Path::TRANSLATION : Path::SCALE, Interpolation::LINEAR, node++, keyTimes(keyCount, length, generator).data(), vectorKeys(keyCount, generator).data(), keyCount);
+    }
+    for (uint32_t keyCount : { 6u, 11u, 3u }) {
+        clip.addTrack(Path::ROTATION, Interpolation::STEP, node++, keyTimes(keyCount, length, generator).data(), rotationKeys(keyCount, false, generator).data(), keyCount);
+        clip.addTrack(Path::TRANSLATION, Interpolation::STEP, node++, keyTimes(keyCount, length, generator).data(), vectorKeys(keyCount, generator).data(), keyCount);
+    }
+    for (uint32_t keyCount : { 4u, 9u, 2u }) {
+        clip.addTrack(Path::ROTATION, Interpolation::CUBICSPLINE, node++, keyTimes(keyCount, length, generator).data(), cubicKeys(rotationKeys(keyCount, false, generator), generator).data(), keyCount);
+        clip.addTrack(Path::TRANSLATION, Interpolation::CUBICSPLINE, node++, keyTimes(keyCount, length, generator).data(), cubicKeys(vectorKeys(keyCount, generator), generator).data(), keyCount);
+    }
+    clip.addTrack(Path::TRANSLATION, Interpolation::LINEAR, node++, keyTimes(1, length, generator).data(), vectorKeys(1, generator).data(), 1);
+    for (uint32_t keyCount : { 8u, 3u }) {
+        std::vector<glm::vec4> rotations = rotationKeys(keyCount, false, generator);
+        std::vector<uint16_t> packed(keyCount * 3);
+        for (uint32_t k = 0; k < keyCount; k++) {
+            CompiledAnimation::packRotation(rotations[k], packed.data() + k * 3);
+        }
+        clip.addQuantizedTrack(Path::ROTATION, Interpolation::LINEAR, node++, keyTimes(keyCount, length, generator).data(), packed.data(), keyCount, glm::vec3(0.0f), glm::vec3(0.0f));
+
+        std::vector<glm::vec4> translations = vectorKeys(keyCount, generator);
+        for (uint32_t k = 0; k < keyCount; k++) {
+            CompiledAnimation::packVector(translations[k], glm::vec3(-2.0f), glm::vec3(4.0f), packed.data() + k * 3);
+        }
+        clip.addQuantizedTrack(Path::TRANSLATION, Interpolation::STEP, node++, keyTimes(keyCount, length, generator).data(), packed.data(), keyCount, glm::vec3(-2.0f), glm::vec3(4.0f));
+    }
+    clip.finalize();
+    checkClip("linear, step and cubicspline", clip, length);
+
+    // NEIGHBOURING KEYS IN OPPOSITE HEMISPHERES. THE SAME ROTATIONS AS AN UNFLIPPED TRACK, SO sample MUST TAKE THE SHORT WAY ROUND AND MATCH IT
+    {
+        CompiledAnimation flipped;
+        CompiledAnimation unflipped;
+        for (uint32_t keyCount : { 2u, 7u, 16u, 5u, 30u }) {
+            const std::vector<float> times = keyTimes(keyCount, length, generator);
+            std::mt19937 keyGenerator = generator;
+            flipped.addTrack(Path::ROTATION, Interpolation::LINEAR, 0, times.data(), rotationKeys(keyCount, true, keyGenerator).data(), keyCount);
+            unflipped.addTrack(Path::ROTATION, Interpolation::LINEAR, 0, times.data(), rotationKeys(keyCount, false, generator).data(), keyCount);
+        }
+        flipped.finalize();
+        unflipped.finalize();
+        checkClip("hemisphere flip", flipped, length);
+
+        Test::context_ = "hemisphere flip, against the unflipped keys";
+        std::vector<glm::vec4> pose(flipped.size());
+        std::vector<glm::vec4> expected(unflipped.size());
+        float error = 0.0f;
+        for (float time = 0.0f; time < length; time += 1.0f / 60.0f) {
+            flipped.sample(time, pose.data());
+            unflipped.sample(time, expected.data());
+            for (size_t t = 0; t < pose.size(); t++) {
+                error = std::max(error, rotationError(pose[t], expected[t]));
+            }
+        }
+        CHECK(error <= ROTATION_TOLERANCE);
+    }
+
+    // q THEN -q IS NO TURN AT ALL, HALFWAY BETWEEN THEM IS STILL q (A PLAIN LERP WOULD PASS THROUGH ZERO)
+    Test::context_ = "q to -q";
+    {
+        CompiledAnimation noTurn;
+        const float times[2] = { 0.0f, 1.0f };
+        const glm::vec4 q = randomRotation(generator);
+        const glm::vec4 keys[2] = { q, -q };
+        noTurn.addTrack(Path::ROTATION, Interpolation::LINEAR, 0, times, keys, 2);
+        noTurn.finalize();
+        glm::vec4 pose;
+        noTurn.sample(0.5f, &pose);
+        CHECK(std::abs(std::abs(glm::dot(pose, q)) - 1.0f) <= ROTATION_TOLERANCE);
+    }
+
+    // TWO PLAYBACKS OF ONE CLIP WITH THEIR OWN CURSORS, ONE A SECOND BEHIND THE OTHER, STEPPED IN TURN
+    Test::context_ = "two playbacks";
+    {
+        std::vector<uint32_t> cursors[2] = { std::vector<uint32_t>(clip.size(), 0), std::vector<uint32_t>(clip.size(), 0) };
+        std::vector<float> scratch(clip.laneScratchSize());
+        float maxRotationError = 0.0f;
+        float maxVectorError = 0.0f;
+        for (float time = 1.0f; time < length; time += 1.0f / 60.0f) {
+            checkSample(clip, time, cursors[0].data(), scratch.data(), maxRotationError, maxVectorError);
+            checkSample(clip, time - 1.0f, cursors[1].data(), scratch.data(), maxRotationError, maxVectorError);
+        }
+        CHECK(maxRotationError <= ROTATION_TOLERANCE);
+        CHECK(maxVectorError <= VECTOR_TOLERANCE);
+    }
+    Test::context_.clear();
+}
@@ -0,0 +1,154 @@
+#include "Test.h"
+#include "DualQuaternionSkinning.h"
+#include <glm/gtc/constants.hpp>
+
+static const float POSITION_TOLERANCE = 1e-4f; // RELATIVE TO THE DISTANCE FROM THE ORIGIN, SO THE 100x RIG GETS THE SAME PRECISION
+static const float DIRECTION_TOLERANCE = 1e-4f;
+
+static glm::mat4 rigid(float degrees, const glm::vec3& axis, const glm::vec3& translation) {
+    glm::mat4 m = glm::mat4_cast(glm::angleAxis(glm::radians(degrees), glm::normalize(axis)));
+    m[3] = glm::vec4(translation, 1.0f);
+    return m;
+}
+
+// A 4x4x4 LATTICE OVER [-1, 1], EVERY VERTEX ON ALL FOUR JOINTS WITH UNEVEN WEIGHTS
+static std::vector<Vertex> makeVertices() {
+    std::vector<Vertex> vertices;
+    for (int x = 0; x < 4; x++) {
+        for (int y = 0; y < 4; y++) {
+            for (int z = 0; z < 4; z++) {
+                Vertex v{};
+                glm::vec3 p = glm::vec3(x, y, z) * (2.0f / 3.0f) - 1.0f;
+                v.pos = glm::vec4(p, 0.0f);
+                v.normal = glm::vec4(glm::normalize(glm::vec3(1.0f + x, -2.0f + y, 0.5f + z)), 0.0f);
+                v.tangent = glm::vec4(glm::normalize(glm::vec3(-0.5f + z, 1.0f + x, 2.0f - y)), 1.0f);
+                glm::vec4 weights(1.0f + x, 1.0f + y, 1.0f + z, 1.0f + ((x + y + z) % 3));
+                v.jointIndices = glm::vec4(0.0f, 1.0f, 2.0f, 3.0f);
+                v.jointWeights = weights / (weights.x + weights.y + weights.z + weights.w);
+                vertices.push_back(v);
+            }
+        }
+    }
+    return vertices;
+}
+
+// EVERY POSE CHECKED HERE IS ONE WHERE BOTH BLENDS ARE EXACT, SO THE LINEAR RESULT IS THE EXPECTED ONE
+static void checkPose(const std::string& name, const std::vector<glm::mat4>& matrices, const std::vector<Vertex>& vertices) {
+    Test::context_ = name;
+    std::vector<DualQuaternionSkinning::DualQuat> palette(matrices.size());
+    DualQuaternionSkinning::fromMatrices(matrices.data(), matrices.size(), palette.data());
+    const float bindScale = DualQuaternionSkinning::uniformScale(matrices.data(), matrices.size());
+
+    float maxPositionError = 0.0f;
+    float maxDirectionError = 0.0f;
+    for (const Vertex& v : vertices) {
+        glm::vec3 position, normal, tangent;
+        glm::vec3 expectedPosition, expectedNormal, expectedTangent;
+        DualQuaternionSkinning::skinVertex(palette.data(), bindScale, v, position, normal, tangent);
+        DualQuaternionSkinning::skinVertexLinear(matrices.data(), v, expectedPosition, expectedNormal, expectedTangent);
+        maxPositionError = std::max(maxPositionError, glm::length(position - expectedPosition) / (1.0f + glm::length(expectedPosition)));
+        maxDirectionError = std::max(maxDirectionError, std::max(glm::length(normal - expectedNormal), glm::length(tangent - expectedTangent)));
+    }
+    CHECK(maxPositionError <= POSITION_TOLERANCE);
+    CHECK(maxDirectionError <= DIRECTION_TOLERANCE);
+}
+
+void runDualQuaternionSkinningTests() {
+    const std::vector<glm::mat4> poses = {
+        rigid(30.0f, glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3(0.5f, -1.0f, 2.0f)),
+        rigid(90.0f, glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(-1.0f, 0.25f, 0.0f)),
+        rigid(135.0f, glm::vec3(0.0f, 1.0f, 1.0f), glm::vec3(0.0f, 2.0f, -0.5f)),
+        rigid(170.0f, glm::vec3(1.0f, -2.0f, 0.5f), glm::vec3(1.5f, 1.5f, 1.5f)),
+    };
+    const std::vector<Vertex> vertices = makeVertices();
+
+    // ONE JOINT'S DUAL QUATERNION MOVES A POINT EXACTLY AS ITS MATRIX DOES
+    Test::context_ = "single joint";
+    for (const glm::mat4& pose : poses) {
+        DualQuaternionSkinning::DualQuat dq = DualQuaternionSkinning::fromMatrix(pose);
+        for (const Vertex& v : vertices) {
+            glm::vec3 expected = glm::vec3(pose * glm::vec4(glm::vec3(v.pos), 1.0f));
+            CHECK(glm::length(DualQuaternionSkinning::transformPoint(dq, glm::vec3(v.pos)) - expected) <= POSITION_TOLERANCE * (1.0f + glm::length(expected)));
+            CHECK(glm::length(DualQuaternionSkinning::transformVector(dq, glm::vec3(v.normal)) - glm::mat3(pose) * glm::vec3(v.normal)) <= DIRECTION_TOLERANCE);
+        }
+    }
+
+    checkPose("identity", std::vector<glm::mat4>(4, glm::mat4(1.0f)), vertices);
+
+    std::vector<Vertex> single = vertices;
+    for (size_t i = 0; i < single.size(); i++) {
+        single[i].jointIndices = glm::vec4(static_cast<float>(i % 4), 0.0f, 0.0f, 0.0f);
+        single[i].jointWeights = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+    }
+    checkPose("one rigid joint per vertex", poses, single);
+
+    // A CENTIMETRE RIG UNDER A 0.01 ARMATURE, THE JOINT MATRICES CARRY A UNIFORM 100x SCALE
+    std::vector<glm::mat4> scaled = poses;
+    for (glm::mat4& m : scaled) {
+        m = m * glm::mat4(glm::mat3(100.0f));
+    }
+    Test::context_ = "bind scale";
+    CHECK(std::abs(DualQuaternionSkinning::uniformScale(scaled.data(), scaled.size()) - 100.0f) <= 100.0f * 1e-5f);
+    checkPose("one rigid joint per vertex, 100x bind scale", scaled, single);
+
+    checkPose("every influence the same transform", std::vector<glm::mat4>(4, poses[3]), vertices);
+
+    std::vector<glm::mat4> translations(4, glm::mat4(1.0f));
+    translations[0][3] = glm::vec4(0.5f, -1.0f, 2.0f, 1.0f);
+    translations[1][3] = glm::vec4(-1.0f, 0.25f, 0.0f, 1.0f);
+    translations[2][3] = glm::vec4(0.0f, 2.0f, -0.5f, 1.0f);
+    translations[3][3] = glm::vec4(1.5f, 1.5f, 1.5f, 1.0f);
+    checkPose("pure translations", translations, vertices);
+
+    // q AND -q ARE THE SAME ROTATION, SO NEGATING ONE INFLUENCE MUST NOT CHANGE THE BLEND. WITHOUT THE HEMISPHERE FLIP IT WOULD TAKE THE LONG WAY ROUND
+    Test::context_ = "negated influence";
+    {
+        DualQuaternionSkinning::DualQuat palette[2];
+        DualQuaternionSkinning::DualQuat negated[2];
+        DualQuaternionSkinning::fromMatrices(poses.data(), 2, palette);
+        negated[0] = palette[0];
+        negated[1].real = -palette[1].real;
+        negated[1].dual = -palette[1].dual;
+        const glm::vec4 weights(0.6f, 0.4f, 0.0f, 0.0f);
+        DualQuaternionSkinning::DualQuat dq = DualQuaternionSkinning::blend(palette, glm::uvec4(0, 1, 0, 0), weights);
+        DualQuaternionSkinning::DualQuat dqNegated = DualQuaternionSkinning::blend(negated, glm::uvec4(0, 1, 0, 0), weights);
+        for (const Vertex& v : vertices) {
+            glm::vec3 expected = DualQuaternionSkinning::transformPoint(dq, glm::vec3(v.pos));
+            CHECK(glm::length(DualQuaternionSkinning::transformPoint(dqNegated, glm::vec3(v.pos)) - expected) <= POSITION_TOLERANCE * (1.0f + glm::length(expected)));
+        }
+        // THE SAME WITH THE NEGATED INFLUENCE FIRST, WHICH SETS THE HEMISPHERE
+        std::swap(negated[0], negated[1]);
+        dqNegated = DualQuaternionSkinning::blend(negated, glm::uvec4(1, 0, 0, 0), weights);
+        for (const Vertex& v : vertices) {
+            glm::vec3 expected = DualQuaternionSkinning::transformPoint(dq, glm::vec3(v.pos));
+            CHECK(glm::length(DualQuaternionSkinning::transformPoint(dqNegated, glm::vec3(v.pos)) - expected) <= POSITION_TOLERANCE * (1.0f + glm::length(expected)));
+        }
+    }
+
+    // TWO JOINTS TWISTED 180 DEGREES APART ABOUT x, A POINT 1 FROM THE AXIS WEIGHTED HALF AND HALF. THE LINEAR BLEND COLLAPSES IT ONTO THE AXIS,
+    // THE DUAL QUATERNION BLEND TURNS IT 90 DEGREES AND KEEPS ITS RADIUS
+    Test::context_ = "180 degree twist";
+    {
+        Vertex twist{};
+        twist.pos = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+        twist.normal = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+        twist.tangent = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+        twist.jointIndices = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+        twist.jointWeights = glm::vec4(0.5f, 0.5f, 0.0f, 0.0f);
+        const glm::mat4 matrices[2] = { glm::mat4(1.0f), glm::mat4_cast(glm::angleAxis(glm::pi<float>(), glm::vec3(1.0f, 0.0f, 0.0f))) };
+        DualQuaternionSkinning::DualQuat palette[2];
+        DualQuaternionSkinning::fromMatrices(matrices, 2, palette);
+
+        glm::vec3 position, normal, tangent;
+        DualQuaternionSkinning::skinVertexLinear(matrices, twist, position, normal, tangent);
+        CHECK(glm::length(glm::vec2(position.y, position.z)) <= POSITION_TOLERANCE);
+
+        DualQuaternionSkinning::skinVertex(palette, 1.0f, twist, position, normal, tangent);
+        CHECK(std::abs(glm::length(glm::vec2(position.y, position.z)) - 1.0f) <= POSITION_TOLERANCE);
+        CHECK(std::abs(position.x) <= POSITION_TOLERANCE);
+        CHECK(std::abs(position.y) <= POSITION_TOLERANCE);
+        CHECK(std::abs(glm::length(normal) - 1.0f) <= DIRECTION_TOLERANCE);
+        CHECK(glm::length(tangent - glm::vec3(1.0f, 0.0f, 0.0f)) <= DIRECTION_TOLERANCE);
+    }
+    Test::context_.clear();
+}
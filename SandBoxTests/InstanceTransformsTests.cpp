@@ -0,0 +1,119 @@
+#include "Test.h"
+#include "InstanceTransforms.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+static const uint32_t FRAMES_IN_FLIGHT = 3;
+
+struct TestObject {
+    glm::mat4 localModelTransform = glm::mat4(1.0f);
+    bool dirty = true;
+};
+
+// A SCENE OF objects, EACH DRAW i BELONGING TO objects[owners[i]] WITH ITS OWN NODE TRANSFORM, AND ONE MAPPED BUFFER PER FRAME IN FLIGHT FILLED
+// WITH THE WHOLE TABLE AS THE RENDERER DOES WHEN IT CREATES THEM
+struct TestScene {
+    std::vector<TestObject> objects;
+    std::vector<uint32_t> owners;
+    std::vector<glm::mat4> nodes;
+    InstanceTransforms table;
+    std::vector<std::vector<glm::mat4>> buffers;
+
+    TestScene(size_t numObjects, const std::vector<uint32_t>& drawOwners) : objects(numObjects), owners(drawOwners) {
+        for (size_t o = 0; o < objects.size(); o++) {
+            objects[o].localModelTransform = glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(o), 0.0f, 2.0f));
+        }
+        for (size_t i = 0; i < owners.size(); i++) {
+            nodes.push_back(glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, static_cast<float>(i), 0.0f)), 0.1f * i, glm::vec3(0.0f, 0.0f, 1.0f)));
+            table.addDraw(&objects[owners[i]].localModelTransform, &objects[owners[i]].dirty, nodes[i]);
+        }
+        buffers.assign(FRAMES_IN_FLIGHT, table.matrices_);
+        for (TestObject& object : objects) {
+            object.dirty = false;
+        }
+    }
+
+    void move(uint32_t object) {
+        objects[object].localModelTransform = glm::rotate(objects[object].localModelTransform, 0.25f, glm::vec3(0.0f, 1.0f, 0.0f));
+        objects[object].dirty = true;
+    }
+
+    // ONE FRAME'S update, THEN THE BUFFER IT WROTE AGAINST A DIRECT RECOMPUTE OF EVERY DRAW. RETURNS HOW MANY MATRICES IT COPIED
+    size_t update(uint32_t frame) {
+        const uint32_t frameIndex = frame % FRAMES_IN_FLIGHT;
+        size_t copied = table.update(frameIndex, FRAMES_IN_FLIGHT, buffers[frameIndex].data());
+        size_t mismatches = 0;
+        for (size_t i = 0; i < owners.size(); i++) {
+            if (buffers[frameIndex][i] != objects[owners[i]].localModelTransform * nodes[i]) {
+                mismatches++;
+            }
+        }
+        size_t stillDirty = 0;
+        for (const TestObject& object : objects) {
+            stillDirty += object.dirty ? 1 : 0;
+        }
+        CHECK(mismatches == 0);
+        CHECK(stillDirty == 0);
+        return copied;
+    }
+};
+
+void runInstanceTransformsTests() {
+    // THREE DRAWS PER OBJECT IN ORDER, ONE RANGE EACH
+    {
+        std::vector<uint32_t> owners;
+        for (uint32_t o = 0; o < 20; o++) {
+            owners.insert(owners.end(), { o, o, o });
+        }
+        TestScene scene(20, owners);
+
+        Test::context_ = "still";
+        uint32_t frame = 0;
+        for (; frame < 2 * FRAMES_IN_FLIGHT; frame++) {
+            CHECK(scene.update(frame) == 0);
+        }
+
+        // A MOVED OBJECT'S DRAWS GO TO EACH FRAME'S BUFFER ONCE, THEN NOTHING IS COPIED AGAIN
+        Test::context_ = "one moved";
+        scene.move(7);
+        for (uint32_t i = 0; i < FRAMES_IN_FLIGHT; i++, frame++) {
+            CHECK(scene.update(frame) == 3);
+        }
+        CHECK(scene.update(frame++) == 0);
+
+        // MOVING AGAIN BEFORE EVERY BUFFER HAS CAUGHT UP, THE BUFFERS THAT MISSED THE FIRST MOVE GET THE SECOND
+        Test::context_ = "moved twice";
+        scene.move(3);
+        CHECK(scene.update(frame++) == 3);
+        scene.move(3);
+        for (uint32_t i = 0; i < FRAMES_IN_FLIGHT; i++, frame++) {
+            CHECK(scene.update(frame) == 3);
+        }
+        CHECK(scene.update(frame++) == 0);
+
+        Test::context_ = "every frame";
+        for (uint32_t i = 0; i < 50; i++, frame++) {
+            for (uint32_t o = i % 4; o < 20; o += 4) {
+                scene.move(o);
+            }
+            scene.update(frame);
+        }
+    }
+
+    // A MERGED BATCH SPLITS OBJECT 0'S DRAWS INTO TWO RANGES THAT SHARE ONE FLAG, BOTH MUST BE RECOMPUTED BEFORE IT IS CLEARED
+    Test::context_ = "split ranges";
+    {
+        TestScene scene(3, { 0, 0, 1, 2, 0, 1 });
+        uint32_t frame = 0;
+        for (; frame < FRAMES_IN_FLIGHT; frame++) {
+            CHECK(scene.update(frame) == 0);
+        }
+        scene.move(0);
+        for (uint32_t i = 0; i < FRAMES_IN_FLIGHT; i++, frame++) {
+            CHECK(scene.update(frame) == 3);
+        }
+        scene.move(1);
+        scene.move(2);
+        CHECK(scene.update(frame++) == 3);
+    }
+    Test::context_.clear();
+}
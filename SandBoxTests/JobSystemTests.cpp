@@ -0,0 +1,138 @@
+#include "Test.h"
+#include "JobSystem.h"
+#include <vector>
+#include <algorithm>
+
+// EVERY INDEX IN [0, count) VISITED EXACTLY ONCE, IN RANGES NO LONGER THAN grain UNLESS IT ALL RAN INLINE
+static void checkCoverage(JobSystem& jobs, size_t count, size_t grain) {
+    std::vector<std::atomic<uint32_t>> visits(count);
+    std::atomic<size_t> oversized{ 0 };
+    const size_t longest = jobs.activeWorkers() == 0 ? count : std::max<size_t>(grain, 1);
+    auto body = [&](size_t begin, size_t end) {
+        if (end - begin > longest && end - begin != count) {
+            oversized++;
+        }
+        for (size_t i = begin; i < end; i++) {
+            visits[i]++;
+        }
+    };
+    jobs.parallelFor(count, grain, body);
+
+    size_t wrong = 0;
+    for (const std::atomic<uint32_t>& v : visits) {
+        wrong += v.load() != 1 ? 1 : 0;
+    }
+    CHECK(wrong == 0);
+    CHECK(oversized == 0);
+}
+
+void runJobSystemTests() {
+    JobSystem jobs(3);
+    Test::context_ = "worker count";
+    CHECK(jobs.workerCount() == 3);
+    CHECK(jobs.activeWorkers() == 3);
+
+    Test::context_ = "coverage";
+    const size_t counts[] = { 0, 1, 7, 64, 1000, 100003 };
+    const size_t grains[] = { 0, 1, 16, 4096 };
+    for (size_t count : counts) {
+        for (size_t grain : grains) {
+            checkCoverage(jobs, count, grain);
+        }
+    }
+
+    // MANY SMALL DISPATCHES BACK TO BACK, THE WAY A FRAME USES IT
+    Test::context_ = "repeated";
+    {
+        std::atomic<size_t> total{ 0 };
+        auto body = [&](size_t begin, size_t end) { total += end - begin; };
+        for (int frame = 0; frame < 2000; frame++) {
+            jobs.parallelFor(37, 2, body);
+        }
+        CHECK(total == 2000 * 37);
+    }
+
+    // setActiveWorkers CLAMPS TO THE WORKERS THERE ARE, 0 KEEPS EVERY RANGE ON THE CALLING THREAD
+    Test::context_ = "active workers";
+    jobs.setActiveWorkers(100);
+    CHECK(jobs.activeWorkers() == 3);
+    jobs.setActiveWorkers(0);
+    CHECK(jobs.activeWorkers() == 0);
+    {
+        const std::thread::id caller = std::this_thread::get_id();
+        std::atomic<size_t> elsewhere{ 0 };
+        auto body = [&](size_t begin, size_t end) { elsewhere += std::this_thread::get_id() != caller ? 1 : 0; };
+        jobs.parallelFor(1000, 1, body);
+        CHECK(elsewhere == 0);
+    }
+    jobs.setActiveWorkers(1);
+    checkCoverage(jobs, 1000, 3);
+
+    // CHANGING THE ACTIVE COUNT FROM ANOTHER THREAD WHILE THE CALLER DISPATCHES MUST NOT LOSE A RANGE OR HANG
+    Test::context_ = "active workers changed concurrently";
+    {
+        std::atomic<bool> stop{ false };
+        std::thread toggler([&] {
+            for (uint32_t i = 0; !stop; i++) {
+                jobs.setActiveWorkers(i % 4);
+            }
+        });
+        std::atomic<size_t> total{ 0 };
+        auto body = [&](size_t begin, size_t end) { total += end - begin; };
+        for (int frame = 0; frame < 2000; frame++) {
+            jobs.parallelFor(50, 1, body);
+        }
+        stop = true;
+        toggler.join();
+        CHECK(total == 2000 * 50);
+    }
+    jobs.setActiveWorkers(3);
+
+    // A BODY THAT DISPATCHES AGAIN, THREE DEEP, AS A MODEL LOAD DOES (MODELS -> PRIMITIVES -> WELD SHARDS). EVERY LEAF ONCE, NO NEW THREADS
+    Test::context_ = "nested";
+    {
+        const size_t outer = 16, middle = 8, inner = 1000;
+        std::vector<std::atomic<uint32_t>> visits(outer * middle * inner);
+        auto outerBody = [&](size_t outerBegin, size_t outerEnd) {
+            for (size_t o = outerBegin; o < outerEnd; o++) {
+                auto middleBody = [&](size_t middleBegin, size_t middleEnd) {
+                    for (size_t m = middleBegin; m < middleEnd; m++) {
+                        auto innerBody = [&](size_t begin, size_t end) {
+                            for (size_t i = begin; i < end; i++) {
+                                visits[(o * middle + m) * inner + i]++;
+                            }
+                        };
+                        jobs.parallelFor(inner, 7, innerBody);
+                    }
+                };
+                jobs.parallelFor(middle, 1, middleBody);
+            }
+        };
+        jobs.parallelFor(outer, 1, outerBody);
+        size_t wrong = 0;
+        for (const std::atomic<uint32_t>& v : visits) {
+            wrong += v.load() != 1 ? 1 : 0;
+        }
+        CHECK(wrong == 0);
+    }
+
+    // SEVERAL THREADS OUTSIDE THE POOL DISPATCHING AT ONCE
+    Test::context_ = "concurrent callers";
+    {
+        std::atomic<size_t> total{ 0 };
+        std::vector<std::thread> callers;
+        for (int c = 0; c < 4; c++) {
+            callers.emplace_back([&] {
+                auto body = [&](size_t begin, size_t end) { total += end - begin; };
+                for (int frame = 0; frame < 500; frame++) {
+                    jobs.parallelFor(100, 3, body);
+                }
+            });
+        }
+        for (std::thread& caller : callers) {
+            caller.join();
+        }
+        CHECK(total == 4 * 500 * 100);
+    }
+    Test::context_.clear();
+}
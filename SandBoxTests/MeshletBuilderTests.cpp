@@ -0,0 +1,221 @@
+#include "Test.h"
+#include "MeshletBuilder.h"
+#include <random>
+#include <glm/gtc/constants.hpp>
+
+static Vertex makeVertex(const glm::vec3& pos) {
+    Vertex v{};
+    v.pos = glm::vec4(pos, 0.0f);
+    return v;
+}
+
+// CCW SEEN FROM OUTSIDE, SO EVERY TRIANGLE FACES AWAY FROM THE CENTRE
+static void makeSphere(uint32_t rings, uint32_t segments, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    for (uint32_t r = 0; r <= rings; r++) {
+        const float theta = glm::pi<float>() * static_cast<float>(r) / static_cast<float>(rings);
+        for (uint32_t s = 0; s <= segments; s++) {
+            const float phi = glm::two_pi<float>() * static_cast<float>(s) / static_cast<float>(segments);
+            vertices.push_back(makeVertex(glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), -std::sin(theta) * std::sin(phi))));
+        }
+    }
+    for (uint32_t r = 0; r < rings; r++) {
+        for (uint32_t s = 0; s < segments; s++) {
+            const uint32_t a = r * (segments + 1) + s;
+            const uint32_t b = a + segments + 1;
+            indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+        }
+    }
+}
+
+// THE y = 0 PLANE, FACING +y
+static void makeGrid(uint32_t size, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    for (uint32_t z = 0; z <= size; z++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            vertices.push_back(makeVertex(glm::vec3(static_cast<float>(x), 0.0f, static_cast<float>(z))));
+        }
+    }
+    for (uint32_t z = 0; z < size; z++) {
+        for (uint32_t x = 0; x < size; x++) {
+            const uint32_t a = z * (size + 1) + x;
+            const uint32_t b = a + size + 1;
+            indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+        }
+    }
+}
+
+// CHECKS THE BUILT MESHLETS OF ONE PRIMITIVE: THE VERTEX/TRIANGLE LIMITS, THE PRIMITIVE'S TRIANGLES COVERED EXACTLY ONCE AND IN ORDER, EVERY VERTEX
+// INSIDE ITS SPHERE, AND NO TRIANGLE THAT FACES A SAMPLE CAMERA IN A CLUSTER THE CONE TEST REJECTS FROM THAT CAMERA
+static std::vector<Meshlet> checkMeshlets(const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+    Test::context_ = name;
+    std::vector<Meshlet> meshlets = MeshletBuilder::build(vertices, indices);
+    const uint32_t triangleIndices = static_cast<uint32_t>(indices.size() - indices.size() % 3);
+    CHECK(meshlets.empty() == (triangleIndices == 0));
+
+    // EVERYTHING IS TESTED IN THE PRIMITIVE'S OWN SPACE WITH PLANES THAT ACCEPT ANY SPHERE, SO ONLY THE CONE CAN REJECT
+    const glm::mat4 identity = glm::mat4(1.0f);
+    glm::vec4 openPlanes[6];
+    for (int i = 0; i < 6; i++) {
+        openPlanes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+    std::vector<glm::vec3> directions;
+    for (int x = -1; x <= 1; x++) {
+        for (int y = -1; y <= 1; y++) {
+            for (int z = -1; z <= 1; z++) {
+                if (x != 0 || y != 0 || z != 0) {
+                    directions.push_back(glm::normalize(glm::vec3(x, y, z)));
+                }
+            }
+        }
+    }
+    const float distances[] = { 1.01f, 2.0f, 8.0f, 100.0f };
+
+    std::vector<uint32_t> stamp(vertices.size(), UINT32_MAX);
+    uint32_t expectedFirst = 0;
+    size_t boundsErrors = 0;
+    size_t coneErrors = 0;
+    for (uint32_t m = 0; m < meshlets.size(); m++) {
+        const Meshlet& meshlet = meshlets[m];
+        const uint32_t first = meshlet.firstIndex;
+        const uint32_t last = first + meshlet.triangleCount * 3;
+
+        // CONTIGUOUS RANGES STARTING WHERE THE LAST ONE ENDED KEEP THE TRIANGLES AND THEIR ORDER EXACTLY AS THE INDEX BUFFER HAS THEM
+        CHECK(first == expectedFirst);
+        CHECK(meshlet.triangleCount > 0 && meshlet.triangleCount <= MeshletBuilder::MAX_TRIANGLES);
+        CHECK(last <= triangleIndices);
+        expectedFirst = last;
+        if (first >= triangleIndices || last > triangleIndices) {
+            continue;
+        }
+
+        uint32_t unique = 0;
+        for (uint32_t i = first; i < last; i++) {
+            if (stamp[indices[i]] != m) {
+                stamp[indices[i]] = m;
+                unique++;
+            }
+        }
+        CHECK(unique == meshlet.vertexCount);
+        CHECK(unique <= MeshletBuilder::MAX_VERTICES);
+
+        const glm::vec3 center = glm::vec3(meshlet.sphere);
+        const float radius = meshlet.sphere.w;
+        for (uint32_t i = first; i < last; i++) {
+            if (glm::length(glm::vec3(vertices[indices[i]].pos) - center) > radius * 1.0001f + 1e-6f) {
+                boundsErrors++;
+                break;
+            }
+        }
+
+        if (meshlet.cone.w >= 1.0f) {
+            continue;
+        }
+
+        // CAMERAS AROUND THE SPHERE AND ALONG THE CONE AXIS. A REJECTED CLUSTER MUST NOT HOLD A TRIANGLE THE CAMERA SEES THE FRONT OF
+        std::vector<glm::vec3> cameras;
+        const float reach = std::max(radius, 1e-3f);
+        for (float d : distances) {
+            for (const glm::vec3& dir : directions) {
+                cameras.push_back(center + dir * reach * d);
+            }
+            cameras.push_back(center + glm::vec3(meshlet.cone) * reach * d);
+            cameras.push_back(center - glm::vec3(meshlet.cone) * reach * d);
+        }
+        for (const glm::vec3& camera : cameras) {
+            if (MeshletBuilder::clusterVisible(meshlet, identity, openPlanes, camera)) {
+                continue;
+            }
+            for (uint32_t i = first; i < last; i += 3) {
+                glm::vec3 p0 = glm::vec3(vertices[indices[i + 0]].pos);
+                glm::vec3 p1 = glm::vec3(vertices[indices[i + 1]].pos);
+                glm::vec3 p2 = glm::vec3(vertices[indices[i + 2]].pos);
+                glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                glm::vec3 toTriangle = p0 - camera;
+                if (glm::dot(toTriangle, normal) < -1e-4f * glm::length(toTriangle) * glm::length(normal)) {
+                    coneErrors++;
+                    break;
+                }
+            }
+        }
+    }
+    CHECK(expectedFirst == triangleIndices);
+    CHECK(boundsErrors == 0);
+    CHECK(coneErrors == 0);
+    return meshlets;
+}
+
+void runMeshletBuilderTests() {
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        makeSphere(32, 64, vertices, indices);
+        std::vector<Meshlet> meshlets = checkMeshlets("sphere", vertices, indices);
+        // A CLOSED SURFACE CUT INTO SMALL PATCHES, MOST OF THEM NARROW ENOUGH TO CULL BY CONE
+        size_t cones = 0;
+        for (const Meshlet& meshlet : meshlets) {
+            cones += meshlet.cone.w < 1.0f;
+        }
+        CHECK(cones * 2 > meshlets.size());
+    }
+
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        makeGrid(40, vertices, indices);
+        std::vector<Meshlet> meshlets = checkMeshlets("grid", vertices, indices);
+        for (const Meshlet& meshlet : meshlets) {
+            CHECK(meshlet.cone.w < 1e-3f);
+            CHECK(glm::dot(glm::vec3(meshlet.cone), glm::vec3(0.0f, 1.0f, 0.0f)) > 0.999f);
+        }
+    }
+
+    // DISJOINT TRIANGLES, THE VERTEX LIMIT CUTS EVERY MESHLET BUT THE LAST AT 64 / 3 TRIANGLES
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        for (uint32_t i = 0; i < 3000 * 3; i++) {
+            vertices.push_back(makeVertex(glm::vec3(unit(generator), unit(generator), unit(generator)) * 10.0f));
+            indices.push_back(i);
+        }
+        std::vector<Meshlet> meshlets = checkMeshlets("triangle soup", vertices, indices);
+        for (size_t m = 0; m + 1 < meshlets.size(); m++) {
+            CHECK(meshlets[m].triangleCount == MeshletBuilder::MAX_VERTICES / 3);
+        }
+    }
+
+    // EIGHT VERTICES, THE TRIANGLE LIMIT CUTS EVERY MESHLET BUT THE LAST AT 124 TRIANGLES
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        for (uint32_t i = 0; i < 8; i++) {
+            vertices.push_back(makeVertex(glm::vec3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f)));
+        }
+        std::uniform_int_distribution<uint32_t> corner(0, 7);
+        for (uint32_t i = 0; i < 1000 * 3; i++) {
+            indices.push_back(corner(generator));
+        }
+        std::vector<Meshlet> meshlets = checkMeshlets("shared vertices", vertices, indices);
+        CHECK(meshlets.size() == (1000 + MeshletBuilder::MAX_TRIANGLES - 1) / MeshletBuilder::MAX_TRIANGLES);
+        for (size_t m = 0; m + 1 < meshlets.size(); m++) {
+            CHECK(meshlets[m].triangleCount == MeshletBuilder::MAX_TRIANGLES);
+        }
+    }
+
+    // ZERO AREA TRIANGLES AND A TRAILING PARTIAL TRIANGLE, WHICH NO DRAW EVER READS
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        makeGrid(4, vertices, indices);
+        indices.insert(indices.end(), { 0, 0, 0, 1, 1, 2, 3, 4 });
+        checkMeshlets("degenerate", vertices, indices);
+    }
+
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        checkMeshlets("empty", vertices, indices);
+    }
+    Test::context_.clear();
+}
@@ -0,0 +1,128 @@
+#include "Test.h"
+#include "NodeHierarchy.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+static const float TOLERANCE = 1e-4f; // RELATIVE, THE FLAT PASS AND THE PARENT WALK MULTIPLY IN A DIFFERENT ORDER
+
+// THE OLD getNodeMatrix: EVERY ANCESTOR'S MATRIX REBUILT FROM ITS TRS ON THE WAY UP TO THE ROOT
+static glm::mat4 parentWalk(const NodeHierarchy& hierarchy, uint32_t node) {
+    auto animatedMatrix = [&](uint32_t n) {
+        return glm::translate(glm::mat4(1.0f), hierarchy.translations_[n]) * glm::mat4_cast(hierarchy.rotations_[n]) * glm::scale(glm::mat4(1.0f), hierarchy.scales_[n]) * hierarchy.matrices_[n];
+    };
+    glm::mat4 nodeMatrix = animatedMatrix(node);
+    for (int32_t parent = hierarchy.parents_[node]; parent >= 0; parent = hierarchy.parents_[parent]) {
+        nodeMatrix = animatedMatrix(parent) * nodeMatrix;
+    }
+    return nodeMatrix;
+}
+
+static float relativeError(const glm::mat4& a, const glm::mat4& b) {
+    float error = 0.0f;
+    for (int c = 0; c < 4; c++) {
+        for (int r = 0; r < 4; r++) {
+            error = std::max(error, std::abs(a[c][r] - b[c][r]) / (1.0f + std::abs(b[c][r])));
+        }
+    }
+    return error;
+}
+
+// EVERY NODE'S WORLD MATRIX AGAINST THE PARENT WALK
+static void checkWorldMatrices(const std::string& name, const NodeHierarchy& hierarchy) {
+    Test::context_ = name;
+    float error = 0.0f;
+    for (uint32_t n = 0; n < hierarchy.size(); n++) {
+        error = std::max(error, relativeError(hierarchy.worldMatrices_[n], parentWalk(hierarchy, n)));
+    }
+    CHECK(error <= TOLERANCE);
+}
+
+static void randomTRS(std::mt19937& generator, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale) {
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> angle(-3.0f, 3.0f);
+    std::uniform_real_distribution<float> size(0.8f, 1.25f);
+    translation = glm::vec3(offset(generator), offset(generator), offset(generator));
+    rotation = glm::quat(glm::vec3(angle(generator), angle(generator), angle(generator)));
+    scale = glm::vec3(size(generator), size(generator), size(generator));
+}
+
+void runNodeHierarchyTests() {
+    std::mt19937 generator(16);
+
+    // A FOREST OF THREE ROOTS: A 40 DEEP CHAIN (A SPINE AND ARM), THEN NODES HUNG OFF RANDOM EARLIER ONES, A FEW CARRYING A glTF matrix AS WELL
+    NodeHierarchy hierarchy;
+    {
+        glm::vec3 translation, scale;
+        glm::quat rotation;
+        for (uint32_t n = 0; n < 300; n++) {
+            randomTRS(generator, translation, rotation, scale);
+            int32_t parent = -1;
+            if (n > 0 && n < 40) {
+                parent = static_cast<int32_t>(n) - 1;
+            }
+            else if (n != 0 && n != 40 && n != 41) {
+                parent = std::uniform_int_distribution<int32_t>(0, static_cast<int32_t>(n) - 1)(generator);
+            }
+            glm::mat4 matrix(1.0f);
+            if (n % 7 == 3) {
+                randomTRS(generator, translation, rotation, scale);
+                matrix = glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation);
+            }
+            hierarchy.addNode(parent, translation, rotation, scale, matrix);
+        }
+    }
+
+    // localMatrix BUILDS T * R * S IN PLACE
+    Test::context_ = "local matrix";
+    {
+        float error = 0.0f;
+        for (uint32_t n = 0; n < hierarchy.size(); n++) {
+            const glm::mat4 expected = glm::translate(glm::mat4(1.0f), hierarchy.translations_[n]) * glm::mat4_cast(hierarchy.rotations_[n]) * glm::scale(glm::mat4(1.0f), hierarchy.scales_[n]) * hierarchy.matrices_[n];
+            error = std::max(error, relativeError(hierarchy.localMatrix(n), expected));
+        }
+        CHECK(error <= TOLERANCE);
+    }
+
+    hierarchy.updateWorldMatrices();
+    checkWorldMatrices("rest pose", hierarchy);
+
+    // A NEW POSE ON EVERY NODE, AS AN ANIMATION CHANNEL WRITES IT
+    for (uint32_t n = 0; n < hierarchy.size(); n++) {
+        glm::vec3 scale;
+        randomTRS(generator, hierarchy.translations_[n], hierarchy.rotations_[n], scale);
+    }
+    hierarchy.updateWorldMatrices();
+    checkWorldMatrices("posed", hierarchy);
+
+    // THE PARTIAL PASS OVER THE CHAIN'S FIRST 20 NODES AFTER POSING EVERY NODE AGAIN. THOSE MATCH THE WALK, THE REST KEEP THEIR OLD WORLD MATRICES
+    Test::context_ = "partial update";
+    {
+        const std::vector<glm::mat4> before = hierarchy.worldMatrices_;
+        std::vector<uint32_t> chain;
+        for (uint32_t n = 0; n < 20; n++) {
+            chain.push_back(n);
+        }
+        for (uint32_t n = 0; n < hierarchy.size(); n++) {
+            glm::vec3 scale;
+            randomTRS(generator, hierarchy.translations_[n], hierarchy.rotations_[n], scale);
+        }
+        hierarchy.updateWorldMatrices(chain);
+
+        float error = 0.0f;
+        size_t changed = 0;
+        for (uint32_t n = 0; n < hierarchy.size(); n++) {
+            if (n < 20) {
+                error = std::max(error, relativeError(hierarchy.worldMatrices_[n], parentWalk(hierarchy, n)));
+            }
+            else {
+                changed += hierarchy.worldMatrices_[n] != before[n] ? 1 : 0;
+            }
+        }
+        CHECK(error <= TOLERANCE);
+        CHECK(changed == 0);
+
+        hierarchy.updateWorldMatrices();
+        checkWorldMatrices("full update after a partial one", hierarchy);
+    }
+    Test::context_.clear();
+}
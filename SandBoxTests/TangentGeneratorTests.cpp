@@ -0,0 +1,125 @@
+#include "Test.h"
+#include "TangentGenerator.h"
+#include <random>
+#include <cstring>
+
+// AN UNPACKED (ONE VERTEX PER INDEX) BUMPY GRID PER ISLAND, islandSpacing APART ALONG x
+static void appendGrids(std::vector<Vertex>& corners, uint32_t islands, uint32_t size, float islandSpacing, std::mt19937& generator) {
+    std::uniform_real_distribution<float> bump(-0.2f, 0.2f);
+    for (uint32_t island = 0; island < islands; island++) {
+        std::vector<Vertex> grid;
+        for (uint32_t y = 0; y <= size; y++) {
+            for (uint32_t x = 0; x <= size; x++) {
+                Vertex v{};
+                glm::vec2 uv = glm::vec2(x, y) / static_cast<float>(size);
+                v.pos = glm::vec4(static_cast<float>(x) + island * islandSpacing, static_cast<float>(y), bump(generator), uv.x);
+                v.normal = glm::vec4(glm::normalize(glm::vec3(bump(generator), bump(generator), 1.0f)), uv.y);
+                grid.push_back(v);
+            }
+        }
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                const uint32_t a = y * (size + 1) + x;
+                const uint32_t b = a + size + 1;
+                for (uint32_t index : { a, b, a + 1, a + 1, b, b + 1 }) {
+                    corners.push_back(grid[index]);
+                }
+            }
+        }
+    }
+}
+
+// THE BATCHED PATH ON jobs AGAINST ONE genTangSpaceDefault CALL THROUGH THE PER CORNER CALLBACKS, BIT FOR BIT. RETURNS THE ISLANDS generate RAN
+static size_t checkBitExact(const std::string& name, const std::vector<Vertex>& corners, JobSystem* jobs) {
+    Test::context_ = name;
+    std::vector<Vertex> reference = corners;
+    TangentGenerator::generateSerial(reference);
+
+    std::vector<Vertex> batched = corners;
+    size_t islands = TangentGenerator::generate(batched, jobs);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < corners.size(); i++) {
+        if (memcmp(&batched[i].tangent, &reference[i].tangent, sizeof(glm::vec4)) != 0) {
+            mismatches++;
+        }
+    }
+    CHECK(batched.size() == corners.size());
+    CHECK(mismatches == 0);
+    return islands;
+}
+
+void runTangentGeneratorTests() {
+    std::mt19937 generator(3);
+    JobSystem jobs(3);
+
+    // UNDER THE SPLIT THRESHOLD, THE SoA INPUT AGAINST THE CALLBACKS
+    {
+        std::vector<Vertex> corners;
+        appendGrids(corners, 4, 16, 100.0f, generator);
+        CHECK(checkBitExact("small", corners, &jobs) == 1);
+    }
+
+    // OVER IT, TWELVE ISLANDS SPREAD OVER THE WORKERS
+    std::vector<Vertex> islands;
+    appendGrids(islands, 12, 60, 100.0f, generator);
+    CHECK(islands.size() >= TangentGenerator::SPLIT_THRESHOLD);
+    CHECK(checkBitExact("split", islands, &jobs) == 12);
+    CHECK(checkBitExact("split, no job system", islands, nullptr) == 1);
+
+    // ISLANDS OF VERY DIFFERENT SIZES, SO THE BATCHES ARE UNEVEN
+    {
+        std::vector<Vertex> corners;
+        appendGrids(corners, 1, 100, 1000.0f, generator);
+        for (uint32_t size = 1; size <= 40; size++) {
+            std::vector<Vertex> small;
+            appendGrids(small, 1, size, 0.0f, generator);
+            for (Vertex& v : small) {
+                v.pos.x += 200.0f + size * 100.0f;
+            }
+            corners.insert(corners.end(), small.begin(), small.end());
+        }
+        CHECK(checkBitExact("uneven islands", corners, &jobs) == 41);
+    }
+
+    // ONE GRID TWELVE TIMES OVER ON THE SAME POSITIONS, ONE ISLAND, SO NOTHING IS SPLIT
+    {
+        std::vector<Vertex> grid;
+        appendGrids(grid, 1, 60, 0.0f, generator);
+        std::vector<Vertex> corners;
+        for (uint32_t copy = 0; copy < 12; copy++) {
+            corners.insert(corners.end(), grid.begin(), grid.end());
+        }
+        CHECK(checkBitExact("stacked", corners, &jobs) == 1);
+    }
+
+    // TWO ISLANDS JOINED BY ONE TRIANGLE THAT SHARES A POSITION WITH EACH
+    {
+        std::vector<Vertex> corners;
+        appendGrids(corners, 2, 110, 200.0f, generator);
+        Vertex bridge[3] = { corners[0], corners[corners.size() / 2], corners[1] };
+        corners.insert(corners.end(), bridge, bridge + 3);
+        CHECK(checkBitExact("bridged", corners, &jobs) == 1);
+    }
+
+    // ZERO AREA TRIANGLES AND -0 POSITIONS AMONG THE ISLANDS
+    {
+        std::vector<Vertex> corners = islands;
+        for (size_t i = 0; i < corners.size(); i += 97) {
+            corners[i].pos.x = corners[i - i % 3].pos.x;
+            corners[i].pos.y = corners[i - i % 3].pos.y;
+            corners[i].pos.z = corners[i - i % 3].pos.z;
+        }
+        for (Vertex& v : corners) {
+            if (v.pos.x == 0.0f) {
+                v.pos.x = -0.0f;
+            }
+        }
+        checkBitExact("degenerate", corners, &jobs);
+    }
+
+    // THE SAME POOL ON A SINGLE THREAD
+    jobs.setActiveWorkers(0);
+    CHECK(checkBitExact("no active workers", islands, &jobs) == 1);
+    Test::context_.clear();
+}
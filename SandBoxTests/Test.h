@@ -0,0 +1,34 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+// CHECKS FOR THE STANDALONE ENGINE TESTS. A FAILED CHECK PRINTS WHERE IT FAILED AND WHAT IT WAS TESTING, main RETURNS NONZERO IF ANY DID SO THE
+// POST BUILD RUN FAILS THE BUILD
+class Test {
+public:
+	static inline int checks_ = 0;
+	static inline int failures_ = 0;
+	static inline std::string context_; // THE CASE BEING CHECKED, PRINTED WITH EACH FAILURE
+
+	static void check(bool passed, const char* expression, const char* file, int line) {
+		checks_++;
+		if (!passed) {
+			failures_++;
+			std::cout << file << "(" << line << "): check failed: " << expression << (context_.empty() ? "" : " [" + context_ + "]") << std::endl;
+		}
+	}
+};
+
+#define CHECK(expression) Test::check((expression), #expression, __FILE__, __LINE__)
+
+void runMeshletBuilderTests();
+void runDualQuaternionSkinningTests();
+void runJobSystemTests();
+void runTangentGeneratorTests();
+void runVertexWelderTests();
+void runInstanceTransformsTests();
+void runCompiledAnimationTests();
+void runClipCompressorTests();
+void runNodeHierarchyTests();
+void runAnimationLODTests();
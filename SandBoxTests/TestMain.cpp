@@ -0,0 +1,17 @@
+#include "Test.h"
+
+int main() {
+    runMeshletBuilderTests();
+    runDualQuaternionSkinningTests();
+    runJobSystemTests();
+    runTangentGeneratorTests();
+    runVertexWelderTests();
+    runInstanceTransformsTests();
+    runCompiledAnimationTests();
+    runClipCompressorTests();
+    runNodeHierarchyTests();
+    runAnimationLODTests();
+
+    std::cout << Test::checks_ - Test::failures_ << " / " << Test::checks_ << " checks passed" << std::endl;
+    return Test::failures_ == 0 ? 0 : 1;
+}
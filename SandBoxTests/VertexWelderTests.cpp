@@ -0,0 +1,186 @@
+#include "Test.h"
+#include "VertexWelder.h"
+#include <random>
+#include <unordered_map>
+
+// THE LOADERS' ORIGINAL unordered_map WELD, THE REFERENCE FOR EXACT MODE
+static void weldReference(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t indexBase) {
+    indices.clear();
+    indices.reserve(vertices.size());
+    std::unordered_map<Vertex, uint32_t> uniqueVertices;
+
+    size_t oldVertexCount = vertices.size();
+    uint32_t postTVertexCount = 0;
+    for (size_t i = 0; i < oldVertexCount; ++i) {
+        Vertex v = vertices[i];
+
+        auto index = uniqueVertices.find(v);
+        if (index == uniqueVertices.end()) {
+            uint32_t vertIndex = postTVertexCount;
+            postTVertexCount++;
+            uniqueVertices.insert(std::make_pair(v, vertIndex));
+            vertices[vertIndex] = v;
+            indices.push_back(vertIndex + indexBase);
+        }
+        else {
+            indices.push_back(index->second + indexBase);
+        }
+    }
+    vertices.resize(postTVertexCount);
+}
+
+// A GRID OF (size + 1)^2 VERTICES SPACED spacing APART FROM origin, UNPACKED INTO size^2 * 6 CORNERS
+static std::vector<Vertex> unpackedGrid(uint32_t size, const glm::vec3& origin, float spacing) {
+    std::vector<Vertex> grid;
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            Vertex v{};
+            v.pos = glm::vec4(origin + glm::vec3(x, y, 0.0f) * spacing, static_cast<float>(x) / size);
+            v.normal = glm::vec4(0.0f, 0.0f, 1.0f, static_cast<float>(y) / size);
+            v.tangent = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+            grid.push_back(v);
+        }
+    }
+    std::vector<Vertex> corners;
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            const uint32_t a = y * (size + 1) + x;
+            const uint32_t b = a + size + 1;
+            for (uint32_t index : { a, b, a + 1, a + 1, b, b + 1 }) {
+                corners.push_back(grid[index]);
+            }
+        }
+    }
+    return corners;
+}
+
+// WELDS corners INTO vertices/indices, CHECKS THERE IS ONE INDEX PER CORNER AND THAT EACH (LESS indexBase) POINTS AT A VERTEX WITHIN epsilon OF IT
+static void weldChecked(const std::string& name, const std::vector<Vertex>& corners, float epsilon, uint32_t indexBase, JobSystem* jobs, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    Test::context_ = name;
+    vertices = corners;
+    VertexWelder::weld(vertices, indices, indexBase, epsilon, jobs);
+    CHECK(indices.size() == corners.size());
+
+    size_t outOfRange = 0;
+    size_t moved = 0;
+    const float tolerance = epsilon > 0.0f ? epsilon : 0.0f;
+    for (size_t i = 0; i < indices.size() && i < corners.size(); i++) {
+        if (indices[i] < indexBase || indices[i] - indexBase >= vertices.size()) {
+            outOfRange++;
+            continue;
+        }
+        const Vertex& v = vertices[indices[i] - indexBase];
+        const glm::vec4 d = glm::abs(v.pos - corners[i].pos);
+        if (std::max(std::max(d.x, d.y), std::max(d.z, d.w)) > tolerance) {
+            moved++;
+        }
+    }
+    CHECK(outOfRange == 0);
+    CHECK(moved == 0);
+}
+
+// weldChecked, THEN THE NUMBER OF VERTICES LEFT
+static void checkWeld(const std::string& name, const std::vector<Vertex>& corners, float epsilon, size_t expectedVertices, uint32_t indexBase = 0) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    weldChecked(name, corners, epsilon, indexBase, nullptr, vertices, indices);
+    CHECK(vertices.size() == expectedVertices);
+}
+
+void runVertexWelderTests() {
+    std::mt19937 generator(8);
+    JobSystem jobs(3);
+
+    // EXACT MODE AGAINST THE unordered_map WELD, SAME VERTICES IN THE SAME FIRST OCCURRENCE ORDER AND THE SAME INDICES
+    {
+        const std::vector<Vertex> corners = unpackedGrid(32, glm::vec3(0.0f), 1.0f);
+        std::vector<Vertex> welded;
+        std::vector<uint32_t> indices;
+        weldChecked("grid", corners, 0.0f, 0, nullptr, welded, indices);
+        CHECK(welded.size() == 33 * 33);
+
+        std::vector<Vertex> reference = corners;
+        std::vector<uint32_t> referenceIndices;
+        weldReference(reference, referenceIndices, 0);
+        CHECK(welded.size() == reference.size());
+        CHECK(indices == referenceIndices);
+        CHECK(welded == reference);
+    }
+
+    checkWeld("index base", unpackedGrid(8, glm::vec3(0.0f), 1.0f), 0.0f, 9 * 9, 1000);
+    checkWeld("empty", std::vector<Vertex>(), 0.0f, 0);
+
+    // -0 AND +0 ARE THE SAME VERTEX, ANY OTHER DIFFERENCE KEEPS THEM APART
+    {
+        std::vector<Vertex> corners(6);
+        corners[0].pos = glm::vec4(0.0f, 1.0f, 2.0f, 0.0f);
+        corners[1].pos = glm::vec4(-0.0f, 1.0f, 2.0f, -0.0f);
+        corners[2].pos = glm::vec4(0.0f, 1.0f, 2.0f, 0.0f);
+        corners[2].normal = glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+        corners[3].pos = glm::vec4(0.0f, 1.0f, 2.0f, 0.0f);
+        corners[3].tangent = glm::vec4(1.0f, 0.0f, 0.0f, -1.0f);
+        corners[4].pos = glm::vec4(std::nextafter(0.0f, 1.0f), 1.0f, 2.0f, 0.0f);
+        corners[5] = corners[3];
+        checkWeld("signed zero", corners, 0.0f, 4);
+    }
+
+    // EVERY CORNER JITTERED BY UNDER A TENTH OF epsilon ABOUT A GRID POINT THAT SITS ON THE epsilon GRID, SO EACH SNAPS BACK TO ITS OWN CELL
+    {
+        const float epsilon = 1.0f / 64.0f;
+        std::vector<Vertex> corners = unpackedGrid(20, glm::vec3(-4.0f, 2.0f, 0.5f), 4.0f * epsilon);
+        std::uniform_real_distribution<float> jitter(-0.1f * epsilon, 0.1f * epsilon);
+        for (Vertex& v : corners) {
+            v.pos += glm::vec4(jitter(generator), jitter(generator), jitter(generator), 0.0f);
+            v.normal += glm::vec4(jitter(generator), jitter(generator), jitter(generator), 0.0f);
+        }
+        checkWeld("jittered, epsilon", corners, epsilon, 21 * 21);
+        checkWeld("jittered, exact", corners, 0.0f, corners.size());
+    }
+
+    // FAR FROM THE ORIGIN WITH A TINY epsilon. THE CELLS DON'T FIT 32 BITS AND PAST 2^62 THEY DON'T FIT AT ALL, NEIGHBOURING FLOATS MUST STAY APART
+    {
+        struct Case {
+            const char* name;
+            glm::vec3 origin;
+            float epsilon;
+        };
+        const Case cases[] = {
+            { "large coordinates", glm::vec3(1.0e6f, -3.0e6f, 2.0e6f), 1.0e-6f },
+            { "beyond the cell range", glm::vec3(1.0e30f, -1.0e30f, 5.0e29f), 1.0e-9f },
+        };
+        for (const Case& c : cases) {
+            // EVERY GRID POINT ITS OWN NUMBER OF FLOAT STEPS ALONG x FROM origin, NOTHING ELSE TELLS THEM APART
+            std::vector<Vertex> corners = unpackedGrid(10, glm::vec3(0.0f), 1.0f);
+            for (Vertex& v : corners) {
+                const uint32_t steps = static_cast<uint32_t>(v.pos.x) + 11 * static_cast<uint32_t>(v.pos.y);
+                v.pos = glm::vec4(c.origin, 0.0f);
+                v.normal.w = 0.0f;
+                for (uint32_t s = 0; s < steps; s++) {
+                    v.pos.x = std::nextafter(v.pos.x, INFINITY);
+                }
+            }
+            checkWeld(c.name, corners, c.epsilon, 11 * 11);
+        }
+    }
+
+    // OVER THE PARALLEL THRESHOLD THE SHARDED WELD ON THE JOB SYSTEM MATCHES THE SERIAL ONE EXACTLY, IN BOTH MODES
+    {
+        std::vector<Vertex> corners = unpackedGrid(110, glm::vec3(0.0f), 0.5f);
+        std::uniform_int_distribution<size_t> pick(0, corners.size() - 1);
+        for (int i = 0; i < 1000; i++) {
+            corners[pick(generator)].tangent.w = -1.0f;
+        }
+        CHECK(corners.size() >= VertexWelder::PARALLEL_THRESHOLD);
+        const float epsilons[] = { 0.0f, 0.3f };
+        for (float epsilon : epsilons) {
+            std::vector<Vertex> serial, sharded;
+            std::vector<uint32_t> serialIndices, shardedIndices;
+            weldChecked("serial", corners, epsilon, 7, nullptr, serial, serialIndices);
+            weldChecked("sharded", corners, epsilon, 7, &jobs, sharded, shardedIndices);
+            CHECK(serial.size() < corners.size());
+            CHECK(shardedIndices == serialIndices);
+            CHECK(sharded == serial);
+        }
+    }
+    Test::context_.clear();
+}